@@ -0,0 +1,132 @@
+#include <stdlib.h>
+#include "alloc.h"
+#include "data.h"
+#include "err.h"
+#include "lists.h"
+#include "state.h"
+
+/** Size of each chunk of memory requested from the system when an arena runs dry. */
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+/** Released memory is threaded into a free list through its own first word. */
+struct FreeSlot {
+  struct FreeSlot* next;
+};
+
+struct ArenaBlock {
+  struct ArenaBlock* next;
+};
+
+// NOTE: Memory released under a state other than the one that allocated it is pushed onto the releasing state's free
+//  list. This is safe as long as the allocating state outlives it, it just means memory can migrate between arenas.
+
+static size_t size_class(size_t size) {
+  return (size + LISP_ALLOC_GRANULARITY - 1) / LISP_ALLOC_GRANULARITY - 1;
+}
+
+/**
+ * Acquire a fresh block for the arena. Whatever space remained in the previous block is abandoned, but with blocks this
+ * much larger than the biggest size class, the waste is negligible.
+ */
+static void grow_arena(struct Arena* arena) {
+  struct ArenaBlock* block = malloc(sizeof(struct ArenaBlock) + ARENA_BLOCK_SIZE);
+
+  if (block == NULL) {
+    lisp_out_of_memory();
+    return;
+  }
+
+  block->next = arena->blocks;
+  arena->blocks = block;
+  arena->bump = (char*) (block + 1);
+  arena->limit = arena->bump + ARENA_BLOCK_SIZE;
+}
+
+void* lisp_alloc(size_t size) {
+  if (size == 0) {
+    size = 1;
+  }
+
+  if (size > LISP_ALLOC_MAX_SMALL) {
+    void* ptr = malloc(size);
+
+    if (ptr == NULL) {
+      lisp_out_of_memory();
+    }
+
+    return ptr;
+  }
+
+  struct Arena* arena = &lisp_state_current()->arena;
+  size_t class = size_class(size);
+
+  // Reuse released memory before growing the arena.
+  struct FreeSlot* slot = arena->free_lists[class];
+  if (slot != NULL) {
+    arena->free_lists[class] = slot->next;
+    return slot;
+  }
+
+  size_t rounded = (class + 1) * LISP_ALLOC_GRANULARITY;
+
+  if (arena->bump == NULL || (size_t) (arena->limit - arena->bump) < rounded) {
+    grow_arena(arena);
+  }
+
+  void* ptr = arena->bump;
+  arena->bump += rounded;
+  return ptr;
+}
+
+void lisp_free(void* ptr, size_t size) {
+  if (ptr == NULL) {
+    return;
+  }
+
+  if (size == 0) {
+    size = 1;
+  }
+
+  if (size > LISP_ALLOC_MAX_SMALL) {
+    free(ptr);
+    return;
+  }
+
+  struct Arena* arena = &lisp_state_current()->arena;
+  size_t class = size_class(size);
+
+  struct FreeSlot* slot = ptr;
+  slot->next = arena->free_lists[class];
+  arena->free_lists[class] = slot;
+}
+
+void destroy_arena(struct Arena* arena) {
+  while (arena->blocks != NULL) {
+    struct ArenaBlock* next = arena->blocks->next;
+    free(arena->blocks);
+    arena->blocks = next;
+  }
+
+  *arena = (struct Arena) {0};
+}
+
+struct LispDatum* alloc_datum(void) {
+#ifdef LISP_TRACING_GC
+  return gc_alloc_datum();
+#else
+  return lisp_alloc(sizeof(struct LispDatum));
+#endif
+}
+
+void free_datum(struct LispDatum* x) {
+#ifdef LISP_TRACING_GC
+  // Datums are only ever reclaimed by the collector.
+  (void) x;
+#else
+  if (x->refs & LISP_REFS_CHUNKED) {
+    free_chunked_cell(x);
+  } else {
+    lisp_free(x, sizeof(struct LispDatum));
+  }
+#endif
+}
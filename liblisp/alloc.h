@@ -0,0 +1,52 @@
+#ifndef LISP_ALLOC_H
+#define LISP_ALLOC_H
+
+#include <stddef.h>
+
+struct LispDatum;
+
+/** Requests larger than this bypass the arenas entirely and are passed directly to malloc/free. */
+#define LISP_ALLOC_MAX_SMALL 256
+
+/** Every small request is rounded up to a multiple of this, which also guarantees 8 byte alignment. */
+#define LISP_ALLOC_GRANULARITY 8
+#define LISP_ALLOC_SIZE_CLASSES (LISP_ALLOC_MAX_SMALL / LISP_ALLOC_GRANULARITY)
+
+/** Bump allocator backing small allocations. Each `LispState` owns one, and its fields are private to alloc.c. */
+struct Arena {
+  /** Every block ever handed out by the system, so that the arena can eventually be torn down. */
+  struct ArenaBlock* blocks;
+
+  /** Bump region of the most recent block. */
+  char* bump;
+  char* limit;
+
+  struct FreeSlot* free_lists[LISP_ALLOC_SIZE_CLASSES];
+};
+
+/** Return every block owned by an arena to the system. Anything allocated from it becomes invalid. */
+void destroy_arena(struct Arena* arena);
+
+/**
+ * Allocate `size` bytes of runtime memory.
+ *
+ * Small requests are served from the arena of the current `LispState`, first checking a free list for the matching size class so
+ * that recently released memory is reused before the arena grows. The returned memory is 8 byte aligned and is not
+ * initialized. Running out of memory is fatal.
+ */
+void* lisp_alloc(size_t size);
+
+/**
+ * Return memory obtained through `lisp_alloc` to the allocator. The size must be the same size that was originally
+ * requested, since it is used to find the size class rather than storing a header alongside each allocation. Passing
+ * NULL does nothing.
+ */
+void lisp_free(void* ptr, size_t size);
+
+/** Shorthand for allocating a single uninitialized datum. */
+struct LispDatum* alloc_datum(void);
+
+/** Release a datum previously obtained from `alloc_datum`. Does not touch anything the datum refers to. */
+void free_datum(struct LispDatum* x);
+
+#endif //LISP_ALLOC_H
@@ -0,0 +1,247 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "../lisp.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_CYCLES 1
+#else
+#define BENCH_HAS_CYCLES 0
+#endif
+
+/** Batches never grow past this many repetitions, however fast the operation. */
+#define BENCH_MAX_BATCH (1u << 30)
+
+/** Most arguments `bench_native` accepts. */
+#define BENCH_MAX_ARGS 8
+
+static uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+static uint64_t now_cycles() {
+#if BENCH_HAS_CYCLES
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static int compare_doubles(const void* a, const void* b) {
+  double x = *(const double*) a;
+  double y = *(const double*) b;
+  return (x > y) - (x < y);
+}
+
+/** Nearest rank percentile of sorted values. */
+static double percentile(const double* sorted, uint32_t count, uint32_t p) {
+  uint32_t rank = (uint32_t) (((uint64_t) p * count + 99) / 100);
+  return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+static uint64_t run_batch(BenchBody body, void* context, uint32_t batch) {
+  uint64_t start = now_ns();
+
+  for (uint32_t i = 0; i < batch; ++i) {
+    body(context);
+  }
+
+  uint64_t elapsed = now_ns() - start;
+
+  // Anything the batch left behind is garbage, so collecting it here keeps the next batch from paying for it.
+  flush_releases();
+  gc_safepoint();
+  return elapsed;
+}
+
+void bench_start(struct Bench* bench, const struct BenchOptions* options) {
+  bench->options = *options;
+  bench->group = "";
+  bench->count = 0;
+
+  if (options->format == BenchCSV) {
+    fprintf(options->out, "group,name,variant,size,batch,samples,min_ns,median_ns,p90_ns,p99_ns,max_ns,"
+                          "median_cycles\n");
+  } else {
+#ifdef LISP_TRACING_GC
+    const char* memory_manager = "tracing";
+#else
+    const char* memory_manager = "refcount";
+#endif
+    fprintf(options->out, "{\n  \"memory_manager\": \"%s\",\n  \"results\": [", memory_manager);
+  }
+}
+
+void bench_finish(struct Bench* bench) {
+  if (bench->options.format == BenchJSON) {
+    fprintf(bench->options.out, "\n  ]\n}\n");
+  }
+
+  fflush(bench->options.out);
+}
+
+bool bench_selected(const struct Bench* bench, const char* name) {
+  return bench->options.filter == NULL || strstr(name, bench->options.filter) != NULL;
+}
+
+void bench_run(struct Bench* bench, const char* name, const char* variant, uint64_t size, BenchBody body,
+               void* context) {
+  if (!bench_selected(bench, name)) {
+    return;
+  }
+
+  const struct BenchOptions* options = &bench->options;
+  uint32_t batch = 1;
+
+  while (run_batch(body, context, batch) < options->min_sample_ns && batch < BENCH_MAX_BATCH) {
+    batch *= 2;
+  }
+
+  for (uint32_t i = 0; i < options->warmup; ++i) {
+    run_batch(body, context, batch);
+  }
+
+  uint32_t samples = options->samples == 0 ? 1 : options->samples;
+  double* ns = malloc(samples * sizeof(double));
+  double* cycles = malloc(samples * sizeof(double));
+
+  if (ns == NULL || cycles == NULL) {
+    set_global_error_behavior(LogAndQuit);
+    raise(Generic, "Unable to allocate memory.");
+    return;
+  }
+
+  for (uint32_t i = 0; i < samples; ++i) {
+    uint64_t start = now_cycles();
+    ns[i] = (double) run_batch(body, context, batch) / batch;
+
+    // Also counts the collection that follows the batch, so this is only an approximation.
+    cycles[i] = (double) (now_cycles() - start) / batch;
+  }
+
+  qsort(ns, samples, sizeof(double), compare_doubles);
+  qsort(cycles, samples, sizeof(double), compare_doubles);
+
+  FILE* out = options->out;
+
+  if (options->format == BenchCSV) {
+    fprintf(out, "%s,%s,\"%s\",%llu,%u,%u,%.2f,%.2f,%.2f,%.2f,%.2f,", bench->group, name, variant,
+            (unsigned long long) size, batch, samples, ns[0], percentile(ns, samples, 50),
+            percentile(ns, samples, 90), percentile(ns, samples, 99), ns[samples - 1]);
+
+    if (BENCH_HAS_CYCLES) {
+      fprintf(out, "%.1f", percentile(cycles, samples, 50));
+    }
+
+    fprintf(out, "\n");
+  } else {
+    fprintf(out, "%s\n    {\"group\": \"%s\", \"name\": \"%s\", \"variant\": \"%s\", \"size\": %llu, "
+                 "\"batch\": %u, \"samples\": %u, \"min_ns\": %.2f, \"median_ns\": %.2f, \"p90_ns\": %.2f, "
+                 "\"p99_ns\": %.2f, \"max_ns\": %.2f, \"median_cycles\": ",
+            bench->count == 0 ? "" : ",", bench->group, name, variant, (unsigned long long) size, batch, samples,
+            ns[0], percentile(ns, samples, 50), percentile(ns, samples, 90), percentile(ns, samples, 99),
+            ns[samples - 1]);
+
+    if (BENCH_HAS_CYCLES) {
+      fprintf(out, "%.1f}", percentile(cycles, samples, 50));
+    } else {
+      fprintf(out, "null}");
+    }
+  }
+
+  fflush(out);
+  ++bench->count;
+
+  free(ns);
+  free(cycles);
+}
+
+struct NativeCall {
+  LispFunction native;
+  struct LispDatum** args;
+  uint32_t nargs;
+};
+
+static void call_native(void* context) {
+  struct NativeCall* call = context;
+  release(call->native(call->args, call->nargs));
+}
+
+void bench_native_array(struct Bench* bench, const char* name, const char* variant, uint64_t size,
+                        LispFunction native, struct LispDatum** args, uint32_t nargs) {
+  if (!bench_selected(bench, name)) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < nargs; ++i) {
+    gc_push_root(&args[i]);
+  }
+
+  struct NativeCall call = {.native = native, .args = args, .nargs = nargs};
+  bench_run(bench, name, variant, size, call_native, &call);
+  gc_pop_roots(nargs);
+}
+
+void bench_native(struct Bench* bench, const char* name, const char* variant, uint64_t size, LispFunction native,
+                  uint32_t nargs, ...) {
+  struct LispDatum* args[BENCH_MAX_ARGS];
+  va_list list;
+  va_start(list, nargs);
+
+  for (uint32_t i = 0; i < nargs; ++i) {
+    args[i] = va_arg(list, struct LispDatum*);
+  }
+
+  va_end(list);
+
+  bench_native_array(bench, name, variant, size, native, args, nargs);
+
+  for (uint32_t i = 0; i < nargs; ++i) {
+    release(args[i]);
+  }
+}
+
+struct LispDatum** bench_integers(uint32_t count) {
+  struct LispDatum** items = malloc((count == 0 ? 1 : count) * sizeof(struct LispDatum*));
+
+  if (items == NULL) {
+    set_global_error_behavior(LogAndQuit);
+    raise(Generic, "Unable to allocate memory.");
+    return NULL;
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+    items[i] = box_integer((int32_t) i);
+  }
+
+  return items;
+}
+
+void bench_free_integers(struct LispDatum** items, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    release(items[i]);
+  }
+
+  free(items);
+}
+
+struct LispDatum* bench_integer_list(uint32_t count) {
+  struct LispDatum** items = bench_integers(count);
+  struct LispDatum* list = new_list(items, count, NULL);
+  bench_free_integers(items, count);
+  return list;
+}
+
+struct LispDatum* bench_integer_vector(uint32_t count) {
+  struct LispDatum** items = bench_integers(count);
+  struct LispDatum* v = new_vector_from(items, count);
+  bench_free_integers(items, count);
+  return v;
+}
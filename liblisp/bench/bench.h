@@ -0,0 +1,96 @@
+#ifndef LISP_BENCH_H
+#define LISP_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "../stdlisp.h"
+
+/*
+ * A small timing harness for the runtime. Each benchmark repeats one operation in batches, doubling the size of a batch
+ * until a single batch takes at least `min_sample_ns`, so that the overhead of reading the clock disappears even for
+ * operations taking a few nanoseconds. It then runs `warmup` batches that are thrown away, followed by `samples`
+ * measured ones, and reports percentiles of the time per operation across them.
+ *
+ * Time is read from CLOCK_MONOTONIC. On x86, the time stamp counter is read alongside it, which counts at a constant
+ * reference rate rather than the current clock speed of the core, but is still handy for comparing runs on one machine.
+ *
+ * Nothing is ever stored between benchmarks: a benchmark runs as soon as it is declared, and its result is written out
+ * right away.
+ */
+
+enum BenchFormat {
+  BenchCSV,
+  BenchJSON
+};
+
+struct BenchOptions {
+  uint32_t warmup;
+  uint32_t samples;
+  uint64_t min_sample_ns;
+
+  /** Only benchmarks whose name contains this are run, if it is not NULL. */
+  const char* filter;
+
+  enum BenchFormat format;
+  FILE* out;
+};
+
+struct Bench {
+  struct BenchOptions options;
+
+  /** Names the suite that the benchmarks being run belong to. */
+  const char* group;
+
+  /** Results written so far. */
+  uint32_t count;
+};
+
+/** Called once per repetition of the operation being measured. */
+typedef void (*BenchBody)(void* context);
+
+/** Start writing results. Must be matched by a call to `bench_finish`. */
+void bench_start(struct Bench* bench, const struct BenchOptions* options);
+
+void bench_finish(struct Bench* bench);
+
+/** Whether a benchmark passes the filter. Use it to skip building expensive inputs for benchmarks that won't run. */
+bool bench_selected(const struct Bench* bench, const char* name);
+
+/**
+ * Measure `body`, and write out the result. `variant` describes the inputs, such as their types, and `size` is how
+ * many items the operation works on, or 1 if that doesn't apply. A safepoint follows every batch, so with the tracing
+ * collector, any datum `context` refers to must be rooted.
+ */
+void bench_run(struct Bench* bench, const char* name, const char* variant, uint64_t size, BenchBody body,
+               void* context);
+
+/** Measure calls to a native with the given arguments, which are only borrowed, releasing the value each returns. */
+void bench_native_array(struct Bench* bench, const char* name, const char* variant, uint64_t size,
+                        LispFunction native, struct LispDatum** args, uint32_t nargs);
+
+/**
+ * Like `bench_native_array`, with up to 8 arguments following `nargs`. The arguments are owned by the benchmark, and
+ * released once it completes, even if it is filtered out.
+ */
+void bench_native(struct Bench* bench, const char* name, const char* variant, uint64_t size, LispFunction native,
+                  uint32_t nargs, ...);
+
+/** A new array of new references to the integers 0 to `count` - 1. Free it with `bench_free_integers`. */
+struct LispDatum** bench_integers(uint32_t count);
+
+void bench_free_integers(struct LispDatum** items, uint32_t count);
+
+/** A proper list of the integers 0 to `count` - 1. */
+struct LispDatum* bench_integer_list(uint32_t count);
+
+/** A vector of the integers 0 to `count` - 1. */
+struct LispDatum* bench_integer_vector(uint32_t count);
+
+// Suites, one per area of the runtime.
+void bench_numeric(struct Bench* bench);
+void bench_lists(struct Bench* bench);
+void bench_containers(struct Bench* bench);
+void bench_output(struct Bench* bench);
+
+#endif //LISP_BENCH_H
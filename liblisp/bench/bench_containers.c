@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "../lisp.h"
+
+/** Number of items in the containers each operation is measured on. */
+static const uint32_t sizes[] = {10, 1000, 100000};
+
+static void vectors(struct Bench* bench, uint32_t n) {
+  if (!bench_selected(bench, "vector")) {
+    return;
+  }
+
+  struct LispDatum** items = bench_integers(n);
+  bench_native_array(bench, "vector", "integer", n, vector, items, n);
+  bench_free_integers(items, n);
+}
+
+/** A hash map from the integers 0 to `n` - 1 to themselves. */
+static struct LispDatum* integer_map(uint32_t n) {
+  struct LispDatum* map = new_hash_map(n);
+
+  for (uint32_t i = 0; i < n; ++i) {
+    struct LispDatum* key = box_integer((int32_t) i);
+    release(hash_put3(map, key, key));
+    release(key);
+  }
+
+  return map;
+}
+
+static void hash_maps(struct Bench* bench, uint32_t n) {
+  if (!bench_selected(bench, "hash-map")) {
+    return;
+  }
+
+  // Alternating keys and values.
+  struct LispDatum** items = bench_integers(2 * n);
+  bench_native_array(bench, "hash-map", "integer", n, hash_map, items, 2 * n);
+  bench_free_integers(items, 2 * n);
+}
+
+struct RemoveAndPut {
+  struct LispDatum* map;
+  struct LispDatum* key;
+};
+
+/** Removing a key and putting it back, so that every repetition actually removes something. */
+static void remove_and_put(void* context) {
+  struct RemoveAndPut* r = context;
+  release(hash_remove2(r->map, r->key));
+  release(hash_put3(r->map, r->key, r->key));
+}
+
+static void hash_remove_put(struct Bench* bench, uint32_t n) {
+  struct RemoveAndPut r = {integer_map(n), box_integer((int32_t) n / 2)};
+  gc_push_root(&r.map);
+  gc_push_root(&r.key);
+
+  bench_run(bench, "hash-remove!+hash-put!", "integer", n, remove_and_put, &r);
+
+  gc_pop_roots(2);
+  release(r.map);
+  release(r.key);
+}
+
+static void strings(struct Bench* bench, uint32_t n) {
+  char* chars = malloc(n + 1);
+  memset(chars, 'a', n);
+  chars[n] = '\0';
+
+  bench_native(bench, "string-append", "string,string", 2 * n, string_append, 2, new_string_from_copy(chars, n),
+               new_string_from_copy(chars, n));
+  free(chars);
+}
+
+struct ArrayKind {
+  const char* name;
+  LispFunction from_args;
+  LispFunction from_list;
+};
+
+static const struct ArrayKind array_kinds[] = {
+    {"i32-array", i32_array, list_to_i32_array},
+    {"f64-array", f64_array, list_to_f64_array},
+    {"c128-array", c128_array, list_to_c128_array},
+};
+
+/** An array of `n` small integers plus `offset`, kept small enough that products of them can't overflow. */
+static struct LispDatum* integer_array(const struct ArrayKind* kind, uint32_t n, int32_t offset) {
+  struct LispDatum** items = malloc(n * sizeof(struct LispDatum*));
+
+  for (uint32_t i = 0; i < n; ++i) {
+    items[i] = box_integer((int32_t) (i % 1000) + offset);
+  }
+
+  struct LispDatum* list = new_list(items, n, NULL);
+  struct LispDatum* array = kind->from_list(&list, 1);
+  release(list);
+  bench_free_integers(items, n);
+  return array;
+}
+
+static void arrays(struct Bench* bench, const struct ArrayKind* kind, uint32_t n) {
+  if (bench_selected(bench, kind->name)) {
+    struct LispDatum** items = bench_integers(n);
+    bench_native_array(bench, kind->name, "integer", n, kind->from_args, items, n);
+    bench_free_integers(items, n);
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), "list->%s", kind->name);
+  bench_native(bench, name, "list", n, kind->from_list, 1, bench_integer_list(n));
+
+  bench_native(bench, "array->list", kind->name, n, array_to_list, 1, integer_array(kind, n, 0));
+  bench_native(bench, "array-length", kind->name, n, array_length, 1, integer_array(kind, n, 0));
+  bench_native(bench, "array-ref", kind->name, n, array_ref, 2, integer_array(kind, n, 0), box_integer(0));
+
+  static const struct {
+    const char* name;
+    LispFunction native;
+  } elementwise[] = {{"array+", array_add}, {"array-", array_subtract}, {"array*", array_multiply},
+                     {"array-dot", array_dot}};
+
+  for (size_t i = 0; i < sizeof(elementwise) / sizeof(elementwise[0]); ++i) {
+    bench_native(bench, elementwise[i].name, kind->name, n, elementwise[i].native, 2, integer_array(kind, n, 0),
+                 integer_array(kind, n, 0));
+  }
+
+  // Shifted up by one, so that none of the divisors are zero.
+  bench_native(bench, "array/", kind->name, n, array_divide, 2, integer_array(kind, n, 0),
+               integer_array(kind, n, 1));
+
+  bench_native(bench, "array-sum", kind->name, n, array_sum, 1, integer_array(kind, n, 0));
+
+  // Complex numbers aren't ordered.
+  if (kind->from_args != c128_array) {
+    bench_native(bench, "array-min", kind->name, n, array_min, 1, integer_array(kind, n, 0));
+    bench_native(bench, "array-max", kind->name, n, array_max, 1, integer_array(kind, n, 0));
+  }
+}
+
+void bench_containers(struct Bench* bench) {
+  bench->group = "containers";
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    uint32_t n = sizes[s];
+    struct LispDatum* middle = box_integer((int32_t) n / 2);
+    gc_push_root(&middle);
+
+    vectors(bench, n);
+    bench_native(bench, "vector-length", "vector", n, vector_length, 1, bench_integer_vector(n));
+    bench_native(bench, "vector-ref", "vector,integer", n, vector_ref, 2, bench_integer_vector(n), retain(middle));
+    bench_native(bench, "vector-set!", "vector,integer,integer", n, vector_set, 3, bench_integer_vector(n),
+                 retain(middle), box_integer(1));
+    bench_native(bench, "vector-slice", "vector,integer", n, vector_slice, 2, bench_integer_vector(n),
+                 retain(middle));
+
+    hash_maps(bench, n);
+    bench_native(bench, "hash-get", "hit", n, hash_get, 2, integer_map(n), retain(middle));
+    bench_native(bench, "hash-get", "miss", n, hash_get, 2, integer_map(n), box_integer(-1));
+    bench_native(bench, "hash-contains?", "hit", n, hash_contains, 2, integer_map(n), retain(middle));
+    bench_native(bench, "hash-put!", "replace", n, hash_put, 3, integer_map(n), retain(middle), box_integer(0));
+    hash_remove_put(bench, n);
+    bench_native(bench, "hash-count", "integer", n, hash_count, 1, integer_map(n));
+    bench_native(bench, "hash-keys", "integer", n, hash_keys, 1, integer_map(n));
+    bench_native(bench, "hash-values", "integer", n, hash_values, 1, integer_map(n));
+    bench_native(bench, "hash->list", "integer", n, hash_to_list, 1, integer_map(n));
+
+    strings(bench, n);
+
+    for (size_t k = 0; k < sizeof(array_kinds) / sizeof(array_kinds[0]); ++k) {
+      arrays(bench, &array_kinds[k], n);
+    }
+
+    gc_pop_roots(1);
+    release(middle);
+  }
+
+  // Grows the vector by one item per repetition, so this is the amortized cost of pushing.
+  bench_native(bench, "vector-push!", "vector,integer", 1, vector_push, 2, new_vector(0), box_integer(1));
+}
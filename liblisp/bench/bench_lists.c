@@ -0,0 +1,48 @@
+#include "bench.h"
+#include "../lisp.h"
+
+/** Lengths of the lists each list operation is measured on. */
+static const uint32_t sizes[] = {10, 1000, 1000000};
+
+static struct LispDatum* add_code(struct LispDatum* self, struct LispDatum** args, uint32_t nargs) {
+  (void) self;
+  return add(args, nargs);
+}
+
+/** Build a list out of `n` arguments. */
+static void build(struct Bench* bench, uint32_t n) {
+  if (!bench_selected(bench, "list")) {
+    return;
+  }
+
+  struct LispDatum** items = bench_integers(n);
+  bench_native_array(bench, "list", "integer", n, list, items, n);
+  bench_free_integers(items, n);
+}
+
+void bench_lists(struct Bench* bench) {
+  bench->group = "lists";
+
+  bench_native(bench, "cons", "integer,integer", 1, cons, 2, box_integer(1), box_integer(2));
+  bench_native(bench, "car", "pair", 1, car, 1, bench_integer_list(2));
+  bench_native(bench, "cdr", "pair", 1, cdr, 1, bench_integer_list(2));
+  bench_native(bench, "set-car!", "pair,integer", 1, set_car, 2, bench_integer_list(2), box_integer(3));
+  bench_native(bench, "eqv", "pair,pair", 1, eqv, 2, bench_integer_list(2), bench_integer_list(2));
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    uint32_t n = sizes[s];
+
+    build(bench, n);
+    bench_native(bench, "length", "list", n, length, 1, bench_integer_list(n));
+    bench_native(bench, "append", "list,list", 2 * n, append, 2, bench_integer_list(n), bench_integer_list(n));
+    bench_native(bench, "reverse", "list", n, reverse, 1, bench_integer_list(n));
+    bench_native(bench, "equal?", "list,list", n, equal, 2, bench_integer_list(n), bench_integer_list(n));
+    bench_native(bench, "list->vector", "list", n, list_to_vector, 1, bench_integer_list(n));
+    bench_native(bench, "vector->list", "vector", n, vector_to_list, 1, bench_integer_vector(n));
+    bench_native(bench, "apply", "procedure,list", n, apply, 2, new_closure(add_code, LISP_VARIADIC, NULL, 0),
+                 bench_integer_list(n));
+  }
+
+  // Last, since it stops lengths from being cached for every list built before it (see lists.h).
+  bench_native(bench, "set-cdr!", "pair,nil", 1, set_cdr, 2, bench_integer_list(2), get_nil());
+}
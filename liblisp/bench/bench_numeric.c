@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "../lisp.h"
+
+/** Kinds of numbers that arithmetic is measured across, from the least precise to the most. */
+enum NumberKind {
+  KindSmallInteger,
+  KindInteger,
+  KindBigInt,
+  KindRational,
+  KindReal,
+  KindComplex,
+  NUMBER_KINDS
+};
+
+static const char* const kind_names[NUMBER_KINDS] = {"small-integer", "integer", "bigint", "rational", "real",
+                                                     "complex"};
+
+/** A new number of the given kind. The two operands of a benchmark differ in `which`, so none of them are trivial. */
+static struct LispDatum* make_number(enum NumberKind kind, int which) {
+  switch (kind) {
+    case KindSmallInteger:
+      return box_integer(7 + which);
+    case KindInteger:
+      return box_integer(100003 + which);
+    case KindBigInt:
+      return new_bigint_from_string(which == 0 ? "123456789012345678901234567890" : "98765432109876543210987");
+    case KindRational:
+      return new_rational(3 + which, 7 + 4 * which);
+    case KindReal:
+      return new_real(1.5 + which);
+    case KindComplex:
+    default:
+      return new_complex(1.5, -2.0 + which);
+  }
+}
+
+struct Operator {
+  const char* name;
+  LispFunction native;
+};
+
+static void binary(struct Bench* bench, const struct Operator* op, enum NumberKind a, enum NumberKind b) {
+  char variant[64];
+  snprintf(variant, sizeof(variant), "%s,%s", kind_names[a], kind_names[b]);
+  bench_native(bench, op->name, variant, 1, op->native, 2, make_number(a, 0), make_number(b, 1));
+}
+
+/** Every kind paired with itself, and with every more precise kind in either order. */
+static void all_pairs(struct Bench* bench, const struct Operator* op, enum NumberKind last) {
+  for (int a = 0; a <= (int) last; ++a) {
+    for (int b = a; b <= (int) last; ++b) {
+      binary(bench, op, a, b);
+
+      if (a != b) {
+        binary(bench, op, b, a);
+      }
+    }
+  }
+}
+
+struct Direct {
+  struct LispDatum* (*native)(struct LispDatum*, struct LispDatum*);
+  struct LispDatum* args[2];
+};
+
+static void call_direct(void* context) {
+  struct Direct* call = context;
+  release(call->native(call->args[0], call->args[1]));
+}
+
+/** Compare the variadic form with the direct entry point lispc calls for two arguments. */
+static void direct(struct Bench* bench, const char* name,
+                   struct LispDatum* (*native)(struct LispDatum*, struct LispDatum*), enum NumberKind kind) {
+  struct Direct call = {native, {make_number(kind, 0), make_number(kind, 1)}};
+  gc_push_root(&call.args[0]);
+  gc_push_root(&call.args[1]);
+
+  char variant[64];
+  snprintf(variant, sizeof(variant), "%s,%s", kind_names[kind], kind_names[kind]);
+  bench_run(bench, name, variant, 1, call_direct, &call);
+
+  gc_pop_roots(2);
+  release(call.args[0]);
+  release(call.args[1]);
+}
+
+/** Sums and comparisons of many arguments, which may be reduced with SIMD. */
+static void folds(struct Bench* bench, const struct Operator* op, enum NumberKind kind) {
+  static const uint32_t sizes[] = {2, 16, 1024};
+
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    uint32_t n = sizes[s];
+    char name[64];
+    snprintf(name, sizeof(name), "%s-fold", op->name);
+
+    if (!bench_selected(bench, name)) {
+      continue;
+    }
+
+    struct LispDatum** args = malloc(n * sizeof(struct LispDatum*));
+
+    // Increasing, so that comparisons have to look at every argument.
+    for (uint32_t i = 0; i < n; ++i) {
+      args[i] = kind == KindReal ? new_real(i * 0.5) : box_integer((int32_t) i);
+    }
+
+    bench_native_array(bench, name, kind_names[kind], n, op->native, args, n);
+
+    for (uint32_t i = 0; i < n; ++i) {
+      release(args[i]);
+    }
+
+    free(args);
+  }
+}
+
+void bench_numeric(struct Bench* bench) {
+  bench->group = "numeric";
+
+  static const struct Operator arithmetic[] = {{"+", add}, {"-", subtract}, {"*", multiply}, {"/", divide}};
+  static const struct Operator ordered[] = {{"<", less_than}, {">", greater_than}, {"<=", less_than_eql},
+                                            {">=", greater_than_eql}};
+  static const struct Operator integral[] = {{"div", division}, {"mod", mod}};
+  static const struct Operator equality = {"=", num_equals};
+
+  for (size_t i = 0; i < sizeof(arithmetic) / sizeof(arithmetic[0]); ++i) {
+    all_pairs(bench, &arithmetic[i], KindComplex);
+  }
+
+  // Complex numbers aren't ordered.
+  for (size_t i = 0; i < sizeof(ordered) / sizeof(ordered[0]); ++i) {
+    all_pairs(bench, &ordered[i], KindReal);
+  }
+
+  all_pairs(bench, &equality, KindComplex);
+
+  for (size_t i = 0; i < sizeof(integral) / sizeof(integral[0]); ++i) {
+    all_pairs(bench, &integral[i], KindBigInt);
+  }
+
+  direct(bench, "add2", add2, KindSmallInteger);
+  direct(bench, "add2", add2, KindReal);
+  direct(bench, "less_than2", less_than2, KindSmallInteger);
+
+  folds(bench, &arithmetic[0], KindSmallInteger);
+  folds(bench, &arithmetic[0], KindReal);
+  folds(bench, &arithmetic[2], KindReal);
+  folds(bench, &ordered[0], KindSmallInteger);
+  folds(bench, &ordered[0], KindReal);
+
+  // Logic and identity, which only look at their arguments.
+  bench_native(bench, "and", "boolean,boolean", 1, logical_and, 2, get_true(), get_true());
+  bench_native(bench, "or", "boolean,boolean", 1, logical_or, 2, get_false(), get_true());
+  bench_native(bench, "not", "boolean", 1, logical_not, 1, get_false());
+  bench_native(bench, "eqv", "integer,real", 1, eqv, 2, make_number(KindInteger, 0), make_number(KindReal, 0));
+  bench_native(bench, "eqv", "rational,rational", 1, eqv, 2, make_number(KindRational, 0),
+               make_number(KindRational, 0));
+}
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include "bench.h"
+#include "../lisp.h"
+
+struct Raise {
+  struct LispDatum* args[2];
+};
+
+/** Raise a condition, and catch it straight away. */
+static void raise_and_catch(void* context) {
+  struct Raise* r = context;
+  struct LispHandler handler;
+  lisp_push_handler(&handler, LISP_ANY_CAUSE);
+
+  if (setjmp(handler.jump) == 0) {
+    release(signal_error(r->args, 2));
+    lisp_pop_handler(&handler);
+  }
+}
+
+static void errors(struct Bench* bench) {
+  struct Raise r = {{condition_keyword(Math), LISP_STRING_LITERAL("benchmark")}};
+  gc_push_root(&r.args[0]);
+  gc_push_root(&r.args[1]);
+
+  bench_run(bench, "error", "keyword,string", 1, raise_and_catch, &r);
+
+  gc_pop_roots(2);
+  release(r.args[0]);
+  release(r.args[1]);
+}
+
+void bench_output(struct Bench* bench) {
+  bench->group = "output";
+
+  // Formatted output is thrown away, so only the cost of producing it and buffering it is measured.
+  FILE* sink = fopen("/dev/null", "w");
+
+  if (sink == NULL) {
+    fprintf(stderr, "Unable to open /dev/null, skipping output benchmarks.\n");
+    return;
+  }
+
+  struct LispPort port;
+  port_open_file(&port, sink);
+  struct LispPort* previous = lisp_set_output_port(&port);
+
+  bench_native(bench, "format", "integer", 1, format, 1, box_integer(123456789));
+  bench_native(bench, "format", "real", 1, format, 1, new_real(3.14159265358979));
+  bench_native(bench, "format", "rational", 1, format, 1, new_rational(-22, 7));
+  bench_native(bench, "format", "complex", 1, format, 1, new_complex(1.5, -0.25));
+  bench_native(bench, "format", "bigint", 1, format, 1, new_bigint_from_string("123456789012345678901234567890"));
+  bench_native(bench, "format", "string", 1, format, 1, LISP_STRING_LITERAL("Hello, world!"));
+  bench_native(bench, "format", "integer,real,string", 3, format, 3, box_integer(7), new_real(0.1),
+               LISP_STRING_LITERAL("text"));
+  bench_native(bench, "format", "list", 1000, format, 1, bench_integer_list(1000));
+  bench_native(bench, "format", "vector", 1000, format, 1, bench_integer_vector(1000));
+  bench_native(bench, "flush-output", "", 1, flush_output, 0);
+
+  lisp_set_output_port(previous);
+  port_close(&port);
+  fclose(sink);
+
+  errors(bench);
+}
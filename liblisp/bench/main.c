@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+
+struct Suite {
+  const char* name;
+  void (*run)(struct Bench* bench);
+};
+
+// The list suite goes last, since `set-cdr!` affects every list built before it (see lists.h).
+static const struct Suite suites[] = {
+    {"numeric", bench_numeric},
+    {"containers", bench_containers},
+    {"output", bench_output},
+    {"lists", bench_lists},
+};
+
+#define SUITES (sizeof(suites) / sizeof(suites[0]))
+
+static void usage(FILE* out) {
+  fprintf(out, "Usage: lisp_bench [options]\n"
+               "  --csv               Write results as CSV (the default).\n"
+               "  --json              Write results as JSON.\n"
+               "  --output FILE       Write results to FILE rather than stdout.\n"
+               "  --suite NAME        Only run one suite: numeric, containers, output, or lists.\n"
+               "  --filter TEXT       Only run benchmarks whose name contains TEXT.\n"
+               "  --samples N         Measured batches per benchmark (default 21).\n"
+               "  --warmup N          Batches run before measuring (default 3).\n"
+               "  --min-sample-us N   Shortest time a batch may take, in microseconds (default 1000).\n");
+}
+
+int main(int argc, char** argv) {
+  struct BenchOptions options = {
+      .warmup = 3,
+      .samples = 21,
+      .min_sample_ns = 1000000,
+      .filter = NULL,
+      .format = BenchCSV,
+      .out = stdout,
+  };
+  const char* suite = NULL;
+  const char* output = NULL;
+
+  for (int i = 1; i < argc; ++i) {
+    const char* arg = argv[i];
+    const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+
+    if (strcmp(arg, "--csv") == 0) {
+      options.format = BenchCSV;
+    } else if (strcmp(arg, "--json") == 0) {
+      options.format = BenchJSON;
+    } else if (strcmp(arg, "--help") == 0) {
+      usage(stdout);
+      return 0;
+    } else if (value == NULL) {
+      usage(stderr);
+      return 1;
+    } else if (strcmp(arg, "--output") == 0) {
+      output = argv[++i];
+    } else if (strcmp(arg, "--suite") == 0) {
+      suite = argv[++i];
+    } else if (strcmp(arg, "--filter") == 0) {
+      options.filter = argv[++i];
+    } else if (strcmp(arg, "--samples") == 0) {
+      options.samples = (uint32_t) strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(arg, "--warmup") == 0) {
+      options.warmup = (uint32_t) strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(arg, "--min-sample-us") == 0) {
+      options.min_sample_ns = 1000 * strtoull(argv[++i], NULL, 10);
+    } else {
+      usage(stderr);
+      return 1;
+    }
+  }
+
+  if (output != NULL && (options.out = fopen(output, "w")) == NULL) {
+    fprintf(stderr, "Unable to open %s.\n", output);
+    return 1;
+  }
+
+  set_global_error_behavior(LogAndQuit);
+
+  struct Bench bench;
+  bench_start(&bench, &options);
+
+  for (size_t i = 0; i < SUITES; ++i) {
+    if (suite == NULL || strcmp(suite, suites[i].name) == 0) {
+      suites[i].run(&bench);
+    }
+  }
+
+  bench_finish(&bench);
+  flush_releases();
+
+  if (output != NULL) {
+    fclose(options.out);
+  }
+
+  return 0;
+}
@@ -0,0 +1,636 @@
+#include <stdlib.h>
+#include <string.h>
+#include "alloc.h"
+#include "bigint.h"
+#include "err.h"
+#include "numfmt.h"
+#include "stats.h"
+
+#define LIMB_BITS 32
+
+/** The largest power of 10 that fits in a limb, used to convert to and from base 10 nine digits at a time. */
+#define DECIMAL_CHUNK 1000000000u
+#define DECIMAL_CHUNK_DIGITS 9
+
+/**
+ * A read only view of the magnitude and sign of an integral datum. Integers are viewed through a single limb of local
+ * storage, so that they can take part in big integer arithmetic without being converted first.
+ */
+struct Magnitude {
+  const uint32_t* limbs;
+  uint32_t length;
+  int negative;
+  uint32_t storage;
+};
+
+static void view(const struct LispDatum* x, struct Magnitude* m) {
+  if (x->type == Integer) {
+    m->negative = x->int_val < 0;
+    m->storage = m->negative ? (uint32_t) -(int64_t) x->int_val : (uint32_t) x->int_val;
+    m->limbs = &m->storage;
+    m->length = m->storage != 0;
+  } else {
+    m->limbs = x->big->limbs;
+    m->length = x->big->length;
+    m->negative = x->big->negative;
+  }
+}
+
+static size_t bigint_size(uint32_t capacity) {
+  return sizeof(struct LispBigInt) + capacity * sizeof(uint32_t);
+}
+
+/** Allocate a zeroed big integer with room for `capacity` limbs. */
+static struct LispBigInt* new_limbs(uint32_t capacity) {
+  struct LispBigInt* big = lisp_alloc(bigint_size(capacity));
+  big->length = capacity;
+  big->capacity = capacity;
+  big->negative = 0;
+  memset(big->limbs, 0, capacity * sizeof(uint32_t));
+  return big;
+}
+
+static void free_limbs(struct LispBigInt* big) {
+  lisp_free(big, bigint_size(big->capacity));
+}
+
+/** Number of limbs in use once leading zeros are dropped. */
+static uint32_t trim(const uint32_t* limbs, uint32_t length) {
+  while (length > 0 && limbs[length - 1] == 0) {
+    --length;
+  }
+
+  return length;
+}
+
+/**
+ * Store a freshly computed magnitude into a scratch number, demoting it to an `Integer` if it fits in one. Takes
+ * ownership of `big`.
+ */
+static void store(struct LispDatum* dest, struct LispBigInt* big, int negative) {
+  big->length = trim(big->limbs, big->length);
+
+  if (big->length <= 1) {
+    uint32_t limb = big->length == 0 ? 0 : big->limbs[0];
+
+    if (limb <= INT32_MAX || (negative && limb == (uint32_t) INT32_MAX + 1)) {
+      free_limbs(big);
+      dest->type = Integer;
+      dest->int_val = (int32_t) (negative ? -(int64_t) limb : (int64_t) limb);
+      return;
+    }
+  }
+
+  big->negative = negative;
+  dest->type = BigInt;
+  dest->big = big;
+}
+
+/** Replace a scratch number with a new value, freeing the limbs it had before. */
+static void replace(struct LispDatum* dest, struct LispBigInt* big, int negative) {
+  struct LispBigInt* old = dest->type == BigInt ? dest->big : NULL;
+  store(dest, big, negative);
+
+  if (old != NULL) {
+    free_limbs(old);
+  }
+}
+
+// Magnitude arithmetic. Lengths are in limbs, and results are written into zeroed memory large enough to hold them.
+
+static int magnitude_compare(const uint32_t* a, uint32_t an, const uint32_t* b, uint32_t bn) {
+  an = trim(a, an);
+  bn = trim(b, bn);
+
+  if (an != bn) {
+    return an > bn ? 1 : -1;
+  }
+
+  for (uint32_t i = an; i > 0; --i) {
+    if (a[i - 1] != b[i - 1]) {
+      return a[i - 1] > b[i - 1] ? 1 : -1;
+    }
+  }
+
+  return 0;
+}
+
+/** r += a, where r has room for the result. */
+static void add_into(uint32_t* r, uint32_t rn, const uint32_t* a, uint32_t an) {
+  uint64_t carry = 0;
+  uint32_t i = 0;
+
+  for (; i < an; ++i) {
+    uint64_t sum = (uint64_t) r[i] + a[i] + carry;
+    r[i] = (uint32_t) sum;
+    carry = sum >> LIMB_BITS;
+  }
+
+  for (; carry != 0 && i < rn; ++i) {
+    uint64_t sum = (uint64_t) r[i] + carry;
+    r[i] = (uint32_t) sum;
+    carry = sum >> LIMB_BITS;
+  }
+}
+
+/** r -= a, where r is at least a. */
+static void subtract_from(uint32_t* r, uint32_t rn, const uint32_t* a, uint32_t an) {
+  int64_t borrow = 0;
+  uint32_t i = 0;
+
+  for (; i < an; ++i) {
+    int64_t difference = (int64_t) r[i] - a[i] - borrow;
+    r[i] = (uint32_t) difference;
+    borrow = difference < 0;
+  }
+
+  for (; borrow != 0 && i < rn; ++i) {
+    int64_t difference = (int64_t) r[i] - borrow;
+    r[i] = (uint32_t) difference;
+    borrow = difference < 0;
+  }
+}
+
+static void multiply_schoolbook(uint32_t* r, const uint32_t* a, uint32_t an, const uint32_t* b, uint32_t bn) {
+  for (uint32_t i = 0; i < bn; ++i) {
+    uint64_t carry = 0;
+
+    for (uint32_t j = 0; j < an; ++j) {
+      uint64_t t = (uint64_t) a[j] * b[i] + r[i + j] + carry;
+      r[i + j] = (uint32_t) t;
+      carry = t >> LIMB_BITS;
+    }
+
+    r[i + an] = (uint32_t) carry;
+  }
+}
+
+/** r = a * b, where r holds an + bn zeroed limbs. */
+static void multiply_magnitudes(uint32_t* r, const uint32_t* a, uint32_t an, const uint32_t* b, uint32_t bn) {
+  if (an < bn) {
+    const uint32_t* t = a;
+    a = b;
+    b = t;
+
+    uint32_t tn = an;
+    an = bn;
+    bn = tn;
+  }
+
+  if (bn < LISP_KARATSUBA_THRESHOLD) {
+    multiply_schoolbook(r, a, an, b, bn);
+    return;
+  }
+
+  // Split a = a1 * B^m + a0. If b is too short to split the same way, multiply it by each half of a separately.
+  uint32_t m = (an + 1) / 2;
+
+  if (bn <= m) {
+    multiply_magnitudes(r, a, m, b, bn);
+
+    uint32_t hn = an - m + bn;
+    uint32_t* high = calloc(hn, sizeof(uint32_t));
+    multiply_magnitudes(high, a + m, an - m, b, bn);
+    add_into(r + m, an + bn - m, high, hn);
+    free(high);
+    return;
+  }
+
+  // With b = b1 * B^m + b0, a * b = z2 * B^2m + z1 * B^m + z0, where z0 = a0 * b0, z2 = a1 * b1, and
+  // z1 = (a0 + a1) * (b0 + b1) - z0 - z2. That is three half size products instead of four.
+  uint32_t* z0 = r;
+  uint32_t* z2 = r + 2 * m;
+  multiply_magnitudes(z0, a, m, b, m);
+  multiply_magnitudes(z2, a + m, an - m, b + m, bn - m);
+
+  uint32_t* sums = calloc(2 * (m + 1), sizeof(uint32_t));
+  uint32_t* sum_a = sums;
+  uint32_t* sum_b = sums + m + 1;
+  memcpy(sum_a, a, m * sizeof(uint32_t));
+  add_into(sum_a, m + 1, a + m, an - m);
+  memcpy(sum_b, b, m * sizeof(uint32_t));
+  add_into(sum_b, m + 1, b + m, bn - m);
+
+  uint32_t z1n = 2 * (m + 1);
+  uint32_t* z1 = calloc(z1n, sizeof(uint32_t));
+  multiply_magnitudes(z1, sum_a, m + 1, sum_b, m + 1);
+  subtract_from(z1, z1n, z0, 2 * m);
+  subtract_from(z1, z1n, z2, an + bn - 2 * m);
+  add_into(r + m, an + bn - m, z1, trim(z1, z1n));
+
+  free(sums);
+  free(z1);
+}
+
+/** Divide a magnitude by a single limb in place, returning the remainder. */
+static uint32_t divide_small(uint32_t* a, uint32_t an, uint32_t d) {
+  uint64_t remainder = 0;
+
+  for (uint32_t i = an; i > 0; --i) {
+    uint64_t current = (remainder << LIMB_BITS) | a[i - 1];
+    a[i - 1] = (uint32_t) (current / d);
+    remainder = current % d;
+  }
+
+  return (uint32_t) remainder;
+}
+
+/**
+ * Long division (Knuth's algorithm D) of u by v, where m >= n >= 2 and the top limb of v is not 0. The quotient takes
+ * m - n + 1 limbs, and the remainder n.
+ */
+static void divide_long(uint32_t* q, uint32_t* r, const uint32_t* u, uint32_t m, const uint32_t* v, uint32_t n) {
+  // Normalize so that the top bit of the divisor is set, which keeps each estimated quotient limb off by at most 2.
+  int s = __builtin_clz(v[n - 1]);
+  uint32_t* vn = malloc(n * sizeof(uint32_t));
+  uint32_t* un = malloc((m + 1) * sizeof(uint32_t));
+
+  for (uint32_t i = n - 1; i > 0; --i) {
+    vn[i] = (v[i] << s) | (uint32_t) ((uint64_t) v[i - 1] >> (LIMB_BITS - s));
+  }
+  vn[0] = v[0] << s;
+
+  un[m] = (uint32_t) ((uint64_t) u[m - 1] >> (LIMB_BITS - s));
+  for (uint32_t i = m - 1; i > 0; --i) {
+    un[i] = (u[i] << s) | (uint32_t) ((uint64_t) u[i - 1] >> (LIMB_BITS - s));
+  }
+  un[0] = u[0] << s;
+
+  for (int64_t j = (int64_t) m - n; j >= 0; --j) {
+    uint64_t top = ((uint64_t) un[j + n] << LIMB_BITS) | un[j + n - 1];
+    uint64_t qhat = top / vn[n - 1];
+    uint64_t rhat = top % vn[n - 1];
+
+    while (qhat >> LIMB_BITS || qhat * vn[n - 2] > ((rhat << LIMB_BITS) | un[j + n - 2])) {
+      --qhat;
+      rhat += vn[n - 1];
+
+      if (rhat >> LIMB_BITS) {
+        break;
+      }
+    }
+
+    // Multiply and subtract.
+    int64_t borrow = 0;
+    int64_t t;
+
+    for (uint32_t i = 0; i < n; ++i) {
+      uint64_t p = qhat * vn[i];
+      t = (int64_t) un[i + j] - borrow - (int64_t) (p & UINT32_MAX);
+      un[i + j] = (uint32_t) t;
+      borrow = (int64_t) (p >> LIMB_BITS) - (t >> LIMB_BITS);
+    }
+
+    t = (int64_t) un[j + n] - borrow;
+    un[j + n] = (uint32_t) t;
+    q[j] = (uint32_t) qhat;
+
+    // The estimate was one too large, so add the divisor back.
+    if (t < 0) {
+      --q[j];
+
+      uint64_t carry = 0;
+      for (uint32_t i = 0; i < n; ++i) {
+        uint64_t sum = (uint64_t) un[i + j] + vn[i] + carry;
+        un[i + j] = (uint32_t) sum;
+        carry = sum >> LIMB_BITS;
+      }
+      un[j + n] += (uint32_t) carry;
+    }
+  }
+
+  for (uint32_t i = 0; i + 1 < n; ++i) {
+    r[i] = (un[i] >> s) | (uint32_t) ((uint64_t) un[i + 1] << (LIMB_BITS - s));
+  }
+  r[n - 1] = un[n - 1] >> s;
+
+  free(vn);
+  free(un);
+}
+
+// Public interface.
+
+struct LispDatum* new_bigint_from_string(const char* digits) {
+  int negative = *digits == '-';
+  if (*digits == '-' || *digits == '+') {
+    ++digits;
+  }
+
+  size_t count = strlen(digits);
+
+  // Each limb holds more than 9 digits, so this is always enough room.
+  struct LispBigInt* big = new_limbs((uint32_t) (count / DECIMAL_CHUNK_DIGITS + 1));
+  uint32_t length = 0;
+
+  // Consume the leading partial chunk first, so that every following chunk is exactly 9 digits.
+  size_t chunk = count % DECIMAL_CHUNK_DIGITS == 0 ? DECIMAL_CHUNK_DIGITS : count % DECIMAL_CHUNK_DIGITS;
+
+  for (size_t i = 0; i < count; i += chunk, chunk = DECIMAL_CHUNK_DIGITS) {
+    uint32_t value = 0;
+    uint32_t scale = 1;
+
+    for (size_t j = 0; j < chunk; ++j) {
+      value = value * 10 + (uint32_t) (digits[i + j] - '0');
+      scale *= 10;
+    }
+
+    // big = big * scale + value
+    uint64_t carry = value;
+    for (uint32_t k = 0; k < length; ++k) {
+      uint64_t t = (uint64_t) big->limbs[k] * scale + carry;
+      big->limbs[k] = (uint32_t) t;
+      carry = t >> LIMB_BITS;
+    }
+
+    if (carry != 0) {
+      big->limbs[length++] = (uint32_t) carry;
+    }
+  }
+
+  struct LispDatum scratch;
+  big->length = length;
+  store(&scratch, big, negative);
+
+  if (scratch.type == Integer) {
+    return box_integer(scratch.int_val);
+  }
+
+  struct LispDatum* x = alloc_datum();
+  x->type = BigInt;
+  x->refs = 1;
+  x->big = scratch.big;
+  LISP_STATS_ALLOC(BigInt, sizeof(struct LispDatum) + bigint_size(x->big->capacity));
+  return x;
+}
+
+static struct LispBigInt* duplicate(const struct LispBigInt* big) {
+  struct LispBigInt* copy = new_limbs(big->length);
+  memcpy(copy->limbs, big->limbs, big->length * sizeof(uint32_t));
+  copy->negative = big->negative;
+  return copy;
+}
+
+struct LispDatum* copy_bigint(const struct LispDatum* x) {
+  struct LispDatum* copy = alloc_datum();
+  copy->type = BigInt;
+  copy->refs = 1;
+  copy->big = duplicate(x->big);
+  LISP_STATS_ALLOC(BigInt, sizeof(struct LispDatum) + bigint_size(copy->big->capacity));
+  return copy;
+}
+
+void destroy_bigint(struct LispDatum* x) {
+  free_limbs(x->big);
+}
+
+void load_scratch(const struct LispDatum* source, struct LispDatum* scratch) {
+  *scratch = *source;
+
+  if (source->type == BigInt) {
+    scratch->big = duplicate(source->big);
+  }
+}
+
+void discard_scratch(struct LispDatum* scratch) {
+  if (scratch->type == BigInt) {
+    free_limbs(scratch->big);
+    scratch->type = Integer;
+    scratch->int_val = 0;
+  }
+}
+
+void scratch_from_int64(struct LispDatum* scratch, int64_t value) {
+  if (value >= INT32_MIN && value <= INT32_MAX) {
+    scratch->type = Integer;
+    scratch->int_val = (int32_t) value;
+    return;
+  }
+
+  uint64_t magnitude = value < 0 ? -(uint64_t) value : (uint64_t) value;
+  struct LispBigInt* big = new_limbs(2);
+  big->limbs[0] = (uint32_t) magnitude;
+  big->limbs[1] = (uint32_t) (magnitude >> LIMB_BITS);
+  store(scratch, big, value < 0);
+}
+
+/** acc = acc + (-1)^negate_x * x */
+static void add_signed(struct LispDatum* acc, const struct LispDatum* x, int negate_x) {
+  struct Magnitude a;
+  struct Magnitude b;
+  view(acc, &a);
+  view(x, &b);
+  b.negative ^= negate_x;
+
+  uint32_t length = (a.length > b.length ? a.length : b.length) + 1;
+  struct LispBigInt* r = new_limbs(length);
+  int negative;
+
+  if (a.negative == b.negative) {
+    memcpy(r->limbs, a.limbs, a.length * sizeof(uint32_t));
+    add_into(r->limbs, length, b.limbs, b.length);
+    negative = a.negative;
+  } else if (magnitude_compare(a.limbs, a.length, b.limbs, b.length) >= 0) {
+    memcpy(r->limbs, a.limbs, a.length * sizeof(uint32_t));
+    subtract_from(r->limbs, length, b.limbs, b.length);
+    negative = a.negative;
+  } else {
+    memcpy(r->limbs, b.limbs, b.length * sizeof(uint32_t));
+    subtract_from(r->limbs, length, a.limbs, a.length);
+    negative = b.negative;
+  }
+
+  replace(acc, r, negative);
+}
+
+void integer_add(struct LispDatum* acc, const struct LispDatum* x) {
+  int32_t sum;
+
+  if (acc->type == Integer && x->type == Integer && !__builtin_add_overflow(acc->int_val, x->int_val, &sum)) {
+    acc->int_val = sum;
+  } else if (acc->type == Integer && x->type == Integer) {
+    scratch_from_int64(acc, (int64_t) acc->int_val + x->int_val);
+  } else {
+    add_signed(acc, x, 0);
+  }
+}
+
+void integer_subtract(struct LispDatum* acc, const struct LispDatum* x) {
+  int32_t difference;
+
+  if (acc->type == Integer && x->type == Integer && !__builtin_sub_overflow(acc->int_val, x->int_val, &difference)) {
+    acc->int_val = difference;
+  } else if (acc->type == Integer && x->type == Integer) {
+    scratch_from_int64(acc, (int64_t) acc->int_val - x->int_val);
+  } else {
+    add_signed(acc, x, 1);
+  }
+}
+
+void integer_multiply(struct LispDatum* acc, const struct LispDatum* x) {
+  int32_t product;
+
+  if (acc->type == Integer && x->type == Integer) {
+    if (__builtin_mul_overflow(acc->int_val, x->int_val, &product)) {
+      scratch_from_int64(acc, (int64_t) acc->int_val * x->int_val);
+    } else {
+      acc->int_val = product;
+    }
+
+    return;
+  }
+
+  struct Magnitude a;
+  struct Magnitude b;
+  view(acc, &a);
+  view(x, &b);
+
+  struct LispBigInt* r = new_limbs(a.length + b.length);
+  multiply_magnitudes(r->limbs, a.limbs, a.length, b.limbs, b.length);
+  replace(acc, r, a.negative != b.negative);
+}
+
+int integer_divmod(const struct LispDatum* a, const struct LispDatum* b, struct LispDatum* quotient,
+                   struct LispDatum* remainder) {
+  if (b->type == Integer && b->int_val == 0) {
+    return -1;
+  }
+
+  // Dividing the smallest integer by -1 is the one case where fixnum division overflows.
+  if (a->type == Integer && b->type == Integer && !(a->int_val == INT32_MIN && b->int_val == -1)) {
+    if (quotient != NULL) {
+      quotient->type = Integer;
+      quotient->int_val = a->int_val / b->int_val;
+    }
+
+    if (remainder != NULL) {
+      remainder->type = Integer;
+      remainder->int_val = a->int_val % b->int_val;
+    }
+
+    return 0;
+  }
+
+  struct Magnitude u;
+  struct Magnitude v;
+  view(a, &u);
+  view(b, &v);
+
+  // Both results start out as at least the size of their largest possible value, and are trimmed by `store`.
+  uint32_t qn = u.length >= v.length ? u.length - v.length + 1 : 1;
+  struct LispBigInt* q = new_limbs(qn);
+  struct LispBigInt* r = new_limbs(v.length);
+
+  if (magnitude_compare(u.limbs, u.length, v.limbs, v.length) < 0) {
+    memcpy(r->limbs, u.limbs, u.length * sizeof(uint32_t));
+  } else if (v.length == 1) {
+    memcpy(q->limbs, u.limbs, u.length * sizeof(uint32_t));
+    r->limbs[0] = divide_small(q->limbs, u.length, v.limbs[0]);
+  } else {
+    divide_long(q->limbs, r->limbs, u.limbs, u.length, v.limbs, v.length);
+  }
+
+  // Truncating division: the quotient is negative when the signs differ, and the remainder takes the dividend's sign.
+  if (quotient != NULL) {
+    store(quotient, q, u.negative != v.negative);
+  } else {
+    free_limbs(q);
+  }
+
+  if (remainder != NULL) {
+    store(remainder, r, u.negative);
+  } else {
+    free_limbs(r);
+  }
+
+  return 0;
+}
+
+int integer_compare(const struct LispDatum* a, const struct LispDatum* b) {
+  if (a->type == Integer && b->type == Integer) {
+    return a->int_val == b->int_val ? 0 : a->int_val > b->int_val ? 1 : -1;
+  }
+
+  struct Magnitude x;
+  struct Magnitude y;
+  view(a, &x);
+  view(b, &y);
+
+  if (x.negative != y.negative) {
+    return x.negative ? -1 : 1;
+  }
+
+  int magnitude = magnitude_compare(x.limbs, x.length, y.limbs, y.length);
+  return x.negative ? -magnitude : magnitude;
+}
+
+int integer_to_int64(const struct LispDatum* x, int64_t* out) {
+  if (x->type == Integer) {
+    *out = x->int_val;
+    return 0;
+  } else if (x->big->length > 2) {
+    return -1;
+  }
+
+  uint64_t magnitude = x->big->limbs[0] | (x->big->length == 2 ? (uint64_t) x->big->limbs[1] << LIMB_BITS : 0);
+
+  if (magnitude > INT64_MAX) {
+    return -1;
+  }
+
+  *out = x->big->negative ? -(int64_t) magnitude : (int64_t) magnitude;
+  return 0;
+}
+
+double integer_to_double(const struct LispDatum* x) {
+  if (x->type == Integer) {
+    return x->int_val;
+  }
+
+  double value = 0;
+
+  for (uint32_t i = x->big->length; i > 0; --i) {
+    value = value * 4294967296.0 + x->big->limbs[i - 1];
+  }
+
+  return x->big->negative ? -value : value;
+}
+
+void integer_format(const struct LispDatum* x, struct LispStringBuilder* out) {
+  if (x->type == Integer) {
+    char digits[LISP_INT_CHARS];
+    string_builder_append(out, digits, format_int64(x->int_val, digits));
+    return;
+  }
+
+  // Peel off 9 digits at a time from the bottom, then write the chunks out from the top.
+  uint32_t length = x->big->length;
+  uint32_t* scratch = malloc(length * sizeof(uint32_t));
+  uint32_t* chunks = malloc((length * 2 + 1) * sizeof(uint32_t));
+  uint32_t count = 0;
+  memcpy(scratch, x->big->limbs, length * sizeof(uint32_t));
+
+  // Big integers always have at least one limb, so there is always at least one chunk.
+  do {
+    chunks[count++] = divide_small(scratch, length, DECIMAL_CHUNK);
+    length = trim(scratch, length);
+  } while (length > 0);
+
+  char* digits = malloc(count * DECIMAL_CHUNK_DIGITS + 1);
+  char* end = digits;
+
+  if (x->big->negative) {
+    *end++ = '-';
+  }
+
+  end += format_uint64(chunks[count - 1], end);
+  for (uint32_t i = count - 1; i > 0; --i) {
+    format_digits9(chunks[i - 1], end);
+    end += DECIMAL_CHUNK_DIGITS;
+  }
+
+  string_builder_append(out, digits, (uint32_t) (end - digits));
+
+  free(digits);
+  free(scratch);
+  free(chunks);
+}
@@ -0,0 +1,83 @@
+#ifndef LISP_BIGINT_H
+#define LISP_BIGINT_H
+
+#include <stdint.h>
+#include "data.h"
+#include "lstring.h"
+
+/*
+ * Integers that do not fit in an `int32_t` are stored as a sign and a magnitude of 32 bit limbs, least significant
+ * first. Big integers are always normalized: any value that fits in an `Integer` is stored as one, so a `BigInt` never
+ * compares equal to an `Integer`. Arithmetic on two `Integer`s stays on the fixnum fast path, and only falls over to
+ * big integers when the overflow checking builtins report that the result does not fit.
+ *
+ * The functions here operate on "integral" datums, which is to say `Integer`s and `BigInt`s, and may freely mix them.
+ * Results are written into scratch numbers: datums that live outside of the heap (i.e. accumulators on the stack), and
+ * which own the limbs of a `BigInt` value. A scratch number must be given up with `discard_scratch` once it is no longer
+ * needed, and turned into a heap datum with `box_number`.
+ */
+
+/** Products of at least this many limbs on both sides are computed with Karatsuba's algorithm. */
+#define LISP_KARATSUBA_THRESHOLD 32
+
+/** Limbs of a big integer. Owned by exactly one datum. */
+struct LispBigInt {
+  uint32_t length;
+  uint32_t capacity;
+  int negative;
+
+  /** The most significant limb in use is never 0. */
+  uint32_t limbs[];
+};
+
+static inline int is_integral(const struct LispDatum* x) {
+  return x->type == Integer || x->type == BigInt;
+}
+
+/** Parse a base 10 integer of any size, with an optional leading sign. The result is an `Integer` if it fits in one. */
+struct LispDatum* new_bigint_from_string(const char* digits);
+
+/** Make a heap copy of a big integer. */
+struct LispDatum* copy_bigint(const struct LispDatum* x);
+
+/** Free the limbs of a big integer. Called when it is destroyed or collected. */
+void destroy_bigint(struct LispDatum* x);
+
+/** Copy a number into a scratch number, duplicating the limbs of a big integer so that they can be modified. */
+void load_scratch(const struct LispDatum* source, struct LispDatum* scratch);
+
+/** Free whatever a scratch number owns. Scratch numbers of other types are left alone. */
+void discard_scratch(struct LispDatum* scratch);
+
+/** Store any 64 bit integer into a scratch number. */
+void scratch_from_int64(struct LispDatum* scratch, int64_t value);
+
+/** Replace an integral scratch number with its sum, difference, or product with another integral value. */
+void integer_add(struct LispDatum* acc, const struct LispDatum* x);
+void integer_subtract(struct LispDatum* acc, const struct LispDatum* x);
+void integer_multiply(struct LispDatum* acc, const struct LispDatum* x);
+
+/**
+ * Truncating division of integral values, as with `/` and `%` in C. Either output may be NULL if it is not needed,
+ * and otherwise must be an uninitialized scratch number.
+ * @return 0 on success, or -1 if the divisor is 0.
+ */
+int integer_divmod(const struct LispDatum* a, const struct LispDatum* b, struct LispDatum* quotient,
+                   struct LispDatum* remainder);
+
+/** Returns a negative value, 0, or a positive value when a is less than, equal to, or greater than b. */
+int integer_compare(const struct LispDatum* a, const struct LispDatum* b);
+
+/**
+ * Read an integral value as a 64 bit integer.
+ * @return 0 on success, or -1 if it does not fit.
+ */
+int integer_to_int64(const struct LispDatum* x, int64_t* out);
+
+/** The nearest double to an integral value. */
+double integer_to_double(const struct LispDatum* x);
+
+/** Write the base 10 representation of an integral value. */
+void integer_format(const struct LispDatum* x, struct LispStringBuilder* out);
+
+#endif //LISP_BIGINT_H
@@ -0,0 +1,51 @@
+#include "alloc.h"
+#include "closure.h"
+#include "err.h"
+#include "stats.h"
+
+static size_t closure_size(uint32_t count) {
+  return sizeof(struct LispClosure) + count * sizeof(struct LispDatum*);
+}
+
+struct LispDatum* new_closure(LispClosureCode code, int32_t arity, struct LispDatum** captured, uint32_t count) {
+  struct LispClosure* closure = lisp_alloc(closure_size(count));
+  closure->code = code;
+  closure->arity = arity;
+  closure->count = count;
+
+  for (uint32_t i = 0; i < count; ++i) {
+    closure->captured[i] = retain(captured[i]);
+  }
+
+  struct LispDatum* f = alloc_datum();
+  f->type = Closure;
+  f->refs = 1;
+  f->closure = closure;
+  LISP_STATS_ALLOC(Closure, sizeof(struct LispDatum) + closure_size(count));
+  return f;
+}
+
+struct LispDatum* call_closure(struct LispDatum* f, struct LispDatum** args, uint32_t nargs) {
+  if (LISP_INVALID(f->type != Closure)) {
+    return raise(Type, "Only procedures can be called.");
+  }
+
+  // Closures can be called from anywhere, so this can't be proven ahead of time.
+  int32_t arity = f->closure->arity;
+
+  if (arity != LISP_VARIADIC && (uint32_t) arity != nargs) {
+    return raise(Argument, "Procedure called with the wrong number of arguments.");
+  }
+
+  return f->closure->code(f, args, nargs);
+}
+
+void destroy_closure(struct LispDatum* f) {
+  uint32_t count = f->closure->count;
+
+  for (uint32_t i = 0; i < count; ++i) {
+    release(f->closure->captured[i]);
+  }
+
+  lisp_free(f->closure, closure_size(count));
+}
@@ -0,0 +1,56 @@
+#ifndef LISP_CLOSURE_H
+#define LISP_CLOSURE_H
+
+#include <stdint.h>
+#include "data.h"
+
+/*
+ * Closures pair compiled code with a flat environment: the values of the variables the code refers to from outside,
+ * copied into an array when the closure is created. Nothing links one environment to another, so reaching a captured
+ * value takes a single index however deeply the closure was nested, and a closure only keeps alive what it uses.
+ * Closures are immutable, and the closure holds its own reference to every captured value.
+ *
+ * lispc only creates closures for functions that escape. Functions that are only ever called by name are compiled to
+ * plain C functions, with the variables they use passed as extra arguments, and never allocate. Neither captures nor
+ * passes top level variables, which lispc keeps at file scope so that redefining one is seen everywhere.
+ */
+
+/**
+ * The code of a closure. It follows the same conventions as a `LispFunction`, borrowing its arguments and returning a
+ * new reference, and is also given the closure itself to read its captured values from.
+ */
+typedef struct LispDatum* (*LispClosureCode)(struct LispDatum* self, struct LispDatum** args, uint32_t nargs);
+
+/** Stored as the arity of closures that take any number of arguments, such as natives used as values. */
+#define LISP_VARIADIC (-1)
+
+/** Lives outside of the datum, which only has room for a pointer to it. Owned by the closure. */
+struct LispClosure {
+  LispClosureCode code;
+
+  /** Number of arguments the code expects, or `LISP_VARIADIC`. */
+  int32_t arity;
+
+  uint32_t count;
+  struct LispDatum* captured[];
+};
+
+/** Create a closure, copying the first `count` captured values into its environment. */
+struct LispDatum* new_closure(LispClosureCode code, int32_t arity, struct LispDatum** captured, uint32_t count);
+
+/** A captured value of a closure, which is only borrowed. Used by compiled code to read its environment. */
+static inline struct LispDatum* closure_captured(const struct LispDatum* f, uint32_t index) {
+  return f->closure->captured[index];
+}
+
+/**
+ * Call a closure with the given arguments, following the usual conventions for natives.
+ * @throws Type error if `f` is not a closure.
+ * @throws Argument error if it is given the wrong number of arguments.
+ */
+struct LispDatum* call_closure(struct LispDatum* f, struct LispDatum** args, uint32_t nargs);
+
+/** Free whatever a closure owns outside of its datum. Called when the closure is destroyed or collected. */
+void destroy_closure(struct LispDatum* f);
+
+#endif //LISP_CLOSURE_H
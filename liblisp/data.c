@@ -1,25 +1,78 @@
 #include <stdlib.h>
 #include <string.h>
+#include "alloc.h"
+#include "bigint.h"
+#include "closure.h"
 #include "data.h"
 #include "err.h"
+#include "hashmap.h"
+#include "lstring.h"
+#include "numarray.h"
+#include "rational.h"
+#include "state.h"
+#include "stats.h"
+#include "vector.h"
+#include "walk.h"
 
 struct LispDatum* new_integer(int32_t i) {
-  struct LispDatum* x = malloc(sizeof(struct LispDatum));
+  struct LispDatum* x = alloc_datum();
   x->type = Integer;
+  x->refs = 1;
+  LISP_STATS_ALLOC(Integer, sizeof(struct LispDatum));
   x->int_val = i;
   return x;
 }
 
+#define SMALL_INT(n) {.type = Integer, .refs = LISP_REFS_IMMORTAL, .int_val = LISP_SMALL_INT_MIN + (n)}
+#define SMALL_INT_4(n) SMALL_INT(n), SMALL_INT((n) + 1), SMALL_INT((n) + 2), SMALL_INT((n) + 3)
+#define SMALL_INT_16(n) SMALL_INT_4(n), SMALL_INT_4((n) + 4), SMALL_INT_4((n) + 8), SMALL_INT_4((n) + 12)
+#define SMALL_INT_64(n) SMALL_INT_16(n), SMALL_INT_16((n) + 16), SMALL_INT_16((n) + 32), SMALL_INT_16((n) + 48)
+#define SMALL_INT_256(n) SMALL_INT_64(n), SMALL_INT_64((n) + 64), SMALL_INT_64((n) + 128), SMALL_INT_64((n) + 192)
+
+// Built entirely at compile time so that there is no initialization step to race on.
+static struct LispDatum SmallIntegers[LISP_SMALL_INT_MAX - LISP_SMALL_INT_MIN + 1] = {
+    SMALL_INT_256(0), SMALL_INT_256(256), SMALL_INT_256(512), SMALL_INT_256(768)
+};
+
+struct LispDatum* box_integer(int32_t i) {
+  if (i >= LISP_SMALL_INT_MIN && i <= LISP_SMALL_INT_MAX) {
+    return &SmallIntegers[i - LISP_SMALL_INT_MIN];
+  }
+
+  return new_integer(i);
+}
+
+struct LispDatum* box_number(const struct LispDatum* x) {
+  switch (x->type) {
+    case Integer:
+      return box_integer(x->int_val);
+    case BigInt:
+      return copy_bigint(x);
+    case Rational:
+      return new_rational(x->num, x->den);
+    case Real:
+      return new_real(x->float_val);
+    case Complex:
+      return new_complex(x->real, x->im);
+    default:
+      return raise(Type, "Attempted to box a non-numeric value.");
+  }
+}
+
 struct LispDatum* new_real(double d) {
-  struct LispDatum* x = malloc(sizeof(struct LispDatum));
+  struct LispDatum* x = alloc_datum();
   x->type = Real;
+  x->refs = 1;
+  LISP_STATS_ALLOC(Real, sizeof(struct LispDatum));
   x->float_val = d;
   return x;
 }
 
-struct LispDatum* new_rational(int32_t a, int32_t b) {
-  struct LispDatum* x = malloc(sizeof(struct LispDatum));
+struct LispDatum* new_rational(int64_t a, int64_t b) {
+  struct LispDatum* x = alloc_datum();
   x->type = Rational;
+  x->refs = 1;
+  LISP_STATS_ALLOC(Rational, sizeof(struct LispDatum));
   x->num = a;
   x->den = b;
   simplify(x);
@@ -27,85 +80,127 @@ struct LispDatum* new_rational(int32_t a, int32_t b) {
 }
 
 struct LispDatum* new_complex(double r, double i) {
-  struct LispDatum* x = malloc(sizeof(struct LispDatum));
+  struct LispDatum* x = alloc_datum();
   x->type = Complex;
+  x->refs = 1;
+  LISP_STATS_ALLOC(Complex, sizeof(struct LispDatum));
   x->real = r;
   x->im = i;
   return x;
 }
 
-struct LispDatum* new_symbol(char* content) {
-  struct LispDatum* x = malloc(sizeof(struct LispDatum));
-  x->type = Symbol;
-  x->content = content;
-  return x;
-}
-
-struct LispDatum* new_symbol_from_copy(char* content, uint32_t length) {
-  struct LispDatum* x = malloc(sizeof(struct LispDatum));
-  x->type = Symbol;
-  x->content = malloc(length);
-
-  strncpy(x->content, content, length);
-
-  return x;
-}
-
-// TODO(matthew-c21): Whenever garbage collection is implemented, this should update the reference count.
 struct LispDatum* new_cons(struct LispDatum* car, struct LispDatum* cdr) {
-  struct LispDatum* x = malloc(sizeof(struct LispDatum));
+  struct LispDatum* x = alloc_datum();
   x->type = Cons;
-  x->car = car;
-  x->cdr = cdr;
+  x->refs = 1;
+  LISP_STATS_ALLOC(Cons, sizeof(struct LispDatum));
+  x->car = retain(car);
+  x->cdr = retain(cdr);
   return x;
 }
 
 struct LispDatum* get_nil() {
   // Essentially, what this does is create a single instance of NIL which is then shared
-  static struct LispDatum x = {.type =  Nil, .int_val = 0};
+  static struct LispDatum x = {.type =  Nil, .refs = LISP_REFS_IMMORTAL, .int_val = 0};
   return &x;
 }
 
-// TODO(matthew-c21): Update for garbage collection later on.
-void discard_datum(struct LispDatum* x) {
-  switch (x->type) {
-    case Integer:
-    case Rational:
-    case Real:
-    case Complex:
-      free(x);
-      break;
-    case String:
-      free(x->content);
-      free(x);
-      break;
-    case Symbol:
-      free(x->label);
-      free(x);
-      break;
-    case Cons:
-      discard_datum(x->car);
-      discard_datum(x->cdr);
-      free(x);
-      break;
-    case Bool:
-    case Nil:
-      break;
+void destroy_datum(struct LispDatum* x) {
+  struct LispState* state = lisp_state_current();
+
+  // Anything whose last reference is dropped while another datum is being destroyed waits on a stack, rather than
+  //  being destroyed by a nested call. However deep a structure is, destroying it only takes one level of C stack.
+  if (state->destroying) {
+    walk_push(&state->doomed, &x, sizeof(x));
+    return;
+  }
+
+  state->destroying = 1;
+
+  while (x != NULL) {
+    struct LispDatum* next = NULL;
+
+    switch (x->type) {
+      case BigInt:
+        destroy_bigint(x);
+        break;
+      case String:
+        destroy_string(x);
+        break;
+      case Vector:
+        destroy_vector(x);
+        break;
+      case HashMap:
+        destroy_map(x);
+        break;
+      case I32Array:
+      case F64Array:
+      case C128Array:
+        destroy_numeric_array(x);
+        break;
+      case Closure:
+        destroy_closure(x);
+        break;
+      case Cons:
+        release(x->car);
+
+        // Carry straight on with the cdr, which saves going through the stack for each cell of a list.
+        if (x->cdr != NULL && !(x->cdr->refs & LISP_REFS_IMMORTAL) &&
+            (--x->cdr->refs & LISP_REFS_COUNT) == 0) {
+          next = x->cdr;
+        }
+        break;
+      default:
+        break;
+    }
+
+    free_datum(x);
+
+    if (next == NULL && state->doomed.count > 0) {
+      next = *(struct LispDatum**) walk_top(&state->doomed, sizeof(next));
+      walk_pop(&state->doomed);
+    }
+
+    x = next;
   }
+
+  state->destroying = 0;
 }
 
-/**
- * Euclid's GCD algorithm, directly copied from [this answer](https://stackoverflow.com/a/19738969).
- */
-int gcd(int a, int b) {
-  int temp;
-  while (b != 0) {
-    temp = a % b;
+void release_deferred(struct LispDatum* x) {
+#ifdef LISP_TRACING_GC
+  // Queued pointers would not be updated if a collection moved what they point to.
+  (void) x;
+#else
+  if (x == NULL || x->refs & LISP_REFS_IMMORTAL) {
+    return;
+  }
+
+  struct LispState* state = lisp_state_current();
+
+  if (state->deferred_count == LISP_DEFERRED_RELEASE_CAPACITY) {
+    flush_releases();
+  }
+
+  state->deferred[state->deferred_count++] = x;
+#endif
+}
 
-    a = b;
-    b = temp;
+void flush_releases(void) {
+  struct LispState* state = lisp_state_current();
+
+  while (state->deferred_count > 0) {
+    release(state->deferred[--state->deferred_count]);
   }
-  return a;
+}
+
+struct LispDatum* reassign(struct LispDatum* old, struct LispDatum* replacement) {
+  release(old);
+  return replacement;
+}
+
+void discard_datum(struct LispDatum* x) {
+  release(x);
 }
 
 /**
@@ -118,44 +213,18 @@ void simplify(struct LispDatum* x) {
   }
 
   // Check for division by 0.
-  if (x->den == 0) {
+  if (rational_normalize(x)) {
     raise(ZeroDivision, "Division by 0 in simplification of rational number");
   }
-
-  // Reduce
-  int g = gcd(x->num, x->den);
-  if (g != 1) {
-    x->num /= g;
-    x->den /= g;
-  }
-
-  // Ensure the numerator contains the sign.
-  if (x->den < 0) {
-    x->num *= -1;
-    x->den *= -1;
-  }
-}
-
-struct LispDatum* new_string(const char* s) {
-  struct LispDatum* string = malloc(sizeof(struct LispDatum));
-  string->type = String;
-
-  size_t len = strlen(s);
-  string->length = len;
-  string->content = malloc(sizeof(char) * len + 1);
-  strncpy(string->content, s, len);
-  string->content[len] = 0;
-
-  return string;
 }
 
 struct LispDatum* get_true() {
-  static struct LispDatum true = {.type = Bool, .boolean = 1};
+  static struct LispDatum true = {.type = Bool, .refs = LISP_REFS_IMMORTAL, .boolean = 1};
   return &true;
 }
 
 struct LispDatum* get_false() {
-  static struct LispDatum false = {.type = Bool, .boolean = 0};
+  static struct LispDatum false = {.type = Bool, .refs = LISP_REFS_IMMORTAL, .boolean = 0};
   return &false;
 }
 
@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "stdlisp.h"
+#include "gc.h"
 
 
 // Note(matthew-c21): This approach to typing forces specific in-built types. For what I'm doing now, that's fine, but I
@@ -13,38 +14,123 @@
 /** The ordering of values of numeric types is important for determining type promotion. If type a > b, then b may be
  * promoted to a. The ordering of non-numeric types is arbitrary, and should never be used for the same purpose. */
 enum LispDataType {
-  Integer = 0, Rational = 1, Real = 2, Complex = 3, String, Symbol, Bool, Cons, Nil
+  Integer = 0, BigInt = 1, Rational = 2, Real = 3, Complex = 4, String, Symbol, Keyword, Bool, Cons, Vector, HashMap,
+  I32Array, F64Array, C128Array, Closure, Nil
+};
+
+/**
+ * Datums with this bit set in their reference count are never freed, and retaining or releasing them does nothing. This
+ * is used for statically allocated values like nil and the booleans. A count that overflows into this bit simply becomes
+ * immortal rather than wrapping around.
+ */
+#define LISP_REFS_IMMORTAL 0x80000000u
+
+/**
+ * The low bits of the reference count word hold the count itself. The bits above it mark cons cells that were allocated
+ * as part of a list chunk, and their position within it (see lists.h).
+ */
+#define LISP_REFS_COUNT 0x00FFFFFFu
+#define LISP_REFS_CHUNKED 0x40000000u
+#define LISP_REFS_INDEX_SHIFT 24
+#define LISP_REFS_INDEX_MASK 0x3F000000u
+
+/** Strings of at most this many characters are stored inline, within the datum itself. */
+#define LISP_SHORT_STRING_MAX 14
+
+/** Stored in place of the length of a short string to mark a long one. */
+#define LISP_LONG_STRING_TAG 0xFF
+
+struct LispStringBuffer;
+struct LispHashTable;
+struct LispBigInt;
+struct LispClosure;
+
+/**
+ * Representation of a string's characters. Short strings keep their (null terminated) characters inline, while longer
+ * ones refer to a shared, immutable buffer. The final byte distinguishes the two, and holds the length of short strings.
+ * Use the accessors in lstring.h rather than reading this directly.
+ */
+union LispString {
+  struct {
+    char chars[LISP_SHORT_STRING_MAX + 1];
+    uint8_t length;
+  } small;
+
+  struct {
+    struct LispStringBuffer* buffer;
+    uint8_t padding[7];
+    uint8_t tag;
+  } large;
 };
 
 /** Since LISP is a dynamically typed language, this struct exists as a way to produce that same behavior. */
 struct LispDatum {
   enum LispDataType type;
 
+  /** Number of owners of this datum. Fits in what would otherwise be padding between the type and the payload. */
+  uint32_t refs;
+
   union {
-    struct { int32_t num; int32_t den; };  // rational
+    struct { int64_t num; int64_t den; };  // rational
     int32_t int_val; // integer
+
+    /** Owned by the datum. Only used for values that do not fit in an integer. See bigint.h. */
+    struct LispBigInt* big; // big integer
+
     double float_val; // real
     struct { double real; double im; };  // complex
 
-    /** Symbols own their own strings. */
-    char* label;  // symbol/keyword
+    /** Symbols and keywords are interned, so there is only ever one datum for each label. */
+    struct { char* label; uint64_t hash; };  // symbol/keyword
 
-    struct { char* content; size_t length; }; // strings
+    union LispString string; // strings
 
     int boolean;
 
-    /** Cons cells do not make copies or transfer the ownership of the referred data. */
+    /** Cons cells do not make copies of the referred data, but each cell holds a reference to its car and cdr. */
     struct { struct LispDatum* car; struct LispDatum* cdr; };  // cons
+
+    /** Items are held contiguously, and the vector holds a reference to each of them. See vector.h. */
+    struct { struct LispDatum** items; uint32_t length; uint32_t capacity; };  // vector
+
+    /** NULL until the first entry is added. See hashmap.h. */
+    struct LispHashTable* table; // hash map
+
+    /** Unboxed numbers, all of the same type. Complex numbers are stored as pairs of doubles. See numarray.h. */
+    struct { void* values; uint32_t count; };  // numeric arrays
+
+    /** Code and captured values. See closure.h. */
+    struct LispClosure* closure; // closure
   };
 };
 
-// TODO(matthew-c21): Later on, these should be modified to connect to the garbage collector.
 // NOTE(matthew-c21): None of these `new` functions do any kind of validation
+// Every `new` function returns a datum with a single reference owned by the caller.
 struct LispDatum* new_integer(int32_t i);
 struct LispDatum* new_real(double d);
-struct LispDatum* new_rational(int32_t a, int32_t b);
+struct LispDatum* new_rational(int64_t a, int64_t b);
 struct LispDatum* new_complex(double r, double i);
 
+/**
+ * Integers within this range are preallocated once and shared, so obtaining one through `box_integer` never touches the
+ * allocator. Small loop counters, lengths, and the results of most everyday arithmetic fall within it.
+ */
+#define LISP_SMALL_INT_MIN (-256)
+#define LISP_SMALL_INT_MAX 767
+
+/**
+ * Obtain an immutable integer. Unlike `new_integer`, the returned value may be shared, and must never be modified or
+ * assumed to be distinct from any other integer with the same value. This is the form that natives and generated code
+ * should prefer for integer results and literals.
+ */
+struct LispDatum* box_integer(int32_t i);
+
+/**
+ * Move a number that lives outside of the heap (i.e. an accumulator on the stack) onto the heap. Integers are passed
+ * through `box_integer`, so the result should be treated as immutable.
+ */
+struct LispDatum* box_number(const struct LispDatum* x);
+
 struct LispDatum* get_true();
 struct LispDatum* get_false();
 
@@ -52,10 +138,77 @@ struct LispDatum* get_false();
  * Strings passed to this function should be null terminated. Since all new strings are either string literals
  * (automatically terminated) or composed from terminated strings, it is safe to assume that all strings that exist at
  * runtime are null terminated. This should be tested within string functions, specifically ones like concat.
+ *
+ * See lstring.h for the rest of the string functions.
  */
 struct LispDatum* new_string(const char* s);
+
+/** Both the car and the cdr are retained by the new cell, so the caller keeps its own references to them. */
 struct LispDatum* new_cons(struct LispDatum* car, struct LispDatum* cdr);
 
+/** Free a datum whose reference count has reached zero. This should only ever be called through `release`. */
+void destroy_datum(struct LispDatum* x);
+
+/**
+ * Whether a datum is immortal. Immortal values are shared by the whole program (including everything loaded from an
+ * image, see image.h), so the natives that modify values in place refuse them. In the tracing build the collector never
+ * looks inside them either, so a reference stored in one would not keep anything alive.
+ */
+static inline int is_immortal(const struct LispDatum* x) {
+  return (x->refs & LISP_REFS_IMMORTAL) != 0;
+}
+
+#ifdef LISP_TRACING_GC
+
+// With the tracing collector, datums are reclaimed once they are unreachable, and reference counts are never touched.
+static inline struct LispDatum* retain(struct LispDatum* x) {
+  return x;
+}
+
+static inline void release(struct LispDatum* x) {
+  (void) x;
+}
+
+#else
+
+/** Take an additional reference to a datum. Returns its argument so that it can be used inline. NULL is ignored. */
+static inline struct LispDatum* retain(struct LispDatum* x) {
+  if (x != NULL && !(x->refs & LISP_REFS_IMMORTAL)) {
+    x->refs = (x->refs & LISP_REFS_COUNT) == LISP_REFS_COUNT ? LISP_REFS_IMMORTAL : x->refs + 1;
+  }
+
+  return x;
+}
+
+/**
+ * Give up a reference to a datum, freeing it once no references remain. Whatever it holds is released without
+ * recursion (see `destroy_datum`), so releasing an arbitrarily long or deep structure does not consume any stack. NULL
+ * is ignored.
+ */
+static inline void release(struct LispDatum* x) {
+  if (x != NULL && !(x->refs & LISP_REFS_IMMORTAL) && (--x->refs & LISP_REFS_COUNT) == 0) {
+    destroy_datum(x);
+  }
+}
+
+#endif
+
+/**
+ * Queue a reference to be released later instead of immediately. Queued releases are processed in a single batch once
+ * the queue fills up or `flush_releases` is called, which keeps the cost of freeing large structures off of hot paths.
+ */
+void release_deferred(struct LispDatum* x);
+
+/** Process every release queued by `release_deferred` under the current `LispState`. */
+void flush_releases(void);
+
+/**
+ * Release the value currently held by a variable, and return its replacement. Used when reassigning a variable, as in
+ * `x = reassign(x, new_value)`. The replacement is evaluated before the old value is released.
+ */
+struct LispDatum* reassign(struct LispDatum* old, struct LispDatum* replacement);
+
+/** Equivalent to `release`, kept for existing callers. */
 void discard_datum(struct LispDatum* x);
 
 // TODO(matthew-c21): I want nil to be a static constant, but I'm not sure how to deal with const-correctness.
@@ -67,7 +220,18 @@ int truthy(const struct LispDatum* x);
 
 // NOTE(matthew-c21): While these functions could just be a `from_string(char*, LispDataType)`, this method avoids the
 //  possibility of mis-tagged unions being generated.
-struct LispDatum* new_symbol(char* content);
-struct LispDatum* new_symbol_from_copy(char* content, uint32_t length);
+/**
+ * Symbols and keywords are interned in a table shared by every thread and every `LispState`. Interned datums are
+ * immortal, and two of them are equal exactly when they are the same pointer. The label is always copied.
+ */
+struct LispDatum* new_symbol(const char* content);
+struct LispDatum* new_symbol_from_copy(const char* content, uint32_t length);
+struct LispDatum* new_keyword(const char* content, uint32_t length);
+
+/**
+ * Intern many labels at once, such as every symbol literal of a program on startup. Labels starting with a colon produce
+ * keywords (without the colon), and anything else produces a symbol.
+ */
+void intern_all(struct LispDatum** out, const char* const* labels, uint32_t count);
 
 #endif //LISP_DATA_H
@@ -2,18 +2,11 @@
 #include <stdlib.h>
 
 #include "err.h"
+#include "port.h"
+#include "state.h"
+#include "stats.h"
 
-// TODO(matthew-c21): Unit testing.
-/**
- * Error state value. This value should be treated as readonly by client code. Should multi-threaded behavior ever
- * become a thing, this will need to be more complex.
- */
-enum Cause GlobalErrorState = None;
-
-// This is left static because it shouldn't ever need to be read externally.
-static enum ErrorBehavior GlobalErrorBehavior = LogOnly;
-
-static void destroy_and_exit() {
+_Noreturn static void destroy_and_exit() {
   // TODO(matthew-c21): If necessary, add resource handles here to be closed before exiting.
   exit(-1);
 }
@@ -37,11 +30,46 @@ static char* cause_string(enum Cause cause) {
   }
 }
 
+void lisp_push_handler(struct LispHandler* handler, unsigned causes) {
+  struct LispState* state = lisp_state_current();
+  handler->causes = causes;
+  handler->cause = None;
+  handler->message = NULL;
+#ifdef LISP_TRACING_GC
+  handler->roots = state->heap.roots.count;
+#endif
+  handler->previous = state->handlers;
+  state->handlers = handler;
+}
+
+void lisp_pop_handler(struct LispHandler* handler) {
+  lisp_state_current()->handlers = handler->previous;
+}
+
 void* raise(enum Cause cause, const char* msg) {
+  struct LispState* state = lisp_state_current();
+  LISP_STATS_RAISE(cause);
+
+  if (cause != None) {
+    for (struct LispHandler* handler = state->handlers; handler != NULL; handler = handler->previous) {
+      if (handler->causes & LISP_CAUSE_MASK(cause)) {
+        state->handlers = handler->previous;
+        handler->cause = cause;
+        handler->message = msg;
+#ifdef LISP_TRACING_GC
+        state->heap.roots.count = handler->roots;
+#endif
+        longjmp(handler->jump, 1);
+      }
+    }
+  }
+
+  // Anything displayed before the error should appear before it.
+  lisp_flush_output();
   fprintf(stderr, "%s: %s\n", cause_string(cause), msg);
-  GlobalErrorState = cause;
+  state->error = cause;
 
-  switch (GlobalErrorBehavior) {
+  switch (state->error_behavior) {
     case LogAndQuit:
       destroy_and_exit();
       break;
@@ -55,6 +83,18 @@ void* raise(enum Cause cause, const char* msg) {
   return NULL;
 }
 
+void lisp_out_of_memory(void) {
+  // Counting the raise could itself need memory, so it goes uncounted.
+  lisp_flush_output();
+  fprintf(stderr, "%s: %s\n", cause_string(Generic), "Unable to allocate memory.");
+  lisp_state_current()->error = Generic;
+  destroy_and_exit();
+}
+
+enum Cause lisp_error_state(void) {
+  return lisp_state_current()->error;
+}
+
 void set_global_error_behavior(enum ErrorBehavior behavior) {
-  GlobalErrorBehavior = behavior;
+  lisp_state_current()->error_behavior = behavior;
 }
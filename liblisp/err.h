@@ -1,6 +1,9 @@
 #ifndef LISP_ERR_H
 #define LISP_ERR_H
 
+#include <setjmp.h>
+#include <stddef.h>
+
 enum Cause {
   None = 0, Type, Argument, ZeroDivision, Math, Generic
 };
@@ -19,21 +22,89 @@ enum ErrorBehavior {
 };
 
 /**
- * Error state value. This value should be treated as readonly by client code.
+ * Error state value of the current `LispState`. This value should be treated as readonly by client code.
  */
-enum Cause GlobalErrorState;
+#define GlobalErrorState (lisp_error_state())
+
+enum Cause lisp_error_state(void);
+
+/** The set of causes a handler accepts. */
+#define LISP_CAUSE_MASK(cause) (1u << (cause))
+#define LISP_ANY_CAUSE (~LISP_CAUSE_MASK(None))
+
+/**
+ * A point to resume from when a condition is raised, giving the code that raises no need to check for errors and the
+ * code that succeeds nothing to pay beyond the `setjmp` on entry. Handlers are installed like so:
+ *
+ *   struct LispHandler handler;
+ *   lisp_push_handler(&handler, LISP_CAUSE_MASK(ZeroDivision));
+ *   if (setjmp(handler.jump) == 0) {
+ *     ... code that may raise ...
+ *     lisp_pop_handler(&handler);
+ *   } else {
+ *     ... handler.cause and handler.message describe what was raised ...
+ *   }
+ *
+ * A raise unwinds to the innermost handler accepting its cause, which has already been popped by the time the `else`
+ * branch runs, along with any handlers pushed after it. Collector roots pushed since the handler are popped as well (see
+ * gc.h), since the variables they refer to are gone. Nothing else on the way is cleaned up, so values only held by
+ * temporaries of the interrupted code are never released, and local variables assigned since the `setjmp` are
+ * indeterminate unless declared `volatile`. Handlers must be popped in the reverse order they were pushed, and the
+ * function that pushed one must not return before it is popped.
+ */
+struct LispHandler {
+  jmp_buf jump;
+  unsigned causes;
+  enum Cause cause;
+
+  /** Static, or owned by a value that the raise left unreleased. Only meant for reporting the condition. */
+  const char* message;
+
+  /** How many collector roots were pushed when the handler was. Unused without the tracing collector. */
+  size_t roots;
+
+  struct LispHandler* previous;
+};
+
+/** Install a handler for any cause in the `LISP_CAUSE_MASK` bitmask `causes` on the current `LispState`. */
+void lisp_push_handler(struct LispHandler* handler, unsigned causes);
+
+/** Remove a handler once the code it guards has completed without raising. */
+void lisp_pop_handler(struct LispHandler* handler);
 
 /**
  * Basic means of expounding on runtime errors. Prints cause and message to stderr. The behavior after this point is
  * based on what the currently set error behavior is. Use `return raise(...)` in the same place you would use `raise E`.
  * The behavior is quite a bit different, but it establishes the same point. This function can also double as a logging
  * tool if no cause is given.
+ *
+ * If a handler accepting the cause has been pushed, nothing is printed and the error state is left alone. Instead, the
+ * raise jumps straight to that handler (see `LispHandler`), regardless of the error behavior.
  * @param cause the reason for the raise. If `None`, no exit will occur, but details will still be printed to `stderr`.
  * @param msg extra details to be printed. If NULL, only the cause will be printed.
  * @return NULL if the global error behavior is set to log only. This method does not return otherwise.
  */
 void* raise(enum Cause cause, const char* msg);
 
+/**
+ * Report that the system ran out of memory and exit, whatever the error behavior. Unlike `raise`, this never unwinds to
+ * a handler, since whatever was being allocated has been left half built.
+ */
+_Noreturn void lisp_out_of_memory(void);
+
+/**
+ * Wraps the validation of anything that the transpiler can prove ahead of time, which is the number of arguments passed
+ * to a native and their types. The unchecked flavor of the library (the `lisp_unchecked` target, built with
+ * `LISP_UNCHECKED`) compiles these checks out, and is only linked into programs where every call was proven valid.
+ * Checks that depend on values, such as division by zero or an index being in range, are always made.
+ */
+#ifdef LISP_UNCHECKED
+#define LISP_INVALID(condition) (0 && (condition))
+#else
+#define LISP_INVALID(condition) (condition)
+#endif
+
+/** Set the error behavior of the current `LispState`. */
 void set_global_error_behavior(enum ErrorBehavior behavior);
 
 #endif //LISP_ERR_H
@@ -0,0 +1,522 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "alloc.h"
+#include "bigint.h"
+#include "closure.h"
+#include "data.h"
+#include "err.h"
+#include "gc.h"
+#include "hashmap.h"
+#include "lstring.h"
+#include "numarray.h"
+#include "state.h"
+#include "vector.h"
+
+/*
+ * Layout of the heap:
+ *
+ * Every datum lives in a fixed size block, aligned to its own size so that the block holding any datum can be found by
+ * masking its address. Blocks belong either to the nursery or to the old space.
+ *
+ * Datums are bump allocated out of the nursery. Collections only happen at safepoints, so when the nursery fills up in
+ * between them, it simply grows by another block. At the next safepoint, live datums are copied out of the nursery into
+ * the old space (Cheney style, using the old space itself as the queue of datums left to scan) and every nursery block
+ * but the first is returned to the system.
+ *
+ * Since every datum is the same size, the old space is compacted in place by sliding live datums toward the front
+ * (LISP2 style): mark, compute forwarding addresses into a side table, update every reference, then move.
+ *
+ * The collector borrows the `refs` word of each datum for its own flags, since reference counts are unused in this
+ * build. Statics are recognized by `LISP_REFS_IMMORTAL` and are never traced through or moved. Every other datum was
+ * allocated through `gc_alloc_datum`, and so lives in a block.
+ */
+
+#define BLOCK_BYTES (64 * 1024)
+
+/** A safepoint triggers a minor collection once the nursery has grown to this many blocks. */
+#define NURSERY_BLOCKS 4
+
+/** The first major collection happens once the old space holds this many datums. */
+#define MAJOR_THRESHOLD_MIN (1u << 18)
+
+#define GC_MARKED 0x40000000u
+#define GC_FORWARDED 0x20000000u
+#define GC_REMEMBERED 0x10000000u
+
+enum Space {
+  Nursery, Old
+};
+
+struct Block {
+  enum Space space;
+  size_t used;
+
+  /** Next block of the nursery. Old blocks are kept in an array instead, since they need to be kept in order. */
+  struct Block* next;
+
+  /** Destinations of each live datum in an old block, only allocated for the duration of a major collection. */
+  struct LispDatum** forward;
+
+  struct LispDatum slots[];
+};
+
+#define BLOCK_SLOTS ((BLOCK_BYTES - sizeof(struct Block)) / sizeof(struct LispDatum))
+
+static void push_pointer(struct PointerStack* stack, void* item) {
+  if (stack->count == stack->capacity) {
+    size_t capacity = stack->capacity == 0 ? 64 : stack->capacity * 2;
+    void** items = realloc(stack->items, sizeof(void*) * capacity);
+
+    if (items == NULL) {
+      lisp_out_of_memory();
+      return;
+    }
+
+    stack->items = items;
+    stack->capacity = capacity;
+  }
+
+  stack->items[stack->count++] = item;
+}
+
+static uint64_t now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + (uint64_t) ts.tv_nsec;
+}
+
+static struct Block* new_block(enum Space space) {
+  struct Block* block = aligned_alloc(BLOCK_BYTES, BLOCK_BYTES);
+
+  if (block == NULL) {
+    lisp_out_of_memory();
+    return NULL;
+  }
+
+  block->space = space;
+  block->used = 0;
+  block->next = NULL;
+  block->forward = NULL;
+  return block;
+}
+
+static struct Block* block_of(const struct LispDatum* x) {
+  return (struct Block*) ((uintptr_t) x & ~(uintptr_t) (BLOCK_BYTES - 1));
+}
+
+static int is_static(const struct LispDatum* x) {
+  return (x->refs & LISP_REFS_IMMORTAL) != 0;
+}
+
+static int in_nursery(const struct LispDatum* x) {
+  return !is_static(x) && block_of(x)->space == Nursery;
+}
+
+struct LispDatum* gc_alloc_datum(void) {
+  struct Heap* heap = &lisp_state_current()->heap;
+
+  if (heap->nursery == NULL) {
+    heap->nursery = heap->nursery_tail = new_block(Nursery);
+    heap->nursery_blocks = 1;
+  } else if (heap->nursery_tail->used == BLOCK_SLOTS) {
+    heap->nursery_tail->next = new_block(Nursery);
+    heap->nursery_tail = heap->nursery_tail->next;
+    ++heap->nursery_blocks;
+  }
+
+  ++heap->stats.nursery_allocated;
+  return &heap->nursery_tail->slots[heap->nursery_tail->used++];
+}
+
+/** Release anything a dead datum owns outside of the heap. */
+static void finalize(struct LispDatum* x) {
+  switch (x->type) {
+    case BigInt:
+      destroy_bigint(x);
+      break;
+    case String:
+      destroy_string(x);
+      break;
+    case Vector:
+      destroy_vector(x);
+      break;
+    case HashMap:
+      destroy_map(x);
+      break;
+    case I32Array:
+    case F64Array:
+    case C128Array:
+      destroy_numeric_array(x);
+      break;
+    case Closure:
+      destroy_closure(x);
+      break;
+    default:
+      break;
+  }
+}
+
+static struct Block* new_old_block(struct Heap* heap) {
+  if (heap->block_count == heap->block_capacity) {
+    size_t capacity = heap->block_capacity == 0 ? 16 : heap->block_capacity * 2;
+    struct Block** blocks = realloc(heap->blocks, sizeof(struct Block*) * capacity);
+
+    if (blocks == NULL) {
+      lisp_out_of_memory();
+      return NULL;
+    }
+
+    heap->blocks = blocks;
+    heap->block_capacity = capacity;
+  }
+
+  struct Block* block = new_block(Old);
+  heap->blocks[heap->block_count++] = block;
+  return block;
+}
+
+static struct LispDatum* old_alloc(struct Heap* heap) {
+  struct Block* block = heap->block_count == 0 ? NULL : heap->blocks[heap->block_count - 1];
+
+  if (block == NULL || block->used == BLOCK_SLOTS) {
+    block = new_old_block(heap);
+  }
+
+  ++heap->old_count;
+  return &block->slots[block->used++];
+}
+
+static void evacuate(struct Heap* heap, struct LispDatum** slot) {
+  struct LispDatum* x = *slot;
+
+  if (x == NULL || !in_nursery(x)) {
+    return;
+  }
+
+  if (x->refs & GC_FORWARDED) {
+    *slot = x->car;
+    return;
+  }
+
+  struct LispDatum* copy = old_alloc(heap);
+  *copy = *x;
+
+  x->refs = GC_FORWARDED;
+  x->car = copy;
+  *slot = copy;
+
+  ++heap->stats.promoted;
+}
+
+static void evacuate_children(struct Heap* heap, struct LispDatum* x) {
+  if (x->type == Cons) {
+    evacuate(heap, &x->car);
+    evacuate(heap, &x->cdr);
+  } else if (x->type == Vector) {
+    for (uint32_t i = 0; i < x->length; ++i) {
+      evacuate(heap, &x->items[i]);
+    }
+  } else if (x->type == HashMap) {
+    uint32_t cursor = 0;
+    struct LispMapEntry* entry;
+
+    while ((entry = map_next(x, &cursor)) != NULL) {
+      evacuate(heap, &entry->key);
+      evacuate(heap, &entry->value);
+    }
+  } else if (x->type == Closure) {
+    for (uint32_t i = 0; i < x->closure->count; ++i) {
+      evacuate(heap, &x->closure->captured[i]);
+    }
+  }
+}
+
+static void minor_collection(struct Heap* heap) {
+  // Everything promoted during this collection is appended after this point, so it doubles as the scan queue.
+  size_t scan_block = heap->block_count == 0 ? 0 : heap->block_count - 1;
+  size_t scan_slot = heap->block_count == 0 ? 0 : heap->blocks[scan_block]->used;
+
+  for (size_t i = 0; i < heap->roots.count; ++i) {
+    evacuate(heap, heap->roots.items[i]);
+  }
+
+  for (size_t i = 0; i < heap->remembered.count; ++i) {
+    struct LispDatum* x = heap->remembered.items[i];
+    x->refs &= ~GC_REMEMBERED;
+    evacuate_children(heap, x);
+  }
+  heap->remembered.count = 0;
+
+  while (scan_block < heap->block_count) {
+    struct Block* block = heap->blocks[scan_block];
+
+    if (scan_slot < block->used) {
+      evacuate_children(heap, &block->slots[scan_slot++]);
+    } else if (scan_block + 1 < heap->block_count) {
+      ++scan_block;
+      scan_slot = 0;
+    } else {
+      break;
+    }
+  }
+
+  // Whatever was not forwarded is garbage. Keep the first block around for reuse.
+  struct Block* block = heap->nursery;
+  while (block != NULL) {
+    for (size_t i = 0; i < block->used; ++i) {
+      if (!(block->slots[i].refs & GC_FORWARDED)) {
+        finalize(&block->slots[i]);
+      }
+    }
+
+    struct Block* next = block->next;
+    if (block != heap->nursery) {
+      free(block);
+    }
+    block = next;
+  }
+
+  if (heap->nursery != NULL) {
+    heap->nursery->next = NULL;
+    heap->nursery->used = 0;
+    heap->nursery_blocks = 1;
+  }
+  heap->nursery_tail = heap->nursery;
+
+  ++heap->stats.minor_collections;
+}
+
+static void mark(struct Heap* heap, struct LispDatum* x) {
+  if (x == NULL || is_static(x) || x->refs & GC_MARKED) {
+    return;
+  }
+
+  x->refs |= GC_MARKED;
+  push_pointer(&heap->marks, x);
+}
+
+static struct LispDatum* forwarded(struct LispDatum* x) {
+  if (x == NULL || is_static(x)) {
+    return x;
+  }
+
+  struct Block* block = block_of(x);
+  return block->forward[x - block->slots];
+}
+
+/** Must only be run directly after a minor collection, when the nursery is empty. */
+static void major_collection(struct Heap* heap) {
+  for (size_t i = 0; i < heap->roots.count; ++i) {
+    mark(heap, *(struct LispDatum**) heap->roots.items[i]);
+  }
+
+  while (heap->marks.count > 0) {
+    struct LispDatum* x = heap->marks.items[--heap->marks.count];
+
+    if (x->type == Cons) {
+      mark(heap, x->car);
+      mark(heap, x->cdr);
+    } else if (x->type == Vector) {
+      for (uint32_t i = 0; i < x->length; ++i) {
+        mark(heap, x->items[i]);
+      }
+    } else if (x->type == HashMap) {
+      uint32_t cursor = 0;
+      struct LispMapEntry* entry;
+
+      while ((entry = map_next(x, &cursor)) != NULL) {
+        mark(heap, entry->key);
+        mark(heap, entry->value);
+      }
+    } else if (x->type == Closure) {
+      for (uint32_t i = 0; i < x->closure->count; ++i) {
+        mark(heap, x->closure->captured[i]);
+      }
+    }
+  }
+
+  // Compute where every live datum will end up, finalizing the dead ones along the way.
+  size_t dest_block = 0;
+  size_t dest_slot = 0;
+  size_t live = 0;
+
+  for (size_t i = 0; i < heap->block_count; ++i) {
+    struct Block* block = heap->blocks[i];
+    block->forward = malloc(sizeof(struct LispDatum*) * BLOCK_SLOTS);
+
+    if (block->forward == NULL) {
+      lisp_out_of_memory();
+      return;
+    }
+
+    for (size_t j = 0; j < block->used; ++j) {
+      struct LispDatum* x = &block->slots[j];
+
+      if (x->refs & GC_MARKED) {
+        if (dest_slot == BLOCK_SLOTS) {
+          ++dest_block;
+          dest_slot = 0;
+        }
+
+        block->forward[j] = &heap->blocks[dest_block]->slots[dest_slot++];
+        ++live;
+      } else {
+        finalize(x);
+        block->forward[j] = NULL;
+      }
+    }
+  }
+
+  for (size_t i = 0; i < heap->roots.count; ++i) {
+    struct LispDatum** root = heap->roots.items[i];
+    *root = forwarded(*root);
+  }
+
+  for (size_t i = 0; i < heap->block_count; ++i) {
+    struct Block* block = heap->blocks[i];
+
+    for (size_t j = 0; j < block->used; ++j) {
+      struct LispDatum* x = &block->slots[j];
+
+      if (!(x->refs & GC_MARKED)) {
+        continue;
+      }
+
+      if (x->type == Cons) {
+        x->car = forwarded(x->car);
+        x->cdr = forwarded(x->cdr);
+      } else if (x->type == Vector) {
+        for (uint32_t i = 0; i < x->length; ++i) {
+          x->items[i] = forwarded(x->items[i]);
+        }
+      } else if (x->type == HashMap) {
+        uint32_t cursor = 0;
+        struct LispMapEntry* entry;
+
+        while ((entry = map_next(x, &cursor)) != NULL) {
+          entry->key = forwarded(entry->key);
+          entry->value = forwarded(entry->value);
+        }
+      } else if (x->type == Closure) {
+        for (uint32_t i = 0; i < x->closure->count; ++i) {
+          x->closure->captured[i] = forwarded(x->closure->captured[i]);
+        }
+      }
+    }
+  }
+
+  // Destinations never come after their sources, so sliding in order never overwrites a datum that has yet to move.
+  for (size_t i = 0; i < heap->block_count; ++i) {
+    struct Block* block = heap->blocks[i];
+
+    for (size_t j = 0; j < block->used; ++j) {
+      struct LispDatum* x = &block->slots[j];
+
+      if (x->refs & GC_MARKED) {
+        struct LispDatum* dest = block->forward[j];
+        x->refs &= ~GC_MARKED;
+
+        if (dest != x) {
+          *dest = *x;
+        }
+      }
+    }
+  }
+
+  // Release the blocks emptied out by compaction.
+  size_t kept = live == 0 ? 0 : dest_block + 1;
+
+  for (size_t i = 0; i < heap->block_count; ++i) {
+    free(heap->blocks[i]->forward);
+    heap->blocks[i]->forward = NULL;
+
+    if (i >= kept) {
+      free(heap->blocks[i]);
+    } else {
+      heap->blocks[i]->used = i == dest_block ? dest_slot : BLOCK_SLOTS;
+    }
+  }
+
+  heap->stats.old_reclaimed += heap->old_count - live;
+  heap->stats.old_live = live;
+  heap->block_count = kept;
+  heap->old_count = live;
+
+  heap->major_threshold = live * 2 > MAJOR_THRESHOLD_MIN ? live * 2 : MAJOR_THRESHOLD_MIN;
+  ++heap->stats.major_collections;
+}
+
+static void collect(struct Heap* heap, int major) {
+  uint64_t start = now_ns();
+
+  minor_collection(heap);
+
+  if (heap->major_threshold == 0) {
+    heap->major_threshold = MAJOR_THRESHOLD_MIN;
+  }
+
+  if (major || heap->old_count >= heap->major_threshold) {
+    major_collection(heap);
+  }
+
+  uint64_t pause = now_ns() - start;
+  heap->stats.last_pause_ns = pause;
+  heap->stats.total_pause_ns += pause;
+
+  if (pause > heap->stats.max_pause_ns) {
+    heap->stats.max_pause_ns = pause;
+  }
+}
+
+void gc_collect(int major) {
+  collect(&lisp_state_current()->heap, major);
+}
+
+void gc_safepoint(void) {
+  struct Heap* heap = &lisp_state_current()->heap;
+
+  if (heap->nursery_blocks >= NURSERY_BLOCKS) {
+    gc_collect(0);
+  }
+}
+
+void gc_push_root(struct LispDatum** slot) {
+  push_pointer(&lisp_state_current()->heap.roots, slot);
+}
+
+void gc_pop_roots(uint32_t count) {
+  struct Heap* heap = &lisp_state_current()->heap;
+  heap->roots.count = count > heap->roots.count ? 0 : heap->roots.count - count;
+}
+
+void gc_write_barrier(struct LispDatum* owner) {
+  struct Heap* heap = &lisp_state_current()->heap;
+
+  if (owner == NULL || is_static(owner) || owner->refs & GC_REMEMBERED || in_nursery(owner)) {
+    return;
+  }
+
+  owner->refs |= GC_REMEMBERED;
+  push_pointer(&heap->remembered, owner);
+}
+
+void destroy_heap(struct Heap* heap) {
+  // Nothing is reachable anymore, so this amounts to finalizing everything.
+  heap->roots.count = 0;
+  collect(heap, 1);
+
+  free(heap->nursery);
+  free(heap->blocks);
+  free(heap->roots.items);
+  free(heap->remembered.items);
+  free(heap->marks.items);
+
+  *heap = (struct Heap) {0};
+}
+
+const struct LispGCStats* gc_stats(void) {
+  return &lisp_state_current()->heap.stats;
+}
@@ -0,0 +1,121 @@
+#ifndef LISP_GC_H
+#define LISP_GC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct LispDatum;
+
+/*
+ * The runtime is built around one of two memory managers, chosen with the LISP_MEMORY_MANAGER CMake option. By
+ * default, datums are reference counted (see `retain` and `release` in data.h). When LISP_TRACING_GC is defined, they
+ * are instead managed by a generational tracing collector: datums are bump allocated in a nursery, survivors of a minor
+ * collection are copied into an old space, and the old space is mark-compacted once it grows large enough.
+ *
+ * The functions in this header are always available so that generated code can be written once for either flavor. With
+ * reference counting they compile down to nothing, and with the tracing collector `retain`/`release` do.
+ *
+ * Collections only ever happen inside `gc_safepoint`, so natives never need to worry about values moving out from
+ * under them. The flip side is that anything which must survive a safepoint has to be reachable from a root. Generated
+ * code reaches a safepoint at the start of every function as well as between top level statements, so it roots every
+ * variable it declares. A raise pops any roots pushed since the handler it unwinds to (see `LispHandler` in err.h).
+ */
+
+#ifdef LISP_TRACING_GC
+
+/** Collection statistics, accumulated over the lifetime of a heap. */
+struct LispGCStats {
+  uint64_t minor_collections;
+  uint64_t major_collections;
+
+  /** Datums allocated in the nursery, and how many of those survived long enough to be promoted. */
+  uint64_t nursery_allocated;
+  uint64_t promoted;
+
+  /** Old space datums live after the most recent major collection, and the total reclaimed by all of them. */
+  uint64_t old_live;
+  uint64_t old_reclaimed;
+
+  /** Pause times in nanoseconds. */
+  uint64_t total_pause_ns;
+  uint64_t max_pause_ns;
+  uint64_t last_pause_ns;
+};
+
+/** A growable stack of pointers, used for the roots, the remembered set, and the mark stack. */
+struct PointerStack {
+  void** items;
+  size_t count;
+  size_t capacity;
+};
+
+/** The collected heap. Each `LispState` owns one, and its fields are private to gc.c. */
+struct Heap {
+  struct Block* nursery;
+  struct Block* nursery_tail;
+  size_t nursery_blocks;
+
+  struct Block** blocks;
+  size_t block_count;
+  size_t block_capacity;
+  size_t old_count;
+  size_t major_threshold;
+
+  struct PointerStack roots;
+
+  /** Old datums which may hold references into the nursery. */
+  struct PointerStack remembered;
+
+  struct PointerStack marks;
+
+  struct LispGCStats stats;
+};
+
+/** Return everything owned by a heap to the system. Anything allocated from it becomes invalid. */
+void destroy_heap(struct Heap* heap);
+
+/**
+ * Register a variable as a root. The variable is read at each collection, and updated if the datum it refers to is
+ * moved, so it must stay valid until it is popped. Roots form a stack, and must be popped in the reverse order.
+ */
+void gc_push_root(struct LispDatum** slot);
+
+/** Unregister the `count` most recently pushed roots. */
+void gc_pop_roots(uint32_t count);
+
+/** Give the collector a chance to run. Only the roots are guaranteed to remain valid afterwards. */
+void gc_safepoint(void);
+
+/** Collect immediately. A major collection compacts the old space in addition to evacuating the nursery. */
+void gc_collect(int major);
+
+/**
+ * Must be called after storing a reference inside of an existing datum (as opposed to one that was just allocated), so
+ * that the collector can track pointers from the old space into the nursery.
+ */
+void gc_write_barrier(struct LispDatum* owner);
+
+const struct LispGCStats* gc_stats(void);
+
+/** Allocate space for a datum in the nursery. Used by `alloc_datum`. */
+struct LispDatum* gc_alloc_datum(void);
+
+#else
+
+static inline void gc_push_root(struct LispDatum** slot) {
+  (void) slot;
+}
+
+static inline void gc_pop_roots(uint32_t count) {
+  (void) count;
+}
+
+static inline void gc_safepoint(void) {}
+
+static inline void gc_write_barrier(struct LispDatum* owner) {
+  (void) owner;
+}
+
+#endif
+
+#endif //LISP_GC_H
@@ -0,0 +1,345 @@
+#include <string.h>
+#include "alloc.h"
+#include "bigint.h"
+#include "hashmap.h"
+#include "lstring.h"
+#include "stats.h"
+#include "stdlisp.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define CTRL_EMPTY ((int8_t) -128)
+#define CTRL_DELETED ((int8_t) -2)
+
+/** Tables are rebuilt once they are 7/8ths full, counting deleted slots. */
+#define MAX_LOAD(capacity) ((capacity) - (capacity) / 8)
+
+static uint64_t mix(uint64_t x) {
+  // Finalizer from SplitMix64. Spreads every input bit over the whole hash, since both ends of it are used.
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9u;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBu;
+  x ^= x >> 31;
+  return x;
+}
+
+static uint64_t hash_double(double d) {
+  // 0.0 and -0.0 compare equal, so they need to hash equally as well.
+  if (d == 0) {
+    d = 0;
+  }
+
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(bits));
+  return bits;
+}
+
+int is_hashable(const struct LispDatum* x) {
+  switch (x->type) {
+    case Cons:
+    case Vector:
+    case HashMap:
+    case I32Array:
+    case F64Array:
+    case C128Array:
+    case Closure:
+      return 0;
+    default:
+      return 1;
+  }
+}
+
+uint64_t datum_hash(const struct LispDatum* x) {
+  // Numbers are hashed by the value they would have after promotion to a real, so that equal numbers of different
+  // types hash alike. Complex numbers only differ from reals when they have an imaginary part.
+  switch (x->type) {
+    case Integer:
+      return mix(hash_double((double) x->int_val));
+    case BigInt:
+      return mix(hash_double(integer_to_double(x)));
+    case Rational:
+      return mix(hash_double(((double) x->num) / (x->den)));
+    case Real:
+      return mix(hash_double(x->float_val));
+    case Complex:
+      return mix(x->im == 0 ? hash_double(x->real) : hash_double(x->real) * 31 + hash_double(x->im));
+    case String:
+      return mix(string_hash(x));
+    case Symbol:
+    case Keyword:
+      return mix(x->hash);
+    case Bool:
+      return mix(x->type + (uint64_t) x->boolean);
+    default:
+      return mix(x->type);
+  }
+}
+
+static int keys_equal(const struct LispDatum* a, const struct LispDatum* b) {
+  return a == b || datum_cmp(a, b);
+}
+
+static int8_t h2(uint64_t hash) {
+  return (int8_t) (hash & 0x7F);
+}
+
+static uint32_t h1(uint64_t hash) {
+  return (uint32_t) (hash >> 7);
+}
+
+// Bit `i` of each of these masks is set if the `i`th control byte of the group meets the condition.
+
+#ifdef __SSE2__
+
+static uint32_t match_byte(const int8_t* group, int8_t value) {
+  __m128i ctrl = _mm_loadu_si128((const __m128i*) group);
+  return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(value)));
+}
+
+static uint32_t match_empty_or_deleted(const int8_t* group) {
+  // Only the special markers have their sign bit set.
+  return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) group));
+}
+
+#else
+
+static uint32_t match_byte(const int8_t* group, int8_t value) {
+  uint32_t mask = 0;
+
+  for (uint32_t i = 0; i < LISP_MAP_GROUP_WIDTH; ++i) {
+    mask |= (uint32_t) (group[i] == value) << i;
+  }
+
+  return mask;
+}
+
+static uint32_t match_empty_or_deleted(const int8_t* group) {
+  uint32_t mask = 0;
+
+  for (uint32_t i = 0; i < LISP_MAP_GROUP_WIDTH; ++i) {
+    mask |= (uint32_t) (group[i] < 0) << i;
+  }
+
+  return mask;
+}
+
+#endif
+
+static uint32_t lowest_bit(uint32_t mask) {
+  return (uint32_t) __builtin_ctz(mask);
+}
+
+static size_t table_size(uint32_t capacity) {
+  return sizeof(struct LispHashTable) + capacity + capacity * sizeof(struct LispMapEntry);
+}
+
+static struct LispHashTable* new_table(uint32_t capacity) {
+  struct LispHashTable* table = lisp_alloc(table_size(capacity));
+  table->capacity = capacity;
+  table->count = 0;
+  table->growth_left = MAX_LOAD(capacity);
+  // The capacity is a multiple of the group width, which keeps the entries aligned.
+  table->entries = (struct LispMapEntry*) (table->ctrl + capacity);
+  memset(table->ctrl, CTRL_EMPTY, capacity);
+  return table;
+}
+
+static void free_table(struct LispHashTable* table) {
+  lisp_free(table, table_size(table->capacity));
+}
+
+/**
+ * Groups are probed in triangular order, which visits every group exactly once since there are a power of two of them.
+ * Returns the index of the first group, and advances `step` on later calls through `next_group`.
+ */
+static uint32_t first_group(const struct LispHashTable* table, uint64_t hash) {
+  return h1(hash) & (table->capacity / LISP_MAP_GROUP_WIDTH - 1);
+}
+
+static uint32_t next_group(const struct LispHashTable* table, uint32_t group, uint32_t* step) {
+  return (group + ++*step) & (table->capacity / LISP_MAP_GROUP_WIDTH - 1);
+}
+
+/** Index of the slot holding a key, or -1. */
+static int64_t find(const struct LispHashTable* table, const struct LispDatum* key, uint64_t hash) {
+  uint32_t step = 0;
+
+  for (uint32_t group = first_group(table, hash);; group = next_group(table, group, &step)) {
+    const int8_t* ctrl = table->ctrl + group * LISP_MAP_GROUP_WIDTH;
+
+    for (uint32_t mask = match_byte(ctrl, h2(hash)); mask != 0; mask &= mask - 1) {
+      uint32_t slot = group * LISP_MAP_GROUP_WIDTH + lowest_bit(mask);
+
+      if (keys_equal(table->entries[slot].key, key)) {
+        return slot;
+      }
+    }
+
+    // A key is always placed in the first group with room for it, so an empty slot means the search is over.
+    if (match_byte(ctrl, CTRL_EMPTY) != 0) {
+      return -1;
+    }
+  }
+}
+
+/** Index of the first empty or deleted slot along a key's probe sequence. There is always at least one. */
+static uint32_t find_free(const struct LispHashTable* table, uint64_t hash) {
+  uint32_t step = 0;
+
+  for (uint32_t group = first_group(table, hash);; group = next_group(table, group, &step)) {
+    uint32_t mask = match_empty_or_deleted(table->ctrl + group * LISP_MAP_GROUP_WIDTH);
+
+    if (mask != 0) {
+      return group * LISP_MAP_GROUP_WIDTH + lowest_bit(mask);
+    }
+  }
+}
+
+static void place(struct LispHashTable* table, uint32_t slot, uint64_t hash, struct LispDatum* key,
+                  struct LispDatum* value) {
+  if (table->ctrl[slot] == CTRL_EMPTY) {
+    --table->growth_left;
+  }
+
+  table->ctrl[slot] = h2(hash);
+  table->entries[slot].key = key;
+  table->entries[slot].value = value;
+  ++table->count;
+}
+
+/** Move every entry into a new table, which also clears out deleted slots. */
+static void rebuild(struct LispDatum* map, uint32_t capacity) {
+  struct LispHashTable* old = map->table;
+  struct LispHashTable* table = new_table(capacity);
+
+  for (uint32_t i = 0; i < old->capacity; ++i) {
+    if (old->ctrl[i] >= 0) {
+      struct LispMapEntry* entry = &old->entries[i];
+      uint64_t hash = datum_hash(entry->key);
+      place(table, find_free(table, hash), hash, entry->key, entry->value);
+    }
+  }
+
+  free_table(old);
+  map->table = table;
+}
+
+/** Smallest valid capacity that holds `count` entries without growing. */
+static uint32_t capacity_for(uint32_t count) {
+  uint32_t capacity = LISP_MAP_GROUP_WIDTH;
+
+  while (MAX_LOAD(capacity) < count) {
+    capacity *= 2;
+  }
+
+  return capacity;
+}
+
+struct LispDatum* new_hash_map(uint32_t capacity) {
+  struct LispDatum* map = alloc_datum();
+  map->type = HashMap;
+  map->refs = 1;
+  map->table = capacity == 0 ? NULL : new_table(capacity_for(capacity));
+  LISP_STATS_ALLOC(HashMap, sizeof(struct LispDatum) + (map->table == NULL ? 0 : table_size(map->table->capacity)));
+  return map;
+}
+
+struct LispDatum* map_get(const struct LispDatum* map, const struct LispDatum* key) {
+  if (map->table == NULL) {
+    return NULL;
+  }
+
+  int64_t slot = find(map->table, key, datum_hash(key));
+  return slot < 0 ? NULL : map->table->entries[slot].value;
+}
+
+void map_put(struct LispDatum* map, struct LispDatum* key, struct LispDatum* value) {
+  uint64_t hash = datum_hash(key);
+
+  if (map->table == NULL) {
+    map->table = new_table(LISP_MAP_GROUP_WIDTH);
+  } else {
+    int64_t slot = find(map->table, key, hash);
+
+    if (slot >= 0) {
+      struct LispDatum* old = map->table->entries[slot].value;
+      map->table->entries[slot].value = retain(value);
+      release(old);
+      return;
+    }
+  }
+
+  if (map->table->growth_left == 0) {
+    // Grow if the table is genuinely full, as opposed to cluttered with deleted slots.
+    uint32_t count = map->table->count + 1;
+    rebuild(map, count > MAX_LOAD(map->table->capacity) / 2 ? map->table->capacity * 2 : map->table->capacity);
+  }
+
+  place(map->table, find_free(map->table, hash), hash, retain(key), retain(value));
+}
+
+int map_remove(struct LispDatum* map, const struct LispDatum* key) {
+  struct LispHashTable* table = map->table;
+
+  if (table == NULL) {
+    return 0;
+  }
+
+  int64_t slot = find(table, key, datum_hash(key));
+
+  if (slot < 0) {
+    return 0;
+  }
+
+  // If the group still has an empty slot, no probe sequence has ever continued past it, so this slot can become empty
+  // again. Otherwise, it has to be marked deleted so that searches keep going.
+  const int8_t* group = table->ctrl + (slot / LISP_MAP_GROUP_WIDTH) * LISP_MAP_GROUP_WIDTH;
+  if (match_byte(group, CTRL_EMPTY) != 0) {
+    table->ctrl[slot] = CTRL_EMPTY;
+    ++table->growth_left;
+  } else {
+    table->ctrl[slot] = CTRL_DELETED;
+  }
+
+  --table->count;
+  release(table->entries[slot].key);
+  release(table->entries[slot].value);
+  return 1;
+}
+
+struct LispMapEntry* map_next(const struct LispDatum* map, uint32_t* cursor) {
+  struct LispHashTable* table = map->table;
+
+  if (table == NULL) {
+    return NULL;
+  }
+
+  while (*cursor < table->capacity) {
+    uint32_t slot = (*cursor)++;
+
+    if (table->ctrl[slot] >= 0) {
+      return &table->entries[slot];
+    }
+  }
+
+  return NULL;
+}
+
+void destroy_map(struct LispDatum* map) {
+  if (map->table == NULL) {
+    return;
+  }
+
+  uint32_t cursor = 0;
+  struct LispMapEntry* entry;
+
+  while ((entry = map_next(map, &cursor)) != NULL) {
+    release(entry->key);
+    release(entry->value);
+  }
+
+  free_table(map->table);
+}
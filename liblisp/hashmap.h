@@ -0,0 +1,70 @@
+#ifndef LISP_HASHMAP_H
+#define LISP_HASHMAP_H
+
+#include <stdint.h>
+#include "data.h"
+
+/*
+ * Hash maps are open addressing tables in the style of SwissTable. Alongside the entries, the table keeps one control
+ * byte per slot, holding either a marker for an empty or deleted slot, or 7 bits of the hash of the key in that slot.
+ * Lookups scan the control bytes a group of LISP_MAP_GROUP_WIDTH slots at a time (with SSE2 where it is available), so
+ * that only slots whose control byte matches ever have their key compared.
+ *
+ * Keys are compared with `datum_cmp`, so only values it can compare may be used as keys: numbers, strings, symbols,
+ * keywords, booleans, and nil. Numbers that compare equal hash equally regardless of their type, so that (for instance)
+ * 1 and 1.0 refer to the same entry.
+ */
+
+#define LISP_MAP_GROUP_WIDTH 16
+
+struct LispMapEntry {
+  struct LispDatum* key;
+  struct LispDatum* value;
+};
+
+/** The storage behind a hash map. The capacity is always a power of two, and at least LISP_MAP_GROUP_WIDTH. */
+struct LispHashTable {
+  uint32_t capacity;
+  uint32_t count;
+
+  /** How many more keys can be placed in empty slots before the table must be rebuilt. */
+  uint32_t growth_left;
+
+  struct LispMapEntry* entries;
+
+  /** Negative for empty and deleted slots. Otherwise, the low 7 bits of the hash of the slot's key. */
+  int8_t ctrl[];
+};
+
+/** Create an empty map with room for `capacity` entries before it needs to grow. */
+struct LispDatum* new_hash_map(uint32_t capacity);
+
+/** Whether a datum may be used as a key. */
+int is_hashable(const struct LispDatum* x);
+
+/** Hash of a hashable datum, consistent with `datum_cmp`. */
+uint64_t datum_hash(const struct LispDatum* x);
+
+/** The value associated with a key, or NULL if there is none. The map keeps its reference to the value. */
+struct LispDatum* map_get(const struct LispDatum* map, const struct LispDatum* key);
+
+/** Associate a value with a hashable key, replacing any previous value. The map takes its own references to both. */
+void map_put(struct LispDatum* map, struct LispDatum* key, struct LispDatum* value);
+
+/** Remove a key and its value. Returns whether the key was present. */
+int map_remove(struct LispDatum* map, const struct LispDatum* key);
+
+static inline uint32_t map_count(const struct LispDatum* map) {
+  return map->table == NULL ? 0 : map->table->count;
+}
+
+/**
+ * Step through the entries of a map, in no particular order. Start with a cursor of 0, and keep calling until this
+ * returns NULL. The map must not be modified in the meantime.
+ */
+struct LispMapEntry* map_next(const struct LispDatum* map, uint32_t* cursor);
+
+/** Free whatever a map owns outside of its datum. Called when the map is destroyed or collected. */
+void destroy_map(struct LispDatum* map);
+
+#endif //LISP_HASHMAP_H
@@ -0,0 +1,453 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bigint.h"
+#include "err.h"
+#include "hashmap.h"
+#include "image.h"
+#include "lstring.h"
+#include "numarray.h"
+#include "walk.h"
+
+#define IMAGE_MAGIC "LISPIMG"
+#define IMAGE_VERSION 1
+
+/** Where images ask to be mapped, far away from anywhere the program's own memory usually ends up. */
+#define IMAGE_BASE ((uintptr_t) 0x100000000000)
+
+/** Every datum and payload in an image starts on a multiple of this. */
+#define IMAGE_ALIGNMENT 8
+
+/** The start of every image. Offsets are from the start of the file, and so also from the start of the mapping. */
+struct ImageHeader {
+  char magic[8];
+  uint32_t version;
+
+  /** Size of a datum in the runtime that wrote the image, which catches images written by an incompatible build. */
+  uint32_t datum_size;
+
+  /** Of the whole file. */
+  uint64_t size;
+
+  /** A pointer to the saved value, filled in like any other. */
+  uint64_t root;
+
+  /** Offsets of the tables of `ImageExternal`s and of the offsets of internal pointers, which follow the data. */
+  uint64_t externals;
+  uint64_t external_count;
+  uint64_t internals;
+  uint64_t internal_count;
+};
+
+enum ImageReference {
+  ReferenceNil, ReferenceTrue, ReferenceFalse, ReferenceSymbol, ReferenceKeyword
+};
+
+/** A pointer to a value outside of the image, which is filled in on every load. */
+struct ImageExternal {
+  /** Offset of the pointer. */
+  uint64_t at;
+
+  /** An `ImageReference`. */
+  uint32_t kind;
+
+  /** The label of a symbol or keyword, which is stored with a terminator in the image. */
+  uint32_t length;
+  uint64_t label;
+};
+
+/** State of an image being saved. */
+struct ImageWriter {
+  /** Offset of every datum (or label, for symbols and keywords) laid out so far. Never 0, since the header comes first. */
+  struct PointerMap offsets;
+
+  /** Datums in the order they are laid out, and those whose contents haven't been looked at yet. */
+  struct WalkStack order;
+  struct WalkStack pending;
+  size_t size;
+  int has_closure;
+
+  char* data;
+  struct WalkStack externals;
+  struct WalkStack internals;
+};
+
+static size_t align(size_t size) {
+  return (size + IMAGE_ALIGNMENT - 1) & ~((size_t) IMAGE_ALIGNMENT - 1);
+}
+
+static int is_external(const struct LispDatum* x) {
+  return x->type == Nil || x->type == Bool;
+}
+
+static int is_interned(const struct LispDatum* x) {
+  return x->type == Symbol || x->type == Keyword;
+}
+
+static size_t table_bytes(const struct LispHashTable* table) {
+  return (size_t) ((const char*) (table->entries + table->capacity) - (const char*) table);
+}
+
+/** Bytes taken up by a datum and its payload. Symbols and keywords only store their labels. */
+static size_t footprint(const struct LispDatum* x) {
+  size_t size = sizeof(struct LispDatum);
+
+  switch (x->type) {
+    case Symbol:
+    case Keyword:
+      return strlen(x->label) + 1;
+    case BigInt:
+      return size + sizeof(struct LispBigInt) + x->big->length * sizeof(uint32_t);
+    case String:
+      return string_is_short(x) ? size : size + sizeof(struct LispStringBuffer) + string_length(x) + 1;
+    case Vector:
+      return size + x->length * sizeof(struct LispDatum*);
+    case HashMap:
+      return x->table == NULL ? size : size + table_bytes(x->table);
+    case I32Array:
+    case F64Array:
+    case C128Array:
+      return size + x->count * numeric_array_element_size(x->type);
+    default:
+      return size;
+  }
+}
+
+/** Lay out a datum, unless it already has been or it lives outside of the image. */
+static void discover(struct ImageWriter* w, const struct LispDatum* x) {
+  if (x == NULL || is_external(x)) {
+    return;
+  }
+
+  struct PointerMapEntry* entry = pointer_map_find(&w->offsets, x);
+
+  if (entry->value != 0) {
+    return;
+  }
+
+  entry->value = w->size;
+  w->size += align(footprint(x));
+  w->has_closure |= x->type == Closure;
+  walk_push(&w->order, &x, sizeof(x));
+  walk_push(&w->pending, &x, sizeof(x));
+}
+
+static void discover_contents(struct ImageWriter* w, const struct LispDatum* x) {
+  switch (x->type) {
+    case Cons:
+      discover(w, x->car);
+      discover(w, x->cdr);
+      break;
+    case Vector:
+      for (uint32_t i = 0; i < x->length; ++i) {
+        discover(w, x->items[i]);
+      }
+      break;
+    case HashMap:
+      for (uint32_t i = 0; x->table != NULL && i < x->table->capacity; ++i) {
+        if (x->table->ctrl[i] >= 0) {
+          discover(w, x->table->entries[i].key);
+          discover(w, x->table->entries[i].value);
+        }
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+static void store_pointer(struct ImageWriter* w, size_t at, uintptr_t value) {
+  memcpy(w->data + at, &value, sizeof(value));
+}
+
+/** Point the pointer at `at` to `offset` within the image. */
+static void internal(struct ImageWriter* w, size_t at, size_t offset) {
+  uint64_t location = at;
+  store_pointer(w, at, IMAGE_BASE + offset);
+  walk_push(&w->internals, &location, sizeof(location));
+}
+
+/** Point the pointer at `at` to `x`, wherever it lives. */
+static void reference(struct ImageWriter* w, size_t at, const struct LispDatum* x) {
+  if (x == NULL) {
+    store_pointer(w, at, 0);
+  } else if (is_external(x) || is_interned(x)) {
+    struct ImageExternal external = {.at = at};
+
+    if (x->type == Nil) {
+      external.kind = ReferenceNil;
+    } else if (x->type == Bool) {
+      external.kind = x->boolean ? ReferenceTrue : ReferenceFalse;
+    } else {
+      external.kind = x->type == Symbol ? ReferenceSymbol : ReferenceKeyword;
+      external.length = (uint32_t) strlen(x->label);
+      external.label = pointer_map_get(&w->offsets, x);
+    }
+
+    store_pointer(w, at, 0);
+    walk_push(&w->externals, &external, sizeof(external));
+  } else {
+    internal(w, at, pointer_map_get(&w->offsets, x));
+  }
+}
+
+#define FIELD(offset, field) ((offset) + offsetof(struct LispDatum, field))
+
+/** Copy a datum and its payload to `offset`. */
+static void write_datum(struct ImageWriter* w, const struct LispDatum* x, size_t offset) {
+  if (is_interned(x)) {
+    strcpy(w->data + offset, x->label);
+    return;
+  }
+
+  struct LispDatum* copy = (struct LispDatum*) (w->data + offset);
+  size_t payload = offset + sizeof(struct LispDatum);
+  *copy = *x;
+  copy->refs = LISP_REFS_IMMORTAL;
+
+  switch (x->type) {
+    case Cons:
+      reference(w, FIELD(offset, car), x->car);
+      reference(w, FIELD(offset, cdr), x->cdr);
+      break;
+    case BigInt: {
+      struct LispBigInt* big = (struct LispBigInt*) (w->data + payload);
+      memcpy(big, x->big, sizeof(struct LispBigInt) + x->big->length * sizeof(uint32_t));
+      big->capacity = big->length;
+      internal(w, FIELD(offset, big), payload);
+      break;
+    }
+    case String:
+      if (!string_is_short(x)) {
+        struct LispStringBuffer* buffer = (struct LispStringBuffer*) (w->data + payload);
+        size_t chars = payload + sizeof(struct LispStringBuffer);
+        *buffer = *x->string.large.buffer;
+        buffer->capacity = buffer->length;
+        memcpy(w->data + chars, string_content(x), buffer->length);
+        internal(w, FIELD(offset, string.large.buffer), payload);
+        internal(w, payload + offsetof(struct LispStringBuffer, chars), chars);
+      }
+      break;
+    case Vector:
+      copy->capacity = x->length;
+
+      if (x->length == 0) {
+        copy->items = NULL;
+        break;
+      }
+
+      for (uint32_t i = 0; i < x->length; ++i) {
+        reference(w, payload + i * sizeof(struct LispDatum*), x->items[i]);
+      }
+
+      internal(w, FIELD(offset, items), payload);
+      break;
+    case HashMap: {
+      if (x->table == NULL) {
+        break;
+      }
+
+      // Hashes only depend on the values of keys, so the table is still valid as it is. Entries in empty and deleted
+      // slots are left zeroed.
+      const struct LispHashTable* table = x->table;
+      size_t entries = payload + (size_t) ((const char*) table->entries - (const char*) table);
+      memcpy(w->data + payload, table, sizeof(struct LispHashTable) + table->capacity);
+
+      for (uint32_t i = 0; i < table->capacity; ++i) {
+        if (table->ctrl[i] >= 0) {
+          size_t entry = entries + i * sizeof(struct LispMapEntry);
+          reference(w, entry + offsetof(struct LispMapEntry, key), table->entries[i].key);
+          reference(w, entry + offsetof(struct LispMapEntry, value), table->entries[i].value);
+        }
+      }
+
+      internal(w, FIELD(offset, table), payload);
+      internal(w, payload + offsetof(struct LispHashTable, entries), entries);
+      break;
+    }
+    case I32Array:
+    case F64Array:
+    case C128Array:
+      if (x->count > 0) {
+        memcpy(w->data + payload, x->values, x->count * numeric_array_element_size(x->type));
+        internal(w, FIELD(offset, values), payload);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+static void free_writer(struct ImageWriter* w) {
+  pointer_map_free(&w->offsets);
+  walk_stack_free(&w->order);
+  walk_stack_free(&w->pending);
+  walk_stack_free(&w->externals);
+  walk_stack_free(&w->internals);
+  free(w->data);
+}
+
+static int write_all(FILE* file, const void* data, size_t size) {
+  return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+int image_save(const char* path, struct LispDatum* root) {
+  struct ImageWriter w = {.size = sizeof(struct ImageHeader)};
+  discover(&w, root);
+
+  while (w.pending.count > 0) {
+    const struct LispDatum* x = *(const struct LispDatum**) walk_top(&w.pending, sizeof(x));
+    walk_pop(&w.pending);
+    discover_contents(&w, x);
+  }
+
+  if (w.has_closure) {
+    free_writer(&w);
+    raise(Type, "`save-image` can't save closures, since their code isn't part of the image.");
+    return -1;
+  }
+
+  w.data = calloc(1, w.size);
+
+  if (w.data == NULL) {
+    lisp_out_of_memory();
+  }
+
+  for (size_t i = 0; i < w.order.count; ++i) {
+    const struct LispDatum* x = ((const struct LispDatum**) w.order.items)[i];
+    write_datum(&w, x, pointer_map_get(&w.offsets, x));
+  }
+
+  struct ImageHeader* header = (struct ImageHeader*) w.data;
+  memcpy(header->magic, IMAGE_MAGIC, sizeof(header->magic));
+  header->version = IMAGE_VERSION;
+  header->datum_size = sizeof(struct LispDatum);
+  reference(&w, offsetof(struct ImageHeader, root), root);
+  header->externals = w.size;
+  header->external_count = w.externals.count;
+  header->internals = header->externals + w.externals.count * sizeof(struct ImageExternal);
+  header->internal_count = w.internals.count;
+  header->size = header->internals + w.internals.count * sizeof(uint64_t);
+
+  FILE* file = fopen(path, "wb");
+  int written = file != NULL && write_all(file, w.data, w.size)
+      && write_all(file, w.externals.items, w.externals.count * sizeof(struct ImageExternal))
+      && write_all(file, w.internals.items, w.internals.count * sizeof(uint64_t));
+
+  if (file != NULL && fclose(file) != 0) {
+    written = 0;
+  }
+
+  free_writer(&w);
+
+  if (!written) {
+    raise(Generic, "`save-image` was unable to write the image.");
+    return -1;
+  }
+
+  return 0;
+}
+
+static struct LispDatum* resolve(const char* image, const struct ImageExternal* external) {
+  switch (external->kind) {
+    case ReferenceNil:
+      return get_nil();
+    case ReferenceTrue:
+      return get_true();
+    case ReferenceFalse:
+      return get_false();
+    case ReferenceSymbol:
+      return new_symbol_from_copy(image + external->label, external->length);
+    default:
+      return new_keyword(image + external->label, external->length);
+  }
+}
+
+static int is_pointer_within(uint64_t at, size_t size) {
+  return at <= size - sizeof(uintptr_t) && at % IMAGE_ALIGNMENT == 0;
+}
+
+static int is_label_within(const char* image, const struct ImageExternal* external, size_t size) {
+  return external->label < size && external->length < size - external->label
+      && image[external->label + external->length] == '\0';
+}
+
+/** Whether an image was written by this runtime, and its tables lie within it. */
+static int is_valid(const struct ImageHeader* header, size_t size) {
+  if (memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0 || header->version != IMAGE_VERSION
+      || header->datum_size != sizeof(struct LispDatum) || header->size != size) {
+    return 0;
+  }
+
+  return header->externals <= size && header->external_count <= (size - header->externals) / sizeof(struct ImageExternal)
+      && header->internals <= size && header->internal_count <= (size - header->internals) / sizeof(uint64_t);
+}
+
+struct LispDatum* image_load(const char* path) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  struct stat info;
+
+  if (fd < 0 || fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(struct ImageHeader)) {
+    if (fd >= 0) {
+      close(fd);
+    }
+
+    return raise(Generic, "`load-image` was unable to read the image.");
+  }
+
+  // Private, so that pointers can be filled in without touching the file. Only the pages they are on get copied.
+  size_t size = (size_t) info.st_size;
+  char* image = mmap((void*) IMAGE_BASE, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (image == MAP_FAILED) {
+    return raise(Generic, "`load-image` was unable to map the image.");
+  }
+
+  const struct ImageHeader* header = (const struct ImageHeader*) image;
+
+  if (!is_valid(header, size)) {
+    munmap(image, size);
+    return raise(Generic, "`load-image` was given a file that isn't an image, or was written by another runtime.");
+  }
+
+  uintptr_t delta = (uintptr_t) image - IMAGE_BASE;
+  const uint64_t* internals = (const uint64_t*) (image + header->internals);
+  const struct ImageExternal* externals = (const struct ImageExternal*) (image + header->externals);
+
+  for (uint64_t i = 0; delta != 0 && i < header->internal_count; ++i) {
+    if (!is_pointer_within(internals[i], size)) {
+      munmap(image, size);
+      return raise(Generic, "`load-image` was given a corrupted image.");
+    }
+
+    uintptr_t pointer;
+    memcpy(&pointer, image + internals[i], sizeof(pointer));
+    pointer += delta;
+    memcpy(image + internals[i], &pointer, sizeof(pointer));
+  }
+
+  for (uint64_t i = 0; i < header->external_count; ++i) {
+    const struct ImageExternal* external = &externals[i];
+
+    if (!is_pointer_within(external->at, size) || external->kind > ReferenceKeyword
+        || (external->kind >= ReferenceSymbol && !is_label_within(image, external, size))) {
+      munmap(image, size);
+      return raise(Generic, "`load-image` was given a corrupted image.");
+    }
+
+    struct LispDatum* x = resolve(image, external);
+    memcpy(image + external->at, &x, sizeof(x));
+  }
+
+  struct LispDatum* root;
+  memcpy(&root, &header->root, sizeof(root));
+  return root;
+}
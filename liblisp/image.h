@@ -0,0 +1,30 @@
+#ifndef LISP_IMAGE_H
+#define LISP_IMAGE_H
+
+#include "data.h"
+
+/*
+ * Images let a program build its constant data once and map it back in on later runs, instead of rebuilding it with
+ * `list`, `cons`, and friends every time it starts.
+ *
+ * An image holds everything reachable from a single value. Datums are written out exactly as they are laid out in
+ * memory, with their payloads (vector items, string characters, hash tables, limbs, array elements) right after them. The
+ * file records the address it expects to be mapped at. When that address is free at load time, which it nearly always
+ * is, the pointers within the image are already correct. Otherwise they are relocated using a table of where each one is
+ * stored. The only pointers that are always filled in on load are those to values the image can't contain: nil, the
+ * booleans, and symbols and keywords, which are interned by label so that they are still identical to the program's own.
+ * Loading therefore costs time proportional to those references rather than to the size of the data.
+ *
+ * Loaded values are immortal, like the other shared values, and stay mapped for the rest of the program. The natives that
+ * modify values in place refuse them: their payloads belong to the mapping rather than the allocator, and in the tracing
+ * build the collector never looks inside them, so neither could cope with them changing. Images are only meant to be read
+ * by the same build of the runtime that wrote them, and closures can't be saved, since their code isn't part of the image.
+ */
+
+/** Save everything reachable from `root` to the file at `path`. Returns 0 on success, or raises and returns -1. */
+int image_save(const char* path, struct LispDatum* root);
+
+/** Map an image into memory, and return the value it was saved from. Raises and returns NULL on failure. */
+struct LispDatum* image_load(const char* path);
+
+#endif //LISP_IMAGE_H
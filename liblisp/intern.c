@@ -0,0 +1,139 @@
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "data.h"
+#include "err.h"
+#include "lstring.h"
+#include "stats.h"
+
+/*
+ * The intern table is split into shards by hash, each guarded by its own lock, so threads interning unrelated labels
+ * rarely contend with one another. Each shard is an open addressed table using linear probing. Interned datums are
+ * allocated outside of any `LispState` and are never freed, so they remain valid without holding onto any lock.
+ */
+
+#define SHARD_COUNT 16
+#define SHARD_INITIAL_CAPACITY 64
+
+struct Shard {
+  pthread_mutex_t lock;
+  struct LispDatum** slots;
+  uint32_t count;
+  uint32_t capacity;
+};
+
+#define SHARD {.lock = PTHREAD_MUTEX_INITIALIZER}
+#define SHARD_4 SHARD, SHARD, SHARD, SHARD
+
+static struct Shard Shards[SHARD_COUNT] = {SHARD_4, SHARD_4, SHARD_4, SHARD_4};
+
+/** Mixes in the type so that a symbol and a keyword with the same label hash differently. */
+static uint64_t hash_label(const char* label, uint32_t length, enum LispDataType type) {
+  return hash_bytes(label, length) ^ ((uint64_t) type << 32);
+}
+
+static int grow_shard(struct Shard* shard) {
+  uint32_t capacity = shard->capacity == 0 ? SHARD_INITIAL_CAPACITY : shard->capacity * 2;
+  struct LispDatum** slots = calloc(capacity, sizeof(struct LispDatum*));
+
+  if (slots == NULL) {
+    return 0;
+  }
+
+  for (uint32_t i = 0; i < shard->capacity; ++i) {
+    struct LispDatum* x = shard->slots[i];
+
+    if (x != NULL) {
+      uint32_t j = (uint32_t) (x->hash / SHARD_COUNT) & (capacity - 1);
+
+      while (slots[j] != NULL) {
+        j = (j + 1) & (capacity - 1);
+      }
+
+      slots[j] = x;
+    }
+  }
+
+  free(shard->slots);
+  shard->slots = slots;
+  shard->capacity = capacity;
+  return 1;
+}
+
+/** Find or create the datum for a label. Must be called with the shard's lock held. Returns NULL if out of memory. */
+static struct LispDatum*
+intern_locked(struct Shard* shard, const char* label, uint32_t length, enum LispDataType type, uint64_t hash) {
+  // Keep the load factor under 3/4.
+  if ((shard->count + 1) * 4 > shard->capacity * 3 && !grow_shard(shard)) {
+    return NULL;
+  }
+
+  uint32_t i = (uint32_t) (hash / SHARD_COUNT) & (shard->capacity - 1);
+
+  for (; shard->slots[i] != NULL; i = (i + 1) & (shard->capacity - 1)) {
+    struct LispDatum* x = shard->slots[i];
+
+    if (x->hash == hash && x->type == type && strncmp(x->label, label, length) == 0 && x->label[length] == 0) {
+      return x;
+    }
+  }
+
+  struct LispDatum* x = malloc(sizeof(struct LispDatum));
+  char* copy = malloc(length + 1);
+
+  if (x == NULL || copy == NULL) {
+    free(x);
+    free(copy);
+    return NULL;
+  }
+
+  memcpy(copy, label, length);
+  copy[length] = 0;
+
+  x->type = type;
+  x->refs = LISP_REFS_IMMORTAL;
+  x->label = copy;
+  x->hash = hash;
+  LISP_STATS_ALLOC(type, sizeof(struct LispDatum) + length + 1);
+
+  shard->slots[i] = x;
+  ++shard->count;
+  return x;
+}
+
+static struct LispDatum* intern(const char* label, uint32_t length, enum LispDataType type) {
+  uint64_t hash = hash_label(label, length, type);
+  struct Shard* shard = &Shards[hash % SHARD_COUNT];
+
+  pthread_mutex_lock(&shard->lock);
+  struct LispDatum* x = intern_locked(shard, label, length, type, hash);
+  pthread_mutex_unlock(&shard->lock);
+
+  if (x == NULL) {
+    lisp_out_of_memory();
+  }
+
+  return x;
+}
+
+struct LispDatum* new_symbol(const char* content) {
+  return intern(content, strlen(content), Symbol);
+}
+
+struct LispDatum* new_symbol_from_copy(const char* content, uint32_t length) {
+  return intern(content, length, Symbol);
+}
+
+struct LispDatum* new_keyword(const char* content, uint32_t length) {
+  return intern(content, length, Keyword);
+}
+
+void intern_all(struct LispDatum** out, const char* const* labels, uint32_t count) {
+  for (uint32_t i = 0; i < count; ++i) {
+    if (labels[i][0] == ':') {
+      out[i] = new_keyword(labels[i] + 1, strlen(labels[i] + 1));
+    } else {
+      out[i] = new_symbol(labels[i]);
+    }
+  }
+}
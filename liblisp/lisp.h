@@ -5,8 +5,18 @@
 #ifndef LISPC_LISP_H
 #define LISPC_LISP_H
 
+#include "bigint.h"
+#include "closure.h"
 #include "data.h"
+#include "hashmap.h"
+#include "lists.h"
+#include "lstring.h"
+#include "numarray.h"
+#include "numeric.h"
+#include "port.h"
+#include "rational.h"
 #include "stdlisp.h"
+#include "vector.h"
 
 void _rust_demo(float value);
 
@@ -0,0 +1,230 @@
+#include <stdatomic.h>
+#include <stddef.h>
+#include "alloc.h"
+#include "lists.h"
+
+#define UNKNOWN_LENGTH (-1)
+
+#ifndef LISP_TRACING_GC
+/**
+ * Bumped whenever a cdr is replaced. Lists can be shared between states, so the count is kept for the whole process
+ * rather than per state.
+ */
+static _Atomic uint64_t list_epoch = 0;
+#endif
+
+/**
+ * A run of cons cells allocated together. Cell `i` links to cell `i + 1` when the chunk is built, and the last cell links
+ * to whatever follows the chunk.
+ */
+struct ListChunk {
+  uint32_t count;
+
+  /** Cells in the chunk which have not been freed yet. */
+  uint32_t live;
+
+  /**
+   * Number of cells at the front of the chunk that are still linked in order. Replacing the cdr of a cell shortens this
+   * to end at that cell, and the cached length can only be used from these cells.
+   */
+  uint32_t linked;
+
+  /** The `list_epoch` when the length was cached. The cached length is only valid while they match. */
+  uint64_t epoch;
+
+  /** Length of the list starting at the first cell, or UNKNOWN_LENGTH if it is improper. */
+  int32_t length;
+
+  struct LispDatum cells[];
+};
+
+static int is_empty_list(const struct LispDatum* x) {
+  return x == NULL || x->type == Nil || (x->type == Cons && x->car == NULL && x->cdr == NULL);
+}
+
+#ifndef LISP_TRACING_GC
+
+static size_t chunk_size(uint32_t count) {
+  return sizeof(struct ListChunk) + count * sizeof(struct LispDatum);
+}
+
+static uint32_t chunk_index(const struct LispDatum* x) {
+  return (x->refs & LISP_REFS_INDEX_MASK) >> LISP_REFS_INDEX_SHIFT;
+}
+
+static struct ListChunk* chunk_of(struct LispDatum* x) {
+  return (struct ListChunk*) ((char*) (x - chunk_index(x)) - offsetof(struct ListChunk, cells));
+}
+
+struct LispDatum* new_list(struct LispDatum** items, uint32_t count, struct LispDatum* tail) {
+  if (is_empty_list(tail)) {
+    tail = NULL;
+  }
+
+  if (count == 0) {
+    return tail == NULL ? new_cons(NULL, NULL) : retain(tail);
+  }
+
+  // Chunks are built back to front, so that each one can link to the next and know the length that follows it.
+  struct LispDatum* rest = retain(tail);
+  int32_t rest_length = list_length(tail);
+  uint64_t epoch = atomic_load_explicit(&list_epoch, memory_order_relaxed);
+  uint32_t end = count;
+
+  while (end > 0) {
+    uint32_t n = end < LISP_LIST_CHUNK_MAX ? end : LISP_LIST_CHUNK_MAX;
+    uint32_t start = end - n;
+
+    struct ListChunk* chunk = lisp_alloc(chunk_size(n));
+    chunk->count = n;
+    chunk->live = n;
+    chunk->linked = n;
+    chunk->epoch = epoch;
+    chunk->length = rest_length == UNKNOWN_LENGTH ? UNKNOWN_LENGTH : rest_length + (int32_t) n;
+
+    for (uint32_t i = 0; i < n; ++i) {
+      struct LispDatum* cell = &chunk->cells[i];
+      cell->type = Cons;
+      cell->refs = LISP_REFS_CHUNKED | i << LISP_REFS_INDEX_SHIFT | 1;
+      cell->car = retain(items[start + i]);
+      cell->cdr = i + 1 < n ? &chunk->cells[i + 1] : rest;
+    }
+
+    rest = &chunk->cells[0];
+    rest_length = chunk->length;
+    end = start;
+  }
+
+  return rest;
+}
+
+void free_chunked_cell(struct LispDatum* x) {
+  struct ListChunk* chunk = chunk_of(x);
+
+  if (--chunk->live == 0) {
+    lisp_free(chunk, chunk_size(chunk->count));
+  }
+}
+
+#else
+
+// The collector moves cells one at a time, so they cannot be kept together in chunks.
+struct LispDatum* new_list(struct LispDatum** items, uint32_t count, struct LispDatum* tail) {
+  struct LispDatum* rest = is_empty_list(tail) ? NULL : tail;
+
+  if (count == 0) {
+    return rest == NULL ? new_cons(NULL, NULL) : rest;
+  }
+
+  for (uint32_t i = count; i > 0; --i) {
+    rest = new_cons(items[i - 1], rest);
+  }
+
+  return rest;
+}
+
+void free_chunked_cell(struct LispDatum* x) {
+  (void) x;
+}
+
+#endif
+
+#ifndef LISP_TRACING_GC
+
+/** The chunk holding `x`, if its cached length can be used from `x`, or NULL otherwise. */
+static struct ListChunk* linked_chunk(const struct LispDatum* x) {
+  if (!(x->refs & LISP_REFS_CHUNKED)) {
+    return NULL;
+  }
+
+  struct ListChunk* chunk = chunk_of((struct LispDatum*) x);
+  return chunk_index(x) < chunk->linked ? chunk : NULL;
+}
+
+int32_t list_length(const struct LispDatum* x) {
+  if (is_empty_list(x)) {
+    return 0;
+  }
+
+  uint64_t epoch = atomic_load_explicit(&list_epoch, memory_order_relaxed);
+  const struct LispDatum* start = x;
+  int32_t length = 0;
+  int cached = 0;
+  int stale = 0;
+
+  while (x != NULL && x->type == Cons && x->car != NULL) {
+    struct ListChunk* chunk = linked_chunk(x);
+
+    if (chunk != NULL) {
+      if (chunk->epoch == epoch) {
+        length = chunk->length == UNKNOWN_LENGTH ? UNKNOWN_LENGTH : length + chunk->length - (int32_t) chunk_index(x);
+        cached = 1;
+        break;
+      }
+      stale = 1;
+    }
+
+    ++length;
+    x = x->cdr;
+  }
+
+  if (!cached && x != NULL) {
+    length = UNKNOWN_LENGTH;
+  }
+
+  // Cache the length again in the chunks that were walked, so that only the first count after a change has to walk.
+  const struct LispDatum* stop = x;
+  int32_t remaining = length;
+
+  for (x = start; stale && x != stop; x = x->cdr) {
+    struct ListChunk* chunk = linked_chunk(x);
+
+    if (chunk != NULL && chunk->epoch != epoch) {
+      chunk->epoch = epoch;
+      chunk->length = remaining == UNKNOWN_LENGTH ? UNKNOWN_LENGTH : remaining + (int32_t) chunk_index(x);
+    }
+
+    if (remaining != UNKNOWN_LENGTH) {
+      --remaining;
+    }
+  }
+
+  return length;
+}
+
+void invalidate_list_lengths(struct LispDatum* x) {
+  if (x->refs & LISP_REFS_CHUNKED) {
+    struct ListChunk* chunk = chunk_of(x);
+    uint32_t index = chunk_index(x);
+
+    if (index < chunk->linked) {
+      chunk->linked = index + 1;
+    }
+  }
+
+  atomic_fetch_add_explicit(&list_epoch, 1, memory_order_relaxed);
+}
+
+#else
+
+// Without chunks there are no cached lengths, so lists are always measured by walking them.
+int32_t list_length(const struct LispDatum* x) {
+  if (is_empty_list(x)) {
+    return 0;
+  }
+
+  int32_t length = 0;
+
+  while (x != NULL && x->type == Cons && x->car != NULL) {
+    ++length;
+    x = x->cdr;
+  }
+
+  return x == NULL ? length : UNKNOWN_LENGTH;
+}
+
+void invalidate_list_lengths(struct LispDatum* x) {
+  (void) x;
+}
+
+#endif
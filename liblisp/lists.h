@@ -0,0 +1,39 @@
+#ifndef LISP_LISTS_H
+#define LISP_LISTS_H
+
+#include <stdint.h>
+#include "data.h"
+
+/*
+ * With reference counting, lists built by natives are unrolled: their cells are allocated together in chunks of up to
+ * LISP_LIST_CHUNK_MAX, laid out contiguously so that traversal stays in cache. Every cell is still an ordinary cons cell
+ * with its own car, cdr, and reference count, so nothing else needs to know about chunks. Chunked cells are marked in
+ * their reference count word, alongside their position within the chunk.
+ *
+ * Each chunk caches the length of the list starting at its first cell, which makes `length` constant time. Replacing a
+ * cdr invalidates every cached length in the process, since lists can be shared between states. The next count walks the
+ * list and caches its length again. The chunk holding the changed cell only keeps a cached length for the cells up to
+ * that one, since the cells after it no longer follow on from them.
+ *
+ * The tracing collector moves cells individually, so in that build lists are built from plain cells instead.
+ */
+
+#define LISP_LIST_CHUNK_MAX 64
+
+
+/**
+ * Build a list of `count` items followed by `tail`, which is NULL for a proper list. The list holds its own references to
+ * the items and the tail. With no items, this is an empty list if there is no tail, or the tail itself otherwise.
+ */
+struct LispDatum* new_list(struct LispDatum** items, uint32_t count, struct LispDatum* tail);
+
+/** Number of elements in a list, nil, or empty list, or -1 if the list is improper (or not a list at all). */
+int32_t list_length(const struct LispDatum* x);
+
+/** Must be called whenever the cdr of an existing cell `x` is replaced. */
+void invalidate_list_lengths(struct LispDatum* x);
+
+/** Return the memory of a chunked cell, freeing its chunk once every cell in it is gone. Used by `free_datum`. */
+void free_chunked_cell(struct LispDatum* x);
+
+#endif //LISP_LISTS_H
@@ -0,0 +1,205 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "alloc.h"
+#include "err.h"
+#include "lstring.h"
+#include "stats.h"
+
+#define BUILDER_INITIAL_CAPACITY 32
+
+static char* buffer_chars(struct LispStringBuffer* buffer) {
+  return (char*) (buffer + 1);
+}
+
+/** Size of the allocation backing a buffer, which `lisp_free` needs to be given back. */
+static size_t buffer_size(const struct LispStringBuffer* buffer) {
+  return sizeof(struct LispStringBuffer) + (buffer->capacity == 0 ? 0 : buffer->capacity + 1);
+}
+
+/** Allocate an empty buffer with room for `capacity` characters plus a terminator. */
+static struct LispStringBuffer* new_buffer(uint32_t capacity) {
+  struct LispStringBuffer* buffer = lisp_alloc(sizeof(struct LispStringBuffer) + capacity + 1);
+  buffer->length = 0;
+  buffer->capacity = capacity;
+  buffer->hash = 0;
+  buffer->chars = buffer_chars(buffer);
+  buffer_chars(buffer)[0] = 0;
+  return buffer;
+}
+
+static struct LispDatum* new_string_datum() {
+  struct LispDatum* x = alloc_datum();
+  x->type = String;
+  x->refs = 1;
+  return x;
+}
+
+static struct LispDatum* new_short_string(const char* s, uint32_t length) {
+  struct LispDatum* x = new_string_datum();
+  memcpy(x->string.small.chars, s, length);
+  x->string.small.chars[length] = 0;
+  x->string.small.length = (uint8_t) length;
+  LISP_STATS_ALLOC(String, sizeof(struct LispDatum));
+  return x;
+}
+
+static struct LispDatum* new_long_string(struct LispStringBuffer* buffer) {
+  struct LispDatum* x = new_string_datum();
+  x->string.large.buffer = buffer;
+  x->string.large.tag = LISP_LONG_STRING_TAG;
+  LISP_STATS_ALLOC(String, sizeof(struct LispDatum) + buffer_size(buffer));
+  return x;
+}
+
+uint64_t hash_bytes(const char* bytes, size_t length) {
+  uint64_t hash = 14695981039346656037u;
+
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= (unsigned char) bytes[i];
+    hash *= 1099511628211u;
+  }
+
+  return hash == 0 ? 1 : hash;
+}
+
+uint64_t string_hash(const struct LispDatum* x) {
+  if (string_is_short(x)) {
+    return hash_bytes(x->string.small.chars, x->string.small.length);
+  }
+
+  struct LispStringBuffer* buffer = x->string.large.buffer;
+
+  if (buffer->hash == 0) {
+    buffer->hash = hash_bytes(buffer->chars, buffer->length);
+  }
+
+  return buffer->hash;
+}
+
+struct LispDatum* new_string(const char* s) {
+  return new_string_from_copy(s, (uint32_t) strlen(s));
+}
+
+struct LispDatum* new_string_from_copy(const char* s, uint32_t length) {
+  if (length <= LISP_SHORT_STRING_MAX) {
+    return new_short_string(s, length);
+  }
+
+  struct LispStringBuffer* buffer = new_buffer(length);
+  memcpy(buffer_chars(buffer), s, length);
+  buffer_chars(buffer)[length] = 0;
+  buffer->length = length;
+
+  return new_long_string(buffer);
+}
+
+struct LispDatum* new_string_literal(const char* s, uint32_t length) {
+  if (length <= LISP_SHORT_STRING_MAX) {
+    return new_short_string(s, length);
+  }
+
+  struct LispStringBuffer* buffer = lisp_alloc(sizeof(struct LispStringBuffer));
+  buffer->length = length;
+  buffer->capacity = 0;
+  buffer->hash = 0;
+  buffer->chars = s;
+
+  return new_long_string(buffer);
+}
+
+void destroy_string(struct LispDatum* x) {
+  if (!string_is_short(x)) {
+    lisp_free(x->string.large.buffer, buffer_size(x->string.large.buffer));
+  }
+}
+
+void string_builder_init(struct LispStringBuilder* builder) {
+  builder->buffer = NULL;
+}
+
+/** Make room for `extra` more characters. */
+static void reserve(struct LispStringBuilder* builder, uint32_t extra) {
+  struct LispStringBuffer* old = builder->buffer;
+  uint32_t needed = string_builder_length(builder) + extra;
+
+  if (old != NULL && needed <= old->capacity) {
+    return;
+  }
+
+  uint32_t capacity = old == NULL ? BUILDER_INITIAL_CAPACITY : old->capacity * 2;
+  if (capacity < needed) {
+    capacity = needed;
+  }
+
+  struct LispStringBuffer* buffer = new_buffer(capacity);
+
+  if (old != NULL) {
+    memcpy(buffer_chars(buffer), old->chars, old->length + 1);
+    buffer->length = old->length;
+    lisp_free(old, buffer_size(old));
+  }
+
+  builder->buffer = buffer;
+}
+
+void string_builder_append(struct LispStringBuilder* builder, const char* s, uint32_t length) {
+  reserve(builder, length);
+
+  struct LispStringBuffer* buffer = builder->buffer;
+  memcpy(buffer_chars(buffer) + buffer->length, s, length);
+  buffer->length += length;
+  buffer_chars(buffer)[buffer->length] = 0;
+}
+
+void string_builder_append_char(struct LispStringBuilder* builder, char c) {
+  string_builder_append(builder, &c, 1);
+}
+
+void string_builder_append_string(struct LispStringBuilder* builder, const struct LispDatum* s) {
+  string_builder_append(builder, string_content(s), string_length(s));
+}
+
+void string_builder_format(struct LispStringBuilder* builder, const char* format, ...) {
+  va_list args;
+  va_list measure;
+  va_start(args, format);
+  va_copy(measure, args);
+
+  int length = vsnprintf(NULL, 0, format, measure);
+  va_end(measure);
+
+  if (length > 0) {
+    reserve(builder, (uint32_t) length);
+
+    struct LispStringBuffer* buffer = builder->buffer;
+    vsnprintf(buffer_chars(buffer) + buffer->length, (size_t) length + 1, format, args);
+    buffer->length += (uint32_t) length;
+  }
+
+  va_end(args);
+}
+
+const char* string_builder_content(const struct LispStringBuilder* builder) {
+  return builder->buffer == NULL ? "" : builder->buffer->chars;
+}
+
+struct LispDatum* string_builder_finish(struct LispStringBuilder* builder) {
+  struct LispStringBuffer* buffer = builder->buffer;
+
+  if (buffer == NULL || buffer->length <= LISP_SHORT_STRING_MAX) {
+    struct LispDatum* x = new_short_string(string_builder_content(builder), string_builder_length(builder));
+    string_builder_discard(builder);
+    return x;
+  }
+
+  builder->buffer = NULL;
+  return new_long_string(buffer);
+}
+
+void string_builder_discard(struct LispStringBuilder* builder) {
+  if (builder->buffer != NULL) {
+    lisp_free(builder->buffer, buffer_size(builder->buffer));
+    builder->buffer = NULL;
+  }
+}
@@ -0,0 +1,90 @@
+#ifndef LISP_LSTRING_H
+#define LISP_LSTRING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "data.h"
+
+/**
+ * Characters of a long string. Buffers are immutable once a string has been built around them, and are owned by that
+ * string. A buffer either owns its characters, which then directly follow it in memory, or refers to static storage
+ * (i.e. a string literal), in which case its capacity is 0.
+ */
+struct LispStringBuffer {
+  uint32_t length;
+  uint32_t capacity;
+
+  /** Computed on first use, since most strings are never hashed. 0 if not yet computed. */
+  uint64_t hash;
+
+  const char* chars;
+};
+
+static inline int string_is_short(const struct LispDatum* x) {
+  return x->string.small.length != LISP_LONG_STRING_TAG;
+}
+
+/** The characters of a string, which are always null terminated. */
+static inline const char* string_content(const struct LispDatum* x) {
+  return string_is_short(x) ? x->string.small.chars : x->string.large.buffer->chars;
+}
+
+static inline uint32_t string_length(const struct LispDatum* x) {
+  return string_is_short(x) ? x->string.small.length : x->string.large.buffer->length;
+}
+
+/** Hash of a string's characters. Cached for long strings, and cheap enough to recompute for short ones. */
+uint64_t string_hash(const struct LispDatum* x);
+
+/** FNV-1a. Never returns 0, so that 0 can be used to mark a missing hash. */
+uint64_t hash_bytes(const char* bytes, size_t length);
+
+/** Create a string from the first `length` characters of `s`, which need not be null terminated. */
+struct LispDatum* new_string_from_copy(const char* s, uint32_t length);
+
+/**
+ * Create a string from characters in static storage, which must be null terminated and must never change. Long strings
+ * refer to the characters directly instead of copying them.
+ */
+struct LispDatum* new_string_literal(const char* s, uint32_t length);
+
+/** Shorthand for `new_string_literal` that measures the literal at compile time. */
+#define LISP_STRING_LITERAL(s) new_string_literal((s), sizeof(s) - 1)
+
+/** Free whatever a string owns outside of its datum. Called when the string is destroyed or collected. */
+void destroy_string(struct LispDatum* x);
+
+/**
+ * Accumulates characters for a new string, growing geometrically so that appending is amortized constant time. Once
+ * finished, the accumulated buffer is handed over to the new string without being copied.
+ */
+struct LispStringBuilder {
+  struct LispStringBuffer* buffer;
+};
+
+void string_builder_init(struct LispStringBuilder* builder);
+
+void string_builder_append(struct LispStringBuilder* builder, const char* s, uint32_t length);
+
+void string_builder_append_char(struct LispStringBuilder* builder, char c);
+
+/** Append the characters of a string datum. */
+void string_builder_append_string(struct LispStringBuilder* builder, const struct LispDatum* s);
+
+/** Append text formatted according to printf rules. */
+void string_builder_format(struct LispStringBuilder* builder, const char* format, ...);
+
+static inline uint32_t string_builder_length(const struct LispStringBuilder* builder) {
+  return builder->buffer == NULL ? 0 : builder->buffer->length;
+}
+
+/** Characters appended so far, null terminated. Only valid until the next append. */
+const char* string_builder_content(const struct LispStringBuilder* builder);
+
+/** Produce a string from everything that has been appended, leaving the builder empty. */
+struct LispDatum* string_builder_finish(struct LispStringBuilder* builder);
+
+/** Throw away everything that has been appended. */
+void string_builder_discard(struct LispStringBuilder* builder);
+
+#endif //LISP_LSTRING_H
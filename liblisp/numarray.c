@@ -0,0 +1,832 @@
+#include <string.h>
+#include "alloc.h"
+#include "bigint.h"
+#include "numarray.h"
+#include "simd.h"
+#include "stats.h"
+
+#ifdef LISP_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * An exact sum of products of 32 bit integers, split as `high * 2^32 + low`. Each product is split the same way before
+ * being added, and whatever carries out of `low` is moved into `high`, so neither half can overflow for any array that
+ * fits in memory.
+ */
+struct WideSum {
+  int64_t high;
+  uint64_t low;
+};
+
+static inline void wide_add(struct WideSum* sum, int64_t product) {
+  // Relies on `>>` being an arithmetic shift, as it is with every compiler this builds with.
+  sum->low += (uint32_t) product;
+  sum->high += (product >> 32) + (int64_t) (sum->low >> 32);
+  sum->low &= 0xFFFFFFFF;
+}
+
+static inline int compare_doubles(double a, double b) {
+  return a == b ? 0 : a > b ? 1 : -1;
+}
+
+// Scalar implementations, which also finish off whatever is left over after the last full vector. Each elementwise
+//  kernel writes `n` results to `out`. Complex kernels take `n` complex numbers, which is to say 2n doubles.
+
+#define F64_ELEMENTWISE_SCALAR(name, operator) \
+static void name##_f64_scalar(const double* a, const double* b, double* out, uint32_t n) { \
+  for (uint32_t i = 0; i < n; ++i) { \
+    out[i] = a[i] operator b[i]; \
+  } \
+}
+
+F64_ELEMENTWISE_SCALAR(add, +)
+F64_ELEMENTWISE_SCALAR(subtract, -)
+F64_ELEMENTWISE_SCALAR(multiply, *)
+F64_ELEMENTWISE_SCALAR(divide, /)
+
+static double dot_f64_scalar(const double* a, const double* b, uint32_t n) {
+  double sum = 0;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    sum += a[i] * b[i];
+  }
+
+  return sum;
+}
+
+static double extremum_f64_scalar(const double* a, uint32_t n, double start, int greatest) {
+  double result = start;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    result = greatest ? (a[i] > result ? a[i] : result) : (a[i] < result ? a[i] : result);
+  }
+
+  return result;
+}
+
+/** Integer kernels return -1 if any result overflows, in which case the output is left partially written. */
+static int add_i32_scalar(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) {
+  for (uint32_t i = 0; i < n; ++i) {
+    if (__builtin_add_overflow(a[i], b[i], &out[i])) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int subtract_i32_scalar(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) {
+  for (uint32_t i = 0; i < n; ++i) {
+    if (__builtin_sub_overflow(a[i], b[i], &out[i])) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static int multiply_i32_scalar(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) {
+  for (uint32_t i = 0; i < n; ++i) {
+    if (__builtin_mul_overflow(a[i], b[i], &out[i])) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+static void divide_i32_scalar(const int32_t* a, const int32_t* b, double* out, uint32_t n) {
+  for (uint32_t i = 0; i < n; ++i) {
+    out[i] = (double) a[i] / (double) b[i];
+  }
+}
+
+static void dot_i32_scalar(const int32_t* a, const int32_t* b, uint32_t n, struct WideSum* sum) {
+  for (uint32_t i = 0; i < n; ++i) {
+    wide_add(sum, (int64_t) a[i] * b[i]);
+  }
+}
+
+static int32_t extremum_i32_scalar(const int32_t* a, uint32_t n, int32_t start, int greatest) {
+  int32_t result = start;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    result = greatest ? (a[i] > result ? a[i] : result) : (a[i] < result ? a[i] : result);
+  }
+
+  return result;
+}
+
+// These match the kernels in numeric.c operation for operation, so that arrays round exactly like boxed numbers.
+
+static void multiply_c128_scalar(const double* a, const double* b, double* out, uint32_t n) {
+  for (uint32_t i = 0; i < 2 * n; i += 2) {
+    double real = a[i] * b[i] - a[i + 1] * b[i + 1];
+    double im = a[i] * b[i + 1] + a[i + 1] * b[i];
+    out[i] = real;
+    out[i + 1] = im;
+  }
+}
+
+static void divide_c128_scalar(const double* a, const double* b, double* out, uint32_t n) {
+  for (uint32_t i = 0; i < 2 * n; i += 2) {
+    double d = b[i] * b[i] + b[i + 1] * b[i + 1];
+    double real = (a[i] * b[i] + a[i + 1] * b[i + 1]) / d;
+    double im = (a[i + 1] * b[i] - a[i] * b[i + 1]) / d;
+    out[i] = real;
+    out[i + 1] = im;
+  }
+}
+
+static void dot_c128_scalar(const double* a, const double* b, uint32_t n, double* sum) {
+  for (uint32_t i = 0; i < 2 * n; i += 2) {
+    sum[0] += a[i] * b[i] - a[i + 1] * b[i + 1];
+    sum[1] += a[i] * b[i + 1] + a[i + 1] * b[i];
+  }
+}
+
+#ifdef LISP_SIMD_X86
+
+#define F64_ELEMENTWISE_SIMD(name, sse2_op, avx2_op) \
+__attribute__((target("sse2"))) \
+static void name##_f64_sse2(const double* a, const double* b, double* out, uint32_t n) { \
+  uint32_t i = 0; \
+  for (; i + 2 <= n; i += 2) { \
+    _mm_storeu_pd(out + i, sse2_op(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i))); \
+  } \
+  name##_f64_scalar(a + i, b + i, out + i, n - i); \
+} \
+__attribute__((target("avx2"))) \
+static void name##_f64_avx2(const double* a, const double* b, double* out, uint32_t n) { \
+  uint32_t i = 0; \
+  for (; i + 4 <= n; i += 4) { \
+    _mm256_storeu_pd(out + i, avx2_op(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i))); \
+  } \
+  name##_f64_scalar(a + i, b + i, out + i, n - i); \
+}
+
+F64_ELEMENTWISE_SIMD(add, _mm_add_pd, _mm256_add_pd)
+F64_ELEMENTWISE_SIMD(subtract, _mm_sub_pd, _mm256_sub_pd)
+F64_ELEMENTWISE_SIMD(multiply, _mm_mul_pd, _mm256_mul_pd)
+F64_ELEMENTWISE_SIMD(divide, _mm_div_pd, _mm256_div_pd)
+
+__attribute__((target("sse2")))
+static double dot_f64_sse2(const double* a, const double* b, uint32_t n) {
+  __m128d x = _mm_setzero_pd();
+  __m128d y = _mm_setzero_pd();
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    x = _mm_add_pd(x, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+    y = _mm_add_pd(y, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+  }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(x, y));
+  return lanes[0] + lanes[1] + dot_f64_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static double dot_f64_avx2(const double* a, const double* b, uint32_t n) {
+  __m256d x = _mm256_setzero_pd();
+  __m256d y = _mm256_setzero_pd();
+  uint32_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    x = _mm256_add_pd(x, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    y = _mm256_add_pd(y, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4)));
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(x, y));
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + dot_f64_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static double extremum_f64_sse2(const double* a, uint32_t n, double start, int greatest) {
+  __m128d result = _mm_set1_pd(start);
+  uint32_t i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    __m128d x = _mm_loadu_pd(a + i);
+    result = greatest ? _mm_max_pd(result, x) : _mm_min_pd(result, x);
+  }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, result);
+  return extremum_f64_scalar(a + i, n - i, extremum_f64_scalar(lanes, 2, start, greatest), greatest);
+}
+
+__attribute__((target("avx2")))
+static double extremum_f64_avx2(const double* a, uint32_t n, double start, int greatest) {
+  __m256d result = _mm256_set1_pd(start);
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_loadu_pd(a + i);
+    result = greatest ? _mm256_max_pd(result, x) : _mm256_min_pd(result, x);
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, result);
+  return extremum_f64_scalar(a + i, n - i, extremum_f64_scalar(lanes, 4, start, greatest), greatest);
+}
+
+// A sum or difference overflows when its sign differs from that of both operands (or for differences, from that of the
+//  minuend but not the subtrahend). The sign bits of the lanes that overflowed are collected, and checked at the end.
+
+__attribute__((target("sse2")))
+static int add_i32_sse2(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) {
+  __m128i overflow = _mm_setzero_si128();
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*) (a + i));
+    __m128i y = _mm_loadu_si128((const __m128i*) (b + i));
+    __m128i sum = _mm_add_epi32(x, y);
+    overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_xor_si128(x, sum), _mm_xor_si128(y, sum)));
+    _mm_storeu_si128((__m128i*) (out + i), sum);
+  }
+
+  return _mm_movemask_ps(_mm_castsi128_ps(overflow)) ? -1 : add_i32_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static int add_i32_avx2(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) {
+  __m256i overflow = _mm256_setzero_si256();
+  uint32_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i*) (a + i));
+    __m256i y = _mm256_loadu_si256((const __m256i*) (b + i));
+    __m256i sum = _mm256_add_epi32(x, y);
+    overflow = _mm256_or_si256(overflow, _mm256_and_si256(_mm256_xor_si256(x, sum), _mm256_xor_si256(y, sum)));
+    _mm256_storeu_si256((__m256i*) (out + i), sum);
+  }
+
+  return _mm256_movemask_ps(_mm256_castsi256_ps(overflow)) ? -1 : add_i32_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static int subtract_i32_sse2(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) {
+  __m128i overflow = _mm_setzero_si128();
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*) (a + i));
+    __m128i y = _mm_loadu_si128((const __m128i*) (b + i));
+    __m128i difference = _mm_sub_epi32(x, y);
+    overflow = _mm_or_si128(overflow, _mm_and_si128(_mm_xor_si128(x, y), _mm_xor_si128(x, difference)));
+    _mm_storeu_si128((__m128i*) (out + i), difference);
+  }
+
+  return _mm_movemask_ps(_mm_castsi128_ps(overflow)) ? -1 : subtract_i32_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static int subtract_i32_avx2(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) {
+  __m256i overflow = _mm256_setzero_si256();
+  uint32_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i*) (a + i));
+    __m256i y = _mm256_loadu_si256((const __m256i*) (b + i));
+    __m256i difference = _mm256_sub_epi32(x, y);
+    overflow = _mm256_or_si256(overflow, _mm256_and_si256(_mm256_xor_si256(x, y), _mm256_xor_si256(x, difference)));
+    _mm256_storeu_si256((__m256i*) (out + i), difference);
+  }
+
+  return _mm256_movemask_ps(_mm256_castsi256_ps(overflow)) ? -1 : subtract_i32_scalar(a + i, b + i, out + i, n - i);
+}
+
+// Products are computed as doubles. Any product that fits in 32 bits is exact, and since rounding is monotonic, any that
+//  doesn't will still be out of range once rounded.
+
+__attribute__((target("sse2")))
+static int multiply_i32_sse2(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) {
+  const __m128d low = _mm_set1_pd(INT32_MIN);
+  const __m128d high = _mm_set1_pd(INT32_MAX);
+  __m128d overflow = _mm_setzero_pd();
+  uint32_t i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    __m128d x = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) (a + i)));
+    __m128d y = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) (b + i)));
+    __m128d product = _mm_mul_pd(x, y);
+    overflow = _mm_or_pd(overflow, _mm_or_pd(_mm_cmplt_pd(product, low), _mm_cmpgt_pd(product, high)));
+    _mm_storel_epi64((__m128i*) (out + i), _mm_cvttpd_epi32(product));
+  }
+
+  return _mm_movemask_pd(overflow) ? -1 : multiply_i32_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static int multiply_i32_avx2(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) {
+  const __m256d low = _mm256_set1_pd(INT32_MIN);
+  const __m256d high = _mm256_set1_pd(INT32_MAX);
+  __m256d overflow = _mm256_setzero_pd();
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) (a + i)));
+    __m256d y = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) (b + i)));
+    __m256d product = _mm256_mul_pd(x, y);
+    overflow = _mm256_or_pd(overflow, _mm256_or_pd(_mm256_cmp_pd(product, low, _CMP_LT_OQ),
+                                                   _mm256_cmp_pd(product, high, _CMP_GT_OQ)));
+    _mm_storeu_si128((__m128i*) (out + i), _mm256_cvttpd_epi32(product));
+  }
+
+  return _mm256_movemask_pd(overflow) ? -1 : multiply_i32_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void divide_i32_sse2(const int32_t* a, const int32_t* b, double* out, uint32_t n) {
+  uint32_t i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    __m128d x = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) (a + i)));
+    __m128d y = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*) (b + i)));
+    _mm_storeu_pd(out + i, _mm_div_pd(x, y));
+  }
+
+  divide_i32_scalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void divide_i32_avx2(const int32_t* a, const int32_t* b, double* out, uint32_t n) {
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m256d x = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) (a + i)));
+    __m256d y = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*) (b + i)));
+    _mm256_storeu_pd(out + i, _mm256_div_pd(x, y));
+  }
+
+  divide_i32_scalar(a + i, b + i, out + i, n - i);
+}
+
+// SSE2 has no signed multiplication with 64 bit products.
+#define dot_i32_sse2 dot_i32_scalar
+
+/** Arithmetic shift of each 64 bit lane right by 32, which AVX2 lacks. */
+__attribute__((target("avx2")))
+static inline __m256i high_halves(__m256i x) {
+  return _mm256_blend_epi32(_mm256_srli_epi64(x, 32), _mm256_srai_epi32(x, 31), 0xAA);
+}
+
+__attribute__((target("avx2")))
+static void dot_i32_avx2(const int32_t* a, const int32_t* b, uint32_t n, struct WideSum* sum) {
+  const __m256i mask = _mm256_set1_epi64x(0xFFFFFFFF);
+  __m256i high = _mm256_setzero_si256();
+  __m256i low = _mm256_setzero_si256();
+  uint32_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i*) (a + i));
+    __m256i y = _mm256_loadu_si256((const __m256i*) (b + i));
+    __m256i even = _mm256_mul_epi32(x, y);
+    __m256i odd = _mm256_mul_epi32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32));
+    high = _mm256_add_epi64(high, _mm256_add_epi64(high_halves(even), high_halves(odd)));
+    low = _mm256_add_epi64(low, _mm256_add_epi64(_mm256_and_si256(even, mask), _mm256_and_si256(odd, mask)));
+  }
+
+  int64_t high_lanes[4];
+  uint64_t low_lanes[4];
+  _mm256_storeu_si256((__m256i*) high_lanes, high);
+  _mm256_storeu_si256((__m256i*) low_lanes, low);
+
+  for (int lane = 0; lane < 4; ++lane) {
+    // Carry out of each lane first, so that adding the lanes together can't overflow.
+    sum->high += high_lanes[lane] + (int64_t) (low_lanes[lane] >> 32);
+    sum->low += low_lanes[lane] & 0xFFFFFFFF;
+  }
+
+  dot_i32_scalar(a + i, b + i, n - i, sum);
+}
+
+__attribute__((target("sse2")))
+static int32_t extremum_i32_sse2(const int32_t* a, uint32_t n, int32_t start, int greatest) {
+  __m128i result = _mm_set1_epi32(start);
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*) (a + i));
+    __m128i take = greatest ? _mm_cmpgt_epi32(x, result) : _mm_cmplt_epi32(x, result);
+    result = _mm_or_si128(_mm_and_si128(take, x), _mm_andnot_si128(take, result));
+  }
+
+  int32_t lanes[4];
+  _mm_storeu_si128((__m128i*) lanes, result);
+  return extremum_i32_scalar(a + i, n - i, extremum_i32_scalar(lanes, 4, start, greatest), greatest);
+}
+
+__attribute__((target("avx2")))
+static int32_t extremum_i32_avx2(const int32_t* a, uint32_t n, int32_t start, int greatest) {
+  __m256i result = _mm256_set1_epi32(start);
+  uint32_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i*) (a + i));
+    result = greatest ? _mm256_max_epi32(result, x) : _mm256_min_epi32(result, x);
+  }
+
+  int32_t lanes[8];
+  _mm256_storeu_si256((__m256i*) lanes, result);
+  return extremum_i32_scalar(a + i, n - i, extremum_i32_scalar(lanes, 8, start, greatest), greatest);
+}
+
+// Complex products pair each real part with both parts of the other operand, and each imaginary part with both parts of
+//  the other operand swapped. Subtracting the second from the first in the real lanes and adding them in the imaginary
+//  lanes gives the product.
+
+__attribute__((target("sse2")))
+static inline __m128d complex_product_sse2(__m128d x, __m128d y) {
+  const __m128d negate_real = _mm_set_pd(0.0, -0.0);
+  __m128d real = _mm_mul_pd(_mm_unpacklo_pd(x, x), y);
+  __m128d im = _mm_mul_pd(_mm_unpackhi_pd(x, x), _mm_shuffle_pd(y, y, 1));
+  return _mm_add_pd(real, _mm_xor_pd(im, negate_real));
+}
+
+__attribute__((target("avx2")))
+static inline __m256d complex_product_avx2(__m256d x, __m256d y) {
+  __m256d real = _mm256_mul_pd(_mm256_movedup_pd(x), y);
+  __m256d im = _mm256_mul_pd(_mm256_permute_pd(x, 0xF), _mm256_permute_pd(y, 0x5));
+  return _mm256_addsub_pd(real, im);
+}
+
+__attribute__((target("sse2")))
+static void multiply_c128_sse2(const double* a, const double* b, double* out, uint32_t n) {
+  for (uint32_t i = 0; i < 2 * n; i += 2) {
+    _mm_storeu_pd(out + i, complex_product_sse2(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  }
+}
+
+__attribute__((target("avx2")))
+static void multiply_c128_avx2(const double* a, const double* b, double* out, uint32_t n) {
+  uint32_t i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    _mm256_storeu_pd(out + 2 * i, complex_product_avx2(_mm256_loadu_pd(a + 2 * i), _mm256_loadu_pd(b + 2 * i)));
+  }
+
+  multiply_c128_scalar(a + 2 * i, b + 2 * i, out + 2 * i, n - i);
+}
+
+// Division multiplies by the conjugate of the divisor, then divides both parts by the divisor's squared magnitude.
+
+__attribute__((target("sse2")))
+static void divide_c128_sse2(const double* a, const double* b, double* out, uint32_t n) {
+  const __m128d conjugate = _mm_set_pd(-0.0, 0.0);
+
+  for (uint32_t i = 0; i < 2 * n; i += 2) {
+    __m128d y = _mm_loadu_pd(b + i);
+    __m128d squares = _mm_mul_pd(y, y);
+    __m128d magnitude = _mm_add_pd(squares, _mm_shuffle_pd(squares, squares, 1));
+    __m128d product = complex_product_sse2(_mm_loadu_pd(a + i), _mm_xor_pd(y, conjugate));
+    _mm_storeu_pd(out + i, _mm_div_pd(product, magnitude));
+  }
+}
+
+__attribute__((target("avx2")))
+static void divide_c128_avx2(const double* a, const double* b, double* out, uint32_t n) {
+  const __m256d conjugate = _mm256_set_pd(-0.0, 0.0, -0.0, 0.0);
+  uint32_t i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    __m256d y = _mm256_loadu_pd(b + 2 * i);
+    __m256d squares = _mm256_mul_pd(y, y);
+    __m256d magnitude = _mm256_add_pd(squares, _mm256_permute_pd(squares, 0x5));
+    __m256d product = complex_product_avx2(_mm256_loadu_pd(a + 2 * i), _mm256_xor_pd(y, conjugate));
+    _mm256_storeu_pd(out + 2 * i, _mm256_div_pd(product, magnitude));
+  }
+
+  divide_c128_scalar(a + 2 * i, b + 2 * i, out + 2 * i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void dot_c128_sse2(const double* a, const double* b, uint32_t n, double* sum) {
+  __m128d total = _mm_loadu_pd(sum);
+
+  for (uint32_t i = 0; i < 2 * n; i += 2) {
+    total = _mm_add_pd(total, complex_product_sse2(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+  }
+
+  _mm_storeu_pd(sum, total);
+}
+
+__attribute__((target("avx2")))
+static void dot_c128_avx2(const double* a, const double* b, uint32_t n, double* sum) {
+  __m256d total = _mm256_setzero_pd();
+  uint32_t i = 0;
+
+  for (; i + 2 <= n; i += 2) {
+    total = _mm256_add_pd(total, complex_product_avx2(_mm256_loadu_pd(a + 2 * i), _mm256_loadu_pd(b + 2 * i)));
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, total);
+  sum[0] += lanes[0] + lanes[2];
+  sum[1] += lanes[1] + lanes[3];
+  dot_c128_scalar(a + 2 * i, b + 2 * i, n - i, sum);
+}
+
+#endif
+
+// Dispatchers for each kernel, named after the scalar implementations they choose between.
+
+#define F64_ELEMENTWISE(name) \
+static void name##_f64(const double* a, const double* b, double* out, uint32_t n) { \
+  LISP_SIMD_SELECT(name##_f64)(a, b, out, n); \
+}
+
+F64_ELEMENTWISE(add)
+F64_ELEMENTWISE(subtract)
+F64_ELEMENTWISE(multiply)
+F64_ELEMENTWISE(divide)
+
+static double dot_f64(const double* a, const double* b, uint32_t n) {
+  return LISP_SIMD_SELECT(dot_f64)(a, b, n);
+}
+
+static double extremum_f64(const double* a, uint32_t n, double start, int greatest) {
+  return LISP_SIMD_SELECT(extremum_f64)(a, n, start, greatest);
+}
+
+#define I32_ELEMENTWISE(name) \
+static int name##_i32(const int32_t* a, const int32_t* b, int32_t* out, uint32_t n) { \
+  return LISP_SIMD_SELECT(name##_i32)(a, b, out, n); \
+}
+
+I32_ELEMENTWISE(add)
+I32_ELEMENTWISE(subtract)
+I32_ELEMENTWISE(multiply)
+
+static void divide_i32(const int32_t* a, const int32_t* b, double* out, uint32_t n) {
+  LISP_SIMD_SELECT(divide_i32)(a, b, out, n);
+}
+
+static void dot_i32(const int32_t* a, const int32_t* b, uint32_t n, struct WideSum* sum) {
+  LISP_SIMD_SELECT(dot_i32)(a, b, n, sum);
+}
+
+static int32_t extremum_i32(const int32_t* a, uint32_t n, int32_t start, int greatest) {
+  return LISP_SIMD_SELECT(extremum_i32)(a, n, start, greatest);
+}
+
+static void multiply_c128(const double* a, const double* b, double* out, uint32_t n) {
+  LISP_SIMD_SELECT(multiply_c128)(a, b, out, n);
+}
+
+static void divide_c128(const double* a, const double* b, double* out, uint32_t n) {
+  LISP_SIMD_SELECT(divide_c128)(a, b, out, n);
+}
+
+static void dot_c128(const double* a, const double* b, uint32_t n, double* sum) {
+  LISP_SIMD_SELECT(dot_c128)(a, b, n, sum);
+}
+
+// The arrays themselves.
+
+static size_t buffer_size(const struct LispDatum* x) {
+  return x->count * numeric_array_element_size(x->type);
+}
+
+struct LispDatum* new_numeric_array(enum LispDataType type, uint32_t count) {
+  struct LispDatum* x = alloc_datum();
+  x->type = type;
+  x->refs = 1;
+  x->count = count;
+  x->values = count == 0 ? NULL : lisp_alloc(buffer_size(x));
+  LISP_STATS_ALLOC(type, sizeof(struct LispDatum) + (count == 0 ? 0 : buffer_size(x)));
+
+  if (count > 0) {
+    memset(x->values, 0, buffer_size(x));
+  }
+
+  return x;
+}
+
+void destroy_numeric_array(struct LispDatum* x) {
+  if (x->count > 0) {
+    lisp_free(x->values, buffer_size(x));
+  }
+}
+
+static int real_of(const struct LispDatum* x, double* out) {
+  switch (x->type) {
+    case Integer:
+    case BigInt:
+      *out = integer_to_double(x);
+      return 0;
+    case Rational:
+      *out = (double) x->num / (double) x->den;
+      return 0;
+    case Real:
+      *out = x->float_val;
+      return 0;
+    default:
+      return -1;
+  }
+}
+
+int numeric_array_store(struct LispDatum* array, uint32_t i, const struct LispDatum* x) {
+  switch (array->type) {
+    case I32Array:
+      if (x->type != Integer) {
+        return -1;
+      }
+
+      ((int32_t*) array->values)[i] = x->int_val;
+      return 0;
+    case F64Array:
+      return real_of(x, &((double*) array->values)[i]);
+    case C128Array: {
+      double* slot = (double*) array->values + 2 * i;
+
+      if (x->type == Complex) {
+        slot[0] = x->real;
+        slot[1] = x->im;
+        return 0;
+      }
+
+      slot[1] = 0;
+      return real_of(x, &slot[0]);
+    }
+    default:
+      return -1;
+  }
+}
+
+struct LispDatum* numeric_array_load(const struct LispDatum* array, uint32_t i) {
+  if (array->type == I32Array) {
+    return box_integer(((const int32_t*) array->values)[i]);
+  } else if (array->type == F64Array) {
+    return new_real(((const double*) array->values)[i]);
+  }
+
+  const double* slot = (const double*) array->values + 2 * i;
+  return new_complex(slot[0], slot[1]);
+}
+
+int numeric_array_equal(const struct LispDatum* a, const struct LispDatum* b) {
+  if (a->type != b->type || a->count != b->count) {
+    return 0;
+  } else if (a->type == I32Array) {
+    return a->count == 0 || memcmp(a->values, b->values, buffer_size(a)) == 0;
+  }
+
+  // Doubles are compared by value, so that 0.0 and -0.0 are equal and NaN is not.
+  const double* x = a->values;
+  const double* y = b->values;
+  uint32_t n = a->type == C128Array ? 2 * a->count : a->count;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    if (x[i] != y[i]) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+struct LispDatum* numeric_array_combine(const struct LispDatum* a, const struct LispDatum* b, enum LispArithmetic op) {
+  enum LispDataType type = a->type == I32Array && op == LispDivide ? F64Array : a->type;
+  struct LispDatum* result = new_numeric_array(type, a->count);
+  uint32_t n = a->count;
+
+  if (a->type == I32Array) {
+    const int32_t* x = a->values;
+    const int32_t* y = b->values;
+    int overflow = 0;
+
+    switch (op) {
+      case LispAdd:
+        overflow = add_i32(x, y, result->values, n);
+        break;
+      case LispSubtract:
+        overflow = subtract_i32(x, y, result->values, n);
+        break;
+      case LispMultiply:
+        overflow = multiply_i32(x, y, result->values, n);
+        break;
+      case LispDivide:
+        divide_i32(x, y, result->values, n);
+        break;
+    }
+
+    if (overflow) {
+      release(result);
+      return NULL;
+    }
+
+    return result;
+  }
+
+  const double* x = a->values;
+  const double* y = b->values;
+
+  // Complex sums and differences are no different from those of twice as many reals.
+  switch (op) {
+    case LispAdd:
+      add_f64(x, y, result->values, a->type == C128Array ? 2 * n : n);
+      break;
+    case LispSubtract:
+      subtract_f64(x, y, result->values, a->type == C128Array ? 2 * n : n);
+      break;
+    case LispMultiply:
+      (a->type == C128Array ? multiply_c128 : multiply_f64)(x, y, result->values, n);
+      break;
+    case LispDivide:
+      (a->type == C128Array ? divide_c128 : divide_f64)(x, y, result->values, n);
+      break;
+  }
+
+  return result;
+}
+
+/** Write an exact wide sum into a scratch number, which only needs to be a big integer if `high` is large. */
+static void scratch_from_wide(struct LispDatum* result, const struct WideSum* sum) {
+  const int64_t limit = (int64_t) 1 << 30;
+
+  if (sum->high >= -limit && sum->high <= limit) {
+    scratch_from_int64(result, sum->high * ((int64_t) 1 << 32) + (int64_t) sum->low);
+    return;
+  }
+
+  struct LispDatum term;
+  scratch_from_int64(result, sum->high);
+  scratch_from_int64(&term, (int64_t) 1 << 32);
+  integer_multiply(result, &term);
+  discard_scratch(&term);
+  scratch_from_int64(&term, (int64_t) sum->low);
+  integer_add(result, &term);
+  discard_scratch(&term);
+}
+
+void numeric_array_dot(const struct LispDatum* a, const struct LispDatum* b, struct LispDatum* result) {
+  if (a->type == I32Array) {
+    struct WideSum sum = {0, 0};
+    dot_i32(a->values, b->values, a->count, &sum);
+    scratch_from_wide(result, &sum);
+  } else if (a->type == F64Array) {
+    result->type = Real;
+    result->float_val = dot_f64(a->values, b->values, a->count);
+  } else {
+    double sum[2] = {0, 0};
+    dot_c128(a->values, b->values, a->count, sum);
+    result->type = Complex;
+    result->real = sum[0];
+    result->im = sum[1];
+  }
+}
+
+void numeric_array_sum(const struct LispDatum* a, struct LispDatum* result) {
+  if (a->type == I32Array) {
+    scratch_from_int64(result, simd_sum_i32(a->values, a->count));
+  } else if (a->type == F64Array) {
+    result->type = Real;
+    result->float_val = simd_sum_f64(a->values, a->count);
+  } else {
+    const double* x = a->values;
+    double real = 0;
+    double im = 0;
+
+    for (uint32_t i = 0; i < 2 * a->count; i += 2) {
+      real += x[i];
+      im += x[i + 1];
+    }
+
+    result->type = Complex;
+    result->real = real;
+    result->im = im;
+  }
+}
+
+void numeric_array_extremum(const struct LispDatum* a, int greatest, struct LispDatum* result) {
+  if (a->type == I32Array) {
+    const int32_t* x = a->values;
+    result->type = Integer;
+    result->int_val = extremum_i32(x + 1, a->count - 1, x[0], greatest);
+  } else if (a->type == F64Array) {
+    const double* x = a->values;
+    result->type = Real;
+    result->float_val = extremum_f64(x + 1, a->count - 1, x[0], greatest);
+  } else {
+    const double* x = a->values;
+    uint32_t best = 0;
+
+    for (uint32_t i = 2; i < 2 * a->count; i += 2) {
+      int order = compare_doubles(x[i], x[best]);
+      order = order != 0 ? order : compare_doubles(x[i + 1], x[best + 1]);
+
+      if (greatest ? order > 0 : order < 0) {
+        best = i;
+      }
+    }
+
+    result->type = Complex;
+    result->real = x[best];
+    result->im = x[best + 1];
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef LISP_NUMARRAY_H
+#define LISP_NUMARRAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "data.h"
+#include "numeric.h"
+
+/*
+ * Numeric arrays hold unboxed numbers of a single type in one contiguous buffer, owned by the datum: 32 bit integers
+ * (`I32Array`), doubles (`F64Array`), or complex numbers stored as pairs of doubles (`C128Array`). Elementwise arithmetic
+ * and reductions run directly over those buffers, with the same AVX2/SSE2 dispatch as simd.h, so the only allocation
+ * they make is for their result.
+ */
+
+static inline int is_numeric_array(const struct LispDatum* x) {
+  return x->type == I32Array || x->type == F64Array || x->type == C128Array;
+}
+
+/** Bytes taken up by each element of an array of the given type. */
+static inline size_t numeric_array_element_size(enum LispDataType type) {
+  return type == I32Array ? sizeof(int32_t) : type == F64Array ? sizeof(double) : 2 * sizeof(double);
+}
+
+/** Create an array of `count` zeros. */
+struct LispDatum* new_numeric_array(enum LispDataType type, uint32_t count);
+
+/**
+ * Convert a number to the element type of an array, and store it at index `i`. Integer arrays only accept `Integer`s,
+ * and real arrays accept any number that is not complex.
+ * @return 0 on success, or -1 if the number can't be stored in the array.
+ */
+int numeric_array_store(struct LispDatum* array, uint32_t i, const struct LispDatum* x);
+
+/** Box the element at index `i`. */
+struct LispDatum* numeric_array_load(const struct LispDatum* array, uint32_t i);
+
+/** Whether two arrays have the same type, and equal elements. */
+int numeric_array_equal(const struct LispDatum* a, const struct LispDatum* b);
+
+/**
+ * Apply an operation to each pair of elements of two arrays of the same type and length. Dividing integer arrays gives a
+ * real array. Division follows IEEE 754, so a zero divisor gives an infinity or NaN rather than an error.
+ * @return a new array, or NULL if an element of an integer result overflows.
+ */
+struct LispDatum* numeric_array_combine(const struct LispDatum* a, const struct LispDatum* b, enum LispArithmetic op);
+
+/**
+ * Reductions, written into a scratch number (see bigint.h). Integer sums and dot products are exact, and may be big
+ * integers. The elements of complex arrays are not conjugated by the dot product.
+ */
+void numeric_array_dot(const struct LispDatum* a, const struct LispDatum* b, struct LispDatum* result);
+void numeric_array_sum(const struct LispDatum* a, struct LispDatum* result);
+
+/**
+ * The least or greatest element of a non-empty array. Complex numbers are ordered as by `numeric_compare`. The result is
+ * unspecified if the array contains NaN.
+ */
+void numeric_array_extremum(const struct LispDatum* a, int greatest, struct LispDatum* result);
+
+/** Free the buffer of an array. Called when it is destroyed or collected. */
+void destroy_numeric_array(struct LispDatum* x);
+
+#endif //LISP_NUMARRAY_H
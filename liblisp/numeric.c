@@ -0,0 +1,494 @@
+#include "bigint.h"
+#include "numeric.h"
+#include "rational.h"
+#include "simd.h"
+#include "stats.h"
+
+/**
+ * Mutating function for promoting numbers, used by the rare kernels that mix big integers with inexact types.
+ *
+ * This function works recursively to promote numbers one step at a time.
+ * @param n the number to be promoted.
+ * @param type for n to be promoted to.
+ */
+static void promote(struct LispDatum* n, enum LispDataType type) {
+  if (type <= n->type) return;
+
+  switch (n->type) {
+    case Integer:
+      // Integers and big integers are both integral, and are handled together without any promotion.
+      if (type == BigInt) return;
+
+      LISP_STATS_PROMOTE(Integer, Rational);
+      n->type = Rational;
+      n->num = n->int_val;
+      n->den = 1;
+      break;
+    case BigInt: {
+      // Big integers beyond the 64 bit terms of a rational skip straight to reals. Since the limbs are not freed here,
+      //  the caller is responsible for any that it owns.
+      int64_t value;
+
+      if (type >= Rational && !integer_to_int64(n, &value)) {
+        LISP_STATS_PROMOTE(BigInt, Rational);
+        n->type = Rational;
+        n->num = value;
+        n->den = 1;
+      } else {
+        LISP_STATS_PROMOTE(BigInt, Real);
+        n->float_val = integer_to_double(n);
+        n->type = Real;
+      }
+      break;
+    }
+    case Rational:
+      LISP_STATS_PROMOTE(Rational, Real);
+      n->type = Real;
+      n->float_val = ((double) n->num) / (n->den);
+      break;
+    case Real:
+      LISP_STATS_PROMOTE(Real, Complex);
+      n->type = Complex;
+      n->real = n->float_val;
+      n->im = 0;
+      break;
+    default:
+      break;
+  }
+
+  promote(n, type);
+}
+
+/**
+ * Promote two numbers until they share a type. Promoting can overshoot the target (a big integer promoted to a rational
+ * may become a real), so this is repeated until the two meet.
+ */
+static void unify(struct LispDatum* a, struct LispDatum* b) {
+  while (a->type != b->type) {
+    if (a->type < b->type) {
+      promote(a, b->type);
+    } else {
+      promote(b, a->type);
+    }
+  }
+}
+
+// Conversions used by the kernels to promote their operands. Each is only ever applied to a value of the named type.
+
+static inline double real_of_integer(const struct LispDatum* x) {
+  return x->int_val;
+}
+
+static inline double real_of_rational(const struct LispDatum* x) {
+  return (double) x->num / (double) x->den;
+}
+
+static inline double real_of_real(const struct LispDatum* x) {
+  return x->float_val;
+}
+
+static inline double real_of_complex(const struct LispDatum* x) {
+  return x->real;
+}
+
+static inline double imag_of_integer(const struct LispDatum* x) {
+  (void) x;
+  return 0;
+}
+
+#define imag_of_rational imag_of_integer
+#define imag_of_real imag_of_integer
+
+static inline double imag_of_complex(const struct LispDatum* x) {
+  return x->im;
+}
+
+static inline void rational_of_integer(struct LispDatum* dest, const struct LispDatum* x) {
+  int64_t value = x->int_val;
+  dest->type = Rational;
+  dest->num = value;
+  dest->den = 1;
+}
+
+static inline void rational_of_rational(struct LispDatum* dest, const struct LispDatum* x) {
+  if (dest != x) {
+    *dest = *x;
+  }
+}
+
+// Operations on promoted values.
+
+#define REAL_add(a, b) ((a) + (b))
+#define REAL_subtract(a, b) ((a) - (b))
+#define REAL_multiply(a, b) ((a) * (b))
+#define REAL_divide(a, b) ((a) / (b))
+
+static inline void store_complex(struct LispDatum* acc, double real, double im) {
+  acc->type = Complex;
+  acc->real = real;
+  acc->im = im;
+}
+
+static inline void complex_add(struct LispDatum* acc, double ar, double ai, double br, double bi) {
+  store_complex(acc, ar + br, ai + bi);
+}
+
+static inline void complex_subtract(struct LispDatum* acc, double ar, double ai, double br, double bi) {
+  store_complex(acc, ar - br, ai - bi);
+}
+
+static inline void complex_multiply(struct LispDatum* acc, double ar, double ai, double br, double bi) {
+  store_complex(acc, ar * br - ai * bi, ar * bi + ai * br);
+}
+
+static inline void complex_divide(struct LispDatum* acc, double ar, double ai, double br, double bi) {
+  double d = br * br + bi * bi;
+  store_complex(acc, (ar * br + ai * bi) / d, (ai * br - ar * bi) / d);
+}
+
+/** Exact division of integral values where possible, otherwise falling back to a real quotient. */
+static void integer_divide(struct LispDatum* acc, const struct LispDatum* x) {
+  struct LispDatum quotient;
+  struct LispDatum remainder;
+
+  integer_divmod(acc, x, &quotient, &remainder);
+
+  if (remainder.type == Integer && remainder.int_val == 0) {
+    discard_scratch(acc);
+    *acc = quotient;
+  } else {
+    double real = integer_to_double(acc) / integer_to_double(x);
+    discard_scratch(acc);
+    discard_scratch(&quotient);
+    discard_scratch(&remainder);
+
+    acc->type = Real;
+    acc->float_val = real;
+  }
+}
+
+// Kernels are generated for each operation and pair of types, and named `<operation>_<acc type>_<x type>`.
+
+#define RATIONAL_KERNEL(op, A, B) \
+static void op##_##A##_##B(struct LispDatum* acc, const struct LispDatum* x) { \
+  struct LispDatum y; \
+  rational_of_##B(&y, x); \
+  rational_of_##A(acc, acc); \
+  rational_##op(acc, &y); \
+}
+
+#define REAL_KERNEL(op, A, B) \
+static void op##_##A##_##B(struct LispDatum* acc, const struct LispDatum* x) { \
+  double result = REAL_##op(real_of_##A(acc), real_of_##B(x)); \
+  acc->type = Real; \
+  acc->float_val = result; \
+}
+
+#define COMPLEX_KERNEL(op, A, B) \
+static void op##_##A##_##B(struct LispDatum* acc, const struct LispDatum* x) { \
+  complex_##op(acc, real_of_##A(acc), imag_of_##A(acc), real_of_##B(x), imag_of_##B(x)); \
+}
+
+static void mixed(struct LispDatum* acc, const struct LispDatum* x, const LispArithKernel table[][LISP_NUMERIC_TYPES]);
+
+/**
+ * Big integers mixed with anything other than integers go through generic promotion. The limbs of a big integer
+ * accumulator are freed once it has been promoted into something else.
+ */
+#define MIXED_KERNEL(op) \
+static void op##_mixed(struct LispDatum* acc, const struct LispDatum* x) { \
+  mixed(acc, x, op##_kernels); \
+}
+
+#define ARITHMETIC_KERNELS(op) \
+static const LispArithKernel op##_kernels[LISP_NUMERIC_TYPES][LISP_NUMERIC_TYPES]; \
+RATIONAL_KERNEL(op, integer, rational) \
+RATIONAL_KERNEL(op, rational, integer) \
+RATIONAL_KERNEL(op, rational, rational) \
+REAL_KERNEL(op, integer, real) \
+REAL_KERNEL(op, rational, real) \
+REAL_KERNEL(op, real, integer) \
+REAL_KERNEL(op, real, rational) \
+REAL_KERNEL(op, real, real) \
+COMPLEX_KERNEL(op, integer, complex) \
+COMPLEX_KERNEL(op, rational, complex) \
+COMPLEX_KERNEL(op, real, complex) \
+COMPLEX_KERNEL(op, complex, integer) \
+COMPLEX_KERNEL(op, complex, rational) \
+COMPLEX_KERNEL(op, complex, real) \
+COMPLEX_KERNEL(op, complex, complex) \
+MIXED_KERNEL(op) \
+static const LispArithKernel op##_kernels[LISP_NUMERIC_TYPES][LISP_NUMERIC_TYPES] = { \
+  {integer_##op, integer_##op, op##_integer_rational, op##_integer_real, op##_integer_complex}, \
+  {integer_##op, integer_##op, op##_mixed, op##_mixed, op##_mixed}, \
+  {op##_rational_integer, op##_mixed, op##_rational_rational, op##_rational_real, op##_rational_complex}, \
+  {op##_real_integer, op##_mixed, op##_real_rational, op##_real_real, op##_real_complex}, \
+  {op##_complex_integer, op##_mixed, op##_complex_rational, op##_complex_real, op##_complex_complex}, \
+};
+
+ARITHMETIC_KERNELS(add)
+ARITHMETIC_KERNELS(subtract)
+ARITHMETIC_KERNELS(multiply)
+ARITHMETIC_KERNELS(divide)
+
+static void mixed(struct LispDatum* acc, const struct LispDatum* x, const LispArithKernel table[][LISP_NUMERIC_TYPES]) {
+  struct LispDatum y = *x;
+  struct LispDatum previous = *acc;
+  unify(acc, &y);
+
+  if (acc->type != previous.type) {
+    discard_scratch(&previous);
+  }
+
+  table[acc->type][y.type](acc, &y);
+}
+
+/** Indexed by `LispArithmetic`. */
+static const LispArithKernel (* const Kernels[])[LISP_NUMERIC_TYPES] = {
+    add_kernels, subtract_kernels, multiply_kernels, divide_kernels
+};
+
+static int is_zero(const struct LispDatum* x) {
+  switch (x->type) {
+    case Integer:
+      return x->int_val == 0;
+    case Rational:
+      return x->num == 0;
+    case Real:
+      return x->float_val == 0;
+    case Complex:
+      return x->real == 0 && x->im == 0;
+    default:
+      // Big integers are never 0, since they are demoted to integers whenever they fit.
+      return 0;
+  }
+}
+
+/** Payloads are gathered into buffers of this many values on the stack before being reduced. */
+#define SIMD_BLOCK 256
+
+/** The type shared by every argument, or -1 if they differ. */
+static int shared_type(struct LispDatum** args, uint32_t nargs) {
+  for (uint32_t i = 1; i < nargs; ++i) {
+    if (args[i]->type != args[0]->type) {
+      return -1;
+    }
+  }
+
+  return args[0]->type;
+}
+
+static inline uint32_t block_size(uint32_t remaining) {
+  return remaining < SIMD_BLOCK ? remaining : SIMD_BLOCK;
+}
+
+/**
+ * Reduce a run of integers or reals with SIMD, and apply the result to the accumulator all at once. Folding a
+ * subtraction is the same as subtracting the sum, so only sums and products need kernels. Integer products are left to
+ * the regular kernels, since they need to check every step for overflow.
+ * @return whether the arguments could be reduced this way.
+ */
+static int fold_homogeneous(struct LispDatum** args, uint32_t nargs, struct LispDatum* acc, enum LispArithmetic op) {
+  if (nargs < LISP_SIMD_FOLD_MIN || op == LispDivide) {
+    return 0;
+  }
+
+  int type = shared_type(args, nargs);
+  struct LispDatum reduced;
+
+  if (type == Integer && op != LispMultiply) {
+    int32_t block[SIMD_BLOCK];
+    int64_t sum = 0;
+
+    for (uint32_t i = 0; i < nargs; i += SIMD_BLOCK) {
+      uint32_t count = block_size(nargs - i);
+
+      for (uint32_t j = 0; j < count; ++j) {
+        block[j] = args[i + j]->int_val;
+      }
+
+      sum += simd_sum_i32(block, count);
+    }
+
+    scratch_from_int64(&reduced, sum);
+  } else if (type == Real) {
+    double block[SIMD_BLOCK];
+    double total = op == LispMultiply ? 1 : 0;
+
+    for (uint32_t i = 0; i < nargs; i += SIMD_BLOCK) {
+      uint32_t count = block_size(nargs - i);
+
+      for (uint32_t j = 0; j < count; ++j) {
+        block[j] = args[i + j]->float_val;
+      }
+
+      total = op == LispMultiply ? total * simd_product_f64(block, count) : total + simd_sum_f64(block, count);
+    }
+
+    reduced.type = Real;
+    reduced.float_val = total;
+  } else {
+    return 0;
+  }
+
+  Kernels[op][acc->type][reduced.type](acc, &reduced);
+  discard_scratch(&reduced);
+  return 1;
+}
+
+int numeric_fold(struct LispDatum** args, uint32_t nargs, struct LispDatum* acc, enum LispArithmetic op) {
+  const LispArithKernel (* table)[LISP_NUMERIC_TYPES] = Kernels[op];
+
+  if (!is_numeric_type(acc->type)) {
+    return LISP_FOLD_NOT_NUMERIC;
+  } else if (fold_homogeneous(args, nargs, acc, op)) {
+    return 0;
+  }
+
+  for (uint32_t i = 0; i < nargs; ++i) {
+    const struct LispDatum* x = args[i];
+
+    if (!is_numeric_type(x->type)) {
+      discard_scratch(acc);
+      return LISP_FOLD_NOT_NUMERIC;
+    } else if (op == LispDivide && is_zero(x)) {
+      discard_scratch(acc);
+      return LISP_FOLD_ZERO_DIVISION;
+    }
+
+    table[acc->type][x->type](acc, x);
+  }
+
+  return 0;
+}
+
+// Comparison kernels, named `compare_<a type>_<b type>`.
+
+static inline int compare_doubles(double a, double b) {
+  return a == b ? 0 : a > b ? 1 : -1;
+}
+
+#define RATIONAL_COMPARE(A, B) \
+static int compare_##A##_##B(const struct LispDatum* a, const struct LispDatum* b) { \
+  struct LispDatum x; \
+  struct LispDatum y; \
+  rational_of_##A(&x, a); \
+  rational_of_##B(&y, b); \
+  return rational_compare(&x, &y); \
+}
+
+#define REAL_COMPARE(A, B) \
+static int compare_##A##_##B(const struct LispDatum* a, const struct LispDatum* b) { \
+  return compare_doubles(real_of_##A(a), real_of_##B(b)); \
+}
+
+#define COMPLEX_COMPARE(A, B) \
+static int compare_##A##_##B(const struct LispDatum* a, const struct LispDatum* b) { \
+  int real = compare_doubles(real_of_##A(a), real_of_##B(b)); \
+  return real != 0 ? real : compare_doubles(imag_of_##A(a), imag_of_##B(b)); \
+}
+
+RATIONAL_COMPARE(integer, rational)
+RATIONAL_COMPARE(rational, integer)
+RATIONAL_COMPARE(rational, rational)
+REAL_COMPARE(integer, real)
+REAL_COMPARE(rational, real)
+REAL_COMPARE(real, integer)
+REAL_COMPARE(real, rational)
+REAL_COMPARE(real, real)
+COMPLEX_COMPARE(integer, complex)
+COMPLEX_COMPARE(rational, complex)
+COMPLEX_COMPARE(real, complex)
+COMPLEX_COMPARE(complex, integer)
+COMPLEX_COMPARE(complex, rational)
+COMPLEX_COMPARE(complex, real)
+COMPLEX_COMPARE(complex, complex)
+
+static int compare_mixed(const struct LispDatum* a, const struct LispDatum* b);
+
+static const LispCompareKernel CompareKernels[LISP_NUMERIC_TYPES][LISP_NUMERIC_TYPES] = {
+    {integer_compare, integer_compare, compare_integer_rational, compare_integer_real, compare_integer_complex},
+    {integer_compare, integer_compare, compare_mixed, compare_mixed, compare_mixed},
+    {compare_rational_integer, compare_mixed, compare_rational_rational, compare_rational_real, compare_rational_complex},
+    {compare_real_integer, compare_mixed, compare_real_rational, compare_real_real, compare_real_complex},
+    {compare_complex_integer, compare_mixed, compare_complex_rational, compare_complex_real, compare_complex_complex},
+};
+
+static int compare_mixed(const struct LispDatum* a, const struct LispDatum* b) {
+  // Copies of the operands never own any limbs, so there is nothing to free once they are promoted.
+  struct LispDatum x = *a;
+  struct LispDatum y = *b;
+  unify(&x, &y);
+  return CompareKernels[x.type][y.type](&x, &y);
+}
+
+int numeric_compare(const struct LispDatum* a, const struct LispDatum* b) {
+  return CompareKernels[a->type][b->type](a, b);
+}
+
+/** Chained comparison of a run of integers or reals with SIMD. Returns -1 if the arguments can't be compared this way. */
+static int ordered_homogeneous(struct LispDatum** args, uint32_t nargs, int accepted) {
+  if (nargs < LISP_SIMD_FOLD_MIN) {
+    return -1;
+  }
+
+  int type = shared_type(args, nargs);
+
+  if (type != Integer && type != Real) {
+    return -1;
+  }
+
+  // Consecutive blocks overlap by one argument, so that the pair straddling them is compared as well.
+  for (uint32_t i = 0; i + 1 < nargs; i += SIMD_BLOCK - 1) {
+    uint32_t count = block_size(nargs - i);
+    int ordered;
+
+    if (type == Integer) {
+      int32_t block[SIMD_BLOCK];
+
+      for (uint32_t j = 0; j < count; ++j) {
+        block[j] = args[i + j]->int_val;
+      }
+
+      ordered = simd_ordered_i32(block, count, accepted);
+    } else {
+      double block[SIMD_BLOCK];
+
+      for (uint32_t j = 0; j < count; ++j) {
+        block[j] = args[i + j]->float_val;
+      }
+
+      ordered = simd_ordered_f64(block, count, accepted);
+    }
+
+    if (!ordered) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+int numeric_ordered(struct LispDatum** args, uint32_t nargs, int accepted) {
+  int ordered = ordered_homogeneous(args, nargs, accepted);
+
+  if (ordered >= 0) {
+    return ordered;
+  }
+
+  ordered = 1;
+
+  for (uint32_t i = 0; i + 1 < nargs; ++i) {
+    // Every argument is checked, even once the result is known.
+    if (!is_numeric_type(args[i]->type) || !is_numeric_type(args[i + 1]->type)) {
+      return LISP_FOLD_NOT_NUMERIC;
+    }
+
+    if (ordered) {
+      int order = numeric_compare(args[i], args[i + 1]);
+      ordered = (accepted & (order < 0 ? LISP_ORDER_LESS : order > 0 ? LISP_ORDER_GREATER : LISP_ORDER_EQUAL)) != 0;
+    }
+  }
+
+  return ordered;
+}
@@ -0,0 +1,67 @@
+#ifndef LISP_NUMERIC_H
+#define LISP_NUMERIC_H
+
+#include <stdint.h>
+#include "data.h"
+
+/*
+ * Generic arithmetic. Every operation on two numbers is dispatched on the pair of their types through a table of
+ * kernels, each of which knows both of its operand types and promotes them inline. This keeps the common cases, such as
+ * adding an integer to a real, down to a single indirect call with no copying of the operands.
+ */
+
+/** Numeric types are the first values of `LispDataType`, and index the kernel tables. */
+#define LISP_NUMERIC_TYPES (Complex + 1)
+
+enum LispArithmetic {
+  LispAdd, LispSubtract, LispMultiply, LispDivide
+};
+
+/** Orderings accepted by a comparison, as a mask. */
+#define LISP_ORDER_LESS 1
+#define LISP_ORDER_EQUAL 2
+#define LISP_ORDER_GREATER 4
+
+/**
+ * Folds and chained comparisons over at least this many arguments first check whether every argument is an integer, or
+ * every argument is a real. If so, the arguments are gathered into a buffer and reduced with SIMD (see simd.h).
+ */
+#define LISP_SIMD_FOLD_MIN 8
+
+/** Failures reported by `numeric_fold`. */
+#define LISP_FOLD_NOT_NUMERIC (-1)
+#define LISP_FOLD_ZERO_DIVISION (-2)
+
+/** Replaces `acc` with the result of applying an operation to it and `x`. */
+typedef void (* LispArithKernel)(struct LispDatum* acc, const struct LispDatum* x);
+
+/** Returns a negative value, 0, or a positive value when a is less than, equal to, or greater than b. */
+typedef int (* LispCompareKernel)(const struct LispDatum* a, const struct LispDatum* b);
+
+static inline int is_numeric_type(enum LispDataType type) {
+  return type <= Complex;
+}
+
+/**
+ * Fold an operation over the given arguments, left to right, starting from `acc`.
+ * @param acc a scratch number (see bigint.h) holding the initial value, which is replaced with the result. It is
+ * discarded if an error occurs. Rationals are left unreduced between steps, and are only normalized once boxed. Sums
+ * and products of many reals may be rounded differently than a strict left to right fold, since they are reduced with
+ * SIMD.
+ * @return 0 on success, or one of the `LISP_FOLD_*` failures.
+ */
+int numeric_fold(struct LispDatum** args, uint32_t nargs, struct LispDatum* acc, enum LispArithmetic op);
+
+/**
+ * Whether every adjacent pair of arguments compares with one of the `accepted` orderings (`LISP_ORDER_*`).
+ * @return 1 or 0, or `LISP_FOLD_NOT_NUMERIC` if any argument is not a number.
+ */
+int numeric_ordered(struct LispDatum** args, uint32_t nargs, int accepted);
+
+/**
+ * Compare two numbers after promotion. Complex numbers are ordered by their real part, then their imaginary part.
+ * Both arguments must be numeric.
+ */
+int numeric_compare(const struct LispDatum* a, const struct LispDatum* b);
+
+#endif //LISP_NUMERIC_H
@@ -0,0 +1,388 @@
+#include <math.h>
+#include <string.h>
+#include "numfmt.h"
+#include "numfmt_table.h"
+
+__extension__ typedef unsigned __int128 uwide;
+
+static const char DIGIT_PAIRS[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static uint32_t decimal_length(uint64_t x) {
+  uint32_t length = 1;
+
+  for (; x >= 10000; x /= 10000) {
+    length += 4;
+  }
+
+  return length + (x >= 10) + (x >= 100) + (x >= 1000);
+}
+
+/** Write the `length` digits of `x` backwards from `end`. */
+static void write_digits(uint64_t x, char* end, uint32_t length) {
+  // Take the low half off first while the value is still wide, so that the remaining work is in 32 bits.
+  while (x >> 32 != 0) {
+    uint32_t pair = (uint32_t) (x % 100);
+    x /= 100;
+    end -= 2;
+    memcpy(end, DIGIT_PAIRS + 2 * pair, 2);
+    length -= 2;
+  }
+
+  uint32_t y = (uint32_t) x;
+
+  while (length >= 2) {
+    uint32_t pair = y % 100;
+    y /= 100;
+    end -= 2;
+    memcpy(end, DIGIT_PAIRS + 2 * pair, 2);
+    length -= 2;
+  }
+
+  if (length == 1) {
+    *--end = (char) ('0' + y);
+  }
+}
+
+uint32_t format_uint64(uint64_t x, char* out) {
+  uint32_t length = decimal_length(x);
+  write_digits(x, out + length, length);
+  return length;
+}
+
+uint32_t format_int64(int64_t x, char* out) {
+  if (x < 0) {
+    *out = '-';
+    // Negate as unsigned, so that INT64_MIN doesn't overflow.
+    return 1 + format_uint64(0 - (uint64_t) x, out + 1);
+  }
+
+  return format_uint64((uint64_t) x, out);
+}
+
+void format_digits9(uint32_t x, char* out) {
+  write_digits(x, out + 9, 9);
+}
+
+// Ryu. The double is m2 * 2^e2, with e2 lowered by 2 to leave room for the halfway points to its neighbours. Those
+//  bound the interval of decimals that read back as the same double. The bounds and the value are scaled by a power of
+//  10 using the precomputed table, then digits are removed from all three together for as long as the bounds still
+//  differ, which leaves the shortest decimal in the interval. The last digit removed from the value decides rounding.
+
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_BIAS 1023
+
+/** ceil(log2(5^e)) for e > 0, and 1 for e = 0. */
+static int32_t pow5_bits(int32_t e) {
+  return ((e * 1217359) >> 19) + 1;
+}
+
+/** floor(log10(2^e)) for 0 <= e <= 1650. */
+static uint32_t log10_pow2(int32_t e) {
+  return (uint32_t) ((e * 78913) >> 18);
+}
+
+/** floor(log10(5^e)) for 0 <= e <= 2620. */
+static uint32_t log10_pow5(int32_t e) {
+  return (uint32_t) ((e * 732923) >> 20);
+}
+
+static uint32_t pow5_factor(uint64_t x) {
+  uint32_t count = 0;
+
+  while (x % 5 == 0) {
+    x /= 5;
+    ++count;
+  }
+
+  return count;
+}
+
+static int multiple_of_pow5(uint64_t x, uint32_t p) {
+  return pow5_factor(x) >= p;
+}
+
+static int multiple_of_pow2(uint64_t x, uint32_t p) {
+  return (x & ((1ull << p) - 1)) == 0;
+}
+
+/** (m * mul) >> j, where mul is a 128 bit table entry and j >= 64. */
+static uint64_t multiply_shift(uint64_t m, const uint64_t* mul, int32_t j) {
+  uwide low = (uwide) m * mul[0];
+  uwide high = (uwide) m * mul[1];
+  return (uint64_t) (((low >> 64) + high) >> (j - 64));
+}
+
+struct Decimal {
+  uint64_t digits;
+  int32_t exponent;
+};
+
+static struct Decimal shortest_decimal(uint64_t mantissa, uint32_t exponent) {
+  int32_t e2;
+  uint64_t m2;
+
+  if (exponent == 0) {
+    e2 = 1 - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+    m2 = mantissa;
+  } else {
+    e2 = (int32_t) exponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS - 2;
+    m2 = (1ull << DOUBLE_MANTISSA_BITS) | mantissa;
+  }
+
+  // The bounds are included when the mantissa is even, since a tie when reading the decimal back rounds to even.
+  int accept_bounds = (m2 & 1) == 0;
+  uint64_t mv = 4 * m2;
+  // The gap to the next lower double is half as wide when the mantissa is at a power of 2.
+  uint32_t mm_shift = mantissa != 0 || exponent <= 1;
+
+  uint64_t vr, vp, vm;
+  int32_t e10;
+  int vm_trailing_zeros = 0;
+  int vr_trailing_zeros = 0;
+
+  if (e2 >= 0) {
+    uint32_t q = log10_pow2(e2) - (e2 > 3);
+    int32_t k = NUMFMT_POW5_INV_BITCOUNT + pow5_bits((int32_t) q) - 1;
+    int32_t i = -e2 + (int32_t) q + k;
+    const uint64_t* mul = NUMFMT_POW5_INV_SPLIT[q];
+    e10 = (int32_t) q;
+    vr = multiply_shift(4 * m2, mul, i);
+    vp = multiply_shift(4 * m2 + 2, mul, i);
+    vm = multiply_shift(4 * m2 - 1 - mm_shift, mul, i);
+
+    // Only small powers of 10 can divide the scaled values exactly, so only then do digits need to be tracked.
+    if (q <= 21) {
+      if (mv % 5 == 0) {
+        vr_trailing_zeros = multiple_of_pow5(mv, q);
+      } else if (accept_bounds) {
+        vm_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+      } else {
+        vp -= multiple_of_pow5(mv + 2, q);
+      }
+    }
+  } else {
+    uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+    int32_t i = -e2 - (int32_t) q;
+    int32_t k = pow5_bits(i) - NUMFMT_POW5_BITCOUNT;
+    int32_t j = (int32_t) q - k;
+    const uint64_t* mul = NUMFMT_POW5_SPLIT[i];
+    e10 = (int32_t) q + e2;
+    vr = multiply_shift(4 * m2, mul, j);
+    vp = multiply_shift(4 * m2 + 2, mul, j);
+    vm = multiply_shift(4 * m2 - 1 - mm_shift, mul, j);
+
+    if (q <= 1) {
+      // mv has at least 2 trailing zero bits, so vr does too.
+      vr_trailing_zeros = 1;
+
+      if (accept_bounds) {
+        vm_trailing_zeros = mm_shift == 1;
+      } else {
+        --vp;
+      }
+    } else if (q < 63) {
+      vr_trailing_zeros = multiple_of_pow2(mv, q);
+    }
+  }
+
+  int32_t removed = 0;
+  uint32_t last_removed = 0;
+  uint64_t output;
+
+  if (vm_trailing_zeros || vr_trailing_zeros) {
+    // The rare general case, where the exact digits removed matter for rounding and for whether the lower bound is hit.
+    while (vp / 10 > vm / 10) {
+      vm_trailing_zeros &= vm % 10 == 0;
+      vr_trailing_zeros &= last_removed == 0;
+      last_removed = (uint32_t) (vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+
+    if (vm_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_trailing_zeros &= last_removed == 0;
+        last_removed = (uint32_t) (vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+
+    if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) {
+      // Exactly halfway, so round to even.
+      last_removed = 4;
+    }
+
+    output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+  } else {
+    int round_up = 0;
+
+    // Most values lose at least two digits, so try that in one step first.
+    if (vp / 100 > vm / 100) {
+      round_up = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+
+    while (vp / 10 > vm / 10) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+
+    output = vr + (vr == vm || round_up);
+  }
+
+  return (struct Decimal) {output, e10 + removed};
+}
+
+/** Integers below 2^53 are their own shortest decimal, once trailing zeros are removed. */
+static int small_integer(uint64_t mantissa, uint32_t exponent, struct Decimal* result) {
+  uint64_t m2 = (1ull << DOUBLE_MANTISSA_BITS) | mantissa;
+  int32_t e2 = (int32_t) exponent - DOUBLE_BIAS - DOUBLE_MANTISSA_BITS;
+
+  if (e2 > 0 || e2 < -DOUBLE_MANTISSA_BITS || (m2 & ((1ull << -e2) - 1)) != 0) {
+    return 0;
+  }
+
+  result->digits = m2 >> -e2;
+  result->exponent = 0;
+
+  while (result->digits % 10 == 0) {
+    result->digits /= 10;
+    ++result->exponent;
+  }
+
+  return 1;
+}
+
+static uint32_t write_literal(const char* s, char* out) {
+  uint32_t length = (uint32_t) strlen(s);
+  memcpy(out, s, length);
+  return length;
+}
+
+uint32_t format_real(double x, char* out) {
+  uint64_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+
+  int negative = (int) (bits >> 63);
+  uint32_t exponent = (uint32_t) (bits >> DOUBLE_MANTISSA_BITS) & 0x7FF;
+  uint64_t mantissa = bits & ((1ull << DOUBLE_MANTISSA_BITS) - 1);
+
+  if (exponent == 0x7FF) {
+    return write_literal(mantissa != 0 ? "+nan.0" : negative ? "-inf.0" : "+inf.0", out);
+  }
+
+  if (exponent == 0 && mantissa == 0) {
+    return write_literal(negative ? "-0.0" : "0.0", out);
+  }
+
+  struct Decimal decimal;
+
+  if (!small_integer(mantissa, exponent, &decimal)) {
+    decimal = shortest_decimal(mantissa, exponent);
+  }
+
+  char* start = out;
+
+  if (negative) {
+    *out++ = '-';
+  }
+
+  uint32_t length = decimal_length(decimal.digits);
+  // The power of 10 of the leading digit.
+  int32_t point = decimal.exponent + (int32_t) length - 1;
+
+  if (point >= 21 || point < -7) {
+    // Leave a gap after the leading digit for the decimal point.
+    write_digits(decimal.digits, out + length + 1, length);
+    out[0] = out[1];
+
+    if (length > 1) {
+      out[1] = '.';
+      out += length + 1;
+    } else {
+      out += 1;
+    }
+
+    *out++ = 'e';
+    out += format_int64(point, out);
+  } else if (point < 0) {
+    uint32_t zeros = (uint32_t) -point;
+    out[0] = '0';
+    out[1] = '.';
+    memset(out + 2, '0', zeros - 1);
+    out += 1 + zeros;
+    write_digits(decimal.digits, out + length, length);
+    out += length;
+  } else if ((uint32_t) point + 1 >= length) {
+    uint32_t zeros = (uint32_t) point + 1 - length;
+    write_digits(decimal.digits, out + length, length);
+    out += length;
+    memset(out, '0', zeros);
+    out += zeros;
+    out[0] = '.';
+    out[1] = '0';
+    out += 2;
+  } else {
+    // The decimal point falls between the digits, so write them with a gap and move the integer part across.
+    uint32_t whole = (uint32_t) point + 1;
+    write_digits(decimal.digits, out + length + 1, length);
+    memmove(out, out + 1, whole);
+    out[whole] = '.';
+    out += length + 1;
+  }
+
+  return (uint32_t) (out - start);
+}
+
+uint32_t format_complex(double real, double im, char* out) {
+  uint32_t length = format_real(real, out);
+
+  // Infinities and NaN already carry a sign.
+  if (isfinite(im) && !signbit(im)) {
+    out[length++] = '+';
+  }
+
+  length += format_real(im, out + length);
+  out[length++] = 'i';
+  return length;
+}
+
+uint32_t format_number(const struct LispDatum* x, char* out) {
+  uint32_t length;
+
+  switch (x->type) {
+    case Integer:
+      return format_int64(x->int_val, out);
+    case Rational:
+      length = format_int64(x->num, out);
+      out[length++] = '/';
+      return length + format_int64(x->den, out + length);
+    case Real:
+      return format_real(x->float_val, out);
+    case Complex:
+      return format_complex(x->real, x->im, out);
+    default:
+      return 0;
+  }
+}
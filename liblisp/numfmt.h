@@ -0,0 +1,49 @@
+#ifndef LISP_NUMFMT_H
+#define LISP_NUMFMT_H
+
+#include <stdint.h>
+#include "data.h"
+
+/*
+ * Conversion of numbers to decimal text, without going through printf, so that the output never depends on the locale.
+ * Integers are written two digits at a time from a table of digit pairs. Reals are written with the fewest significant
+ * digits that read back as the same double, found by the Ryu algorithm (Adams, PLDI 2018), which only needs 64 and 128
+ * bit integer arithmetic and a table of powers of 5 (see numfmt_table.h).
+ *
+ * Reals always show that they are inexact, with a decimal point in fixed notation (`2.0`, `0.001`) or an exponent in
+ * scientific notation (`1e21`, `1.5e-7`). Scientific notation is used once the exponent is below -7 or at least 21.
+ * Infinities and NaN are written `+inf.0`, `-inf.0` and `+nan.0`.
+ *
+ * None of these functions terminate their output with a null character.
+ */
+
+/** Room for any 64 bit integer, including its sign. */
+#define LISP_INT_CHARS 20
+
+/** Room for any real written by `format_real`. */
+#define LISP_REAL_CHARS 32
+
+/** Room for any number written by `format_number`. */
+#define LISP_NUMBER_CHARS (2 * LISP_REAL_CHARS + 1)
+
+/** @return the number of characters written. */
+uint32_t format_uint64(uint64_t x, char* out);
+uint32_t format_int64(int64_t x, char* out);
+
+/** Write exactly 9 digits, padded with leading zeros. `x` must be less than 10^9. */
+void format_digits9(uint32_t x, char* out);
+
+/** @return the number of characters written. */
+uint32_t format_real(double x, char* out);
+
+/**
+ * Write an `Integer`, `Rational`, `Real` or `Complex` as `display` shows it. Big integers have no fixed bound on their
+ * length, and are written by `integer_format` instead.
+ * @return the number of characters written.
+ */
+uint32_t format_number(const struct LispDatum* x, char* out);
+
+/** Write a complex number from its parts, with the sign of the imaginary part always shown. */
+uint32_t format_complex(double real, double im, char* out);
+
+#endif //LISP_NUMFMT_H
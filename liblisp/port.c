@@ -0,0 +1,130 @@
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lstring.h"
+#include "port.h"
+#include "state.h"
+
+#define STRING_PORT_INITIAL_CAPACITY 64
+
+void port_open_file(struct LispPort* port, FILE* file) {
+  port->file = file;
+  port->buffer = malloc(LISP_PORT_BUFFER_SIZE);
+  port->length = 0;
+  port->capacity = LISP_PORT_BUFFER_SIZE;
+}
+
+void port_open_string(struct LispPort* port) {
+  port->file = NULL;
+  port->buffer = NULL;
+  port->length = 0;
+  port->capacity = 0;
+}
+
+void port_close(struct LispPort* port) {
+  port_flush(port);
+  free(port->buffer);
+  port->buffer = NULL;
+  port->length = 0;
+  port->capacity = 0;
+}
+
+void port_flush(struct LispPort* port) {
+  if (port->file == NULL) {
+    return;
+  }
+
+  if (port->length > 0) {
+    fwrite(port->buffer, sizeof(char), port->length, port->file);
+    port->length = 0;
+  }
+
+  fflush(port->file);
+}
+
+/**
+ * Make room for at least `needed` more characters. File ports write out what they have first, and only grow if that
+ * isn't enough, which only happens for a single piece of text larger than the whole buffer.
+ */
+static void reserve(struct LispPort* port, size_t needed) {
+  if (port->file != NULL && port->length > 0 && port->length + needed > port->capacity) {
+    fwrite(port->buffer, sizeof(char), port->length, port->file);
+    port->length = 0;
+  }
+
+  if (port->length + needed <= port->capacity) {
+    return;
+  }
+
+  size_t capacity = port->capacity == 0 ? STRING_PORT_INITIAL_CAPACITY : port->capacity;
+
+  while (capacity < port->length + needed) {
+    capacity *= 2;
+  }
+
+  port->buffer = realloc(port->buffer, capacity);
+  port->capacity = capacity;
+}
+
+void port_write(struct LispPort* port, const char* chars, size_t length) {
+  reserve(port, length);
+  memcpy(port->buffer + port->length, chars, length);
+  port->length += length;
+}
+
+void port_print(struct LispPort* port, const char* format, ...) {
+  va_list args;
+
+  // Most text fits in whatever room is left, so format straight into the buffer, and only measure it if that fails.
+  va_start(args, format);
+  size_t room = port->capacity - port->length;
+  int length = vsnprintf(room == 0 ? NULL : port->buffer + port->length, room, format, args);
+  va_end(args);
+
+  if (length < 0) {
+    return;
+  } else if ((size_t) length < room) {
+    port->length += (size_t) length;
+    return;
+  }
+
+  reserve(port, (size_t) length + 1);
+  va_start(args, format);
+  vsnprintf(port->buffer + port->length, (size_t) length + 1, format, args);
+  va_end(args);
+  port->length += (size_t) length;
+}
+
+struct LispDatum* port_take_string(struct LispPort* port) {
+  struct LispDatum* s = new_string_from_copy(port->length == 0 ? "" : port->buffer, (uint32_t) port->length);
+  port->length = 0;
+  return s;
+}
+
+struct LispPort* lisp_output_port(void) {
+  struct LispState* state = lisp_state_current();
+
+  if (state->output != NULL) {
+    return state->output;
+  } else if (state->standard_output.buffer == NULL) {
+    port_open_file(&state->standard_output, stdout);
+  }
+
+  return &state->standard_output;
+}
+
+struct LispPort* lisp_set_output_port(struct LispPort* port) {
+  struct LispPort* previous = lisp_output_port();
+  lisp_state_current()->output = port;
+  return previous;
+}
+
+void lisp_flush_output(void) {
+  struct LispState* state = lisp_state_current();
+
+  if (state->output != NULL) {
+    port_flush(state->output);
+  }
+
+  port_flush(&state->standard_output);
+}
@@ -0,0 +1,75 @@
+#ifndef LISP_PORT_H
+#define LISP_PORT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+ * Output ports collect text in a buffer, rather than handing every piece to stdio as it is produced. File ports write
+ * their buffer out whenever it fills up, and when explicitly flushed. String ports keep growing their buffer, and their
+ * contents can be taken once writing is done.
+ *
+ * `display` and `format` write to the current output port of the calling thread's state. Unless another port is set,
+ * that is a file port on stdout, which is only written out once full, when an error is raised, or when
+ * `lisp_flush_output` is called. Generated programs flush it before they exit.
+ */
+
+/** Capacity of the buffer of a file port. */
+#define LISP_PORT_BUFFER_SIZE 65536
+
+struct LispDatum;
+
+struct LispPort {
+  /** Where a file port writes its buffer to. NULL for string ports. */
+  FILE* file;
+
+  char* buffer;
+  size_t length;
+  size_t capacity;
+};
+
+/** Open a port writing to a file, which remains owned by the caller. */
+void port_open_file(struct LispPort* port, FILE* file);
+
+/** Open a port collecting text in memory. */
+void port_open_string(struct LispPort* port);
+
+/** Flush a port, and free its buffer. The port may be opened again afterwards. */
+void port_close(struct LispPort* port);
+
+void port_write(struct LispPort* port, const char* chars, size_t length);
+
+static inline void port_write_char(struct LispPort* port, char c) {
+  if (port->length == port->capacity) {
+    port_write(port, &c, 1);
+  } else {
+    port->buffer[port->length++] = c;
+  }
+}
+
+/** Shorthand for `port_write` that measures a literal at compile time. */
+#define LISP_PORT_LITERAL(port, s) port_write((port), (s), sizeof(s) - 1)
+
+/** Write text formatted according to printf rules. */
+void port_print(struct LispPort* port, const char* format, ...);
+
+/** Write out the buffer of a file port, and flush the file. Does nothing to string ports. */
+void port_flush(struct LispPort* port);
+
+/** Make a string of everything written to a string port so far, and empty the port. */
+struct LispDatum* port_take_string(struct LispPort* port);
+
+/** The port that `display` and `format` write to. */
+struct LispPort* lisp_output_port(void);
+
+/**
+ * Redirect `display` and `format` for the current state to the given port, which must stay open until it is replaced.
+ * Passing NULL restores the port on stdout.
+ * @return the port that was previously current.
+ */
+struct LispPort* lisp_set_output_port(struct LispPort* port);
+
+/** Flush the current output port, as well as the one on stdout if it has been replaced. */
+void lisp_flush_output(void);
+
+#endif //LISP_PORT_H
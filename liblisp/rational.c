@@ -0,0 +1,135 @@
+#include "rational.h"
+
+// GCC and Clang both provide 128 bit integers on 64 bit targets. `__extension__` keeps -Wpedantic quiet about them.
+__extension__ typedef __int128 wide;
+__extension__ typedef unsigned __int128 uwide;
+
+/** Terms are kept within ±INT64_MAX, so that negating one never overflows. */
+static int fits(wide x) {
+  return x >= -INT64_MAX && x <= INT64_MAX;
+}
+
+static uwide magnitude(wide x) {
+  return x < 0 ? -(uwide) x : (uwide) x;
+}
+
+static int trailing_zeros(uwide x) {
+  uint64_t low = (uint64_t) x;
+  return low != 0 ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t) (x >> 64));
+}
+
+static uwide wide_gcd(uwide a, uwide b) {
+  if (a == 0 || b == 0) {
+    return a | b;
+  }
+
+  int shift = trailing_zeros(a | b);
+  a >>= trailing_zeros(a);
+
+  while (b != 0) {
+    b >>= trailing_zeros(b);
+
+    if (a > b) {
+      uwide t = a;
+      a = b;
+      b = t;
+    }
+
+    b -= a;
+  }
+
+  return a << shift;
+}
+
+uint64_t binary_gcd(uint64_t a, uint64_t b) {
+  if (a == 0 || b == 0) {
+    return a | b;
+  }
+
+  int shift = __builtin_ctzll(a | b);
+  a >>= __builtin_ctzll(a);
+
+  while (b != 0) {
+    b >>= __builtin_ctzll(b);
+
+    if (a > b) {
+      uint64_t t = a;
+      a = b;
+      b = t;
+    }
+
+    b -= a;
+  }
+
+  return a << shift;
+}
+
+/** Write a result back into the accumulator, reducing it first only if it does not fit as it is. */
+static void store(struct LispDatum* acc, wide num, wide den) {
+  if (!fits(num) || !fits(den)) {
+    wide g = (wide) wide_gcd(magnitude(num), magnitude(den));
+    num /= g;
+    den /= g;
+  }
+
+  if (!fits(num) || !fits(den)) {
+    acc->type = Real;
+    acc->float_val = (double) num / (double) den;
+    return;
+  }
+
+  acc->num = (int64_t) num;
+  acc->den = (int64_t) den;
+}
+
+int rational_normalize(struct LispDatum* x) {
+  if (x->den == 0) {
+    return -1;
+  }
+
+  int64_t g = (int64_t) binary_gcd(magnitude(x->num), magnitude(x->den));
+  if (g != 1) {
+    x->num /= g;
+    x->den /= g;
+  }
+
+  // Ensure the numerator contains the sign.
+  if (x->den < 0) {
+    x->num = -x->num;
+    x->den = -x->den;
+  }
+
+  return 0;
+}
+
+void rational_add(struct LispDatum* acc, const struct LispDatum* x) {
+  // Sums of values with the same denominator (including integers promoted to rationals) skip the cross multiplication.
+  if (acc->den == x->den) {
+    store(acc, (wide) acc->num + x->num, acc->den);
+  } else {
+    store(acc, (wide) acc->num * x->den + (wide) x->num * acc->den, (wide) acc->den * x->den);
+  }
+}
+
+void rational_subtract(struct LispDatum* acc, const struct LispDatum* x) {
+  if (acc->den == x->den) {
+    store(acc, (wide) acc->num - x->num, acc->den);
+  } else {
+    store(acc, (wide) acc->num * x->den - (wide) x->num * acc->den, (wide) acc->den * x->den);
+  }
+}
+
+void rational_multiply(struct LispDatum* acc, const struct LispDatum* x) {
+  store(acc, (wide) acc->num * x->num, (wide) acc->den * x->den);
+}
+
+void rational_divide(struct LispDatum* acc, const struct LispDatum* x) {
+  store(acc, (wide) acc->num * x->den, (wide) acc->den * x->num);
+}
+
+int rational_compare(const struct LispDatum* a, const struct LispDatum* b) {
+  // Denominators are positive, so cross multiplying preserves the ordering.
+  wide left = (wide) a->num * b->den;
+  wide right = (wide) b->num * a->den;
+  return left == right ? 0 : left > right ? 1 : -1;
+}
@@ -0,0 +1,36 @@
+#ifndef LISP_RATIONAL_H
+#define LISP_RATIONAL_H
+
+#include <stdint.h>
+#include "data.h"
+
+/*
+ * Rational arithmetic on 64 bit terms. Each operation computes its result with 128 bit intermediates, so no single step
+ * can overflow. Results are only reduced when they would not otherwise fit back into 64 bit terms, which lets a fold over
+ * many rationals skip the GCD on most steps and normalize once at the end (see `box_number`). A result that still does
+ * not fit once reduced is turned into a real.
+ *
+ * The accumulators passed to these functions may hold unreduced terms with a denominator of either sign, but must not
+ * have a zero denominator. The other operand is always expected to be normalized.
+ */
+
+/** Greatest common divisor, by Stein's binary algorithm. */
+uint64_t binary_gcd(uint64_t a, uint64_t b);
+
+/**
+ * Bring a rational into lowest terms with a positive denominator.
+ * @return 0 on success, or -1 if the denominator is 0.
+ */
+int rational_normalize(struct LispDatum* x);
+
+void rational_add(struct LispDatum* acc, const struct LispDatum* x);
+void rational_subtract(struct LispDatum* acc, const struct LispDatum* x);
+void rational_multiply(struct LispDatum* acc, const struct LispDatum* x);
+
+/** The divisor must not be 0. */
+void rational_divide(struct LispDatum* acc, const struct LispDatum* x);
+
+/** Exact comparison of two normalized rationals, by cross multiplication. */
+int rational_compare(const struct LispDatum* a, const struct LispDatum* b);
+
+#endif //LISP_RATIONAL_H
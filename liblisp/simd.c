@@ -0,0 +1,285 @@
+#include "simd.h"
+
+#ifdef LISP_SIMD_X86
+#include <immintrin.h>
+#endif
+
+static int ordering_i32(int32_t a, int32_t b) {
+  return a < b ? LISP_ORDER_LESS : a > b ? LISP_ORDER_GREATER : LISP_ORDER_EQUAL;
+}
+
+static int ordering_f64(double a, double b) {
+  // Matches `numeric_compare`, where anything that is neither equal nor greater (i.e. NaN) is less.
+  return a == b ? LISP_ORDER_EQUAL : a > b ? LISP_ORDER_GREATER : LISP_ORDER_LESS;
+}
+
+// Scalar implementations, which also finish off whatever is left over after the last full vector.
+
+static int64_t sum_i32_scalar(const int32_t* x, uint32_t n) {
+  int64_t sum = 0;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    sum += x[i];
+  }
+
+  return sum;
+}
+
+static double sum_f64_scalar(const double* x, uint32_t n) {
+  double sum = 0;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    sum += x[i];
+  }
+
+  return sum;
+}
+
+static double product_f64_scalar(const double* x, uint32_t n) {
+  double product = 1;
+
+  for (uint32_t i = 0; i < n; ++i) {
+    product *= x[i];
+  }
+
+  return product;
+}
+
+static int ordered_i32_scalar(const int32_t* x, uint32_t n, int accepted) {
+  for (uint32_t i = 0; i + 1 < n; ++i) {
+    if (!(accepted & ordering_i32(x[i], x[i + 1]))) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+static int ordered_f64_scalar(const double* x, uint32_t n, int accepted) {
+  for (uint32_t i = 0; i + 1 < n; ++i) {
+    if (!(accepted & ordering_f64(x[i], x[i + 1]))) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+#ifdef LISP_SIMD_X86
+
+// SSE2 is always available on x86-64, but has to be checked for on 32 bit targets.
+
+__attribute__((target("sse2")))
+static int64_t sum_i32_sse2(const int32_t* x, uint32_t n) {
+  __m128i total = _mm_setzero_si128();
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    // Sign extend each lane to 64 bits by interleaving it with its sign.
+    __m128i v = _mm_loadu_si128((const __m128i*) (x + i));
+    __m128i sign = _mm_cmpgt_epi32(_mm_setzero_si128(), v);
+    total = _mm_add_epi64(total, _mm_unpacklo_epi32(v, sign));
+    total = _mm_add_epi64(total, _mm_unpackhi_epi32(v, sign));
+  }
+
+  int64_t lanes[2];
+  _mm_storeu_si128((__m128i*) lanes, total);
+  return lanes[0] + lanes[1] + sum_i32_scalar(x + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static int64_t sum_i32_avx2(const int32_t* x, uint32_t n) {
+  __m256i total = _mm256_setzero_si256();
+  uint32_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    __m256i low = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*) (x + i)));
+    __m256i high = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*) (x + i + 4)));
+    total = _mm256_add_epi64(total, _mm256_add_epi64(low, high));
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256((__m256i*) lanes, total);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum_i32_scalar(x + i, n - i);
+}
+
+// Reals are reduced into two independent accumulators, so that consecutive additions don't wait on each other.
+
+__attribute__((target("sse2")))
+static double sum_f64_sse2(const double* x, uint32_t n) {
+  __m128d a = _mm_setzero_pd();
+  __m128d b = _mm_setzero_pd();
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    a = _mm_add_pd(a, _mm_loadu_pd(x + i));
+    b = _mm_add_pd(b, _mm_loadu_pd(x + i + 2));
+  }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(a, b));
+  return lanes[0] + lanes[1] + sum_f64_scalar(x + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static double sum_f64_avx2(const double* x, uint32_t n) {
+  __m256d a = _mm256_setzero_pd();
+  __m256d b = _mm256_setzero_pd();
+  uint32_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    a = _mm256_add_pd(a, _mm256_loadu_pd(x + i));
+    b = _mm256_add_pd(b, _mm256_loadu_pd(x + i + 4));
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(a, b));
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sum_f64_scalar(x + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static double product_f64_sse2(const double* x, uint32_t n) {
+  __m128d a = _mm_set1_pd(1);
+  __m128d b = _mm_set1_pd(1);
+  uint32_t i = 0;
+
+  for (; i + 4 <= n; i += 4) {
+    a = _mm_mul_pd(a, _mm_loadu_pd(x + i));
+    b = _mm_mul_pd(b, _mm_loadu_pd(x + i + 2));
+  }
+
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_mul_pd(a, b));
+  return lanes[0] * lanes[1] * product_f64_scalar(x + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static double product_f64_avx2(const double* x, uint32_t n) {
+  __m256d a = _mm256_set1_pd(1);
+  __m256d b = _mm256_set1_pd(1);
+  uint32_t i = 0;
+
+  for (; i + 8 <= n; i += 8) {
+    a = _mm256_mul_pd(a, _mm256_loadu_pd(x + i));
+    b = _mm256_mul_pd(b, _mm256_loadu_pd(x + i + 4));
+  }
+
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_mul_pd(a, b));
+  return lanes[0] * lanes[1] * lanes[2] * lanes[3] * product_f64_scalar(x + i, n - i);
+}
+
+// Chained comparisons compare each vector of values against the same vector shifted along by one. A lane passes if its
+//  ordering is one of those accepted, which is worked out by masking each ordering with whether it is accepted.
+
+__attribute__((target("sse2")))
+static int ordered_i32_sse2(const int32_t* x, uint32_t n, int accepted) {
+  __m128i less = _mm_set1_epi32(accepted & LISP_ORDER_LESS ? -1 : 0);
+  __m128i equal = _mm_set1_epi32(accepted & LISP_ORDER_EQUAL ? -1 : 0);
+  __m128i greater = _mm_set1_epi32(accepted & LISP_ORDER_GREATER ? -1 : 0);
+  uint32_t i = 0;
+
+  for (; i + 4 < n; i += 4) {
+    __m128i a = _mm_loadu_si128((const __m128i*) (x + i));
+    __m128i b = _mm_loadu_si128((const __m128i*) (x + i + 1));
+    __m128i passed = _mm_or_si128(_mm_and_si128(_mm_cmplt_epi32(a, b), less),
+                                  _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi32(a, b), equal),
+                                               _mm_and_si128(_mm_cmpgt_epi32(a, b), greater)));
+
+    if (_mm_movemask_epi8(passed) != 0xFFFF) {
+      return 0;
+    }
+  }
+
+  return ordered_i32_scalar(x + i, n - i, accepted);
+}
+
+__attribute__((target("avx2")))
+static int ordered_i32_avx2(const int32_t* x, uint32_t n, int accepted) {
+  __m256i less = _mm256_set1_epi32(accepted & LISP_ORDER_LESS ? -1 : 0);
+  __m256i equal = _mm256_set1_epi32(accepted & LISP_ORDER_EQUAL ? -1 : 0);
+  __m256i greater = _mm256_set1_epi32(accepted & LISP_ORDER_GREATER ? -1 : 0);
+  uint32_t i = 0;
+
+  for (; i + 8 < n; i += 8) {
+    __m256i a = _mm256_loadu_si256((const __m256i*) (x + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*) (x + i + 1));
+    __m256i passed = _mm256_or_si256(_mm256_and_si256(_mm256_cmpgt_epi32(b, a), less),
+                                     _mm256_or_si256(_mm256_and_si256(_mm256_cmpeq_epi32(a, b), equal),
+                                                     _mm256_and_si256(_mm256_cmpgt_epi32(a, b), greater)));
+
+    if (_mm256_movemask_epi8(passed) != -1) {
+      return 0;
+    }
+  }
+
+  return ordered_i32_scalar(x + i, n - i, accepted);
+}
+
+__attribute__((target("sse2")))
+static int ordered_f64_sse2(const double* x, uint32_t n, int accepted) {
+  __m128d less = _mm_castsi128_pd(_mm_set1_epi32(accepted & LISP_ORDER_LESS ? -1 : 0));
+  __m128d equal = _mm_castsi128_pd(_mm_set1_epi32(accepted & LISP_ORDER_EQUAL ? -1 : 0));
+  __m128d greater = _mm_castsi128_pd(_mm_set1_epi32(accepted & LISP_ORDER_GREATER ? -1 : 0));
+  uint32_t i = 0;
+
+  for (; i + 2 < n; i += 2) {
+    __m128d a = _mm_loadu_pd(x + i);
+    __m128d b = _mm_loadu_pd(x + i + 1);
+    __m128d eq = _mm_cmpeq_pd(a, b);
+    __m128d gt = _mm_cmpgt_pd(a, b);
+    __m128d passed = _mm_or_pd(_mm_andnot_pd(_mm_or_pd(eq, gt), less),
+                               _mm_or_pd(_mm_and_pd(eq, equal), _mm_and_pd(gt, greater)));
+
+    if (_mm_movemask_pd(passed) != 0x3) {
+      return 0;
+    }
+  }
+
+  return ordered_f64_scalar(x + i, n - i, accepted);
+}
+
+__attribute__((target("avx2")))
+static int ordered_f64_avx2(const double* x, uint32_t n, int accepted) {
+  __m256d less = _mm256_castsi256_pd(_mm256_set1_epi32(accepted & LISP_ORDER_LESS ? -1 : 0));
+  __m256d equal = _mm256_castsi256_pd(_mm256_set1_epi32(accepted & LISP_ORDER_EQUAL ? -1 : 0));
+  __m256d greater = _mm256_castsi256_pd(_mm256_set1_epi32(accepted & LISP_ORDER_GREATER ? -1 : 0));
+  uint32_t i = 0;
+
+  for (; i + 4 < n; i += 4) {
+    __m256d a = _mm256_loadu_pd(x + i);
+    __m256d b = _mm256_loadu_pd(x + i + 1);
+    __m256d eq = _mm256_cmp_pd(a, b, _CMP_EQ_OQ);
+    __m256d gt = _mm256_cmp_pd(a, b, _CMP_GT_OQ);
+    __m256d passed = _mm256_or_pd(_mm256_andnot_pd(_mm256_or_pd(eq, gt), less),
+                                  _mm256_or_pd(_mm256_and_pd(eq, equal), _mm256_and_pd(gt, greater)));
+
+    if (_mm256_movemask_pd(passed) != 0xF) {
+      return 0;
+    }
+  }
+
+  return ordered_f64_scalar(x + i, n - i, accepted);
+}
+
+#endif
+
+int64_t simd_sum_i32(const int32_t* x, uint32_t n) {
+  return LISP_SIMD_SELECT(sum_i32)(x, n);
+}
+
+double simd_sum_f64(const double* x, uint32_t n) {
+  return LISP_SIMD_SELECT(sum_f64)(x, n);
+}
+
+double simd_product_f64(const double* x, uint32_t n) {
+  return LISP_SIMD_SELECT(product_f64)(x, n);
+}
+
+int simd_ordered_i32(const int32_t* x, uint32_t n, int accepted) {
+  return LISP_SIMD_SELECT(ordered_i32)(x, n, accepted);
+}
+
+int simd_ordered_f64(const double* x, uint32_t n, int accepted) {
+  return LISP_SIMD_SELECT(ordered_f64)(x, n, accepted);
+}
@@ -0,0 +1,39 @@
+#ifndef LISP_SIMD_H
+#define LISP_SIMD_H
+
+#include <stdint.h>
+#include "numeric.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define LISP_SIMD_X86
+#endif
+
+/*
+ * Reductions over contiguous buffers of numbers, used when every argument to a variadic numeric native has the same
+ * type (see numeric.c). On x86 each of these picks an AVX2 or SSE2 implementation at runtime, depending on what the CPU
+ * supports. Everywhere else, they fall back to plain loops.
+ */
+
+/** Sum of `n` integers. Lanes are 64 bits wide, so this never overflows. */
+int64_t simd_sum_i32(const int32_t* x, uint32_t n);
+
+/** Sum and product of `n` doubles. The terms are combined in a different order than a left to right fold would. */
+double simd_sum_f64(const double* x, uint32_t n);
+double simd_product_f64(const double* x, uint32_t n);
+
+/** Whether every adjacent pair in `x` compares with one of the `accepted` orderings. NaN compares as less. */
+int simd_ordered_i32(const int32_t* x, uint32_t n, int accepted);
+int simd_ordered_f64(const double* x, uint32_t n, int accepted);
+
+/**
+ * The widest implementation of a kernel that the CPU supports, out of `<name>_avx2`, `<name>_sse2`, and
+ * `<name>_scalar`. Only the scalar implementation needs to exist on other architectures.
+ */
+#ifdef LISP_SIMD_X86
+#define LISP_SIMD_SELECT(name) \
+  (__builtin_cpu_supports("avx2") ? name##_avx2 : __builtin_cpu_supports("sse2") ? name##_sse2 : name##_scalar)
+#else
+#define LISP_SIMD_SELECT(name) name##_scalar
+#endif
+
+#endif //LISP_SIMD_H
@@ -0,0 +1,53 @@
+#include <stdlib.h>
+#include "data.h"
+#include "state.h"
+
+_Thread_local struct LispState* LispCurrentState = NULL;
+
+static _Thread_local struct LispState DefaultState = {.error = None, .error_behavior = LogOnly, .detect_cycles = 1};
+
+struct LispState* lisp_state_default(void) {
+  LispCurrentState = &DefaultState;
+  return LispCurrentState;
+}
+
+struct LispState* lisp_state_new(void) {
+  struct LispState* state = calloc(1, sizeof(struct LispState));
+
+  if (state == NULL) {
+    return raise(Generic, "Unable to allocate memory.");
+  }
+
+  state->error = None;
+  state->error_behavior = LogOnly;
+  state->detect_cycles = 1;
+  return state;
+}
+
+void lisp_state_destroy(struct LispState* state) {
+  if (state == NULL) {
+    return;
+  }
+
+  // Teardown has to happen under the state being destroyed, since releases and finalizers act on the current state.
+  struct LispState* previous = lisp_state_bind(state);
+
+  flush_releases();
+  walk_stack_free(&state->doomed);
+  port_close(&state->standard_output);
+
+#ifdef LISP_TRACING_GC
+  destroy_heap(&state->heap);
+#endif
+
+  destroy_arena(&state->arena);
+
+  lisp_state_bind(previous == state ? NULL : previous);
+  free(state);
+}
+
+struct LispState* lisp_state_bind(struct LispState* state) {
+  struct LispState* previous = lisp_state_current();
+  LispCurrentState = state != NULL ? state : &DefaultState;
+  return previous;
+}
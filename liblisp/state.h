@@ -0,0 +1,85 @@
+#ifndef LISP_STATE_H
+#define LISP_STATE_H
+
+#include <stdint.h>
+#include "alloc.h"
+#include "err.h"
+#include "gc.h"
+#include "port.h"
+#include "walk.h"
+
+struct LispDatum;
+
+#define LISP_DEFERRED_RELEASE_CAPACITY 256
+
+/**
+ * Everything the runtime would otherwise keep in global variables. Each state is an independent heap with its own error
+ * state, so separate threads running under separate states never contend with one another.
+ *
+ * Natives always operate on the state bound to the calling thread. Every thread starts out bound to a default state of
+ * its own, so programs that never create a state work as if there were just one. Datums belong to the state that
+ * allocated them and must not be handed to another one, with the exception of statically allocated values (nil, the
+ * booleans, and small integers), which are immutable and shared by every state.
+ *
+ * The fields are only exposed so that the runtime can reach them cheaply, and should not be touched by client code.
+ */
+struct LispState {
+  struct Arena arena;
+
+#ifdef LISP_TRACING_GC
+  struct Heap heap;
+#endif
+
+  struct LispDatum* deferred[LISP_DEFERRED_RELEASE_CAPACITY];
+  uint32_t deferred_count;
+
+  /** Datums waiting to be destroyed, while `destroying` is set (see `destroy_datum`). */
+  struct WalkStack doomed;
+  int destroying;
+
+  enum Cause error;
+  enum ErrorBehavior error_behavior;
+
+  /** Whether `display` watches for cycles from the start, rather than only once it has run out of fuel (see walk.h). */
+  int detect_cycles;
+
+  /** Innermost installed handler, or NULL if a raise should fall back on the error behavior. */
+  struct LispHandler* handlers;
+
+  /** Where `display` and `format` write to. NULL for `standard_output`, which is only opened once first written to. */
+  struct LispPort* output;
+  struct LispPort standard_output;
+};
+
+/** Create a state with nothing allocated yet. Errors are logged without quitting, as with the default state. */
+struct LispState* lisp_state_new(void);
+
+/**
+ * Free a state, returning its arena to the system at once, so that every datum and small buffer allocated under it
+ * becomes invalid. Buffers larger than `LISP_ALLOC_MAX_SMALL` (list chunks, vector items, hash tables, and the like)
+ * come straight from malloc, and are only freed along with the values that own them. With reference counting, values
+ * still referenced when the state is destroyed are never released, so release them first to avoid leaking those
+ * buffers. The tracing collector finalizes every value it manages on destruction, so nothing is leaked in that build.
+ * If the state is bound to the calling thread, the thread goes back to its default state.
+ */
+void lisp_state_destroy(struct LispState* state);
+
+/**
+ * Bind a state to the calling thread, so that everything the thread does from now on uses it. A state must only be bound
+ * to one thread at a time. Passing NULL restores the thread's default state.
+ * @return the state that was previously bound.
+ */
+struct LispState* lisp_state_bind(struct LispState* state);
+
+/** Bind the calling thread to its default state and return it. Use `lisp_state_current` instead. */
+struct LispState* lisp_state_default(void);
+
+extern _Thread_local struct LispState* LispCurrentState;
+
+/** The state bound to the calling thread. */
+static inline struct LispState* lisp_state_current(void) {
+  struct LispState* state = LispCurrentState;
+  return state != NULL ? state : lisp_state_default();
+}
+
+#endif //LISP_STATE_H
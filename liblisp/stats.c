@@ -0,0 +1,237 @@
+#define _POSIX_C_SOURCE 200809L
+
+// The C library's `raise` is renamed out of the way of the runtime's own (see err.h).
+#define raise c_raise
+#include <signal.h>
+#undef raise
+
+#include "stats.h"
+
+#ifdef LISP_STATS
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "numfmt.h"
+
+_Thread_local struct LispStats* LispCurrentStats = NULL;
+
+/** Every block ever registered. Blocks are only ever pushed, and never freed, so readers can walk it without a lock. */
+static _Atomic(struct LispStats*) all_stats = NULL;
+
+static pthread_once_t installed = PTHREAD_ONCE_INIT;
+
+/** Where reports go, decided once so that the signal handler doesn't have to look at the environment. */
+static int report_fd = STDERR_FILENO;
+
+static const char* const TYPE_NAMES[LISP_STATS_TYPES] = {
+    [Integer] = "integer", [BigInt] = "bigint", [Rational] = "rational", [Real] = "real", [Complex] = "complex",
+    [String] = "string", [Symbol] = "symbol", [Keyword] = "keyword", [Bool] = "bool", [Cons] = "cons",
+    [Vector] = "vector", [HashMap] = "hash-map", [I32Array] = "i32-array", [F64Array] = "f64-array",
+    [C128Array] = "c128-array", [Closure] = "closure", [Nil] = "nil"
+};
+
+#define LISP_STATS_NATIVE_NAME(NAME, LISP_NAME) LISP_NAME,
+
+static const char* const NATIVE_NAMES[LISP_STATS_NATIVE_COUNT] = {LISP_STATS_NATIVES(LISP_STATS_NATIVE_NAME)};
+
+// The same names as the condition keywords.
+static const char* const CAUSE_NAMES[LISP_STATS_CAUSES] = {
+    [None] = "none", [Type] = "type", [Argument] = "argument", [ZeroDivision] = "zero-division", [Math] = "math",
+    [Generic] = "generic"
+};
+
+static void report_on_signal(int signal) {
+  (void) signal;
+  int saved = errno;
+  lisp_stats_report(report_fd);
+  errno = saved;
+}
+
+static void report_on_exit(void) {
+  lisp_stats_report(report_fd);
+}
+
+static void install(void) {
+  const char* path = getenv("LISP_STATS_FILE");
+
+  if (path != NULL) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+
+    if (fd >= 0) {
+      report_fd = fd;
+    }
+  }
+
+  // A handler the program installed itself takes priority.
+  struct sigaction previous;
+
+  if (sigaction(SIGUSR1, NULL, &previous) == 0 && previous.sa_handler == SIG_DFL) {
+    struct sigaction action = {0};
+    action.sa_handler = report_on_signal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGUSR1, &action, NULL);
+  }
+
+  atexit(report_on_exit);
+}
+
+struct LispStats* lisp_stats_register(void) {
+  pthread_once(&installed, install);
+
+  struct LispStats* stats = calloc(1, sizeof(struct LispStats));
+
+  // Not raised, since counting the raise would come straight back here.
+  if (stats == NULL) {
+    fprintf(stderr, "Unable to allocate memory for stats.\n");
+    exit(-1);
+  }
+
+  stats->next = atomic_load(&all_stats);
+
+  while (!atomic_compare_exchange_weak(&all_stats, &stats->next, stats)) {}
+
+  LispCurrentStats = stats;
+  return stats;
+}
+
+static void add_counters(_Atomic uint64_t* total, _Atomic uint64_t* counters, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    lisp_stats_bump(&total[i], atomic_load_explicit(&counters[i], memory_order_relaxed));
+  }
+}
+
+#define COUNTERS(field) (sizeof(field) / sizeof(_Atomic uint64_t))
+
+void lisp_stats_collect(struct LispStats* totals) {
+  *totals = (struct LispStats) {0};
+
+  for (struct LispStats* stats = atomic_load(&all_stats); stats != NULL; stats = stats->next) {
+    add_counters(totals->allocations, stats->allocations, COUNTERS(stats->allocations));
+    add_counters(totals->bytes, stats->bytes, COUNTERS(stats->bytes));
+    add_counters(totals->calls, stats->calls, COUNTERS(stats->calls));
+    add_counters(&totals->promotions[0][0], &stats->promotions[0][0], COUNTERS(stats->promotions));
+    add_counters(totals->raises, stats->raises, COUNTERS(stats->raises));
+  }
+}
+
+/** Output buffered on the stack, since stdio can't be used from a signal handler. */
+struct Report {
+  int fd;
+  uint32_t length;
+  char buffer[1024];
+};
+
+static void report_flush(struct Report* report) {
+  const char* pending = report->buffer;
+  size_t remaining = report->length;
+
+  while (remaining > 0) {
+    ssize_t written = write(report->fd, pending, remaining);
+
+    if (written < 0 && errno == EINTR) {
+      continue;
+    } else if (written <= 0) {
+      break;
+    }
+
+    pending += written;
+    remaining -= (size_t) written;
+  }
+
+  report->length = 0;
+}
+
+static void report_write(struct Report* report, const char* s) {
+  for (; *s != '\0'; ++s) {
+    if (report->length == sizeof(report->buffer)) {
+      report_flush(report);
+    }
+
+    report->buffer[report->length++] = *s;
+  }
+}
+
+static void report_count(struct Report* report, const char* name, uint64_t count, int first) {
+  char digits[LISP_INT_CHARS + 1];
+  digits[format_uint64(count, digits)] = '\0';
+
+  report_write(report, first ? "\"" : ",\"");
+  report_write(report, name);
+  report_write(report, "\":");
+  report_write(report, digits);
+}
+
+/** A JSON object mapping each name to its counter. Zeros are left out if `sparse` is set. */
+static void report_object(struct Report* report, const char* key, const char* const* names,
+                          _Atomic uint64_t* counters, size_t count, int sparse) {
+  int first = 1;
+
+  report_write(report, "\"");
+  report_write(report, key);
+  report_write(report, "\":{");
+
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t n = atomic_load_explicit(&counters[i], memory_order_relaxed);
+
+    if (!sparse || n != 0) {
+      report_count(report, names[i], n, first);
+      first = 0;
+    }
+  }
+
+  report_write(report, "}");
+}
+
+void lisp_stats_report(int fd) {
+  struct LispStats totals;
+  lisp_stats_collect(&totals);
+
+  struct Report report;
+  report.fd = fd;
+  report.length = 0;
+
+  report_write(&report, "{");
+  report_object(&report, "allocations", TYPE_NAMES, totals.allocations, LISP_STATS_TYPES, 0);
+  report_write(&report, ",");
+  report_object(&report, "bytes", TYPE_NAMES, totals.bytes, LISP_STATS_TYPES, 0);
+  report_write(&report, ",");
+  report_object(&report, "calls", NATIVE_NAMES, totals.calls, LISP_STATS_NATIVE_COUNT, 1);
+
+  // Promotions are keyed by both of their types, as in "integer->rational".
+  report_write(&report, ",\"promotions\":{");
+  int first = 1;
+
+  for (int from = 0; from < LISP_STATS_TYPES; ++from) {
+    for (int to = 0; to < LISP_STATS_TYPES; ++to) {
+      uint64_t n = atomic_load_explicit(&totals.promotions[from][to], memory_order_relaxed);
+
+      if (n != 0) {
+        char name[64] = {0};
+        strcat(name, TYPE_NAMES[from]);
+        strcat(name, "->");
+        strcat(name, TYPE_NAMES[to]);
+        report_count(&report, name, n, first);
+        first = 0;
+      }
+    }
+  }
+
+  report_write(&report, "},");
+  report_object(&report, "raises", CAUSE_NAMES, totals.raises, LISP_STATS_CAUSES, 0);
+  report_write(&report, "}\n");
+  report_flush(&report);
+}
+
+#else
+
+void lisp_stats_report(int fd) {
+  (void) fd;
+}
+
+#endif
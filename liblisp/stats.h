@@ -0,0 +1,122 @@
+#ifndef LISP_STATS_H
+#define LISP_STATS_H
+
+#include <stdint.h>
+#include "data.h"
+#include "err.h"
+
+/*
+ * Counters for profiling what a program asks of the runtime, enabled by building with the LISP_STATS CMake option. They
+ * record datums allocated and their bytes by type, calls to each native, each step taken by numeric promotion, and raised
+ * conditions by cause.
+ *
+ * Every thread counts into a block of its own, so counting never contends. The blocks outlive their threads and are
+ * added together whenever a report is written, which happens once the program exits and whenever it receives SIGUSR1.
+ * Reports are written to stderr, or appended to the file named by the LISP_STATS_FILE environment variable, as a single
+ * line of JSON.
+ *
+ * Without LISP_STATS, the hooks below compile to nothing.
+ */
+
+/** Every native the runtime provides, by the name of its C function and its Lisp name. */
+#define LISP_STATS_NATIVES(X) \
+  X(add, "+") X(subtract, "-") X(multiply, "*") X(divide, "/") X(division, "div") X(mod, "mod") \
+  X(format, "format") X(flush_output, "flush-output") X(signal_error, "error") \
+  X(eqv, "eqv") X(equal, "equal?") X(less_than, "<") X(greater_than, ">") X(num_equals, "=") \
+  X(less_than_eql, "<=") X(greater_than_eql, ">=") X(logical_and, "and") X(logical_or, "or") X(logical_not, "not") \
+  X(list, "list") X(car, "car") X(cdr, "cdr") X(length, "length") X(cons, "cons") X(append, "append") \
+  X(reverse, "reverse") X(set_car, "set-car!") X(set_cdr, "set-cdr!") X(apply, "apply") \
+  X(string_append, "string-append") \
+  X(vector, "vector") X(vector_length, "vector-length") X(vector_ref, "vector-ref") X(vector_set, "vector-set!") \
+  X(vector_push, "vector-push!") X(vector_slice, "vector-slice") X(vector_to_list, "vector->list") \
+  X(list_to_vector, "list->vector") \
+  X(hash_map, "hash-map") X(hash_get, "hash-get") X(hash_contains, "hash-contains?") X(hash_put, "hash-put!") \
+  X(hash_remove, "hash-remove!") X(hash_count, "hash-count") X(hash_keys, "hash-keys") X(hash_values, "hash-values") \
+  X(hash_to_list, "hash->list") \
+  X(i32_array, "i32-array") X(f64_array, "f64-array") X(c128_array, "c128-array") \
+  X(list_to_i32_array, "list->i32-array") X(list_to_f64_array, "list->f64-array") \
+  X(list_to_c128_array, "list->c128-array") X(array_to_list, "array->list") X(array_length, "array-length") \
+  X(array_ref, "array-ref") X(array_add, "array+") X(array_subtract, "array-") X(array_multiply, "array*") \
+  X(array_divide, "array/") X(array_dot, "array-dot") X(array_sum, "array-sum") X(array_min, "array-min") \
+  X(array_max, "array-max") X(save_image, "save-image") X(load_image, "load-image")
+
+#define LISP_STATS_NATIVE_ID(NAME, LISP_NAME) LispStats_##NAME,
+
+enum LispStatsNative {
+  LISP_STATS_NATIVES(LISP_STATS_NATIVE_ID)
+  LISP_STATS_NATIVE_COUNT
+};
+
+#undef LISP_STATS_NATIVE_ID
+
+#define LISP_STATS_TYPES (Nil + 1)
+#define LISP_STATS_CAUSES (Generic + 1)
+
+#ifdef LISP_STATS
+
+#include <stdatomic.h>
+
+/** One thread's counters. Atomic only so that a report taken from another thread never reads a torn value. */
+struct LispStats {
+  _Atomic uint64_t allocations[LISP_STATS_TYPES];
+  _Atomic uint64_t bytes[LISP_STATS_TYPES];
+  _Atomic uint64_t calls[LISP_STATS_NATIVE_COUNT];
+
+  /** Indexed by the type promoted from, then the type promoted to. */
+  _Atomic uint64_t promotions[LISP_STATS_TYPES][LISP_STATS_TYPES];
+  _Atomic uint64_t raises[LISP_STATS_CAUSES];
+
+  struct LispStats* next;
+};
+
+extern _Thread_local struct LispStats* LispCurrentStats;
+
+/** Create the calling thread's block. Use `lisp_stats_current` instead. */
+struct LispStats* lisp_stats_register(void);
+
+static inline struct LispStats* lisp_stats_current(void) {
+  struct LispStats* stats = LispCurrentStats;
+  return stats != NULL ? stats : lisp_stats_register();
+}
+
+/** Only the owning thread ever writes a counter, so there is no need for the cost of an atomic add. */
+static inline void lisp_stats_bump(_Atomic uint64_t* counter, uint64_t n) {
+  atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline void lisp_stats_allocated(enum LispDataType type, uint64_t size) {
+  struct LispStats* stats = lisp_stats_current();
+  lisp_stats_bump(&stats->allocations[type], 1);
+  lisp_stats_bump(&stats->bytes[type], size);
+}
+
+/** A datum of `type` was created, taking up `size` bytes including anything it owned from the start. */
+#define LISP_STATS_ALLOC(type, size) lisp_stats_allocated((type), (size))
+
+/** Placed at the top of whichever function does the work of a native, so that each call is counted exactly once. */
+#define LISP_STATS_CALL(NAME) lisp_stats_bump(&lisp_stats_current()->calls[LispStats_##NAME], 1)
+
+/** A number took a single step up the numeric tower. */
+#define LISP_STATS_PROMOTE(from, to) lisp_stats_bump(&lisp_stats_current()->promotions[from][to], 1)
+
+#define LISP_STATS_RAISE(cause) lisp_stats_bump(&lisp_stats_current()->raises[cause], 1)
+
+/** Add up the counters of every thread so far into `totals`. */
+void lisp_stats_collect(struct LispStats* totals);
+
+#else
+
+#define LISP_STATS_ALLOC(type, size) ((void) 0)
+#define LISP_STATS_CALL(NAME) ((void) 0)
+#define LISP_STATS_PROMOTE(from, to) ((void) 0)
+#define LISP_STATS_RAISE(cause) ((void) 0)
+
+#endif
+
+/**
+ * Write a report of the counters of every thread so far to a file descriptor. Only makes async-signal-safe calls, so it
+ * may be called from a signal handler. Writes nothing without LISP_STATS.
+ */
+void lisp_stats_report(int fd);
+
+#endif //LISP_STATS_H
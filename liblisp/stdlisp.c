@@ -2,8 +2,23 @@
 #include <stdlib.h>
 #include <string.h>
 #include "stdlisp.h"
+#include "alloc.h"
+#include "bigint.h"
+#include "closure.h"
 #include "data.h"
 #include "err.h"
+#include "hashmap.h"
+#include "image.h"
+#include "lists.h"
+#include "lstring.h"
+#include "numarray.h"
+#include "numeric.h"
+#include "numfmt.h"
+#include "port.h"
+#include "state.h"
+#include "stats.h"
+#include "vector.h"
+#include "walk.h"
 
 /**
  * Determine if a datum refers to an occupied (not {NULL, NULL}) Cons pair.
@@ -12,59 +27,43 @@ static int is_occupied_node(const struct LispDatum* d) {
   return d != NULL && (d->type == Cons && d->car != NULL);
 }
 
-// TODO(matthew-c21): When garbage collection is added, this sort of behavior should be invoked alongside the gc to
-//    increase reference counts.
-/**
- * Push a new value to the end of a list. Assumes that the given node is already at the end of the list.
+/*
+ * Natives taking a fixed number of arguments are implemented by their direct entry points (see stdlisp.h), and their
+ * variadic forms only check the number of arguments before passing them on. Calls are counted (see stats.h) by the
+ * direct entry points, so that they are counted the same way whichever form is called.
  */
-static void push(struct LispDatum* node, struct LispDatum* value) {
-  if (node == NULL || node->type != Cons || node->cdr != NULL) {
-    set_global_error_behavior(LogAndQuit);
-    raise(Generic, "Fatal programming error occurred causing illegal call to `push`.");
-  }
 
-  // Pushing to an empty node
-  if (node->car == NULL) {
-    node->car = value;
-  } else {
-    node->cdr = malloc(sizeof(struct LispDatum));
-    node->cdr->type = Cons;
-    node->cdr->car = value;
-    node->cdr->cdr = NULL;
-  }
+#define VARIADIC_FORM_1(NAME, LISP_NAME) \
+struct LispDatum* NAME(struct LispDatum** args, uint32_t nargs) { \
+  if (LISP_INVALID(nargs != 1)) { \
+    return raise(Argument, "`" LISP_NAME "` takes a single argument."); \
+  } \
+  return NAME##1(args[0]); \
 }
 
-/**
- * Mutating function for promoting numbers.
- *
- * This function works recursively to promote numbers one step at a time. Going from an integer to a complex number
- * takes longer than going from a real number to a complex number.
- * @param n the number to be promoted.
- * @param type for n to be promoted to.
- */
-void promote(struct LispDatum* n, enum LispDataType type) {
-  if (type <= n->type) return;
+#define VARIADIC_FORM_2(NAME, LISP_NAME) \
+struct LispDatum* NAME(struct LispDatum** args, uint32_t nargs) { \
+  if (LISP_INVALID(nargs != 2)) { \
+    return raise(Argument, "`" LISP_NAME "` takes exactly two arguments."); \
+  } \
+  return NAME##2(args[0], args[1]); \
+}
 
-  switch (n->type) {
-    case Integer:
-      n->type = Rational;
-      n->num = n->int_val;
-      n->den = 1;
-      break;
-    case Rational:
-      n->type = Real;
-      n->float_val = ((double) n->num) / (n->den);
-      break;
-    case Real:
-      n->type = Complex;
-      n->real = n->float_val;
-      n->im = 0;
-      break;
-    default:
-      break;
-  }
+#define VARIADIC_FORM_3(NAME, LISP_NAME) \
+struct LispDatum* NAME(struct LispDatum** args, uint32_t nargs) { \
+  if (LISP_INVALID(nargs != 3)) { \
+    return raise(Argument, "`" LISP_NAME "` takes exactly three arguments."); \
+  } \
+  return NAME##3(args[0], args[1], args[2]); \
+}
 
-  promote(n, type);
+/** Natives with optional arguments dispatch on the number given. */
+#define VARIADIC_FORM_2_3(NAME, LISP_NAME) \
+struct LispDatum* NAME(struct LispDatum** args, uint32_t nargs) { \
+  if (LISP_INVALID(nargs != 2 && nargs != 3)) { \
+    return raise(Argument, "`" LISP_NAME "` takes two or three arguments."); \
+  } \
+  return nargs == 2 ? NAME##2(args[0], args[1]) : NAME##3(args[0], args[1], args[2]); \
 }
 
 /**
@@ -79,6 +78,9 @@ void copy_lisp_datum(const struct LispDatum* source, struct LispDatum* dest) {
     case Integer:
       dest->int_val = source->int_val;
       break;
+    case BigInt:
+      dest->big = source->big;
+      break;
     case Rational:
       dest->num = source->num;
       dest->den = source->den;
@@ -91,18 +93,36 @@ void copy_lisp_datum(const struct LispDatum* source, struct LispDatum* dest) {
       dest->im = source->im;
       break;
     case Symbol:
+    case Keyword:
       dest->label = source->label;
+      dest->hash = source->hash;
       break;
     case Cons:
       dest->car = source->car;
       dest->cdr = source->cdr;
       break;
+    case Vector:
+      dest->items = source->items;
+      dest->length = source->length;
+      dest->capacity = source->capacity;
+      break;
+    case HashMap:
+      dest->table = source->table;
+      break;
+    case I32Array:
+    case F64Array:
+    case C128Array:
+      dest->values = source->values;
+      dest->count = source->count;
+      break;
+    case Closure:
+      dest->closure = source->closure;
+      break;
     case Nil:
       *dest = *get_nil();
       break;
     case String:
-      dest->content = source->content;
-      dest->length = source->length;
+      dest->string = source->string;
       break;
     case Bool:
       dest->boolean = source->boolean;
@@ -115,622 +135,1032 @@ void write_zero(struct LispDatum* x) {
   x->int_val = 0;
 }
 
-/**
- * Fold a function f over the given arguments.
- *
- * This is a utility function aimed at reducing boilerplate for numeric functions that can be evaluated by folding a two
- * argument function across a list of numbers. This function fails immediately if any non-numeric parameters are found.
- * @param args argument list provided to the original function
- * @param nargs number of arguments provided
- * @param acc initial value passed in as the first argument to f.
- * @param f a function pointer that takes two numbers of the same type. The first value should be treated as both an
- * input and output parameter.
- * @return 0 if no errors occur, else -1.
- */
-int iterative_math_function(struct LispDatum** args, uint32_t nargs, struct LispDatum* acc,
-                            void (* f)(struct LispDatum*, const struct LispDatum*)) {
-  if (acc->type > Complex) {
-    return -1;
-  }
+// The following functions fold into an accumulator on the stack, so the only allocation they perform is boxing the
+//  final result (which for small integers is no allocation at all). Big integer accumulators are scratch numbers, and
+//  are discarded once boxed. See numeric.h for the arithmetic itself.
 
-  struct LispDatum intermediate;
+/** Box the final value of an accumulator, and give up whatever it owns. */
+static struct LispDatum* box_scratch(struct LispDatum* acc) {
+  struct LispDatum* result = box_number(acc);
+  discard_scratch(acc);
+  return result;
+}
 
-  for (uint32_t i = 0; i < nargs; ++i) {
-    // Because it's easier to promote mutably and we don't want to modify the incoming arguments, we copy it to the
-    //  intermediate beforehand.
-    copy_lisp_datum(args[i], &intermediate);
+/** Whether the result of an operation on two integers fits in one, so nothing has to be promoted. */
+static int fits_integer(int64_t result) {
+  return result >= INT32_MIN && result <= INT32_MAX;
+}
 
-    if (intermediate.type > Complex) {
-      return -1;
-    }
+/** Apply an operation to two numbers, as the variadic natives do for each argument after the first. */
+static int arithmetic2(struct LispDatum* a, struct LispDatum* b, struct LispDatum* acc, enum LispArithmetic op) {
+  load_scratch(a, acc);
+  return numeric_fold(&b, 1, acc, op);
+}
 
-    // Ensure both values are of the same type.
-    if (intermediate.type > acc->type) {
-      promote(acc, intermediate.type);
-    } else if (intermediate.type < acc->type) {
-      promote(&intermediate, acc->type);
-    }
+struct LispDatum* add(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(add);
+  struct LispDatum acc;
+  write_zero(&acc);
 
-    f(acc, &intermediate);
-    simplify(acc);
+  if (numeric_fold(args, nargs, &acc, LispAdd)) {
+    return raise(Math, "Addition error.");
   }
 
-  return 0;
+  return box_scratch(&acc);
 }
 
-void add_aux(struct LispDatum* acc, const struct LispDatum* intermediate) {
-  switch (acc->type) {
-    case Integer:
-      acc->int_val += intermediate->int_val;
-      break;
-    case Rational:
-      acc->num = intermediate->den * acc->num + acc->den * intermediate->num;
-      acc->den = intermediate->den * acc->den;
-      break;
-    case Real:
-      acc->float_val += intermediate->float_val;
-      break;
-    case Complex:
-      acc->real += intermediate->real;
-      acc->im += intermediate->im;
-      break;
-    default:
-      break;
+struct LispDatum* add2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(add);
+  if (a->type == Integer && b->type == Integer) {
+    int64_t sum = (int64_t) a->int_val + b->int_val;
+
+    if (fits_integer(sum)) {
+      return box_integer((int32_t) sum);
+    }
   }
-}
 
-struct LispDatum* add(struct LispDatum** args, uint32_t nargs) {
-  struct LispDatum* init = new_integer(0);
+  struct LispDatum acc;
 
-  if (iterative_math_function(args, nargs, init, add_aux)) {
+  if (arithmetic2(a, b, &acc, LispAdd)) {
     return raise(Math, "Addition error.");
   }
 
-  return init;
-}
-
-void subtract_aux(struct LispDatum* acc, const struct LispDatum* intermediate) {
-  switch (acc->type) {
-    case Integer:
-      acc->int_val -= intermediate->int_val;
-      break;
-    case Rational:
-      acc->num = intermediate->den * acc->num - acc->den * intermediate->num;
-      acc->den = intermediate->den * acc->den;
-      break;
-    case Real:
-      acc->float_val -= intermediate->float_val;
-      break;
-    case Complex:
-      acc->real -= intermediate->real;
-      acc->im -= intermediate->im;
-      break;
-    default:
-      break;
-  }
+  return box_scratch(&acc);
 }
 
 struct LispDatum* subtract(struct LispDatum** args, uint32_t nargs) {
-  struct LispDatum* init;
+  LISP_STATS_CALL(subtract);
+  struct LispDatum acc;
 
-  if (nargs == 0) {
+  if (LISP_INVALID(nargs == 0)) {
     return raise(Argument, "Too few calls to subtract.");
   } else if (nargs == 1) {
     // The argument needs to be negated, so it is essentially being subtracted from 0.
-    init = new_integer(0);
+    write_zero(&acc);
   } else {
-    init = malloc(sizeof(struct LispDatum));
-    copy_lisp_datum(args[0], init);
+    load_scratch(args[0], &acc);
 
     args = args + 1;  // The first argument does not need to be subtracted from itself.
     nargs -= 1;     // Reduce the number of arguments to compensate.
   }
 
-  if (iterative_math_function(args, nargs, init, subtract_aux)) {
-    free(init);
+  if (numeric_fold(args, nargs, &acc, LispSubtract)) {
     return raise(Math, "Error during subtraction.");
   }
 
-  return init;
+  return box_scratch(&acc);
 }
 
-void multiply_aux(struct LispDatum* acc, const struct LispDatum* intermediate) {
-  double tmp;
-  switch (acc->type) {
-    case Integer:
-      acc->int_val *= intermediate->int_val;
-      break;
-    case Rational:
-      acc->num *= intermediate->num;
-      acc->den *= intermediate->den;
-      break;
-    case Real:
-      acc->float_val *= intermediate->float_val;
-      break;
-    case Complex:
-      tmp = acc->real;
-      acc->real = (tmp * intermediate->real) - (acc->im * intermediate->im);
-      acc->im = (tmp * intermediate->im) + (acc->im * intermediate->real);
-      break;
-    default:
-      break;
+struct LispDatum* subtract2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(subtract);
+  if (a->type == Integer && b->type == Integer) {
+    int64_t difference = (int64_t) a->int_val - b->int_val;
+
+    if (fits_integer(difference)) {
+      return box_integer((int32_t) difference);
+    }
+  }
+
+  struct LispDatum acc;
+
+  if (arithmetic2(a, b, &acc, LispSubtract)) {
+    return raise(Math, "Error during subtraction.");
   }
+
+  return box_scratch(&acc);
 }
 
 struct LispDatum* multiply(struct LispDatum** args, uint32_t nargs) {
-  struct LispDatum* init = new_integer(1);
+  LISP_STATS_CALL(multiply);
+  struct LispDatum acc;
+  acc.type = Integer;
+  acc.int_val = 1;
 
-  if (iterative_math_function(args, nargs, init, multiply_aux)) {
-    free(init);
+  if (numeric_fold(args, nargs, &acc, LispMultiply)) {
     return raise(Math, "Error during multiplication.");
   }
 
-  return init;
+  return box_scratch(&acc);
 }
 
-void divide_aux(struct LispDatum* acc, const struct LispDatum* intermediate) {
-  double d;
-
-  struct LispDatum zero;
-  write_zero(&zero);
+struct LispDatum* multiply2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(multiply);
+  if (a->type == Integer && b->type == Integer) {
+    int64_t product = (int64_t) a->int_val * b->int_val;
 
-  if (datum_cmp(intermediate, &zero)) {
-    raise(ZeroDivision, NULL);
+    if (fits_integer(product)) {
+      return box_integer((int32_t) product);
+    }
   }
 
-  switch (acc->type) {
-    case Integer:
-      if (acc->int_val % intermediate->int_val == 0) {
-        acc->int_val /= intermediate->int_val;
-      } else {
-        acc->type = Real;
-        acc->float_val = ((double) acc->int_val) / (intermediate->int_val);
-      }
-      break;
-    case Rational:
-      acc->num *= intermediate->den;
-      acc->den *= intermediate->num;
-      break;
-    case Real:
-      acc->float_val /= intermediate->float_val;
-      break;
-    case Complex:
-      d = intermediate->real * intermediate->real + intermediate->im * intermediate->im;
-      acc->real = (acc->real * intermediate->real + acc->im * intermediate->im) / d;
-      acc->im = (acc->im * intermediate->real - acc->real * intermediate->im) / d;
-      break;
-    default:
-      break;
+  struct LispDatum acc;
+
+  if (arithmetic2(a, b, &acc, LispMultiply)) {
+    return raise(Math, "Error during multiplication.");
   }
+
+  return box_scratch(&acc);
 }
 
 struct LispDatum* divide(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(divide);
   if (nargs == 0) {
-    return new_integer(0);
+    return box_integer(0);
   } else if (nargs == 1) {
-    return args[0];
+    return retain(args[0]);
   }
 
-  struct LispDatum* init = malloc(sizeof(struct LispDatum));
-  copy_lisp_datum(args[0], init);
+  struct LispDatum acc;
+  load_scratch(args[0], &acc);
+
+  int status = numeric_fold(args + 1, nargs - 1, &acc, LispDivide);
 
-  if (iterative_math_function(args, nargs, init, divide_aux)) {
-    free(init);
+  if (status == LISP_FOLD_ZERO_DIVISION) {
+    return raise(ZeroDivision, "Division by 0.");
+  } else if (status) {
     return raise(Math, "Error during division.");
   }
 
-  return init;
+  return box_scratch(&acc);
 }
 
-struct LispDatum* mod(struct LispDatum** args, uint32_t nargs) {
-  if (nargs != 2) {
-    return raise(Argument, "Incorrect number of arguments passed to mod.");
+struct LispDatum* divide2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(divide);
+  // Only exact quotients can stay integers. Widened first, since INT32_MIN / -1 overflows.
+  if (a->type == Integer && b->type == Integer && b->int_val != 0 && (int64_t) a->int_val % b->int_val == 0) {
+    int64_t quotient = (int64_t) a->int_val / b->int_val;
+
+    if (fits_integer(quotient)) {
+      return box_integer((int32_t) quotient);
+    }
   }
 
-  if (args[0]->type != Integer || args[1]->type != Integer) {
-    return raise(Math, "Cannot perform modulus operation on non-integer values.");
+  struct LispDatum acc;
+  int status = arithmetic2(a, b, &acc, LispDivide);
+
+  if (status == LISP_FOLD_ZERO_DIVISION) {
+    return raise(ZeroDivision, "Division by 0.");
+  } else if (status) {
+    return raise(Math, "Error during division.");
   }
 
-  return new_integer(args[0]->int_val % args[1]->int_val);
+  return box_scratch(&acc);
 }
 
-struct LispDatum* division(struct LispDatum** args, uint32_t nargs) {
-  if (nargs != 2) {
-    return raise(Argument, "Incorrect number of arguments passed to mod.");
+VARIADIC_FORM_2(mod, "mod")
+
+struct LispDatum* mod2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(mod);
+  if (LISP_INVALID(!is_integral(a) || !is_integral(b))) {
+    return raise(Math, "Cannot perform modulus operation on non-integer values.");
   }
 
-  if (args[0]->type != Integer || args[1]->type != Integer) {
-    return raise(Math, "Cannot perform division algorithm on non-integer values.");
+  struct LispDatum r;
+
+  if (integer_divmod(a, b, NULL, &r)) {
+    return raise(ZeroDivision, "Modulus by 0.");
   }
 
-  struct LispDatum* d = new_integer(args[0]->int_val / args[1]->int_val);
-  struct LispDatum* r = new_integer(args[0]->int_val % args[1]->int_val);
-  return new_cons(r, new_cons(d, get_nil()));
+  return box_scratch(&r);
 }
 
-void display(struct LispDatum* datum) {
-  struct LispDatum* read_ptr = datum;
+VARIADIC_FORM_2(division, "div")
+
+struct LispDatum* division2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(division);
+  if (LISP_INVALID(!is_integral(a) || !is_integral(b))) {
+    return raise(Math, "Cannot perform division algorithm on non-integer values.");
+  }
+
+  struct LispDatum quotient;
+  struct LispDatum remainder;
 
+  if (integer_divmod(a, b, &quotient, &remainder)) {
+    return raise(ZeroDivision, "Division algorithm applied with a divisor of 0.");
+  }
+
+  struct LispDatum* d = box_scratch(&quotient);
+  struct LispDatum* r = box_scratch(&remainder);
+  struct LispDatum* tail = new_cons(d, get_nil());
+  struct LispDatum* result = new_cons(r, tail);
+
+  release(d);
+  release(r);
+  release(tail);
+
+  return result;
+}
+
+/** Write anything other than a list, vector or hash map. */
+static void write_atom(struct LispPort* port, const struct LispDatum* datum) {
   switch (datum->type) {
     case Integer:
-      printf("%d", datum->int_val);
-      break;
     case Rational:
-      printf("%d/%d", datum->num, datum->den);
-      break;
     case Real:
-      printf("%f", datum->float_val);
+    case Complex: {
+      char digits[LISP_NUMBER_CHARS];
+      port_write(port, digits, format_number(datum, digits));
       break;
-    case Complex:
-      printf("%f%+fi", datum->real, datum->im);
+    }
+    case BigInt: {
+      struct LispStringBuilder digits;
+      string_builder_init(&digits);
+      integer_format(datum, &digits);
+      port_write(port, string_builder_content(&digits), string_builder_length(&digits));
+      string_builder_discard(&digits);
       break;
+    }
     case Symbol:
-      printf("%s", datum->label);
+      port_write(port, datum->label, strlen(datum->label));
       break;
-    case Cons:
-      // TODO(matthew-c21): Handle case of final element not getting extra space.
-      printf("(");
-      while (is_occupied_node(read_ptr)) {
-        display(read_ptr->car);
-        printf(" ");
-        read_ptr = read_ptr->cdr;
+    case Keyword:
+      port_write_char(port, ':');
+      port_write(port, datum->label, strlen(datum->label));
+      break;
+    case I32Array:
+      LISP_PORT_LITERAL(port, "#i32(");
+      for (uint32_t i = 0; i < datum->count; ++i) {
+        char digits[LISP_INT_CHARS + 1];
+        uint32_t length = format_int64(((const int32_t*) datum->values)[i], digits);
+        digits[length++] = ' ';
+        port_write(port, digits, length);
       }
-
-      if (read_ptr != NULL) {
-        printf(". ");
-        display(read_ptr);
+      port_write_char(port, ')');
+      break;
+    case F64Array:
+      LISP_PORT_LITERAL(port, "#f64(");
+      for (uint32_t i = 0; i < datum->count; ++i) {
+        char digits[LISP_REAL_CHARS + 1];
+        uint32_t length = format_real(((const double*) datum->values)[i], digits);
+        digits[length++] = ' ';
+        port_write(port, digits, length);
       }
-
-      printf(")");
+      port_write_char(port, ')');
+      break;
+    case C128Array:
+      LISP_PORT_LITERAL(port, "#c128(");
+      for (uint32_t i = 0; i < datum->count; ++i) {
+        const double* parts = (const double*) datum->values + 2 * i;
+        char digits[LISP_NUMBER_CHARS + 1];
+        uint32_t length = format_complex(parts[0], parts[1], digits);
+        digits[length++] = ' ';
+        port_write(port, digits, length);
+      }
+      port_write_char(port, ')');
+      break;
+    case Closure:
+      LISP_PORT_LITERAL(port, "#<procedure>");
       break;
     case Nil:
-      printf("nil");
+      LISP_PORT_LITERAL(port, "nil");
       break;
     case String:
-      printf("%s", datum->content);
+      port_write(port, string_content(datum), string_length(datum));
       break;
     case Bool:
-      printf("%s", datum->boolean ? "#t" : "#f");
+      port_write(port, datum->boolean ? "#t" : "#f", 2);
+      break;
+    default:
       break;
   }
 }
 
-int is_numeric(const struct LispDatum* x) {
-  return x->type <= Complex;
+static int is_container(const struct LispDatum* x) {
+  return x->type == Cons || x->type == Vector || x->type == HashMap;
 }
 
-int datum_cmp(const struct LispDatum* a, const struct LispDatum* b) {
-  if (a->type == Nil && a->type == b->type) return 1;
+/** A list, vector or hash map that is part way through being written. */
+struct PrintFrame {
+  struct LispDatum* container;
 
-  if (is_numeric(a) && is_numeric(b)) {
-    // Make copies in order to promote. Only one copy is required, but two saves some duplicate code.
-    struct LispDatum x;
-    struct LispDatum y;
-    copy_lisp_datum(a, &x);
-    copy_lisp_datum(b, &y);
-
-    enum LispDataType max_type = a->type > b->type ? a->type : b->type;
-    promote(&x, max_type);
-    promote(&y, max_type);
-
-    switch (x.type) {
-      case Integer:
-        return x.int_val == y.int_val;
-      case Rational:
-        return x.num == y.num && x.den == y.den;
-      case Real:
-        return x.float_val == y.float_val;
-      case Complex:
-        return x.real == y.real && x.im == y.im;
-      default:
-        raise(Generic, "Non-numeric value undergoing numeric equality test.");
-        return 0;
-    }
-  } else if (a->type == b->type) {
-    // TODO(matthew-c21): Cons, symbol, keyword equality all missing.
-    switch (a->type) {
-      case String:
-        return a->length == b->length && strncmp(a->content, b->content, a->length) == 0;
-      case Bool:
-        return a->boolean == b->boolean;
-      default:
-        return 0;
-    }
-  }
+  /** Lists: the cell whose car is written next. */
+  struct LispDatum* cell;
 
-  // TODO(matthew-c21): Non-numeric type equality.
+  /** Lists: how many cells have been written. Vectors: the index written next. Hash maps: the cursor for `map_next`. */
+  uint32_t position;
 
-  // Only numeric types are implemented, so just return false.
-  return 0;
-}
+  /** Hash maps: the entry whose key was just written, and whose value is written next. */
+  struct LispMapEntry* entry;
 
-struct LispDatum* format(struct LispDatum** args, uint32_t nargs) {
-  for (uint32_t i = 0; i < nargs; ++i) {
-    display(args[i]);
-    printf(" ");
-  }
+  /** Whether a space is owed after the element just written. */
+  int separate;
 
-  printf("\n");
+  /** Lists: whether an improper tail has been written. */
+  int tail_written;
 
-  return get_nil();
-}
+  /** Identifies the frame in `Printer.path`. Frames further up the stack always have greater serials. */
+  uintptr_t serial;
+};
 
-// Several of the following functions start with the same check. However, since there is no proper means of jumping from
-//  one part of execution to another, there's no good way eliminate this redundancy.
+struct Printer {
+  struct LispPort* port;
+  struct WalkStack frames;
 
-struct LispDatum* car(struct LispDatum** args, uint32_t nargs) {
-  if (nargs != 1) {
-    return raise(Argument, "`car` takes a single argument.");
-  } else if (args[0]->type != Cons) {
-    return raise(Type, "`car` expected proper list argument");
-  }
+  /** The containers and list cells being written, mapped to the serial of their frame (see walk.h). */
+  struct PointerMap path;
+  uintptr_t serials;
+  uint32_t fuel;
+};
 
-  return args[0]->car;
-}
+/** Whether the frame with the given serial is still on the stack. */
+static int frame_active(const struct Printer* p, uintptr_t serial) {
+  const struct PrintFrame* frames = (const struct PrintFrame*) p->frames.items;
+  size_t low = 0;
+  size_t high = p->frames.count;
 
-struct LispDatum* cdr(struct LispDatum** args, uint32_t nargs) {
-  if (nargs != 1) {
-    return raise(Argument, "`cdr` expects exactly one argument");
-  } else if (args[0]->type != Nil && args[0]->type != Cons) {
-    return raise(Type, "`cdr` expected a list valued argument.");
-  }
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
 
-  if (is_occupied_node(args[0])) {
-    return args[0]->cdr;
+    if (frames[mid].serial == serial) {
+      return 1;
+    } else if (frames[mid].serial < serial) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
   }
 
-  return list(NULL, 0);
+  return 0;
 }
 
-struct LispDatum* length(struct LispDatum** args, uint32_t nargs) {
-  if (nargs != 1) {
-    return raise(Argument, "`length` takes a single argument.");
-  } else if (args[0]->type == Nil) {
-    return new_integer(0);
-  } else if (args[0]->type != Cons) {
-    return raise(Type, "`length` expected list argument");
-  }
-
-  int len = 0;
-  struct LispDatum* ptr = args[0];
-
-  while (is_occupied_node(ptr)) {
-    ++len;
-    ptr = ptr->cdr;
-  }
+/** Record that a container or cell belongs to a frame, unless it already belongs to one still being written. */
+static int enters_cycle(struct Printer* p, const struct LispDatum* x, uintptr_t serial) {
+  if (p->fuel > 0 && --p->fuel > 0) {
+    return 0;
+  } else if (p->path.capacity == 0) {
+    // Just ran out of fuel, so catch up on the containers already open. Coming back to any of them is then a cycle.
+    const struct PrintFrame* frames = (const struct PrintFrame*) p->frames.items;
 
-  // The 0 length check helps account for empty lists that never get assigned to their cdr.
-  if (len != 0 && ptr != NULL) {
-    return raise(Type, "`length` expected list argument. Received pair.");
+    for (size_t i = 0; i < p->frames.count; ++i) {
+      pointer_map_find(&p->path, frames[i].container)->value = frames[i].serial;
+    }
   }
 
-  return new_integer(len);
-}
+  struct PointerMapEntry* entry = pointer_map_find(&p->path, x);
 
-struct LispDatum* cons(struct LispDatum** args, uint32_t nargs) {
-  if (nargs != 2) {
-    return raise(Argument, "`cons` takes exactly two arguments.");
+  if (entry->value != 0 && frame_active(p, entry->value)) {
+    return 1;
   }
 
-  return new_cons(args[0], args[1]);
+  entry->value = serial;
+  return 0;
 }
 
-struct LispDatum* list(struct LispDatum** args, uint32_t nargs) {
-  struct LispDatum* alist = malloc(sizeof(struct LispDatum));
-  alist->type = Cons;
+static void open_container(struct Printer* p, struct LispDatum* x) {
+  struct PrintFrame frame = {.container = x, .cell = x, .serial = ++p->serials};
 
-  if (nargs == 0) {
-    alist->car = alist->cdr = NULL;
-    return alist;
+  if (x->type == Cons && x->car == NULL) {
+    LISP_PORT_LITERAL(p->port, "()");
+    return;
+  } else if (enters_cycle(p, x, frame.serial)) {
+    LISP_PORT_LITERAL(p->port, "#<cycle>");
+    return;
   }
 
-  struct LispDatum* write_ptr = alist;
-  int initial_write = 1;
-
-  for (uint32_t i = 0; i < nargs; ++i) {
-    push(write_ptr, args[i]);
-    if (initial_write) {
-      initial_write = 0;
-    } else {
-      write_ptr = write_ptr->cdr;
-    }
+  switch (x->type) {
+    case Cons:
+      port_write_char(p->port, '(');
+      break;
+    case Vector:
+      LISP_PORT_LITERAL(p->port, "#(");
+      break;
+    default:
+      port_write_char(p->port, '{');
+      break;
   }
 
-  return alist;
+  walk_push(&p->frames, &frame, sizeof(frame));
 }
 
-struct LispDatum* append(struct LispDatum** args, uint32_t nargs) {
-  // Ensure type of all arguments.
-  for (uint32_t i = 0; i < nargs; ++i) {
-    if (args[i]->type != Cons && args[i]->type != Nil) {
-      return raise(Type, "Expected list in argument to `append`.");
-    }
-  }
-
-  // Special cases for small argument numbers.
-  if (nargs == 0) {
-    return list(NULL, 0);
-  } else if (nargs == 1) {
-    return args[0];
-  }
-
-  struct LispDatum* combination = malloc(sizeof(struct LispDatum));
-  combination->type = Cons;
-
-  struct LispDatum* write_ptr = combination;
-
-  int initial_write = 1;
-
-  for (uint32_t i = 0; i < nargs - 1; ++i) {
-    struct LispDatum* idx = args[i];
+/**
+ * Write whatever punctuation comes between the element just written and the next one, closing any containers that are
+ * finished along the way.
+ * @return the next element to write, or NULL once everything has been written.
+ */
+static struct LispDatum* next_element(struct Printer* p) {
+  while (p->frames.count > 0) {
+    struct PrintFrame* frame = walk_top(&p->frames, sizeof(struct PrintFrame));
 
-    if (idx->type == Nil) {
-      continue;
+    if (frame->separate) {
+      port_write_char(p->port, ' ');
+      frame->separate = 0;
     }
 
-    // check type of each idx. If any pairs appear, toss them. If a Nil appears, it should be skipped.
-    while (is_occupied_node(idx)) {
-      push(write_ptr, idx->car);
+    switch (frame->container->type) {
+      case Cons: {
+        struct LispDatum* cell = frame->cell;
+
+        if (is_occupied_node(cell)) {
+          // The first cell was already checked when the list was opened.
+          if (frame->position++ > 0 && enters_cycle(p, cell, frame->serial)) {
+            LISP_PORT_LITERAL(p->port, ". #<cycle>)");
+            break;
+          }
+
+          frame->cell = cell->cdr;
+          frame->separate = 1;
+          return cell->car;
+        } else if (cell != NULL && cell->type != Cons && !frame->tail_written) {
+          LISP_PORT_LITERAL(p->port, ". ");
+          frame->tail_written = 1;
+          return cell;
+        }
 
-      if (initial_write) {
-        initial_write = 0;
-      } else {
-        write_ptr = write_ptr->cdr;
+        port_write_char(p->port, ')');
+        break;
       }
+      case Vector:
+        if (frame->position < frame->container->length) {
+          frame->separate = 1;
+          return frame->container->items[frame->position++];
+        }
 
-      idx = idx->cdr;
-    }
+        port_write_char(p->port, ')');
+        break;
+      default:
+        if (frame->entry != NULL) {
+          struct LispDatum* value = frame->entry->value;
+          frame->entry = NULL;
+          frame->separate = 1;
+          return value;
+        } else if ((frame->entry = map_next(frame->container, &frame->position)) != NULL) {
+          frame->separate = 1;
+          return frame->entry->key;
+        }
 
-    if (idx != NULL) {
-      return raise(Type, "Non-terminal arguments to `append` should be proper lists");
+        port_write_char(p->port, '}');
+        break;
     }
-  }
 
-  // If it's an occupied list (proper or otherwise), push it at the end. It must otherwise be empty or nil.
-  if (is_occupied_node(args[nargs - 1])) {
-    write_ptr->cdr = args[nargs-1];
+    walk_pop(&p->frames);
   }
 
-  // Otherwise it's nil and nothing needs to be done.
-  return combination;
+  return NULL;
 }
 
-struct LispDatum* reverse(struct LispDatum** args, uint32_t nargs) {
-  if (nargs != 1) {
-    return raise(Argument, "`reverse` takes exactly one argument");
-  } else if (args[0]->type == Nil) {
-    return args[0];
-  } else if (args[0]->type != Cons) {
-    return raise(Type, "`reverse` expected list argument");
-  }
-
-  // Handle case of empty and singleton list.
-  if (args[0]->car == NULL || args[0]->cdr == NULL) {
-    return args[0];
+/**
+ * Write a datum with an explicit stack of the containers it is nested in, so that arbitrarily deep structures can be
+ * written. A container or list cell that is reached again from inside itself is written as `#<cycle>`. Without cycle
+ * detection, that is only noticed once the fuel has run out.
+ */
+static void write_datum(struct LispPort* port, struct LispDatum* datum) {
+  if (!is_container(datum)) {
+    write_atom(port, datum);
+    return;
   }
 
-  struct LispDatum* reversal = NULL;
-  struct LispDatum* idx = args[0];
-
-  while (is_occupied_node(idx)) {
-    reversal = new_cons(idx->car, reversal);
-    idx = idx->cdr;
-  }
+  struct Printer p = {.port = port, .fuel = lisp_state_current()->detect_cycles ? 0 : LISP_WALK_FUEL};
+  struct LispDatum* x = datum;
 
-  if (idx != NULL) {
-    return raise(Type, "`reverse` expects a proper list");
-  }
+  while (x != NULL) {
+    if (is_container(x)) {
+      open_container(&p, x);
+    } else {
+      write_atom(port, x);
+    }
 
-  if (reversal == NULL) {
-    return list(NULL, 0);
+    x = next_element(&p);
   }
 
-  return reversal;
+  walk_stack_free(&p.frames);
+  pointer_map_free(&p.path);
 }
 
-struct LispDatum* eqv(struct LispDatum** args, uint32_t nargs) {
-  int truthy = 1;
+void display(struct LispDatum* datum) {
+  write_datum(lisp_output_port(), datum);
+}
 
-  for (uint32_t i = 0; i + 1 < nargs; ++i) {
-    truthy = truthy && datum_cmp(args[i], args[i + 1]);
-  }
+void set_global_cycle_detection(int enabled) {
+  lisp_state_current()->detect_cycles = enabled;
+}
 
-  return truthy ? get_true() : get_false();
+int is_numeric(const struct LispDatum* x) {
+  return x->type <= Complex;
 }
 
-static int cmp(struct LispDatum* a, struct LispDatum* b) {
+int datum_cmp(const struct LispDatum* a, const struct LispDatum* b) {
+  if (a->type == Nil && a->type == b->type) return 1;
+
   if (is_numeric(a) && is_numeric(b)) {
-    struct LispDatum x;
-    copy_lisp_datum(a, &x);
-
-    struct LispDatum y;
-    copy_lisp_datum(b, &y);
-
-    promote(&x, y.type);
-    promote(&y, x.type);
-
-    switch (x.type) {
-      case Integer:
-        return x.int_val == y.int_val ? 0 : x.int_val > y.int_val ? 1 : -1;
-      case Rational:
-        return x.num == y.num && x.den == y.den ? 0 : (double) x.num / x.den > (double) y.num / y.den ? 1 : -1;
-      case Real:
-        return x.float_val == y.float_val ? 0 : x.float_val > y.float_val ? 1 : -1;
-      case Complex:
-        if (x.real == y.real) {
-          return x.im == y.im ? 0 : x.im > y.im ? 1 : -1;
-        } else {
-          return  x.real > y.real ? 1 : -1;
-        }
+    return numeric_compare(a, b) == 0;
+  } else if (a->type == b->type) {
+    switch (a->type) {
+      case Symbol:
+      case Keyword:
+        // Interned, so identity is equality.
+        return a == b;
+      case String:
+        return string_length(a) == string_length(b) &&
+               memcmp(string_content(a), string_content(b), string_length(a)) == 0;
+      case Bool:
+        return a->boolean == b->boolean;
+      case I32Array:
+      case F64Array:
+      case C128Array:
+        return numeric_array_equal(a, b);
+      case Cons:
+        // Lists are only the same if they are the same cells, apart from empty lists (see `datum_equal`).
+        return a == b || (a->car == NULL && b->car == NULL);
       default:
-        raise(Generic, "invalid state reached during cmp");
-        return 0;
+        return a == b;
     }
-  } else {
-    raise(Generic, "invalid state reached during cmp");
-    return 0;
   }
+
+  return 0;
 }
 
-static struct LispDatum*
-comparator(struct LispDatum** args, uint32_t nargs, int (* valid)(struct LispDatum*, struct LispDatum*)) {
-  int is_true = 1;
+/** Union-find over the containers `datum_equal` has matched up, where each one's value in the map is its parent. */
+static const void* equivalence_class(struct PointerMap* classes, const void* x) {
+  uintptr_t parent;
 
-  for (uint32_t i = 0; i + 1 < nargs; ++i) {
-    // TODO(matthew-c21): Redundant checks are redundant.
-    if (!is_numeric(args[i]) || !is_numeric(args[i + 1])) {
-      return raise(Generic, "Compared values must be numeric.");
+  while ((parent = pointer_map_get(classes, x)) != 0) {
+    // Path halving: point at the grandparent on the way up, so later lookups take fewer steps.
+    uintptr_t grandparent = pointer_map_get(classes, (const void*) parent);
+
+    if (grandparent == 0) {
+      return (const void*) parent;
     }
 
-    is_true = is_true && valid(args[i], args[i + 1]);
+    pointer_map_find(classes, x)->value = grandparent;
+    x = (const void*) grandparent;
   }
 
-  return is_true ? get_true() : get_false();
+  return x;
 }
 
-int less_than_aux(struct LispDatum* a, struct LispDatum* b) {
-  return cmp(a, b) < 0;
-}
+/**
+ * Assume that two containers are equal.
+ * @return 1 if that was already assumed, in which case they needn't be compared again.
+ */
+static int assume_equal(struct PointerMap* classes, const void* a, const void* b) {
+  const void* class_a = equivalence_class(classes, a);
+  const void* class_b = equivalence_class(classes, b);
 
-struct LispDatum* less_than(struct LispDatum** args, uint32_t nargs) {
-  return comparator(args, nargs, less_than_aux);
+  if (class_a == class_b) {
+    return 1;
+  }
+
+  pointer_map_find(classes, class_a)->value = (uintptr_t) class_b;
+  return 0;
+}
+
+/** The rest of a list after a cell, where nil and the empty list both end it like NULL does. */
+static const struct LispDatum* list_rest(const struct LispDatum* cell) {
+  const struct LispDatum* rest = cell->cdr;
+  return rest == NULL || rest->type == Nil || (rest->type == Cons && rest->car == NULL) ? NULL : rest;
+}
+
+struct EqualPair {
+  const struct LispDatum* a;
+  const struct LispDatum* b;
+};
+
+int datum_equal(const struct LispDatum* a, const struct LispDatum* b) {
+  struct WalkStack pending = {0};
+  struct PointerMap classes = {0};
+  uint32_t fuel = LISP_WALK_FUEL;
+  int same = 1;
+
+  for (;;) {
+    if (a == b) {
+      // Identical, including both being the end of a list.
+    } else if (a == NULL || b == NULL || a->type != b->type || !is_container(a) ||
+               (a->type == Cons && (a->car == NULL || b->car == NULL))) {
+      if (a == NULL || b == NULL || !datum_cmp(a, b)) {
+        same = 0;
+        break;
+      }
+    } else if (fuel > 0 ? (--fuel, 0) : assume_equal(&classes, a, b)) {
+      // Already being compared further up, so any difference will be found there. This is what stops cycles.
+    } else if (a->type == Cons) {
+      // Carry straight on with the cars, and come back for the rest of the lists.
+      struct EqualPair rest = {list_rest(a), list_rest(b)};
+      walk_push(&pending, &rest, sizeof(rest));
+      a = a->car;
+      b = b->car;
+      continue;
+    } else if (a->type == Vector) {
+      if (a->length != b->length) {
+        same = 0;
+        break;
+      }
+
+      for (uint32_t i = a->length; i > 0; --i) {
+        struct EqualPair items = {a->items[i - 1], b->items[i - 1]};
+        walk_push(&pending, &items, sizeof(items));
+      }
+    } else {
+      if (map_count(a) != map_count(b)) {
+        same = 0;
+        break;
+      }
+
+      uint32_t cursor = 0;
+      struct LispMapEntry* entry;
+
+      while ((entry = map_next(a, &cursor)) != NULL) {
+        struct EqualPair values = {entry->value, map_get(b, entry->key)};
+
+        if (values.b == NULL) {
+          same = 0;
+          break;
+        }
+
+        walk_push(&pending, &values, sizeof(values));
+      }
+
+      if (!same) {
+        break;
+      }
+    }
+
+    if (pending.count == 0) {
+      break;
+    }
+
+    struct EqualPair* next = walk_top(&pending, sizeof(struct EqualPair));
+    a = next->a;
+    b = next->b;
+    walk_pop(&pending);
+  }
+
+  walk_stack_free(&pending);
+  pointer_map_free(&classes);
+  return same;
+}
+
+struct LispDatum* format(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(format);
+  struct LispPort* port = lisp_output_port();
+
+  for (uint32_t i = 0; i < nargs; ++i) {
+    write_datum(port, args[i]);
+    port_write_char(port, ' ');
+  }
+
+  port_write_char(port, '\n');
+
+  return get_nil();
+}
+
+struct LispDatum* flush_output(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(flush_output);
+  (void) args;
+
+  if (LISP_INVALID(nargs != 0)) {
+    return raise(Argument, "`flush-output` takes no arguments.");
+  }
+
+  port_flush(lisp_output_port());
+  return get_nil();
+}
+
+static const char* const CONDITION_NAMES[] = {
+    [None] = "none", [Type] = "type", [Argument] = "argument", [ZeroDivision] = "zero-division", [Math] = "math",
+    [Generic] = "generic"
+};
+
+struct LispDatum* condition_keyword(enum Cause cause) {
+  const char* name = CONDITION_NAMES[cause];
+  return new_keyword(name, strlen(name));
+}
+
+struct LispDatum* signal_error(struct LispDatum** args, uint32_t nargs) {
+  if (LISP_INVALID(nargs < 1 || nargs > 2)) {
+    return raise(Argument, "`error` takes a condition keyword and an optional message.");
+  }
+
+  return nargs == 1 ? signal_error1(args[0]) : signal_error2(args[0], args[1]);
+}
+
+struct LispDatum* signal_error1(struct LispDatum* cause) {
+  return signal_error2(cause, NULL);
+}
+
+struct LispDatum* signal_error2(struct LispDatum* cause, struct LispDatum* message) {
+  LISP_STATS_CALL(signal_error);
+  if (LISP_INVALID(cause->type != Keyword || (message != NULL && message->type != String))) {
+    return raise(Type, "`error` expected a keyword and a string.");
+  }
+
+  // Keywords are interned, so they can be told apart by identity.
+  for (enum Cause c = Type; c <= Generic; ++c) {
+    if (cause == condition_keyword(c)) {
+      return raise(c, message != NULL ? string_content(message) : "Raised by `error`.");
+    }
+  }
+
+  return raise(Argument, "`error` expected one of :type, :argument, :zero-division, :math or :generic.");
 }
 
-int num_equals_aux(struct LispDatum* a, struct LispDatum* b) {
-  return cmp(a, b) == 0;
+VARIADIC_FORM_1(car, "car")
+
+struct LispDatum* car1(struct LispDatum* x) {
+  LISP_STATS_CALL(car);
+  if (LISP_INVALID(x->type != Cons)) {
+    return raise(Type, "`car` expected proper list argument");
+  }
+
+  return retain(x->car);
+}
+
+VARIADIC_FORM_1(cdr, "cdr")
+
+struct LispDatum* cdr1(struct LispDatum* x) {
+  LISP_STATS_CALL(cdr);
+  if (LISP_INVALID(x->type != Nil && x->type != Cons)) {
+    return raise(Type, "`cdr` expected a list valued argument.");
+  }
+
+  if (is_occupied_node(x)) {
+    return retain(x->cdr);
+  }
+
+  return new_list(NULL, 0, NULL);
+}
+
+VARIADIC_FORM_1(length, "length")
+
+struct LispDatum* length1(struct LispDatum* x) {
+  LISP_STATS_CALL(length);
+  if (LISP_INVALID(x->type != Cons && x->type != Nil)) {
+    return raise(Type, "`length` expected list argument");
+  }
+
+  int32_t len = list_length(x);
+
+  if (len < 0) {
+    return raise(Type, "`length` expected list argument. Received pair.");
+  }
+
+  return box_integer(len);
+}
+
+VARIADIC_FORM_2(cons, "cons")
+
+struct LispDatum* cons2(struct LispDatum* car, struct LispDatum* cdr) {
+  LISP_STATS_CALL(cons);
+  return new_cons(car, cdr);
+}
+
+struct LispDatum* list(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(list);
+  return new_list(args, nargs, NULL);
+}
+
+/**
+ * Gather the elements of a proper list into `items`, which must have room for all of them. Returns the number of
+ * elements written.
+ */
+static uint32_t collect_items(const struct LispDatum* x, struct LispDatum** items) {
+  uint32_t count = 0;
+
+  while (is_occupied_node(x)) {
+    items[count++] = x->car;
+    x = x->cdr;
+  }
+
+  return count;
+}
+
+struct LispDatum* append(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(append);
+  // Ensure type of all arguments.
+  for (uint32_t i = 0; i < nargs; ++i) {
+    if (LISP_INVALID(args[i]->type != Cons && args[i]->type != Nil)) {
+      return raise(Type, "Expected list in argument to `append`.");
+    }
+  }
+
+  // Special cases for small argument numbers.
+  if (nargs == 0) {
+    return new_list(NULL, 0, NULL);
+  } else if (nargs == 1) {
+    return retain(args[0]);
+  }
+
+  // Size everything up front, so that the copied elements can be laid out in as few chunks as possible.
+  uint32_t total = 0;
+
+  for (uint32_t i = 0; i < nargs - 1; ++i) {
+    int32_t len = list_length(args[i]);
+
+    if (len < 0) {
+      return raise(Type, "Non-terminal arguments to `append` should be proper lists");
+    }
+
+    total += (uint32_t) len;
+  }
+
+  struct LispDatum* buffer[LISP_LIST_CHUNK_MAX];
+  struct LispDatum** items = total <= LISP_LIST_CHUNK_MAX ? buffer : lisp_alloc(total * sizeof(struct LispDatum*));
+  uint32_t count = 0;
+
+  for (uint32_t i = 0; i < nargs - 1; ++i) {
+    count += collect_items(args[i], items + count);
+  }
+
+  // The last list (proper or otherwise) is shared as the tail. If it is empty or nil, the result simply ends.
+  struct LispDatum* combination = new_list(items, count, args[nargs - 1]);
+
+  if (items != buffer) {
+    lisp_free(items, total * sizeof(struct LispDatum*));
+  }
+
+  return combination;
+}
+
+VARIADIC_FORM_1(reverse, "reverse")
+
+struct LispDatum* reverse1(struct LispDatum* x) {
+  LISP_STATS_CALL(reverse);
+  if (x->type == Nil) {
+    return retain(x);
+  } else if (LISP_INVALID(x->type != Cons)) {
+    return raise(Type, "`reverse` expected list argument");
+  }
+
+  // Handle case of empty and singleton list.
+  if (x->car == NULL || x->cdr == NULL) {
+    return retain(x);
+  }
+
+  int32_t len = list_length(x);
+
+  if (len < 0) {
+    return raise(Type, "`reverse` expects a proper list");
+  }
+
+  struct LispDatum* buffer[LISP_LIST_CHUNK_MAX];
+  struct LispDatum** items = len <= LISP_LIST_CHUNK_MAX ? buffer : lisp_alloc((size_t) len * sizeof(struct LispDatum*));
+  const struct LispDatum* idx = x;
+
+  for (int32_t i = len - 1; i >= 0; --i) {
+    items[i] = idx->car;
+    idx = idx->cdr;
+  }
+
+  struct LispDatum* reversal = new_list(items, (uint32_t) len, NULL);
+
+  if (items != buffer) {
+    lisp_free(items, (size_t) len * sizeof(struct LispDatum*));
+  }
+
+  return reversal;
+}
+
+VARIADIC_FORM_2(set_car, "set-car!")
+
+struct LispDatum* set_car2(struct LispDatum* pair, struct LispDatum* value) {
+  LISP_STATS_CALL(set_car);
+  if (!is_occupied_node(pair)) {
+    return raise(Type, "`set-car!` expected a non-empty list");
+  } else if (is_immortal(pair)) {
+    return raise(Argument, "`set-car!` can't modify an immutable list");
+  }
+
+  struct LispDatum* old = pair->car;
+  pair->car = retain(value);
+  gc_write_barrier(pair);
+  release(old);
+
+  return get_nil();
+}
+
+VARIADIC_FORM_2(set_cdr, "set-cdr!")
+
+struct LispDatum* set_cdr2(struct LispDatum* pair, struct LispDatum* value) {
+  LISP_STATS_CALL(set_cdr);
+  if (!is_occupied_node(pair)) {
+    return raise(Type, "`set-cdr!` expected a non-empty list");
+  } else if (is_immortal(pair)) {
+    return raise(Argument, "`set-cdr!` can't modify an immutable list");
+  }
+
+  // An empty list or nil as the new cdr ends the list, as with the tail given to `append`.
+  struct LispDatum* cdr = value;
+  if (cdr->type == Nil || (cdr->type == Cons && cdr->car == NULL && cdr->cdr == NULL)) {
+    cdr = NULL;
+  }
+
+  struct LispDatum* old = pair->cdr;
+  pair->cdr = retain(cdr);
+  gc_write_barrier(pair);
+  release(old);
+
+  invalidate_list_lengths(pair);
+  return get_nil();
+}
+
+struct LispDatum* equal(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(equal);
+  int truthy = 1;
+
+  for (uint32_t i = 0; i + 1 < nargs && truthy; ++i) {
+    truthy = datum_equal(args[i], args[i + 1]);
+  }
+
+  return truthy ? get_true() : get_false();
+}
+
+struct LispDatum* equal2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(equal);
+  return datum_equal(a, b) ? get_true() : get_false();
+}
+
+struct LispDatum* eqv(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(eqv);
+  int truthy = 1;
+
+  for (uint32_t i = 0; i + 1 < nargs; ++i) {
+    truthy = truthy && datum_cmp(args[i], args[i + 1]);
+  }
+
+  return truthy ? get_true() : get_false();
+}
+
+struct LispDatum* eqv2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(eqv);
+  return datum_cmp(a, b) ? get_true() : get_false();
+}
+
+static struct LispDatum* comparator(struct LispDatum** args, uint32_t nargs, int accepted) {
+  int ordered = numeric_ordered(args, nargs, accepted);
+
+  if (ordered < 0) {
+    return raise(Generic, "Compared values must be numeric.");
+  }
+
+  return ordered ? get_true() : get_false();
+}
+
+/** Compare two numbers, without going through the general comparison when both are integers. */
+static struct LispDatum* comparator2(struct LispDatum* a, struct LispDatum* b, int accepted) {
+  if (a->type == Integer && b->type == Integer) {
+    int order = a->int_val < b->int_val ? LISP_ORDER_LESS
+                : a->int_val > b->int_val ? LISP_ORDER_GREATER
+                : LISP_ORDER_EQUAL;
+    return order & accepted ? get_true() : get_false();
+  }
+
+  struct LispDatum* args[2] = {a, b};
+  return comparator(args, 2, accepted);
+}
+
+struct LispDatum* less_than(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(less_than);
+  return comparator(args, nargs, LISP_ORDER_LESS);
+}
+
+struct LispDatum* less_than2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(less_than);
+  return comparator2(a, b, LISP_ORDER_LESS);
 }
 
 struct LispDatum* num_equals(struct LispDatum** args, uint32_t nargs) {
-  return comparator(args, nargs, num_equals_aux);
+  LISP_STATS_CALL(num_equals);
+  return comparator(args, nargs, LISP_ORDER_EQUAL);
 }
 
-int greater_than_aux(struct LispDatum* a, struct LispDatum* b) {
-  return cmp(a, b) > 0;
+struct LispDatum* num_equals2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(num_equals);
+  return comparator2(a, b, LISP_ORDER_EQUAL);
 }
 
 struct LispDatum* greater_than(struct LispDatum** args, uint32_t nargs) {
-  return comparator(args, nargs, greater_than_aux);
+  LISP_STATS_CALL(greater_than);
+  return comparator(args, nargs, LISP_ORDER_GREATER);
 }
 
-int less_than_eql_aux(struct LispDatum* a, struct LispDatum* b) {
-  return cmp(a, b) <= 0;
+struct LispDatum* greater_than2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(greater_than);
+  return comparator2(a, b, LISP_ORDER_GREATER);
 }
 
 struct LispDatum* less_than_eql(struct LispDatum** args, uint32_t nargs) {
-  return comparator(args, nargs, less_than_eql_aux);
+  LISP_STATS_CALL(less_than_eql);
+  return comparator(args, nargs, LISP_ORDER_LESS | LISP_ORDER_EQUAL);
 }
 
-int greater_than_eql_aux(struct LispDatum* a, struct LispDatum* b) {
-  return cmp(a, b) >= 0;
+struct LispDatum* less_than_eql2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(less_than_eql);
+  return comparator2(a, b, LISP_ORDER_LESS | LISP_ORDER_EQUAL);
 }
 
 struct LispDatum* greater_than_eql(struct LispDatum** args, uint32_t nargs) {
-  return comparator(args, nargs, greater_than_eql_aux);
+  LISP_STATS_CALL(greater_than_eql);
+  return comparator(args, nargs, LISP_ORDER_GREATER | LISP_ORDER_EQUAL);
+}
+
+struct LispDatum* greater_than_eql2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(greater_than_eql);
+  return comparator2(a, b, LISP_ORDER_GREATER | LISP_ORDER_EQUAL);
 }
 
 // NOTE(matthew-c21): The implementation of the following functions assumes that values are immutable. Bugs may ensure
 //  if that assumption is violated.
 struct LispDatum* logical_and(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(logical_and);
   struct LispDatum* last = get_true();
 
   for (uint32_t i = 0; i < nargs; ++i) {
@@ -741,24 +1171,629 @@ struct LispDatum* logical_and(struct LispDatum** args, uint32_t nargs) {
     }
   }
 
-  return last;
+  return retain(last);
 }
 
 struct LispDatum* logical_or(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(logical_or);
   for (uint32_t i = 0; i < nargs; ++i) {
     if (truthy(args[i])) {  // Direct pointer comparison is bad unless the pointer is static.
-      return args[i];
+      return retain(args[i]);
     }
   }
 
   return get_false();
 }
 
-struct LispDatum* logical_not(struct LispDatum** args, uint32_t nargs) {
-  if (nargs != 1) {
-    return raise(Generic, "Wrong number of arguments passed to not");
+VARIADIC_FORM_1(logical_not, "not")
+
+struct LispDatum* logical_not1(struct LispDatum* x) {
+  LISP_STATS_CALL(logical_not);
+  return truthy(x) ? get_false() : get_true();
+}
+
+VARIADIC_FORM_2(apply, "apply")
+
+struct LispDatum* apply2(struct LispDatum* f, struct LispDatum* arguments) {
+  LISP_STATS_CALL(apply);
+  if (LISP_INVALID(arguments->type != Cons && arguments->type != Nil)) {
+    return raise(Type, "`apply` expected a list of arguments.");
+  }
+
+  int32_t len = list_length(arguments);
+
+  if (len < 0) {
+    return raise(Type, "`apply` expected a proper list of arguments.");
+  }
+
+  struct LispDatum* buffer[LISP_LIST_CHUNK_MAX];
+  struct LispDatum** items = len <= LISP_LIST_CHUNK_MAX ? buffer : lisp_alloc((size_t) len * sizeof(struct LispDatum*));
+  const struct LispDatum* idx = arguments;
+
+  for (int32_t i = 0; i < len; ++i) {
+    items[i] = idx->car;
+    idx = idx->cdr;
+  }
+
+  struct LispDatum* result = call_closure(f, items, (uint32_t) len);
+
+  if (items != buffer) {
+    lisp_free(items, (size_t) len * sizeof(struct LispDatum*));
+  }
+
+  return result;
+}
+
+struct LispDatum* string_append(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(string_append);
+  struct LispStringBuilder builder;
+  string_builder_init(&builder);
+
+  for (uint32_t i = 0; i < nargs; ++i) {
+    if (LISP_INVALID(args[i]->type != String)) {
+      string_builder_discard(&builder);
+      return raise(Type, "`string-append` expected string arguments.");
+    }
+
+    string_builder_append_string(&builder, args[i]);
+  }
+
+  return string_builder_finish(&builder);
+}
+
+
+/**
+ * Determine whether a datum is an integer usable as a position within a vector of the given length. Positions may be at
+ * most `limit`, which is either the length itself (as for the end of a slice) or one less.
+ */
+static int is_position(const struct LispDatum* x, uint32_t limit) {
+  return x->type == Integer && x->int_val >= 0 && (uint32_t) x->int_val <= limit;
+}
+
+struct LispDatum* vector(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(vector);
+  return new_vector_from(args, nargs);
+}
+
+VARIADIC_FORM_1(vector_length, "vector-length")
+
+struct LispDatum* vector_length1(struct LispDatum* v) {
+  LISP_STATS_CALL(vector_length);
+  if (LISP_INVALID(v->type != Vector)) {
+    return raise(Type, "`vector-length` expected vector argument.");
+  }
+
+  return box_integer((int32_t) v->length);
+}
+
+VARIADIC_FORM_2(vector_ref, "vector-ref")
+
+struct LispDatum* vector_ref2(struct LispDatum* v, struct LispDatum* index) {
+  LISP_STATS_CALL(vector_ref);
+  if (LISP_INVALID(v->type != Vector || index->type != Integer)) {
+    return raise(Type, "`vector-ref` expected a vector and an integer.");
+  } else if (v->length == 0 || !is_position(index, v->length - 1)) {
+    return raise(Argument, "`vector-ref` index out of range.");
+  }
+
+  return retain(v->items[index->int_val]);
+}
+
+VARIADIC_FORM_3(vector_set, "vector-set!")
+
+struct LispDatum* vector_set3(struct LispDatum* v, struct LispDatum* index, struct LispDatum* item) {
+  LISP_STATS_CALL(vector_set);
+  if (LISP_INVALID(v->type != Vector || index->type != Integer)) {
+    return raise(Type, "`vector-set!` expected a vector and an integer.");
+  } else if (v->length == 0 || !is_position(index, v->length - 1)) {
+    return raise(Argument, "`vector-set!` index out of range.");
+  } else if (is_immortal(v)) {
+    return raise(Argument, "`vector-set!` can't modify an immutable vector.");
+  }
+
+  struct LispDatum** slot = &v->items[index->int_val];
+  struct LispDatum* old = *slot;
+  *slot = retain(item);
+  gc_write_barrier(v);
+  release(old);
+
+  return get_nil();
+}
+
+VARIADIC_FORM_2(vector_push, "vector-push!")
+
+struct LispDatum* vector_push2(struct LispDatum* v, struct LispDatum* item) {
+  LISP_STATS_CALL(vector_push);
+  if (LISP_INVALID(v->type != Vector)) {
+    return raise(Type, "`vector-push!` expected vector argument.");
+  } else if (is_immortal(v)) {
+    return raise(Argument, "`vector-push!` can't modify an immutable vector.");
+  }
+
+  vector_append(v, item);
+  gc_write_barrier(v);
+
+  return get_nil();
+}
+
+VARIADIC_FORM_2_3(vector_slice, "vector-slice")
+
+/** Copy part of a vector, up to its end when no end is given. */
+static struct LispDatum* slice_vector(struct LispDatum* v, struct LispDatum* start, struct LispDatum* end) {
+  if (LISP_INVALID(v->type != Vector)) {
+    return raise(Type, "`vector-slice` expected vector argument.");
+  }
+
+  uint32_t size = v->length;
+
+  if (!is_position(start, size) || (end != NULL && !is_position(end, size))) {
+    return raise(Argument, "`vector-slice` bounds out of range.");
+  }
+
+  uint32_t first = (uint32_t) start->int_val;
+  uint32_t last = end != NULL ? (uint32_t) end->int_val : size;
+
+  if (last < first) {
+    return raise(Argument, "`vector-slice` end comes before start.");
+  }
+
+  return new_vector_from(v->items + first, last - first);
+}
+
+struct LispDatum* vector_slice2(struct LispDatum* v, struct LispDatum* start) {
+  LISP_STATS_CALL(vector_slice);
+  return slice_vector(v, start, NULL);
+}
+
+struct LispDatum* vector_slice3(struct LispDatum* v, struct LispDatum* start, struct LispDatum* end) {
+  LISP_STATS_CALL(vector_slice);
+  return slice_vector(v, start, end);
+}
+
+VARIADIC_FORM_1(vector_to_list, "vector->list")
+
+struct LispDatum* vector_to_list1(struct LispDatum* v) {
+  LISP_STATS_CALL(vector_to_list);
+  if (LISP_INVALID(v->type != Vector)) {
+    return raise(Type, "`vector->list` expected vector argument.");
+  }
+
+  return new_list(v->items, v->length, NULL);
+}
+
+VARIADIC_FORM_1(list_to_vector, "list->vector")
+
+struct LispDatum* list_to_vector1(struct LispDatum* x) {
+  LISP_STATS_CALL(list_to_vector);
+  if (LISP_INVALID(x->type != Cons && x->type != Nil)) {
+    return raise(Type, "`list->vector` expected list argument.");
+  }
+
+  int32_t len = list_length(x);
+
+  if (len < 0) {
+    return raise(Type, "`list->vector` expects a proper list.");
+  }
+
+  struct LispDatum* v = new_vector((uint32_t) len);
+  struct LispDatum* idx = x;
+
+  while (is_occupied_node(idx)) {
+    vector_append(v, idx->car);
+    idx = idx->cdr;
+  }
+
+  return v;
+}
+
+struct LispDatum* hash_map(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(hash_map);
+  if (nargs % 2 != 0) {
+    return raise(Argument, "`hash-map` expects a value for every key.");
+  }
+
+  for (uint32_t i = 0; i < nargs; i += 2) {
+    if (!is_hashable(args[i])) {
+      return raise(Type, "Hash map keys must be numbers, strings, symbols, keywords, booleans, or nil.");
+    }
   }
 
-  return truthy(args[0]) ? get_false() : get_true();
+  struct LispDatum* map = new_hash_map(nargs / 2);
+
+  for (uint32_t i = 0; i < nargs; i += 2) {
+    map_put(map, args[i], args[i + 1]);
+  }
+
+  return map;
 }
 
+VARIADIC_FORM_2_3(hash_get, "hash-get")
+
+/** Look up a key, returning the fallback if it is missing, or nil when there is no fallback. */
+static struct LispDatum* lookup(struct LispDatum* map, struct LispDatum* key, struct LispDatum* fallback) {
+  if (LISP_INVALID(map->type != HashMap)) {
+    return raise(Type, "`hash-get` expected hash map argument.");
+  }
+
+  struct LispDatum* value = is_hashable(key) ? map_get(map, key) : NULL;
+
+  if (value == NULL) {
+    return fallback != NULL ? retain(fallback) : get_nil();
+  }
+
+  return retain(value);
+}
+
+struct LispDatum* hash_get2(struct LispDatum* map, struct LispDatum* key) {
+  LISP_STATS_CALL(hash_get);
+  return lookup(map, key, NULL);
+}
+
+struct LispDatum* hash_get3(struct LispDatum* map, struct LispDatum* key, struct LispDatum* fallback) {
+  LISP_STATS_CALL(hash_get);
+  return lookup(map, key, fallback);
+}
+
+VARIADIC_FORM_2(hash_contains, "hash-contains?")
+
+struct LispDatum* hash_contains2(struct LispDatum* map, struct LispDatum* key) {
+  LISP_STATS_CALL(hash_contains);
+  if (LISP_INVALID(map->type != HashMap)) {
+    return raise(Type, "`hash-contains?` expected hash map argument.");
+  }
+
+  return is_hashable(key) && map_get(map, key) != NULL ? get_true() : get_false();
+}
+
+VARIADIC_FORM_3(hash_put, "hash-put!")
+
+struct LispDatum* hash_put3(struct LispDatum* map, struct LispDatum* key, struct LispDatum* value) {
+  LISP_STATS_CALL(hash_put);
+  if (LISP_INVALID(map->type != HashMap)) {
+    return raise(Type, "`hash-put!` expected hash map argument.");
+  } else if (!is_hashable(key)) {
+    return raise(Type, "Hash map keys must be numbers, strings, symbols, keywords, booleans, or nil.");
+  } else if (is_immortal(map)) {
+    return raise(Argument, "`hash-put!` can't modify an immutable hash map.");
+  }
+
+  map_put(map, key, value);
+  gc_write_barrier(map);
+
+  return get_nil();
+}
+
+VARIADIC_FORM_2(hash_remove, "hash-remove!")
+
+struct LispDatum* hash_remove2(struct LispDatum* map, struct LispDatum* key) {
+  LISP_STATS_CALL(hash_remove);
+  if (LISP_INVALID(map->type != HashMap)) {
+    return raise(Type, "`hash-remove!` expected hash map argument.");
+  } else if (is_immortal(map)) {
+    return raise(Argument, "`hash-remove!` can't modify an immutable hash map.");
+  }
+
+  return is_hashable(key) && map_remove(map, key) ? get_true() : get_false();
+}
+
+VARIADIC_FORM_1(hash_count, "hash-count")
+
+struct LispDatum* hash_count1(struct LispDatum* map) {
+  LISP_STATS_CALL(hash_count);
+  if (LISP_INVALID(map->type != HashMap)) {
+    return raise(Type, "`hash-count` expected hash map argument.");
+  }
+
+  return box_integer((int32_t) map_count(map));
+}
+
+/** What `collect_entries` gathers from each entry. */
+enum EntryPart {
+  EntryKeys, EntryValues, EntryPairs
+};
+
+static struct LispDatum* collect_entries(struct LispDatum* map, enum EntryPart part, const char* name) {
+  if (LISP_INVALID(map->type != HashMap)) {
+    return raise(Type, name);
+  }
+
+  uint32_t count = map_count(map);
+  struct LispDatum* buffer[LISP_LIST_CHUNK_MAX];
+  struct LispDatum** items = count <= LISP_LIST_CHUNK_MAX ? buffer : lisp_alloc(count * sizeof(struct LispDatum*));
+  uint32_t cursor = 0;
+  struct LispMapEntry* entry;
+
+  for (uint32_t i = 0; (entry = map_next(map, &cursor)) != NULL; ++i) {
+    switch (part) {
+      case EntryKeys:
+        items[i] = entry->key;
+        break;
+      case EntryValues:
+        items[i] = entry->value;
+        break;
+      case EntryPairs:
+        items[i] = new_cons(entry->key, entry->value);
+        break;
+    }
+  }
+
+  struct LispDatum* result = new_list(items, count, NULL);
+
+  if (part == EntryPairs) {
+    for (uint32_t i = 0; i < count; ++i) {
+      release(items[i]);
+    }
+  }
+
+  if (items != buffer) {
+    lisp_free(items, count * sizeof(struct LispDatum*));
+  }
+
+  return result;
+}
+
+VARIADIC_FORM_1(hash_keys, "hash-keys")
+
+struct LispDatum* hash_keys1(struct LispDatum* map) {
+  LISP_STATS_CALL(hash_keys);
+  return collect_entries(map, EntryKeys, "`hash-keys` expected a single hash map argument.");
+}
+
+VARIADIC_FORM_1(hash_values, "hash-values")
+
+struct LispDatum* hash_values1(struct LispDatum* map) {
+  LISP_STATS_CALL(hash_values);
+  return collect_entries(map, EntryValues, "`hash-values` expected a single hash map argument.");
+}
+
+VARIADIC_FORM_1(hash_to_list, "hash->list")
+
+struct LispDatum* hash_to_list1(struct LispDatum* map) {
+  LISP_STATS_CALL(hash_to_list);
+  return collect_entries(map, EntryPairs, "`hash->list` expected a single hash map argument.");
+}
+
+/** Build a numeric array of the given type out of numbers, raising the given message if one can't be stored. */
+static struct LispDatum* fill_array(enum LispDataType type, struct LispDatum** items, uint32_t count,
+                                    const char* message) {
+  struct LispDatum* array = new_numeric_array(type, count);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    if (numeric_array_store(array, i, items[i])) {
+      release(array);
+      return raise(Type, message);
+    }
+  }
+
+  return array;
+}
+
+struct LispDatum* i32_array(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(i32_array);
+  return fill_array(I32Array, args, nargs, "`i32-array` expected integer arguments.");
+}
+
+struct LispDatum* f64_array(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(f64_array);
+  return fill_array(F64Array, args, nargs, "`f64-array` expected real arguments.");
+}
+
+struct LispDatum* c128_array(struct LispDatum** args, uint32_t nargs) {
+  LISP_STATS_CALL(c128_array);
+  return fill_array(C128Array, args, nargs, "`c128-array` expected numeric arguments.");
+}
+
+static struct LispDatum* list_to_array(struct LispDatum* x, enum LispDataType type, const char* message) {
+  if (LISP_INVALID(x->type != Cons && x->type != Nil)) {
+    return raise(Type, message);
+  }
+
+  int32_t len = list_length(x);
+
+  if (len < 0) {
+    return raise(Type, message);
+  }
+
+  struct LispDatum* array = new_numeric_array(type, (uint32_t) len);
+  struct LispDatum* idx = x;
+
+  for (uint32_t i = 0; is_occupied_node(idx); ++i, idx = idx->cdr) {
+    if (numeric_array_store(array, i, idx->car)) {
+      release(array);
+      return raise(Type, message);
+    }
+  }
+
+  return array;
+}
+
+VARIADIC_FORM_1(list_to_i32_array, "list->i32-array")
+
+struct LispDatum* list_to_i32_array1(struct LispDatum* x) {
+  LISP_STATS_CALL(list_to_i32_array);
+  return list_to_array(x, I32Array, "`list->i32-array` expected a single proper list of integers.");
+}
+
+VARIADIC_FORM_1(list_to_f64_array, "list->f64-array")
+
+struct LispDatum* list_to_f64_array1(struct LispDatum* x) {
+  LISP_STATS_CALL(list_to_f64_array);
+  return list_to_array(x, F64Array, "`list->f64-array` expected a single proper list of reals.");
+}
+
+VARIADIC_FORM_1(list_to_c128_array, "list->c128-array")
+
+struct LispDatum* list_to_c128_array1(struct LispDatum* x) {
+  LISP_STATS_CALL(list_to_c128_array);
+  return list_to_array(x, C128Array, "`list->c128-array` expected a single proper list of numbers.");
+}
+
+VARIADIC_FORM_1(array_to_list, "array->list")
+
+struct LispDatum* array_to_list1(struct LispDatum* array) {
+  LISP_STATS_CALL(array_to_list);
+  if (LISP_INVALID(!is_numeric_array(array))) {
+    return raise(Type, "`array->list` expected a single numeric array argument.");
+  }
+
+  uint32_t count = array->count;
+  struct LispDatum* buffer[LISP_LIST_CHUNK_MAX];
+  struct LispDatum** items = count <= LISP_LIST_CHUNK_MAX ? buffer : lisp_alloc(count * sizeof(struct LispDatum*));
+
+  for (uint32_t i = 0; i < count; ++i) {
+    items[i] = numeric_array_load(array, i);
+  }
+
+  struct LispDatum* result = new_list(items, count, NULL);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    release(items[i]);
+  }
+
+  if (items != buffer) {
+    lisp_free(items, count * sizeof(struct LispDatum*));
+  }
+
+  return result;
+}
+
+VARIADIC_FORM_1(array_length, "array-length")
+
+struct LispDatum* array_length1(struct LispDatum* array) {
+  LISP_STATS_CALL(array_length);
+  if (LISP_INVALID(!is_numeric_array(array))) {
+    return raise(Type, "`array-length` expected numeric array argument.");
+  }
+
+  return box_integer((int32_t) array->count);
+}
+
+VARIADIC_FORM_2(array_ref, "array-ref")
+
+struct LispDatum* array_ref2(struct LispDatum* array, struct LispDatum* index) {
+  LISP_STATS_CALL(array_ref);
+  if (LISP_INVALID(!is_numeric_array(array) || index->type != Integer)) {
+    return raise(Type, "`array-ref` expected a numeric array and an integer.");
+  } else if (array->count == 0 || !is_position(index, array->count - 1)) {
+    return raise(Argument, "`array-ref` index out of range.");
+  }
+
+  return numeric_array_load(array, (uint32_t) index->int_val);
+}
+
+/** Whether two arrays have the same type and length, as elementwise natives expect. */
+static int is_array_pair(const struct LispDatum* a, const struct LispDatum* b) {
+  return is_numeric_array(a) && a->type == b->type && a->count == b->count;
+}
+
+static struct LispDatum* combine_arrays(struct LispDatum* a, struct LispDatum* b, enum LispArithmetic op,
+                                        const char* message) {
+  if (!is_array_pair(a, b)) {
+    return raise(Type, message);
+  }
+
+  struct LispDatum* result = numeric_array_combine(a, b, op);
+  return result != NULL ? result : raise(Math, "Integer array arithmetic overflowed.");
+}
+
+VARIADIC_FORM_2(array_add, "array+")
+
+struct LispDatum* array_add2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(array_add);
+  return combine_arrays(a, b, LispAdd, "`array+` expected two numeric arrays of the same type and length.");
+}
+
+VARIADIC_FORM_2(array_subtract, "array-")
+
+struct LispDatum* array_subtract2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(array_subtract);
+  return combine_arrays(a, b, LispSubtract, "`array-` expected two numeric arrays of the same type and length.");
+}
+
+VARIADIC_FORM_2(array_multiply, "array*")
+
+struct LispDatum* array_multiply2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(array_multiply);
+  return combine_arrays(a, b, LispMultiply, "`array*` expected two numeric arrays of the same type and length.");
+}
+
+VARIADIC_FORM_2(array_divide, "array/")
+
+struct LispDatum* array_divide2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(array_divide);
+  return combine_arrays(a, b, LispDivide, "`array/` expected two numeric arrays of the same type and length.");
+}
+
+VARIADIC_FORM_2(array_dot, "array-dot")
+
+struct LispDatum* array_dot2(struct LispDatum* a, struct LispDatum* b) {
+  LISP_STATS_CALL(array_dot);
+  if (!is_array_pair(a, b)) {
+    return raise(Type, "`array-dot` expected two numeric arrays of the same type and length.");
+  }
+
+  struct LispDatum result;
+  numeric_array_dot(a, b, &result);
+  return box_scratch(&result);
+}
+
+VARIADIC_FORM_1(array_sum, "array-sum")
+
+struct LispDatum* array_sum1(struct LispDatum* array) {
+  LISP_STATS_CALL(array_sum);
+  if (LISP_INVALID(!is_numeric_array(array))) {
+    return raise(Type, "`array-sum` expected a single numeric array argument.");
+  }
+
+  struct LispDatum result;
+  numeric_array_sum(array, &result);
+  return box_scratch(&result);
+}
+
+static struct LispDatum* array_extremum(struct LispDatum* array, int greatest, const char* message) {
+  if (LISP_INVALID(!is_numeric_array(array))) {
+    return raise(Type, message);
+  } else if (array->count == 0) {
+    return raise(Argument, message);
+  }
+
+  struct LispDatum result;
+  numeric_array_extremum(array, greatest, &result);
+  return box_number(&result);
+}
+
+VARIADIC_FORM_1(array_min, "array-min")
+
+struct LispDatum* array_min1(struct LispDatum* array) {
+  LISP_STATS_CALL(array_min);
+  return array_extremum(array, 0, "`array-min` expected a single non-empty numeric array argument.");
+}
+
+VARIADIC_FORM_1(array_max, "array-max")
+
+struct LispDatum* array_max1(struct LispDatum* array) {
+  LISP_STATS_CALL(array_max);
+  return array_extremum(array, 1, "`array-max` expected a single non-empty numeric array argument.");
+}
+
+VARIADIC_FORM_2(save_image, "save-image")
+
+struct LispDatum* save_image2(struct LispDatum* path, struct LispDatum* value) {
+  LISP_STATS_CALL(save_image);
+  if (LISP_INVALID(path->type != String)) {
+    return raise(Type, "`save-image` expected a string path.");
+  }
+
+  return image_save(string_content(path), value) == 0 ? get_nil() : NULL;
+}
+
+VARIADIC_FORM_1(load_image, "load-image")
+
+struct LispDatum* load_image1(struct LispDatum* path) {
+  LISP_STATS_CALL(load_image);
+  if (LISP_INVALID(path->type != String)) {
+    return raise(Type, "`load-image` expected a string path.");
+  }
+
+  return image_load(string_content(path));
+}
@@ -2,19 +2,34 @@
 #define LISP_STDLISP_H
 
 #include "data.h"
+#include "err.h"
 
 // TODO(matthew-c21): I need to figure out a proper means of error handling.
 // TODO(matthew-c21): To go with prior TODO, determine behavior of division by 0.
 
+/*
+ * Ownership: every native borrows its arguments, and returns a new reference that the caller is responsible for
+ * releasing. This holds even when the returned value is one of the arguments (or part of one), in which case the native
+ * retains it before returning. Any structure built by a native holds its own references to the values it contains.
+ */
+
 /** Function pointer specifically designed to manage LISPy calling conventions.  */
 typedef struct LispDatum* (*LispFunction)(struct LispDatum**, uint32_t);
 
+/*
+ * Natives that take a fixed number of arguments also have direct entry points, named after the native and the number
+ * of arguments they take, e.g. `car1(x)` or `add2(a, b)`. These skip building an argument array and checking its
+ * length, and are what compiled code calls when the arity of a call is known. Otherwise they behave exactly like the
+ * variadic forms, which remain for calls through a `LispFunction`.
+ */
+
 /**
  * Sum all values provided.
  *
  * If no arguments are supplied, return 0. If non-numeric arguments are supplied, return NULL.
  */
 struct LispDatum* add(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* add2(struct LispDatum* a, struct LispDatum* b);
 
 /**
  * Subtract the 2nd, 3rd, etc., arguments from the first.
@@ -23,6 +38,7 @@ struct LispDatum* add(struct LispDatum** args, uint32_t nargs);
  * are supplied, return NULL.
  */
 struct LispDatum* subtract(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* subtract2(struct LispDatum* a, struct LispDatum* b);
 
 /**
  * Multiply all provided arguments.
@@ -30,6 +46,7 @@ struct LispDatum* subtract(struct LispDatum** args, uint32_t nargs);
  * If no arguments are supplied, return 1. If non-numeric arguments are supplied, return NULL.
  */
 struct LispDatum* multiply(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* multiply2(struct LispDatum* a, struct LispDatum* b);
 
 /**
  * Divide the first argument by all subsequent arguments.
@@ -38,6 +55,7 @@ struct LispDatum* multiply(struct LispDatum** args, uint32_t nargs);
  * arguments are supplied, return NULL.
  */
 struct LispDatum* divide(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* divide2(struct LispDatum* a, struct LispDatum* b);
 
 /**
  * Given integers a and b, return the smallest integer m such that a = b(mod m).
@@ -45,6 +63,7 @@ struct LispDatum* divide(struct LispDatum** args, uint32_t nargs);
  * Takes exactly two integer arguments. If anything else is provided, return NULL.
  */
 struct LispDatum* mod(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* mod2(struct LispDatum* a, struct LispDatum* b);
 
 /**
  * Given integers a and b, return a nil terminated list containing two numbers x and y such that y<a and a = bx + y.
@@ -52,30 +71,79 @@ struct LispDatum* mod(struct LispDatum** args, uint32_t nargs);
  * Takes exactly two integer arguments. If anything else is provided, return NULL.
  */
 struct LispDatum* division(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* division2(struct LispDatum* a, struct LispDatum* b);
 
+/** Write each argument followed by a space, then a newline, to the current output port (see port.h). Returns nil. */
 struct LispDatum* format(struct LispDatum** args, uint32_t nargs);
 
+/** Write the contents of the current output port out to its file. Returns nil. */
+struct LispDatum* flush_output(struct LispDatum** args, uint32_t nargs);
+
+/**
+ * Raise a condition, given a keyword naming its cause (see `condition_keyword`) and an optional message string. Control
+ * passes to the innermost `guard` or `with-handler` accepting the cause (see `LispHandler` in err.h), and otherwise
+ * follows the error behavior, returning NULL if it allows.
+ */
+struct LispDatum* signal_error(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* signal_error1(struct LispDatum* cause);
+struct LispDatum* signal_error2(struct LispDatum* cause, struct LispDatum* message);
+
+/** The keyword a cause goes by in LISP: `:type`, `:argument`, `:zero-division`, `:math` or `:generic`. */
+struct LispDatum* condition_keyword(enum Cause cause);
+
+/**
+ * Write a datum to the current output port, which is buffered stdout by default. The datum is only borrowed. Nesting
+ * is only limited by memory. The first time part of a circular structure comes back around inside itself, it is written
+ * as `#<cycle>`. With cycle detection turned off, circular structures are unrolled until the walk runs out of fuel
+ * (see walk.h), and only then cut short the same way.
+ */
 void display(struct LispDatum* datum);
 
+/**
+ * Set whether `display` in the current `LispState` watches for cycles from the start, which it does by default. Turning
+ * it off saves keeping track of the containers being written, at the cost of unrolling cycles for a while.
+ */
+void set_global_cycle_detection(int enabled);
+
+/**
+ * Whether two values are the same under `eqv?`. Numbers are compared by value across types, and strings by content.
+ * Lists, vectors and hash maps are only the same as themselves, except that all empty lists are the same.
+ */
 int datum_cmp(const struct LispDatum* a, const struct LispDatum* b);
 
+/**
+ * Whether two values are the same under `equal?`: like `datum_cmp`, but lists, vectors and hash maps are compared by
+ * their contents. Structures of any depth can be compared, and so can circular ones.
+ */
+int datum_equal(const struct LispDatum* a, const struct LispDatum* b);
+
 /**
  * Determines if two objects are strictly equal.
  *
  * This is equivalent to the eqv? predicate found in Scheme. See the R7RS spec for more information.
  */
 struct LispDatum* eqv(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* eqv2(struct LispDatum* a, struct LispDatum* b);
+
+/** Determines if each argument has the same structure and contents as the next, as with Scheme's equal? predicate. */
+struct LispDatum* equal(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* equal2(struct LispDatum* a, struct LispDatum* b);
 
 // Comparative functions and logical manipulation
 // TODO(matthew-c21): Most comparators can be discarded once user generated functions are in order.
 struct LispDatum* less_than(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* less_than2(struct LispDatum* a, struct LispDatum* b);
 struct LispDatum* num_equals(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* num_equals2(struct LispDatum* a, struct LispDatum* b);
 struct LispDatum* greater_than(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* greater_than2(struct LispDatum* a, struct LispDatum* b);
 struct LispDatum* less_than_eql(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* less_than_eql2(struct LispDatum* a, struct LispDatum* b);
 struct LispDatum* greater_than_eql(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* greater_than_eql2(struct LispDatum* a, struct LispDatum* b);
 
 /**
- * Returns last value in a list
+ * Returns last value in a list. Like `logical_or`, the result is one of the arguments rather than a copy.
  * @param args
  * @param nargs
  * @return
@@ -83,20 +151,31 @@ struct LispDatum* greater_than_eql(struct LispDatum** args, uint32_t nargs);
 struct LispDatum* logical_and(struct LispDatum** args, uint32_t nargs);
 struct LispDatum* logical_or(struct LispDatum** args, uint32_t nargs);
 struct LispDatum* logical_not(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* logical_not1(struct LispDatum* x);
+
+/**
+ * Call a procedure with the items of a list as its arguments, so `(apply f (list 1 2))` is the same as `(f 1 2)`. The
+ * list is only borrowed for the duration of the call. See closure.h.
+ */
+struct LispDatum* apply(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* apply2(struct LispDatum* f, struct LispDatum* arguments);
 
 // LIST FUNCTIONS
 
 /**
  * Obtain the first element of a list. Fails if the argument is not a list, or if it is empty as the first element of an
- * empty list is not defined.
+ * empty list is not defined. The element itself is returned (with a new reference), not a copy.
  */
 struct LispDatum* car(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* car1(struct LispDatum* x);
 
 /**
  * Obtain the linked child nodes in a list. When used on an empty list or nil, returns an empty list. When used on an
- * improper list, e.g. `(cdr '(a . b))`, returns the second item - in this case the symbol 'b'.
+ * improper list, e.g. `(cdr '(a . b))`, returns the second item - in this case the symbol 'b'. The tail is shared with
+ * the argument rather than copied.
  */
 struct LispDatum* cdr(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* cdr1(struct LispDatum* x);
 
 /**
  * Obtains the length of a proper list. Fails on non-list arguments, or when receiving too many arguments at once.
@@ -104,7 +183,11 @@ struct LispDatum* cdr(struct LispDatum** args, uint32_t nargs);
  * @throws Argument error if not given exactly one argument
  */
 struct LispDatum* length(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* length1(struct LispDatum* x);
+
+/** Creates a new pair. The pair holds its own references to both arguments. */
 struct LispDatum* cons(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* cons2(struct LispDatum* car, struct LispDatum* cdr);
 
 /**
  * Creates a linked list structure using the provided arguments. If `nargs` is 0, then the args array is not evaluated
@@ -116,7 +199,8 @@ struct LispDatum* list(struct LispDatum** args, uint32_t nargs);
 /**
  * Combines multiple lists together. Only joins top level lists. Returns an empty list if no lists are provided. Returns
  * the given list if only one list is provided. This has an interesting quirk that `(append nil)` returns nil instead of
- * an empty list. It will fail if given a single argument of any other type, however.
+ * an empty list. It will fail if given a single argument of any other type, however. All lists but the last are
+ * copied, while the last list is shared as the tail of the result.
  *
  * Example: (append (1 2) (3 4)) ==> (1 2 3 4)
  */
@@ -130,5 +214,200 @@ struct LispDatum* append(struct LispDatum** args, uint32_t nargs);
  * @throws Type exception if the argument is neither a proper list nor nil.
  */
 struct LispDatum* reverse(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* reverse1(struct LispDatum* x);
+
+/**
+ * Replace the first element of a non-empty list. Since lists share structure, the change is visible through every list
+ * that contains the cell. Returns nil.
+ */
+struct LispDatum* set_car(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* set_car2(struct LispDatum* pair, struct LispDatum* value);
+
+/**
+ * Replace the rest of a non-empty list. Giving nil or an empty list makes the cell the last in its list. Returns nil.
+ * @throws Type exception if the first argument is not a non-empty list.
+ */
+struct LispDatum* set_cdr(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* set_cdr2(struct LispDatum* pair, struct LispDatum* value);
+
+/**
+ * Concatenates any number of strings into a new string. Returns an empty string if no strings are provided.
+ *
+ * @throws Type exception if any argument is not a string.
+ */
+struct LispDatum* string_append(struct LispDatum** args, uint32_t nargs);
+
+/** Creates a vector of the given arguments. `vector(NULL, 0)` returns a valid, empty vector. */
+struct LispDatum* vector(struct LispDatum** args, uint32_t nargs);
+
+struct LispDatum* vector_length(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* vector_length1(struct LispDatum* v);
+
+/**
+ * Obtain the item at a 0 based index of a vector in constant time. The item itself is returned, not a copy.
+ * @throws Argument exception if the index is out of range.
+ */
+struct LispDatum* vector_ref(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* vector_ref2(struct LispDatum* v, struct LispDatum* index);
+
+/**
+ * Replace the item at a 0 based index of a vector. Returns nil.
+ * @throws Argument exception if the index is out of range.
+ */
+struct LispDatum* vector_set(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* vector_set3(struct LispDatum* v, struct LispDatum* index, struct LispDatum* item);
+
+/** Add an item to the end of a vector in amortized constant time. Returns nil. */
+struct LispDatum* vector_push(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* vector_push2(struct LispDatum* v, struct LispDatum* item);
+
+/**
+ * Copy the items of a vector from a start index up to (not including) an end index into a new vector. The end defaults
+ * to the length of the vector. The items themselves are shared.
+ *
+ * Example: (vector-slice #(1 2 3 4) 1 3) ==> #(2 3)
+ */
+struct LispDatum* vector_slice(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* vector_slice2(struct LispDatum* v, struct LispDatum* start);
+struct LispDatum* vector_slice3(struct LispDatum* v, struct LispDatum* start, struct LispDatum* end);
+
+/** Creates a list of the items in a vector. */
+struct LispDatum* vector_to_list(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* vector_to_list1(struct LispDatum* v);
+
+/**
+ * Creates a vector of the elements in a list.
+ * @throws Type exception if the argument is neither a proper list nor nil.
+ */
+struct LispDatum* list_to_vector(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* list_to_vector1(struct LispDatum* x);
+
+/**
+ * Creates a hash map from alternating keys and values. Later keys replace earlier ones that compare equal.
+ *
+ * Example: (hash-map :a 1 :b 2) ==> {:a 1 :b 2}
+ * @throws Argument exception if there is a key without a value.
+ * @throws Type exception if a key is a list, vector, or hash map.
+ */
+struct LispDatum* hash_map(struct LispDatum** args, uint32_t nargs);
+
+/**
+ * Look up the value associated with a key. If there is none, returns the optional third argument, or nil without it.
+ * The value itself is returned, not a copy.
+ */
+struct LispDatum* hash_get(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* hash_get2(struct LispDatum* map, struct LispDatum* key);
+struct LispDatum* hash_get3(struct LispDatum* map, struct LispDatum* key, struct LispDatum* fallback);
+
+struct LispDatum* hash_contains(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* hash_contains2(struct LispDatum* map, struct LispDatum* key);
+
+/**
+ * Associate a key with a value, replacing any previous value. Returns nil.
+ * @throws Type exception if the key is a list, vector, or hash map.
+ */
+struct LispDatum* hash_put(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* hash_put3(struct LispDatum* map, struct LispDatum* key, struct LispDatum* value);
+
+/** Remove a key and its value. Returns whether the key was present. */
+struct LispDatum* hash_remove(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* hash_remove2(struct LispDatum* map, struct LispDatum* key);
+
+struct LispDatum* hash_count(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* hash_count1(struct LispDatum* map);
+
+/** The keys, values, and key-value pairs of a hash map respectively as lists, in no particular order. */
+struct LispDatum* hash_keys(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* hash_keys1(struct LispDatum* map);
+struct LispDatum* hash_values(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* hash_values1(struct LispDatum* map);
+struct LispDatum* hash_to_list(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* hash_to_list1(struct LispDatum* map);
+
+/**
+ * Create a numeric array of 32 bit integers, reals, or complex numbers from the arguments. See numarray.h.
+ *
+ * Example: (f64-array 1 2.5 1/2) ==> #f64(1.0 2.5 0.5)
+ * @throws Type exception if an argument can't be stored in the array, such as a real in an integer array.
+ */
+struct LispDatum* i32_array(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* f64_array(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* c128_array(struct LispDatum** args, uint32_t nargs);
+
+/**
+ * Create a numeric array of the numbers in a list.
+ * @throws Type exception if the argument is not a proper list, or a number can't be stored in the array.
+ */
+struct LispDatum* list_to_i32_array(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* list_to_i32_array1(struct LispDatum* x);
+struct LispDatum* list_to_f64_array(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* list_to_f64_array1(struct LispDatum* x);
+struct LispDatum* list_to_c128_array(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* list_to_c128_array1(struct LispDatum* x);
+
+/** Creates a list of the elements of a numeric array, each boxed. */
+struct LispDatum* array_to_list(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_to_list1(struct LispDatum* array);
+
+struct LispDatum* array_length(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_length1(struct LispDatum* array);
+
+/**
+ * Obtain the element at a 0 based index of a numeric array, as a new number.
+ * @throws Argument exception if the index is out of range.
+ */
+struct LispDatum* array_ref(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_ref2(struct LispDatum* array, struct LispDatum* index);
+
+/**
+ * Elementwise arithmetic on two numeric arrays of the same type and length. Dividing integer arrays gives a real array,
+ * and division by zero follows IEEE 754 rather than raising.
+ *
+ * Example: (array* (i32-array 1 2 3) (i32-array 4 5 6)) ==> #i32(4 10 18)
+ * @throws Math exception if an element of an integer array overflows.
+ */
+struct LispDatum* array_add(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_add2(struct LispDatum* a, struct LispDatum* b);
+struct LispDatum* array_subtract(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_subtract2(struct LispDatum* a, struct LispDatum* b);
+struct LispDatum* array_multiply(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_multiply2(struct LispDatum* a, struct LispDatum* b);
+struct LispDatum* array_divide(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_divide2(struct LispDatum* a, struct LispDatum* b);
+
+/** Sum of the elementwise products of two numeric arrays of the same type and length. */
+struct LispDatum* array_dot(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_dot2(struct LispDatum* a, struct LispDatum* b);
+
+/** Sum of the elements of a numeric array. Integer sums are exact, and may be big integers. */
+struct LispDatum* array_sum(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_sum1(struct LispDatum* array);
+
+/**
+ * The least and greatest element of a numeric array. Complex numbers are ordered by real part, then imaginary part.
+ * @throws Argument exception if the array is empty.
+ */
+struct LispDatum* array_min(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_min1(struct LispDatum* array);
+struct LispDatum* array_max(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* array_max1(struct LispDatum* array);
+
+/**
+ * Save a value, and everything it refers to, to an image file that `load-image` can map back in on a later run without
+ * rebuilding it. See image.h.
+ * Example: (save-image "tables.img" (list 1 2 3)) ==> nil
+ * @throws Type exception if the value contains a closure.
+ */
+struct LispDatum* save_image(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* save_image2(struct LispDatum* path, struct LispDatum* value);
+
+/**
+ * Load the value saved to an image file. The result is immutable, and shared with anything else loaded from the same
+ * call. `set-car!`, `set-cdr!`, `vector-set!`, `vector-push!`, `hash-put!`, and `hash-remove!` raise an Argument
+ * exception when given any part of it.
+ * Example: (load-image "tables.img") ==> (1 2 3)
+ */
+struct LispDatum* load_image(struct LispDatum** args, uint32_t nargs);
+struct LispDatum* load_image1(struct LispDatum* path);
 
 #endif //LISP_STDLISP_H
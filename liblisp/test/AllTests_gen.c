@@ -0,0 +1,361 @@
+
+
+/* This is auto-generated code. Edit at your own peril. */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "CuTest.h"
+
+
+extern void Test_datum_slot_reuse(CuTest*);
+extern void Test_distinct_allocations(CuTest*);
+extern void Test_large_string_allocation(CuTest*);
+extern void Test_boxed_integers_are_shared(CuTest*);
+extern void Test_arithmetic_results_use_shared_integers(CuTest*);
+extern void Test_bigint_overflow_promotes(CuTest*);
+extern void Test_bigint_parse_and_format(CuTest*);
+extern void Test_bigint_karatsuba(CuTest*);
+extern void Test_bigint_divmod(CuTest*);
+extern void Test_bigint_compare(CuTest*);
+extern void Test_closure_call(CuTest*);
+extern void Test_closure_owns_environment(CuTest*);
+extern void Test_apply(CuTest*);
+extern void Test_handler_catches_raise(CuTest*);
+extern void Test_handler_not_raised(CuTest*);
+extern void Test_handler_filters_causes(CuTest*);
+extern void Test_handler_catches_natives(CuTest*);
+extern void Test_gc_minor_preserves_roots(CuTest*);
+extern void Test_gc_safepoint_waits_for_full_nursery(CuTest*);
+extern void Test_gc_major_compacts(CuTest*);
+extern void Test_gc_write_barrier(CuTest*);
+extern void Test_gc_long_list(CuTest*);
+extern void Test_gc_traces_vectors(CuTest*);
+extern void Test_gc_traces_maps(CuTest*);
+extern void Test_gc_traces_closures(CuTest*);
+extern void Test_gc_raise_pops_roots(CuTest*);
+extern void Test_map_put_get(CuTest*);
+extern void Test_map_numeric_keys(CuTest*);
+extern void Test_map_remove(CuTest*);
+extern void Test_map_natives(CuTest*);
+extern void Test_image_round_trip(CuTest*);
+extern void Test_image_shared_structure(CuTest*);
+extern void Test_image_errors(CuTest*);
+extern void Test_image_immutable(CuTest*);
+extern void Test_list_spanning_chunks(CuTest*);
+extern void Test_list_length_of_tails(CuTest*);
+extern void Test_list_shared_tail(CuTest*);
+extern void Test_list_improper_tail(CuTest*);
+extern void Test_list_set_cdr(CuTest*);
+extern void Test_list_set_cdr_other_state(CuTest*);
+extern void Test_list_length_cached_again(CuTest*);
+extern void Test_list_set_car(CuTest*);
+extern void Test_list_reverse_large(CuTest*);
+extern void Test_list_equal(CuTest*);
+extern void Test_list_equal_deep(CuTest*);
+extern void Test_list_equal_cycles(CuTest*);
+extern void Test_numarray_elementwise(CuTest*);
+extern void Test_numarray_overflow(CuTest*);
+extern void Test_numarray_reductions(CuTest*);
+extern void Test_numarray_complex_reductions(CuTest*);
+extern void Test_numarray_lists(CuTest*);
+extern void Test_numeric_pairs_commute(CuTest*);
+extern void Test_numeric_mixed_types(CuTest*);
+extern void Test_numeric_divide(CuTest*);
+extern void Test_numfmt_integers(CuTest*);
+extern void Test_numfmt_real_notation(CuTest*);
+extern void Test_numfmt_real_roundtrip(CuTest*);
+extern void Test_numfmt_numbers(CuTest*);
+extern void Test_port_display(CuTest*);
+extern void Test_port_format(CuTest*);
+extern void Test_port_display_deep(CuTest*);
+extern void Test_port_display_cycles(CuTest*);
+extern void Test_port_display_shared(CuTest*);
+extern void Test_port_file_buffering(CuTest*);
+extern void Test_rational_long_fold(CuTest*);
+extern void Test_rational_intermediate_overflow(CuTest*);
+extern void Test_rational_exact_compare(CuTest*);
+extern void Test_new_datum_single_owner(CuTest*);
+extern void Test_statics_are_immortal(CuTest*);
+extern void Test_list_owns_elements(CuTest*);
+extern void Test_shared_tail_survives(CuTest*);
+extern void Test_release_long_list(CuTest*);
+extern void Test_deferred_release(CuTest*);
+extern void Test_release_deep_nesting(CuTest*);
+extern void Test_simd_kernels(CuTest*);
+extern void Test_simd_integer_fold(CuTest*);
+extern void Test_simd_real_fold(CuTest*);
+extern void Test_simd_chained_compare(CuTest*);
+extern void Test_state_error_isolation(CuTest*);
+extern void Test_state_bind_restores_default(CuTest*);
+extern void Test_state_statics_are_shared(CuTest*);
+extern void Test_state_concurrent_workloads(CuTest*);
+extern void TestStats_CountsAllocationsByType(CuTest*);
+extern void TestStats_CountsNativeCallsOnce(CuTest*);
+extern void TestStats_CountsPromotionSteps(CuTest*);
+extern void TestStats_CountsRaisesByCause(CuTest*);
+extern void TestStats_ReportIsOneLineOfJson(CuTest*);
+extern void Test_int_equality(CuTest*);
+extern void Test_int_inequality(CuTest*);
+extern void Test_float_equality(CuTest*);
+extern void Test_float_inequality(CuTest*);
+extern void Test_rational_equality(CuTest*);
+extern void Test_rational_inequality(CuTest*);
+extern void Test_complex_equality(CuTest*);
+extern void Test_complex_inequality(CuTest*);
+extern void Test_promotion_equality_int(CuTest*);
+extern void Test_promotion_equality_rational(CuTest*);
+extern void Test_promotion_equality_real(CuTest*);
+extern void Test_cons_equality(CuTest*);
+extern void Test_cons_inequality(CuTest*);
+extern void Test_int_addition(CuTest*);
+extern void Test_real_addition(CuTest*);
+extern void Test_rational_addition(CuTest*);
+extern void Test_complex_addition(CuTest*);
+extern void Test_direct_arithmetic(CuTest*);
+extern void Test_int_subtraction(CuTest*);
+extern void Test_real_subtraction(CuTest*);
+extern void Test_rational_subtraction(CuTest*);
+extern void Test_complex_subtraction(CuTest*);
+extern void Test_int_division(CuTest*);
+extern void Test_real_division(CuTest*);
+extern void Test_rational_division(CuTest*);
+extern void Test_complex_division(CuTest*);
+extern void Test_int_int_multiplication(CuTest*);
+extern void Test_int_real_multiplication(CuTest*);
+extern void Test_int_rational_multiplication(CuTest*);
+extern void Test_int_complex_multiplication(CuTest*);
+extern void Test_real_int_multiplication(CuTest*);
+extern void Test_real_real_multiplication(CuTest*);
+extern void Test_real_rational_multiplication(CuTest*);
+extern void Test_real_complex_multiplication(CuTest*);
+extern void Test_rational_int_multiplication(CuTest*);
+extern void Test_rational_real_multiplication(CuTest*);
+extern void Test_rational_rational_multiplication(CuTest*);
+extern void Test_rational_complex_multiplication(CuTest*);
+extern void Test_complex_int_multiplication(CuTest*);
+extern void Test_complex_real_multiplication(CuTest*);
+extern void Test_complex_rational_multiplication(CuTest*);
+extern void Test_complex_complex_multiplication(CuTest*);
+extern void Test_multiplication(CuTest*);
+extern void Test_bool_equality(CuTest*);
+extern void Test_bool_inequality(CuTest*);
+extern void Test_discard_statics(CuTest*);
+extern void Test_string_equality(CuTest*);
+extern void Test_string_inequality(CuTest*);
+extern void Test_variable_eqv(CuTest*);
+extern void Test_empty_list(CuTest*);
+extern void Test_single_element_list(CuTest*);
+extern void Test_nil_cadr(CuTest*);
+extern void Test_car(CuTest*);
+extern void Test_cdr(CuTest*);
+extern void Test_cadr_errors(CuTest*);
+extern void Test_length(CuTest*);
+extern void Test_length_errors(CuTest*);
+extern void Test_append(CuTest*);
+extern void Test_append_errors(CuTest*);
+extern void Test_cons(CuTest*);
+extern void Test_cons_errors(CuTest*);
+extern void Test_reverse(CuTest*);
+extern void Test_reverse_errors(CuTest*);
+extern void Test_short_strings_are_inline(CuTest*);
+extern void Test_long_strings(CuTest*);
+extern void Test_long_literals_are_not_copied(CuTest*);
+extern void Test_string_hash(CuTest*);
+extern void Test_string_builder(CuTest*);
+extern void Test_string_append(CuTest*);
+extern void Test_symbols_are_interned(CuTest*);
+extern void Test_keywords_are_distinct_from_symbols(CuTest*);
+extern void Test_symbol_equality(CuTest*);
+extern void Test_intern_all(CuTest*);
+extern void Test_concurrent_interning(CuTest*);
+extern void Test_vector_push_grows(CuTest*);
+extern void Test_vector_set(CuTest*);
+extern void Test_vector_slice(CuTest*);
+extern void Test_vector_list_conversion(CuTest*);
+
+
+void RunAllTests(void) 
+{
+    CuString *output = CuStringNew();
+    CuSuite* suite = CuSuiteNew();
+
+
+    SUITE_ADD_TEST(suite, Test_datum_slot_reuse);
+    SUITE_ADD_TEST(suite, Test_distinct_allocations);
+    SUITE_ADD_TEST(suite, Test_large_string_allocation);
+    SUITE_ADD_TEST(suite, Test_boxed_integers_are_shared);
+    SUITE_ADD_TEST(suite, Test_arithmetic_results_use_shared_integers);
+    SUITE_ADD_TEST(suite, Test_bigint_overflow_promotes);
+    SUITE_ADD_TEST(suite, Test_bigint_parse_and_format);
+    SUITE_ADD_TEST(suite, Test_bigint_karatsuba);
+    SUITE_ADD_TEST(suite, Test_bigint_divmod);
+    SUITE_ADD_TEST(suite, Test_bigint_compare);
+    SUITE_ADD_TEST(suite, Test_closure_call);
+    SUITE_ADD_TEST(suite, Test_closure_owns_environment);
+    SUITE_ADD_TEST(suite, Test_apply);
+    SUITE_ADD_TEST(suite, Test_handler_catches_raise);
+    SUITE_ADD_TEST(suite, Test_handler_not_raised);
+    SUITE_ADD_TEST(suite, Test_handler_filters_causes);
+    SUITE_ADD_TEST(suite, Test_handler_catches_natives);
+    SUITE_ADD_TEST(suite, Test_gc_minor_preserves_roots);
+    SUITE_ADD_TEST(suite, Test_gc_safepoint_waits_for_full_nursery);
+    SUITE_ADD_TEST(suite, Test_gc_major_compacts);
+    SUITE_ADD_TEST(suite, Test_gc_write_barrier);
+    SUITE_ADD_TEST(suite, Test_gc_long_list);
+    SUITE_ADD_TEST(suite, Test_gc_traces_vectors);
+    SUITE_ADD_TEST(suite, Test_gc_traces_maps);
+    SUITE_ADD_TEST(suite, Test_gc_traces_closures);
+    SUITE_ADD_TEST(suite, Test_gc_raise_pops_roots);
+    SUITE_ADD_TEST(suite, Test_map_put_get);
+    SUITE_ADD_TEST(suite, Test_map_numeric_keys);
+    SUITE_ADD_TEST(suite, Test_map_remove);
+    SUITE_ADD_TEST(suite, Test_map_natives);
+    SUITE_ADD_TEST(suite, Test_image_round_trip);
+    SUITE_ADD_TEST(suite, Test_image_shared_structure);
+    SUITE_ADD_TEST(suite, Test_image_errors);
+    SUITE_ADD_TEST(suite, Test_image_immutable);
+    SUITE_ADD_TEST(suite, Test_list_spanning_chunks);
+    SUITE_ADD_TEST(suite, Test_list_length_of_tails);
+    SUITE_ADD_TEST(suite, Test_list_shared_tail);
+    SUITE_ADD_TEST(suite, Test_list_improper_tail);
+    SUITE_ADD_TEST(suite, Test_list_set_cdr);
+    SUITE_ADD_TEST(suite, Test_list_set_cdr_other_state);
+    SUITE_ADD_TEST(suite, Test_list_length_cached_again);
+    SUITE_ADD_TEST(suite, Test_list_set_car);
+    SUITE_ADD_TEST(suite, Test_list_reverse_large);
+    SUITE_ADD_TEST(suite, Test_list_equal);
+    SUITE_ADD_TEST(suite, Test_list_equal_deep);
+    SUITE_ADD_TEST(suite, Test_list_equal_cycles);
+    SUITE_ADD_TEST(suite, Test_numarray_elementwise);
+    SUITE_ADD_TEST(suite, Test_numarray_overflow);
+    SUITE_ADD_TEST(suite, Test_numarray_reductions);
+    SUITE_ADD_TEST(suite, Test_numarray_complex_reductions);
+    SUITE_ADD_TEST(suite, Test_numarray_lists);
+    SUITE_ADD_TEST(suite, Test_numeric_pairs_commute);
+    SUITE_ADD_TEST(suite, Test_numeric_mixed_types);
+    SUITE_ADD_TEST(suite, Test_numeric_divide);
+    SUITE_ADD_TEST(suite, Test_numfmt_integers);
+    SUITE_ADD_TEST(suite, Test_numfmt_real_notation);
+    SUITE_ADD_TEST(suite, Test_numfmt_real_roundtrip);
+    SUITE_ADD_TEST(suite, Test_numfmt_numbers);
+    SUITE_ADD_TEST(suite, Test_port_display);
+    SUITE_ADD_TEST(suite, Test_port_format);
+    SUITE_ADD_TEST(suite, Test_port_display_deep);
+    SUITE_ADD_TEST(suite, Test_port_display_cycles);
+    SUITE_ADD_TEST(suite, Test_port_display_shared);
+    SUITE_ADD_TEST(suite, Test_port_file_buffering);
+    SUITE_ADD_TEST(suite, Test_rational_long_fold);
+    SUITE_ADD_TEST(suite, Test_rational_intermediate_overflow);
+    SUITE_ADD_TEST(suite, Test_rational_exact_compare);
+    SUITE_ADD_TEST(suite, Test_new_datum_single_owner);
+    SUITE_ADD_TEST(suite, Test_statics_are_immortal);
+    SUITE_ADD_TEST(suite, Test_list_owns_elements);
+    SUITE_ADD_TEST(suite, Test_shared_tail_survives);
+    SUITE_ADD_TEST(suite, Test_release_long_list);
+    SUITE_ADD_TEST(suite, Test_deferred_release);
+    SUITE_ADD_TEST(suite, Test_release_deep_nesting);
+    SUITE_ADD_TEST(suite, Test_simd_kernels);
+    SUITE_ADD_TEST(suite, Test_simd_integer_fold);
+    SUITE_ADD_TEST(suite, Test_simd_real_fold);
+    SUITE_ADD_TEST(suite, Test_simd_chained_compare);
+    SUITE_ADD_TEST(suite, Test_state_error_isolation);
+    SUITE_ADD_TEST(suite, Test_state_bind_restores_default);
+    SUITE_ADD_TEST(suite, Test_state_statics_are_shared);
+    SUITE_ADD_TEST(suite, Test_state_concurrent_workloads);
+    SUITE_ADD_TEST(suite, TestStats_CountsAllocationsByType);
+    SUITE_ADD_TEST(suite, TestStats_CountsNativeCallsOnce);
+    SUITE_ADD_TEST(suite, TestStats_CountsPromotionSteps);
+    SUITE_ADD_TEST(suite, TestStats_CountsRaisesByCause);
+    SUITE_ADD_TEST(suite, TestStats_ReportIsOneLineOfJson);
+    SUITE_ADD_TEST(suite, Test_int_equality);
+    SUITE_ADD_TEST(suite, Test_int_inequality);
+    SUITE_ADD_TEST(suite, Test_float_equality);
+    SUITE_ADD_TEST(suite, Test_float_inequality);
+    SUITE_ADD_TEST(suite, Test_rational_equality);
+    SUITE_ADD_TEST(suite, Test_rational_inequality);
+    SUITE_ADD_TEST(suite, Test_complex_equality);
+    SUITE_ADD_TEST(suite, Test_complex_inequality);
+    SUITE_ADD_TEST(suite, Test_promotion_equality_int);
+    SUITE_ADD_TEST(suite, Test_promotion_equality_rational);
+    SUITE_ADD_TEST(suite, Test_promotion_equality_real);
+    SUITE_ADD_TEST(suite, Test_cons_equality);
+    SUITE_ADD_TEST(suite, Test_cons_inequality);
+    SUITE_ADD_TEST(suite, Test_int_addition);
+    SUITE_ADD_TEST(suite, Test_real_addition);
+    SUITE_ADD_TEST(suite, Test_rational_addition);
+    SUITE_ADD_TEST(suite, Test_complex_addition);
+    SUITE_ADD_TEST(suite, Test_direct_arithmetic);
+    SUITE_ADD_TEST(suite, Test_int_subtraction);
+    SUITE_ADD_TEST(suite, Test_real_subtraction);
+    SUITE_ADD_TEST(suite, Test_rational_subtraction);
+    SUITE_ADD_TEST(suite, Test_complex_subtraction);
+    SUITE_ADD_TEST(suite, Test_int_division);
+    SUITE_ADD_TEST(suite, Test_real_division);
+    SUITE_ADD_TEST(suite, Test_rational_division);
+    SUITE_ADD_TEST(suite, Test_complex_division);
+    SUITE_ADD_TEST(suite, Test_int_int_multiplication);
+    SUITE_ADD_TEST(suite, Test_int_real_multiplication);
+    SUITE_ADD_TEST(suite, Test_int_rational_multiplication);
+    SUITE_ADD_TEST(suite, Test_int_complex_multiplication);
+    SUITE_ADD_TEST(suite, Test_real_int_multiplication);
+    SUITE_ADD_TEST(suite, Test_real_real_multiplication);
+    SUITE_ADD_TEST(suite, Test_real_rational_multiplication);
+    SUITE_ADD_TEST(suite, Test_real_complex_multiplication);
+    SUITE_ADD_TEST(suite, Test_rational_int_multiplication);
+    SUITE_ADD_TEST(suite, Test_rational_real_multiplication);
+    SUITE_ADD_TEST(suite, Test_rational_rational_multiplication);
+    SUITE_ADD_TEST(suite, Test_rational_complex_multiplication);
+    SUITE_ADD_TEST(suite, Test_complex_int_multiplication);
+    SUITE_ADD_TEST(suite, Test_complex_real_multiplication);
+    SUITE_ADD_TEST(suite, Test_complex_rational_multiplication);
+    SUITE_ADD_TEST(suite, Test_complex_complex_multiplication);
+    SUITE_ADD_TEST(suite, Test_multiplication);
+    SUITE_ADD_TEST(suite, Test_bool_equality);
+    SUITE_ADD_TEST(suite, Test_bool_inequality);
+    SUITE_ADD_TEST(suite, Test_discard_statics);
+    SUITE_ADD_TEST(suite, Test_string_equality);
+    SUITE_ADD_TEST(suite, Test_string_inequality);
+    SUITE_ADD_TEST(suite, Test_variable_eqv);
+    SUITE_ADD_TEST(suite, Test_empty_list);
+    SUITE_ADD_TEST(suite, Test_single_element_list);
+    SUITE_ADD_TEST(suite, Test_nil_cadr);
+    SUITE_ADD_TEST(suite, Test_car);
+    SUITE_ADD_TEST(suite, Test_cdr);
+    SUITE_ADD_TEST(suite, Test_cadr_errors);
+    SUITE_ADD_TEST(suite, Test_length);
+    SUITE_ADD_TEST(suite, Test_length_errors);
+    SUITE_ADD_TEST(suite, Test_append);
+    SUITE_ADD_TEST(suite, Test_append_errors);
+    SUITE_ADD_TEST(suite, Test_cons);
+    SUITE_ADD_TEST(suite, Test_cons_errors);
+    SUITE_ADD_TEST(suite, Test_reverse);
+    SUITE_ADD_TEST(suite, Test_reverse_errors);
+    SUITE_ADD_TEST(suite, Test_short_strings_are_inline);
+    SUITE_ADD_TEST(suite, Test_long_strings);
+    SUITE_ADD_TEST(suite, Test_long_literals_are_not_copied);
+    SUITE_ADD_TEST(suite, Test_string_hash);
+    SUITE_ADD_TEST(suite, Test_string_builder);
+    SUITE_ADD_TEST(suite, Test_string_append);
+    SUITE_ADD_TEST(suite, Test_symbols_are_interned);
+    SUITE_ADD_TEST(suite, Test_keywords_are_distinct_from_symbols);
+    SUITE_ADD_TEST(suite, Test_symbol_equality);
+    SUITE_ADD_TEST(suite, Test_intern_all);
+    SUITE_ADD_TEST(suite, Test_concurrent_interning);
+    SUITE_ADD_TEST(suite, Test_vector_push_grows);
+    SUITE_ADD_TEST(suite, Test_vector_set);
+    SUITE_ADD_TEST(suite, Test_vector_slice);
+    SUITE_ADD_TEST(suite, Test_vector_list_conversion);
+
+    CuSuiteRun(suite);
+    CuSuiteSummary(suite, output);
+    CuSuiteDetails(suite, output);
+    printf("%s\n", output->buffer);
+    CuStringDelete(output);
+    CuSuiteDelete(suite);
+}
+
+int main(void)
+{
+    RunAllTests();
+}
+
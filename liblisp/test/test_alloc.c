@@ -0,0 +1,78 @@
+#include <string.h>
+
+#include "CuTest.h"
+#include "../alloc.h"
+#include "../data.h"
+#include "../lstring.h"
+#include "../stdlisp.h"
+
+void Test_datum_slot_reuse(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  // Datums are not reused until the collector runs.
+  (void) tc;
+  return;
+#endif
+
+  struct LispDatum* a = new_integer(1);
+  discard_datum(a);
+
+  // The most recently released slot of a size class is the first to be handed back out.
+  struct LispDatum* b = new_real(2.0);
+  CuAssertPtrEquals(tc, a, b);
+  CuAssert(tc, "Reused slot is reinitialized", b->type == Real && b->float_val == 2.0);
+
+  discard_datum(b);
+}
+
+void Test_distinct_allocations(CuTest* tc) {
+  struct LispDatum* a = new_integer(1);
+  struct LispDatum* b = new_integer(2);
+
+  CuAssert(tc, "Live datums do not overlap", a != b);
+  CuAssertIntEquals(tc, 1, a->int_val);
+  CuAssertIntEquals(tc, 2, b->int_val);
+
+  discard_datum(a);
+  discard_datum(b);
+}
+
+void Test_large_string_allocation(CuTest* tc) {
+  char buffer[LISP_ALLOC_MAX_SMALL * 2];
+  memset(buffer, 'a', sizeof(buffer) - 1);
+  buffer[sizeof(buffer) - 1] = 0;
+
+  struct LispDatum* s = new_string(buffer);
+  CuAssertIntEquals(tc, sizeof(buffer) - 1, string_length(s));
+  CuAssertStrEquals(tc, buffer, string_content(s));
+
+  discard_datum(s);
+}
+
+void Test_boxed_integers_are_shared(CuTest* tc) {
+  CuAssertPtrEquals(tc, box_integer(5), box_integer(5));
+  CuAssertPtrEquals(tc, box_integer(LISP_SMALL_INT_MIN), box_integer(LISP_SMALL_INT_MIN));
+  CuAssertPtrEquals(tc, box_integer(LISP_SMALL_INT_MAX), box_integer(LISP_SMALL_INT_MAX));
+  CuAssertIntEquals(tc, -17, box_integer(-17)->int_val);
+
+  struct LispDatum* big = box_integer(LISP_SMALL_INT_MAX + 1);
+  CuAssertIntEquals(tc, LISP_SMALL_INT_MAX + 1, big->int_val);
+  CuAssert(tc, "Values outside the small range are allocated", big != box_integer(LISP_SMALL_INT_MAX + 1));
+
+  // Discarding a shared integer must leave it intact.
+  discard_datum(box_integer(3));
+  CuAssertIntEquals(tc, 3, box_integer(3)->int_val);
+  CuAssertIntEquals(tc, Integer, box_integer(3)->type);
+}
+
+void Test_arithmetic_results_use_shared_integers(CuTest* tc) {
+  struct LispDatum* args[2];
+  args[0] = new_integer(40);
+  args[1] = new_integer(2);
+
+  CuAssertPtrEquals(tc, box_integer(42), add(args, 2));
+  CuAssertPtrEquals(tc, box_integer(38), subtract(args, 2));
+  CuAssertPtrEquals(tc, box_integer(80), multiply(args, 2));
+
+  discard_datum(args[0]);
+  discard_datum(args[1]);
+}
@@ -0,0 +1,164 @@
+#include <string.h>
+#include "CuTest.h"
+#include "../bigint.h"
+#include "../data.h"
+#include "../err.h"
+#include "../stdlisp.h"
+
+#define AssertThrows(expression, err) CuAssertPtrEquals(tc, NULL, (expression)); \
+CuAssertIntEquals(tc, (err), GlobalErrorState); \
+raise(None, NULL);
+
+static void assert_digits(CuTest* tc, const char* expected, const struct LispDatum* x) {
+  struct LispStringBuilder digits;
+  string_builder_init(&digits);
+  integer_format(x, &digits);
+  CuAssertStrEquals(tc, expected, string_builder_content(&digits));
+  string_builder_discard(&digits);
+}
+
+/** base^exponent, computed one multiplication at a time so that each product stays below the Karatsuba threshold. */
+static struct LispDatum* power(int32_t base, int exponent) {
+  struct LispDatum* acc = box_integer(1);
+
+  for (int i = 0; i < exponent; ++i) {
+    struct LispDatum* args[] = {acc, box_integer(base)};
+    struct LispDatum* next = multiply(args, 2);
+    release(acc);
+    acc = next;
+  }
+
+  return acc;
+}
+
+void Test_bigint_overflow_promotes(CuTest* tc) {
+  struct LispDatum* args[] = {box_integer(INT32_MAX), box_integer(1)};
+  struct LispDatum* sum = add(args, 2);
+  CuAssertIntEquals(tc, BigInt, sum->type);
+  assert_digits(tc, "2147483648", sum);
+
+  // Results are demoted again as soon as they fit.
+  struct LispDatum* back[] = {sum, box_integer(1)};
+  struct LispDatum* difference = subtract(back, 2);
+  CuAssertIntEquals(tc, Integer, difference->type);
+  CuAssertIntEquals(tc, INT32_MAX, difference->int_val);
+
+  struct LispDatum* factors[] = {box_integer(INT32_MIN), box_integer(-1)};
+  struct LispDatum* product = multiply(factors, 2);
+  assert_digits(tc, "2147483648", product);
+
+  struct LispDatum* negated[] = {product};
+  struct LispDatum* negative = subtract(negated, 1);
+  CuAssertIntEquals(tc, Integer, negative->type);
+  CuAssertIntEquals(tc, INT32_MIN, negative->int_val);
+
+  release(sum);
+  release(difference);
+  release(product);
+  release(negative);
+}
+
+void Test_bigint_parse_and_format(CuTest* tc) {
+  const char* digits = "-123456789012345678901234567890000000001";
+  struct LispDatum* x = new_bigint_from_string(digits);
+  CuAssertIntEquals(tc, BigInt, x->type);
+  assert_digits(tc, digits, x);
+
+  struct LispDatum* small = new_bigint_from_string("+000042");
+  CuAssertIntEquals(tc, Integer, small->type);
+  CuAssertIntEquals(tc, 42, small->int_val);
+
+  struct LispDatum* min = new_bigint_from_string("-2147483648");
+  CuAssertIntEquals(tc, Integer, min->type);
+  CuAssertIntEquals(tc, INT32_MIN, min->int_val);
+
+  release(x);
+  release(small);
+  release(min);
+}
+
+void Test_bigint_karatsuba(CuTest* tc) {
+  // 3^3000 is about 150 limbs, so squaring 3^1500 splits several times before reaching the schoolbook base case.
+  struct LispDatum* half = power(3, 1500);
+  struct LispDatum* expected = power(3, 3000);
+
+  struct LispDatum* args[] = {half, half};
+  struct LispDatum* square = multiply(args, 2);
+  CuAssertTrue(tc, datum_cmp(expected, square));
+
+  // Unbalanced operands.
+  struct LispDatum* small = power(7, 200);
+  struct LispDatum* unbalanced_args[] = {expected, small};
+  struct LispDatum* unbalanced = multiply(unbalanced_args, 2);
+
+  struct LispDatum quotient;
+  struct LispDatum remainder;
+  CuAssertIntEquals(tc, 0, integer_divmod(unbalanced, small, &quotient, &remainder));
+  CuAssertTrue(tc, datum_cmp(expected, &quotient));
+  CuAssertIntEquals(tc, Integer, remainder.type);
+  CuAssertIntEquals(tc, 0, remainder.int_val);
+  discard_scratch(&quotient);
+
+  release(half);
+  release(expected);
+  release(square);
+  release(small);
+  release(unbalanced);
+}
+
+void Test_bigint_divmod(CuTest* tc) {
+  struct LispDatum* a = new_bigint_from_string("-100000000000000000000000000007");
+  struct LispDatum* b = new_bigint_from_string("10000000000000");
+
+  struct LispDatum quotient;
+  struct LispDatum remainder;
+  CuAssertIntEquals(tc, 0, integer_divmod(a, b, &quotient, &remainder));
+  assert_digits(tc, "-10000000000000000", &quotient);
+  assert_digits(tc, "-7", &remainder);
+  discard_scratch(&quotient);
+
+  struct LispDatum* args[] = {a, box_integer(0)};
+  AssertThrows(mod(args, 2), ZeroDivision);
+
+  args[1] = box_integer(1000);
+  struct LispDatum* r = mod(args, 2);
+  CuAssertIntEquals(tc, -7, r->int_val);
+
+  // Exact quotients stay integral, and inexact ones become real.
+  struct LispDatum* exact_args[] = {b, box_integer(-1000)};
+  struct LispDatum* exact = divide(exact_args, 2);
+  assert_digits(tc, "-10000000000", exact);
+
+  struct LispDatum* inexact_args[] = {b, box_integer(3)};
+  struct LispDatum* inexact = divide(inexact_args, 2);
+  CuAssertIntEquals(tc, Real, inexact->type);
+
+  release(a);
+  release(b);
+  release(r);
+  release(exact);
+  release(inexact);
+}
+
+void Test_bigint_compare(CuTest* tc) {
+  struct LispDatum* big = new_bigint_from_string("4294967296");
+  struct LispDatum* negative = new_bigint_from_string("-4294967296");
+  struct LispDatum* real = new_real(4294967296.0);
+
+  struct LispDatum* ascending[] = {negative, box_integer(-1), box_integer(1), big};
+  CuAssertPtrEquals(tc, get_true(), less_than(ascending, 4));
+
+  struct LispDatum* equal[] = {big, real};
+  CuAssertPtrEquals(tc, get_true(), num_equals(equal, 2));
+
+  struct LispDatum* sum_args[] = {big, new_rational(1, 2)};
+  struct LispDatum* sum = add(sum_args, 2);
+  CuAssertIntEquals(tc, Rational, sum->type);
+  CuAssertTrue(tc, sum->num == 8589934593 && sum->den == 2);
+
+  release(big);
+  release(negative);
+  release(real);
+  release(sum_args[1]);
+  release(sum);
+}
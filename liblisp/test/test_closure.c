@@ -0,0 +1,78 @@
+#include "CuTest.h"
+#include "../closure.h"
+#include "../data.h"
+#include "../err.h"
+#include "../lstring.h"
+#include "../stdlisp.h"
+
+#define AssertThrows(expression, err) CuAssertPtrEquals(tc, NULL, (expression)); \
+CuAssertIntEquals(tc, (err), GlobalErrorState); \
+raise(None, NULL);
+
+/** Adds its captured value to its argument. */
+static struct LispDatum* add_captured(struct LispDatum* self, struct LispDatum** args, uint32_t nargs) {
+  (void) nargs;
+  return add2(closure_captured(self, 0), args[0]);
+}
+
+/** Returns its captured value, whatever it is given. */
+static struct LispDatum* constantly(struct LispDatum* self, struct LispDatum** args, uint32_t nargs) {
+  (void) args;
+  (void) nargs;
+  return retain(closure_captured(self, 0));
+}
+
+void Test_closure_call(CuTest* tc) {
+  struct LispDatum* captured[] = {box_integer(10)};
+  struct LispDatum* f = new_closure(add_captured, 1, captured, 1);
+  CuAssertIntEquals(tc, Closure, f->type);
+
+  struct LispDatum* args[] = {box_integer(5), box_integer(6)};
+  struct LispDatum* result = call_closure(f, args, 1);
+  CuAssertIntEquals(tc, 15, result->int_val);
+  release(result);
+
+  AssertThrows(call_closure(f, args, 2), Argument)
+  AssertThrows(call_closure(args[0], args, 1), Type)
+
+  release(f);
+}
+
+void Test_closure_owns_environment(CuTest* tc) {
+  struct LispDatum* s = new_string("captured");
+  struct LispDatum* f = new_closure(constantly, LISP_VARIADIC, &s, 1);
+
+#ifndef LISP_TRACING_GC
+  CuAssertIntEquals(tc, 2, s->refs);
+#endif
+
+  // Any number of arguments is fine for a variadic closure.
+  struct LispDatum* result = call_closure(f, NULL, 0);
+  CuAssertPtrEquals(tc, s, result);
+  release(result);
+
+  release(f);
+#ifndef LISP_TRACING_GC
+  CuAssertIntEquals(tc, 1, s->refs);
+#endif
+  release(s);
+}
+
+void Test_apply(CuTest* tc) {
+  struct LispDatum* captured[] = {box_integer(1)};
+  struct LispDatum* f = new_closure(add_captured, 1, captured, 1);
+  struct LispDatum* items[] = {box_integer(41)};
+  struct LispDatum* arguments = list(items, 1);
+
+  struct LispDatum* result = apply2(f, arguments);
+  CuAssertIntEquals(tc, 42, result->int_val);
+  release(result);
+
+  struct LispDatum* empty = list(NULL, 0);
+  AssertThrows(apply2(f, empty), Argument)
+  AssertThrows(apply2(f, f), Type)
+
+  release(empty);
+  release(arguments);
+  release(f);
+}
@@ -0,0 +1,97 @@
+#include <string.h>
+#include "CuTest.h"
+#include "../data.h"
+#include "../err.h"
+#include "../lstring.h"
+#include "../state.h"
+#include "../stdlisp.h"
+
+void Test_handler_catches_raise(CuTest* tc) {
+  struct LispHandler handler;
+  volatile int finished = 0;
+
+  lisp_push_handler(&handler, LISP_ANY_CAUSE);
+  if (setjmp(handler.jump) == 0) {
+    raise(ZeroDivision, "Caught");
+    finished = 1;
+    lisp_pop_handler(&handler);
+  } else {
+    CuAssertIntEquals(tc, ZeroDivision, handler.cause);
+    CuAssertStrEquals(tc, "Caught", handler.message);
+  }
+
+  CuAssertIntEquals(tc, 0, finished);
+  CuAssertPtrEquals(tc, NULL, lisp_state_current()->handlers);
+
+  // Handled conditions leave no trace in the error state.
+  CuAssertIntEquals(tc, None, GlobalErrorState);
+}
+
+void Test_handler_not_raised(CuTest* tc) {
+  struct LispHandler handler;
+  volatile int caught = 0;
+
+  lisp_push_handler(&handler, LISP_ANY_CAUSE);
+  if (setjmp(handler.jump) == 0) {
+    // Logging never unwinds.
+    raise(None, "Logged");
+    lisp_pop_handler(&handler);
+  } else {
+    caught = 1;
+  }
+
+  CuAssertIntEquals(tc, 0, caught);
+  CuAssertPtrEquals(tc, NULL, lisp_state_current()->handlers);
+}
+
+void Test_handler_filters_causes(CuTest* tc) {
+  struct LispHandler outer;
+  struct LispHandler inner;
+  volatile int reached = 0;
+
+  lisp_push_handler(&outer, LISP_CAUSE_MASK(Type));
+  if (setjmp(outer.jump) == 0) {
+    lisp_push_handler(&inner, LISP_CAUSE_MASK(Math) | LISP_CAUSE_MASK(ZeroDivision));
+    if (setjmp(inner.jump) == 0) {
+      raise(Type, "Skips the inner handler");
+      lisp_pop_handler(&inner);
+    } else {
+      reached = 1;
+    }
+
+    lisp_pop_handler(&outer);
+  } else {
+    CuAssertIntEquals(tc, Type, outer.cause);
+    reached = 2;
+  }
+
+  CuAssertIntEquals(tc, 2, reached);
+  CuAssertPtrEquals(tc, NULL, lisp_state_current()->handlers);
+}
+
+void Test_handler_catches_natives(CuTest* tc) {
+  struct LispHandler handler;
+
+  lisp_push_handler(&handler, LISP_ANY_CAUSE);
+  if (setjmp(handler.jump) == 0) {
+    divide((struct LispDatum*[]) {box_integer(1), box_integer(0)}, 2);
+    lisp_pop_handler(&handler);
+  }
+
+  CuAssertIntEquals(tc, ZeroDivision, handler.cause);
+
+  struct LispDatum* message = new_string_from_copy("Out of range", 12);
+
+  lisp_push_handler(&handler, LISP_ANY_CAUSE);
+  if (setjmp(handler.jump) == 0) {
+    signal_error((struct LispDatum*[]) {condition_keyword(Math), message}, 2);
+    lisp_pop_handler(&handler);
+  }
+
+  CuAssertIntEquals(tc, Math, handler.cause);
+  CuAssertStrEquals(tc, "Out of range", handler.message);
+  CuAssertPtrEquals(tc, new_keyword("zero-division", 13), condition_keyword(ZeroDivision));
+
+  release(message);
+  CuAssertIntEquals(tc, None, GlobalErrorState);
+}
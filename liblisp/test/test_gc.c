@@ -0,0 +1,267 @@
+#include "CuTest.h"
+#include "../closure.h"
+#include "../data.h"
+#include "../err.h"
+#include "../gc.h"
+#include "../hashmap.h"
+#include "../lstring.h"
+#include "../state.h"
+#include "../stdlisp.h"
+#include "../vector.h"
+
+// These tests only apply when the runtime is built with LISP_MEMORY_MANAGER=tracing.
+
+#ifdef LISP_TRACING_GC
+/** Allocate enough garbage to fill the nursery several times over. */
+static void churn() {
+  for (int i = 0; i < 100000; ++i) {
+    new_real(i);
+  }
+}
+
+static struct LispDatum* build_list(int n) {
+  struct LispDatum* alist = NULL;
+  gc_push_root(&alist);
+
+  for (int i = n - 1; i >= 0; --i) {
+    alist = new_cons(new_integer(i), alist);
+  }
+
+  gc_pop_roots(1);
+  return alist;
+}
+#endif
+
+void Test_gc_minor_preserves_roots(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  struct LispDatum* s = new_string("survivor");
+  struct LispDatum* alist = build_list(3);
+  struct LispDatum* original = alist;
+  gc_push_root(&s);
+  gc_push_root(&alist);
+
+  uint64_t promoted = gc_stats()->promoted;
+  churn();
+  gc_collect(0);
+
+  // Only the roots and what they refer to should have been promoted.
+  CuAssert(tc, "Roots were moved out of the nursery", alist != original);
+  CuAssertIntEquals(tc, 7, (int) (gc_stats()->promoted - promoted));
+  CuAssertStrEquals(tc, "survivor", string_content(s));
+  CuAssertIntEquals(tc, 0, alist->car->int_val);
+  CuAssertIntEquals(tc, 2, alist->cdr->cdr->car->int_val);
+  CuAssertPtrEquals(tc, NULL, alist->cdr->cdr->cdr);
+
+  gc_pop_roots(2);
+#else
+  (void) tc;
+#endif
+}
+
+void Test_gc_safepoint_waits_for_full_nursery(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  gc_collect(0);
+  uint64_t minor = gc_stats()->minor_collections;
+
+  new_real(1.0);
+  gc_safepoint();
+  CuAssertIntEquals(tc, (int) minor, (int) gc_stats()->minor_collections);
+
+  churn();
+  gc_safepoint();
+  CuAssertIntEquals(tc, (int) minor + 1, (int) gc_stats()->minor_collections);
+#else
+  (void) tc;
+#endif
+}
+
+void Test_gc_major_compacts(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  struct LispDatum* keep = build_list(1000);
+  struct LispDatum* drop = build_list(1000);
+  gc_push_root(&keep);
+  gc_push_root(&drop);
+  gc_collect(0);
+
+  drop = get_nil();
+  gc_collect(1);
+
+  CuAssertIntEquals(tc, 2000, (int) gc_stats()->old_live);
+
+  struct LispDatum* args[1] = {keep};
+  struct LispDatum* len = length(args, 1);
+  CuAssertIntEquals(tc, 1000, len->int_val);
+
+  int i = 0;
+  for (struct LispDatum* cell = keep; cell != NULL; cell = cell->cdr) {
+    CuAssertIntEquals(tc, i++, cell->car->int_val);
+  }
+
+  gc_pop_roots(2);
+#else
+  (void) tc;
+#endif
+}
+
+void Test_gc_write_barrier(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  struct LispDatum* cell = new_cons(get_nil(), get_nil());
+  gc_push_root(&cell);
+  gc_collect(0);
+
+  // The cell is now old, so storing a young datum in it must be recorded.
+  cell->car = new_string("young");
+  gc_write_barrier(cell);
+
+  churn();
+  gc_collect(0);
+  CuAssertStrEquals(tc, "young", string_content(cell->car));
+
+  gc_pop_roots(1);
+#else
+  (void) tc;
+#endif
+}
+
+void Test_gc_long_list(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  struct LispDatum* alist = build_list(1000000);
+  gc_push_root(&alist);
+
+  gc_collect(1);
+
+  struct LispDatum* args[1] = {alist};
+  CuAssertIntEquals(tc, 1000000, length(args, 1)->int_val);
+  CuAssertIntEquals(tc, 1, alist->cdr->car->int_val);
+
+  alist = get_nil();
+  gc_collect(1);
+  CuAssertIntEquals(tc, 0, (int) gc_stats()->old_live);
+
+  gc_pop_roots(1);
+#else
+  (void) tc;
+#endif
+}
+
+void Test_gc_traces_vectors(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  struct LispDatum* v = new_vector(0);
+  gc_push_root(&v);
+  gc_collect(0);
+
+  // The vector is old by now, so pushing nursery values into it relies on the write barrier.
+  for (int i = 0; i < 100; ++i) {
+    vector_append(v, new_integer(i));
+    gc_write_barrier(v);
+  }
+
+  churn();
+  gc_collect(0);
+  churn();
+  gc_collect(1);
+
+  CuAssertIntEquals(tc, 100, v->length);
+  for (int i = 0; i < 100; ++i) {
+    CuAssertIntEquals(tc, i, v->items[i]->int_val);
+  }
+
+  gc_pop_roots(1);
+#else
+  (void) tc;
+#endif
+}
+
+void Test_gc_traces_maps(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  struct LispDatum* map = new_hash_map(0);
+  gc_push_root(&map);
+  gc_collect(0);
+
+  for (int i = 0; i < 100; ++i) {
+    map_put(map, new_integer(i), new_string("value"));
+    gc_write_barrier(map);
+  }
+
+  churn();
+  gc_collect(0);
+  churn();
+  gc_collect(1);
+
+  CuAssertIntEquals(tc, 100, map_count(map));
+  for (int i = 0; i < 100; ++i) {
+    struct LispDatum* key = new_integer(i);
+    CuAssertStrEquals(tc, "value", string_content(map_get(map, key)));
+  }
+
+  gc_pop_roots(1);
+#else
+  (void) tc;
+#endif
+}
+
+#ifdef LISP_TRACING_GC
+static struct LispDatum* first_captured(struct LispDatum* self, struct LispDatum** args, uint32_t nargs) {
+  (void) args;
+  (void) nargs;
+  return closure_captured(self, 0);
+}
+#endif
+
+void Test_gc_traces_closures(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  struct LispDatum* captured[] = {build_list(3)};
+  struct LispDatum* f = new_closure(first_captured, 0, captured, 1);
+  gc_push_root(&f);
+
+  churn();
+  gc_collect(0);
+  churn();
+  gc_collect(1);
+
+  struct LispDatum* alist = call_closure(f, NULL, 0);
+  CuAssertIntEquals(tc, 0, alist->car->int_val);
+  CuAssertIntEquals(tc, 2, alist->cdr->cdr->car->int_val);
+
+  gc_pop_roots(1);
+#else
+  (void) tc;
+#endif
+}
+
+#ifdef LISP_TRACING_GC
+/** Root a variable of its own, then raise without popping it, like a generated function interrupted by a raise. */
+static void raise_while_rooted(void) {
+  struct LispDatum* local = new_string("local");
+  gc_push_root(&local);
+  raise(Argument, "Raised with a root pushed.");
+}
+#endif
+
+void Test_gc_raise_pops_roots(CuTest* tc) {
+#ifdef LISP_TRACING_GC
+  struct LispDatum* s = new_string("survivor");
+  gc_push_root(&s);
+  size_t roots = lisp_state_current()->heap.roots.count;
+
+  struct LispHandler handler;
+  lisp_push_handler(&handler, LISP_ANY_CAUSE);
+
+  if (setjmp(handler.jump) == 0) {
+    raise_while_rooted();
+    lisp_pop_handler(&handler);
+  }
+
+  // The root pushed by the interrupted function referred to its stack frame, which no longer exists.
+  CuAssertIntEquals(tc, Argument, handler.cause);
+  CuAssertIntEquals(tc, (int) roots, (int) lisp_state_current()->heap.roots.count);
+
+  churn();
+  gc_collect(0);
+  CuAssertStrEquals(tc, "survivor", string_content(s));
+
+  gc_pop_roots(1);
+#else
+  (void) tc;
+#endif
+}
@@ -0,0 +1,138 @@
+#include <stdio.h>
+
+#include "CuTest.h"
+#include "../data.h"
+#include "../err.h"
+#include "../hashmap.h"
+#include "../lists.h"
+#include "../lstring.h"
+#include "../stdlisp.h"
+
+#define AssertThrows(expression, err) CuAssertPtrEquals(tc, NULL, (expression)); \
+CuAssertIntEquals(tc, (err), GlobalErrorState); \
+raise(None, NULL);
+
+void Test_map_put_get(CuTest* tc) {
+  struct LispDatum* map = new_hash_map(0);
+  struct LispDatum* keys[1000];
+
+  // Enough to grow the table several times.
+  for (int32_t i = 0; i < 1000; ++i) {
+    char label[16];
+    snprintf(label, sizeof(label), "key %d", i);
+    keys[i] = new_string(label);
+    map_put(map, keys[i], box_integer(i));
+  }
+
+  CuAssertIntEquals(tc, 1000, map_count(map));
+
+  for (int32_t i = 0; i < 1000; ++i) {
+    char label[16];
+    snprintf(label, sizeof(label), "key %d", i);
+    struct LispDatum* key = new_string(label);
+    CuAssertIntEquals(tc, i, map_get(map, key)->int_val);
+    release(key);
+  }
+
+  map_put(map, keys[0], get_true());
+  CuAssertIntEquals(tc, 1000, map_count(map));
+  CuAssertPtrEquals(tc, get_true(), map_get(map, keys[0]));
+
+  for (int32_t i = 0; i < 1000; ++i) {
+    release(keys[i]);
+  }
+  release(map);
+}
+
+void Test_map_numeric_keys(CuTest* tc) {
+  struct LispDatum* map = new_hash_map(0);
+  struct LispDatum* one = new_real(1.0);
+  struct LispDatum* half = new_rational(1, 2);
+  struct LispDatum* real_half = new_real(0.5);
+  struct LispDatum* complex_half = new_complex(0.5, 0);
+
+  // Keys that compare equal after promotion are the same key.
+  map_put(map, box_integer(1), get_true());
+  CuAssertPtrEquals(tc, get_true(), map_get(map, one));
+
+  map_put(map, half, get_false());
+  CuAssertPtrEquals(tc, get_false(), map_get(map, real_half));
+  CuAssertPtrEquals(tc, get_false(), map_get(map, complex_half));
+  CuAssertIntEquals(tc, 2, map_count(map));
+
+  release(one);
+  release(half);
+  release(real_half);
+  release(complex_half);
+  release(map);
+}
+
+void Test_map_remove(CuTest* tc) {
+  struct LispDatum* map = new_hash_map(0);
+
+  for (int32_t i = 0; i < 500; ++i) {
+    map_put(map, box_integer(i), box_integer(i));
+  }
+
+  for (int32_t i = 0; i < 500; i += 2) {
+    CuAssert(tc, "Present keys are removed", map_remove(map, box_integer(i)));
+  }
+
+  CuAssert(tc, "Missing keys are not removed", !map_remove(map, box_integer(0)));
+  CuAssertIntEquals(tc, 250, map_count(map));
+
+  for (int32_t i = 0; i < 500; ++i) {
+    struct LispDatum* value = map_get(map, box_integer(i));
+    CuAssert(tc, "Only odd keys remain", i % 2 == 0 ? value == NULL : value->int_val == i);
+  }
+
+  // Churning through removals and insertions must not fill the table up with deleted slots.
+  for (int32_t i = 0; i < 100000; ++i) {
+    map_put(map, box_integer(1000), get_true());
+    map_remove(map, box_integer(1000));
+  }
+  CuAssertIntEquals(tc, 250, map_count(map));
+
+  release(map);
+}
+
+void Test_map_natives(CuTest* tc) {
+  struct LispDatum* a = new_keyword("a", 1);
+  struct LispDatum* b = new_keyword("b", 1);
+  struct LispDatum* args[] = {a, box_integer(1), b, box_integer(2)};
+  struct LispDatum* map = hash_map(args, 4);
+
+  struct LispDatum* count = hash_count(&map, 1);
+  CuAssertIntEquals(tc, 2, count->int_val);
+  release(count);
+
+  struct LispDatum* get_args[] = {map, b, get_false()};
+  struct LispDatum* value = hash_get(get_args, 2);
+  CuAssertIntEquals(tc, 2, value->int_val);
+  release(value);
+
+  get_args[1] = box_integer(3);
+  CuAssertPtrEquals(tc, get_nil(), hash_get(get_args, 2));
+  CuAssertPtrEquals(tc, get_false(), hash_get(get_args, 3));
+
+  struct LispDatum* pairs = hash_to_list(&map, 1);
+  CuAssertIntEquals(tc, 2, list_length(pairs));
+  CuAssertIntEquals(tc, Cons, pairs->car->type);
+  release(pairs);
+
+  struct LispDatum* keys = hash_keys(&map, 1);
+  CuAssert(tc, "Keys are listed", keys->car == a || keys->car == b);
+  release(keys);
+
+  struct LispDatum* remove_args[] = {map, a};
+  CuAssertPtrEquals(tc, get_true(), hash_remove(remove_args, 2));
+  CuAssertPtrEquals(tc, get_false(), hash_remove(remove_args, 2));
+
+  struct LispDatum* key = list(NULL, 0);
+  struct LispDatum* put_args[] = {map, key, get_true()};
+  AssertThrows(hash_put(put_args, 3), Type);
+  AssertThrows(hash_map(args, 3), Argument);
+
+  release(key);
+  release(map);
+}
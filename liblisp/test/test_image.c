@@ -0,0 +1,179 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "CuTest.h"
+#include "../bigint.h"
+#include "../closure.h"
+#include "../data.h"
+#include "../err.h"
+#include "../hashmap.h"
+#include "../lstring.h"
+#include "../stdlisp.h"
+#include "../vector.h"
+
+#define AssertThrows(expression, err) CuAssertPtrEquals(tc, NULL, (expression)); \
+CuAssertIntEquals(tc, (err), GlobalErrorState); \
+raise(None, NULL);
+
+/** A fresh file to save an image to, which the caller should remove. */
+static struct LispDatum* temporary_path(void) {
+  char path[] = "/tmp/lisp_imageXXXXXX";
+  close(mkstemp(path));
+  return new_string(path);
+}
+
+/** One of everything an image can hold. */
+static struct LispDatum* build_sample(void) {
+  struct LispDatum* map = new_hash_map(0);
+  struct LispDatum* key = new_keyword("answer", 6);
+  struct LispDatum* answer = new_real(42.5);
+  map_put(map, key, answer);
+  release(answer);
+
+  struct LispDatum* numbers[] = {box_integer(3), new_real(0.5)};
+  struct LispDatum* array = f64_array(numbers, 2);
+  release(numbers[1]);
+
+  struct LispDatum* items[] = {
+      box_integer(7), new_integer(100000), new_bigint_from_string("123456789012345678901234567890"),
+      new_rational(-2, 3), new_complex(1, -1), new_string("short"),
+      new_string("a string long enough to need a buffer of its own"), new_symbol("table"), key, get_true(),
+      get_false(), get_nil(), map, array
+  };
+  uint32_t count = sizeof(items) / sizeof(items[0]);
+
+  struct LispDatum* v = vector(items, count);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    release(items[i]);
+  }
+
+  return v;
+}
+
+void Test_image_round_trip(CuTest* tc) {
+  struct LispDatum* path = temporary_path();
+  struct LispDatum* sample = build_sample();
+
+  struct LispDatum* result = save_image2(path, sample);
+  CuAssertPtrEquals(tc, get_nil(), result);
+
+  struct LispDatum* loaded = load_image1(path);
+  CuAssertPtrNotNull(tc, loaded);
+  CuAssertPtrEquals(tc, get_true(), equal2(sample, loaded));
+
+  // Values that are shared with the rest of the program are the same ones, rather than copies.
+  CuAssertPtrEquals(tc, new_symbol("table"), loaded->items[7]);
+  CuAssertPtrEquals(tc, new_keyword("answer", 6), loaded->items[8]);
+  CuAssertPtrEquals(tc, get_true(), loaded->items[9]);
+  CuAssertPtrEquals(tc, get_nil(), loaded->items[11]);
+
+  // Lookups still work without the map being rebuilt.
+  struct LispDatum* answer = map_get(loaded->items[12], new_keyword("answer", 6));
+  CuAssertPtrNotNull(tc, answer);
+  CuAssertDblEquals(tc, 42.5, answer->float_val, 0);
+
+  // Loaded values are immortal, so releasing them does nothing.
+  release(loaded);
+  release(loaded);
+  CuAssertIntEquals(tc, Vector, loaded->type);
+
+  release(sample);
+  remove(string_content(path));
+  release(path);
+}
+
+void Test_image_shared_structure(CuTest* tc) {
+  struct LispDatum* path = temporary_path();
+  struct LispDatum* cell = new_cons(box_integer(1), get_nil());
+  struct LispDatum* items[] = {cell, cell, cell};
+  struct LispDatum* v = vector(items, 3);
+
+  // Make the cell circular for long enough to save it.
+  cell->cdr = cell;
+  CuAssertPtrEquals(tc, get_nil(), save_image2(path, v));
+  cell->cdr = get_nil();
+
+  // Loading a second time can't reuse the address of the first, so the second copy has to be relocated.
+  struct LispDatum* first = load_image1(path);
+  struct LispDatum* second = load_image1(path);
+  CuAssertTrue(tc, first != second);
+
+  struct LispDatum* loaded[] = {first, second};
+
+  for (int i = 0; i < 2; ++i) {
+    struct LispDatum* x = loaded[i];
+    CuAssertIntEquals(tc, 3, x->length);
+    CuAssertPtrEquals(tc, x->items[0], x->items[1]);
+    CuAssertPtrEquals(tc, x->items[0], x->items[2]);
+    CuAssertPtrEquals(tc, x->items[0], x->items[0]->cdr);
+    CuAssertIntEquals(tc, 1, x->items[0]->car->int_val);
+  }
+
+  release(cell);
+  release(v);
+  remove(string_content(path));
+  release(path);
+}
+
+static struct LispDatum* nothing(struct LispDatum* self, struct LispDatum** args, uint32_t nargs) {
+  (void) self;
+  (void) args;
+  (void) nargs;
+  return get_nil();
+}
+
+void Test_image_errors(CuTest* tc) {
+  struct LispDatum* path = temporary_path();
+  struct LispDatum* f = new_closure(nothing, 0, NULL, 0);
+  struct LispDatum* contains_closure = new_cons(f, get_nil());
+
+  AssertThrows(save_image2(path, contains_closure), Type)
+  AssertThrows(save_image2(box_integer(1), get_nil()), Type)
+
+  // The file is still empty, and so isn't an image.
+  AssertThrows(load_image1(path), Generic)
+
+  remove(string_content(path));
+  AssertThrows(load_image1(path), Generic)
+
+  release(contains_closure);
+  release(f);
+  release(path);
+}
+
+void Test_image_immutable(CuTest* tc) {
+  struct LispDatum* path = temporary_path();
+  struct LispDatum* cell = new_cons(box_integer(1), get_nil());
+  struct LispDatum* map = new_hash_map(0);
+  struct LispDatum* key = new_keyword("answer", 6);
+  map_put(map, key, box_integer(42));
+
+  struct LispDatum* items[] = {cell, map};
+  struct LispDatum* v = vector(items, 2);
+  CuAssertPtrEquals(tc, get_nil(), save_image2(path, v));
+
+  struct LispDatum* loaded = load_image1(path);
+  CuAssertPtrNotNull(tc, loaded);
+  struct LispDatum* s = new_string("a string that can't be stored in the image");
+
+  AssertThrows(vector_push2(loaded, s), Argument)
+  AssertThrows(vector_set3(loaded, box_integer(0), s), Argument)
+  AssertThrows(set_car2(loaded->items[0], s), Argument)
+  AssertThrows(set_cdr2(loaded->items[0], s), Argument)
+  AssertThrows(hash_put3(loaded->items[1], key, s), Argument)
+  AssertThrows(hash_remove2(loaded->items[1], key), Argument)
+
+  // Nothing was changed.
+  CuAssertIntEquals(tc, 2, loaded->length);
+  CuAssertIntEquals(tc, 1, loaded->items[0]->car->int_val);
+  CuAssertPtrEquals(tc, get_nil(), loaded->items[0]->cdr);
+  CuAssertIntEquals(tc, 42, map_get(loaded->items[1], key)->int_val);
+
+  release(s);
+  release(v);
+  release(map);
+  release(cell);
+  remove(string_content(path));
+  release(path);
+}
@@ -0,0 +1,321 @@
+#include <stdlib.h>
+
+#include "CuTest.h"
+#include "../data.h"
+#include "../err.h"
+#include "../lists.h"
+#include "../state.h"
+#include "../stdlisp.h"
+#include "../vector.h"
+
+/** A list of the integers [0, count). */
+static struct LispDatum* range(uint32_t count) {
+  struct LispDatum** items = malloc(count * sizeof(struct LispDatum*));
+
+  for (uint32_t i = 0; i < count; ++i) {
+    items[i] = box_integer((int32_t) i);
+  }
+
+  struct LispDatum* x = new_list(items, count, NULL);
+  free(items);
+  return x;
+}
+
+static int32_t length_of(struct LispDatum* x) {
+  struct LispDatum* len = length(&x, 1);
+  int32_t result = len->int_val;
+  release(len);
+  return result;
+}
+
+void Test_list_spanning_chunks(CuTest* tc) {
+  uint32_t count = LISP_LIST_CHUNK_MAX * 3 + 5;
+  struct LispDatum* x = range(count);
+
+  CuAssertIntEquals(tc, (int) count, list_length(x));
+
+  struct LispDatum* ptr = x;
+  for (uint32_t i = 0; i < count; ++i) {
+    CuAssertIntEquals(tc, (int) i, ptr->car->int_val);
+    ptr = ptr->cdr;
+  }
+  CuAssertPtrEquals(tc, NULL, ptr);
+
+  release(x);
+}
+
+void Test_list_length_of_tails(CuTest* tc) {
+  struct LispDatum* x = range(LISP_LIST_CHUNK_MAX * 2);
+  struct LispDatum* ptr = x;
+
+  for (int32_t i = 0; i < LISP_LIST_CHUNK_MAX * 2; ++i) {
+    CuAssertIntEquals(tc, LISP_LIST_CHUNK_MAX * 2 - i, list_length(ptr));
+    ptr = ptr->cdr;
+  }
+
+  CuAssertIntEquals(tc, 0, list_length(ptr));
+  CuAssertIntEquals(tc, 0, list_length(get_nil()));
+
+  release(x);
+}
+
+void Test_list_shared_tail(CuTest* tc) {
+  struct LispDatum* tail = range(100);
+  struct LispDatum* args[] = {NULL, tail};
+  args[0] = range(3);
+
+  struct LispDatum* combined = append(args, 2);
+  CuAssertIntEquals(tc, 103, length_of(combined));
+  CuAssertPtrEquals(tc, tail, combined->cdr->cdr->cdr);
+
+  // The tail outlives both lists that refer to it.
+  release(args[0]);
+  release(tail);
+  CuAssertIntEquals(tc, 1, combined->cdr->cdr->cdr->cdr->car->int_val);
+  release(combined);
+}
+
+void Test_list_improper_tail(CuTest* tc) {
+  struct LispDatum* pair = new_cons(box_integer(1), box_integer(2));
+  struct LispDatum* items[] = {box_integer(0)};
+  struct LispDatum* x = new_list(items, 1, pair);
+
+  CuAssertIntEquals(tc, -1, list_length(x));
+  CuAssertPtrEquals(tc, NULL, length(&x, 1));
+  CuAssertIntEquals(tc, Type, GlobalErrorState);
+  raise(None, NULL);
+
+  release(x);
+  release(pair);
+}
+
+void Test_list_set_cdr(CuTest* tc) {
+  struct LispDatum* x = range(LISP_LIST_CHUNK_MAX + 10);
+  struct LispDatum* replacement = range(3);
+
+  // Cut the list down to (0 1 3 4 5 ...), then (0 1 0 1 2).
+  struct LispDatum* args[] = {x->cdr, x->cdr->cdr->cdr};
+  struct LispDatum* result = set_cdr(args, 2);
+  CuAssertIntEquals(tc, LISP_LIST_CHUNK_MAX + 9, length_of(x));
+  release(result);
+
+  args[1] = replacement;
+  result = set_cdr(args, 2);
+  CuAssertIntEquals(tc, 5, length_of(x));
+  release(result);
+
+  // Lists built afterwards cache their lengths again.
+  struct LispDatum* fresh = range(10);
+  CuAssertIntEquals(tc, 10, list_length(fresh));
+
+  args[1] = get_nil();
+  result = set_cdr(args, 2);
+  CuAssertIntEquals(tc, 2, length_of(x));
+  CuAssertPtrEquals(tc, NULL, x->cdr->cdr);
+  release(result);
+
+  release(x);
+  release(replacement);
+  release(fresh);
+}
+
+void Test_list_set_cdr_other_state(CuTest* tc) {
+#ifndef LISP_TRACING_GC
+  struct LispDatum* x = range(LISP_LIST_CHUNK_MAX + 10);
+  CuAssertIntEquals(tc, LISP_LIST_CHUNK_MAX + 10, list_length(x));
+
+  // Cut the list down to (0 1) under another state. The cell that used to follow is kept alive, so that it isn't freed
+  // into the other state's arena.
+  struct LispDatum* rest = retain(x->cdr->cdr);
+  struct LispState* state = lisp_state_new();
+  struct LispState* previous = lisp_state_bind(state);
+  struct LispDatum* args[] = {x->cdr, get_nil()};
+  release(set_cdr(args, 2));
+  lisp_state_bind(previous);
+  lisp_state_destroy(state);
+
+  CuAssertIntEquals(tc, 2, list_length(x));
+  CuAssertIntEquals(tc, LISP_LIST_CHUNK_MAX + 8, list_length(rest));
+
+  release(rest);
+  release(x);
+#else
+  (void) tc;
+#endif
+}
+
+void Test_list_length_cached_again(CuTest* tc) {
+#ifndef LISP_TRACING_GC
+  struct LispDatum* x = range(LISP_LIST_CHUNK_MAX * 3);
+  struct LispDatum* other = range(3);
+
+  // Changing an unrelated list invalidates every cached length, but counting `x` once caches its length again.
+  struct LispDatum* args[] = {other->cdr, get_nil()};
+  release(set_cdr(args, 2));
+  CuAssertIntEquals(tc, LISP_LIST_CHUNK_MAX * 3, list_length(x));
+
+  // Cutting the list behind the runtime's back shows that the next count comes from the cache rather than a walk.
+  struct LispDatum* cut = x->cdr->cdr;
+  x->cdr->cdr = NULL;
+  CuAssertIntEquals(tc, LISP_LIST_CHUNK_MAX * 3, list_length(x));
+  x->cdr->cdr = cut;
+
+  // The chunk holding a changed cell only caches the length from the cells up to that one.
+  struct LispDatum* tail = x;
+  for (int i = 0; i < 10; ++i) {
+    tail = tail->cdr;
+  }
+  struct LispDatum* detached = retain(tail->cdr);
+  args[0] = tail;
+  args[1] = other;
+  release(set_cdr(args, 2));
+  CuAssertIntEquals(tc, 13, list_length(x));
+  CuAssertIntEquals(tc, 13, list_length(x));
+  CuAssertIntEquals(tc, 8, list_length(x->cdr->cdr->cdr->cdr->cdr));
+  CuAssertIntEquals(tc, LISP_LIST_CHUNK_MAX * 3 - 11, list_length(detached));
+  CuAssertIntEquals(tc, LISP_LIST_CHUNK_MAX * 3 - 11, list_length(detached));
+
+  release(detached);
+  release(other);
+  release(x);
+#else
+  (void) tc;
+#endif
+}
+
+void Test_list_set_car(CuTest* tc) {
+  struct LispDatum* x = range(3);
+  struct LispDatum* value = new_string("replacement");
+  struct LispDatum* args[] = {x->cdr, value};
+
+  release(set_car(args, 2));
+  CuAssertPtrEquals(tc, value, x->cdr->car);
+  CuAssertIntEquals(tc, 3, length_of(x));
+
+  struct LispDatum* empty = list(NULL, 0);
+  args[0] = empty;
+  CuAssertPtrEquals(tc, NULL, set_car(args, 2));
+  CuAssertIntEquals(tc, Type, GlobalErrorState);
+  raise(None, NULL);
+
+  release(empty);
+  release(value);
+  release(x);
+}
+
+void Test_list_reverse_large(CuTest* tc) {
+  struct LispDatum* x = range(200);
+  struct LispDatum* r = reverse(&x, 1);
+
+  CuAssertIntEquals(tc, 200, length_of(r));
+  CuAssertIntEquals(tc, 199, r->car->int_val);
+  release(x);
+
+  struct LispDatum* ptr = r;
+  for (int32_t i = 199; i >= 0; --i) {
+    CuAssertIntEquals(tc, i, ptr->car->int_val);
+    ptr = ptr->cdr;
+  }
+
+  release(r);
+}
+
+void Test_list_equal(CuTest* tc) {
+  struct LispDatum* a = range(100);
+  struct LispDatum* b = range(100);
+  struct LispDatum* c = range(99);
+
+  CuAssertTrue(tc, datum_equal(a, b));
+  CuAssertTrue(tc, !datum_cmp(a, b));
+  CuAssertTrue(tc, !datum_equal(a, c));
+
+  struct LispDatum* empty = list(NULL, 0);
+  struct LispDatum* other_empty = list(NULL, 0);
+  CuAssertTrue(tc, datum_equal(empty, other_empty));
+  release(empty);
+  release(other_empty);
+
+  // Nested through vectors, with strings compared by content.
+  struct LispDatum* items[] = {a, new_string("text")};
+  struct LispDatum* v = new_vector_from(items, 2);
+  items[0] = b;
+  struct LispDatum* w = new_vector_from(items, 2);
+  CuAssertTrue(tc, datum_equal(v, w));
+  struct LispDatum* args[] = {v, w};
+  CuAssertPtrEquals(tc, get_true(), equal(args, 2));
+  args[1] = a;
+  CuAssertPtrEquals(tc, get_false(), equal(args, 2));
+
+  release(items[1]);
+  release(v);
+  release(w);
+  release(a);
+  release(b);
+  release(c);
+}
+
+void Test_list_equal_deep(CuTest* tc) {
+  struct LispDatum* a = box_integer(0);
+  struct LispDatum* b = box_integer(0);
+
+  for (int i = 0; i < 200000; ++i) {
+    struct LispDatum* next_a = new_cons(a, NULL);
+    struct LispDatum* next_b = new_cons(b, NULL);
+    release(a);
+    release(b);
+    a = next_a;
+    b = next_b;
+  }
+
+  CuAssertTrue(tc, datum_equal(a, b));
+
+  struct LispDatum* args[] = {b, box_integer(1)};
+  struct LispDatum* innermost = b;
+  while (innermost->car->type == Cons) {
+    innermost = innermost->car;
+  }
+  args[0] = innermost;
+  release(set_car(args, 2));
+  CuAssertTrue(tc, !datum_equal(a, b));
+
+  release(a);
+  release(b);
+}
+
+void Test_list_equal_cycles(CuTest* tc) {
+  // (1 1 1 ...) built with cycles of different lengths, which are still equal.
+  struct LispDatum* ones[] = {box_integer(1), box_integer(1), box_integer(1)};
+  struct LispDatum* a = new_list(ones, 1, NULL);
+  struct LispDatum* b = new_list(ones, 3, NULL);
+  struct LispDatum* c = new_list(ones, 3, NULL);
+
+  struct LispDatum* args[] = {a, a};
+  release(set_cdr(args, 2));
+  args[0] = b->cdr->cdr;
+  args[1] = b;
+  release(set_cdr(args, 2));
+  CuAssertTrue(tc, datum_equal(a, b));
+
+  // Changing one element of the cycle makes them differ.
+  args[0] = c->cdr->cdr;
+  args[1] = c;
+  release(set_cdr(args, 2));
+  args[0] = c->cdr;
+  args[1] = box_integer(2);
+  release(set_car(args, 2));
+  CuAssertTrue(tc, !datum_equal(a, c));
+  CuAssertTrue(tc, datum_equal(c, c));
+
+  // Break the cycles, so that the lists can be released.
+  args[1] = get_nil();
+  args[0] = a;
+  release(set_cdr(args, 2));
+  args[0] = b->cdr->cdr;
+  release(set_cdr(args, 2));
+  args[0] = c->cdr->cdr;
+  release(set_cdr(args, 2));
+
+  release(a);
+  release(b);
+  release(c);
+}
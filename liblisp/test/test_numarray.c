@@ -0,0 +1,217 @@
+#include <math.h>
+#include "CuTest.h"
+#include "../bigint.h"
+#include "../data.h"
+#include "../err.h"
+#include "../lists.h"
+#include "../numarray.h"
+#include "../numeric.h"
+#include "../stdlisp.h"
+
+#define AssertThrows(expression, err) CuAssertPtrEquals(tc, NULL, (expression)); \
+CuAssertIntEquals(tc, (err), GlobalErrorState); \
+raise(None, NULL);
+
+#define LENGTH 37
+
+typedef struct LispDatum* (* Native)(struct LispDatum**, uint32_t);
+
+/** An array of each type with `count` elements, whose values vary in sign and magnitude. */
+static struct LispDatum* sample_array(enum LispDataType type, uint32_t count, int seed) {
+  struct LispDatum* array = new_numeric_array(type, count);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    int32_t value = (int32_t) ((i * 7919 + (uint32_t) seed * 104729) % 2001) - 1000;
+    struct LispDatum* x = type == I32Array ? box_integer(value) :
+                          type == F64Array ? new_real(value / 8.0) : new_complex(value / 8.0, (value % 13) / 4.0 + 1);
+    numeric_array_store(array, i, x);
+    release(x);
+  }
+
+  return array;
+}
+
+/** Check an elementwise native against the boxed arithmetic native, element by element, for every length up to n. */
+static void assert_elementwise(CuTest* tc, enum LispDataType type, Native elementwise, Native boxed) {
+  for (uint32_t n = 0; n <= LENGTH; ++n) {
+    struct LispDatum* args[] = {sample_array(type, n, 1), sample_array(type, n, 2)};
+    struct LispDatum* result = elementwise(args, 2);
+    CuAssertIntEquals(tc, n, result->count);
+
+    for (uint32_t i = 0; i < n; ++i) {
+      struct LispDatum* pair[] = {numeric_array_load(args[0], i), numeric_array_load(args[1], i)};
+      struct LispDatum* expected = boxed(pair, 2);
+      struct LispDatum* actual = numeric_array_load(result, i);
+      CuAssertTrue(tc, datum_cmp(expected, actual));
+
+      release(pair[0]);
+      release(pair[1]);
+      release(expected);
+      release(actual);
+    }
+
+    release(args[0]);
+    release(args[1]);
+    release(result);
+  }
+}
+
+void Test_numarray_elementwise(CuTest* tc) {
+  enum LispDataType types[] = {I32Array, F64Array, C128Array};
+
+  for (int i = 0; i < 3; ++i) {
+    assert_elementwise(tc, types[i], array_add, add);
+    assert_elementwise(tc, types[i], array_subtract, subtract);
+    assert_elementwise(tc, types[i], array_multiply, multiply);
+
+    // Integer division gives reals instead of rationals, which `datum_cmp` still compares exactly.
+    if (types[i] != I32Array) {
+      assert_elementwise(tc, types[i], array_divide, divide);
+    }
+  }
+
+  struct LispDatum* ints[] = {i32_array((struct LispDatum*[]) {box_integer(1), box_integer(7)}, 2),
+                              i32_array((struct LispDatum*[]) {box_integer(4), box_integer(0)}, 2)};
+  struct LispDatum* quotient = array_divide(ints, 2);
+  CuAssertIntEquals(tc, F64Array, quotient->type);
+  CuAssertDblEquals(tc, 0.25, ((double*) quotient->values)[0], 0);
+  CuAssertTrue(tc, isinf(((double*) quotient->values)[1]));
+
+  release(ints[0]);
+  release(ints[1]);
+  release(quotient);
+}
+
+void Test_numarray_overflow(CuTest* tc) {
+  struct LispDatum* args[] = {sample_array(I32Array, LENGTH, 1), sample_array(I32Array, LENGTH, 2)};
+  struct LispDatum* big = box_integer(INT32_MAX);
+
+  // An overflow in the vectorized part, and another in the tail.
+  for (uint32_t i = 3; i < LENGTH; i += LENGTH - 4) {
+    numeric_array_store(args[0], i, big);
+    numeric_array_store(args[1], i, box_integer(2));
+    AssertThrows(array_add(args, 2), Math);
+    AssertThrows(array_multiply(args, 2), Math);
+    numeric_array_store(args[1], i, box_integer(-1));
+    AssertThrows(array_subtract(args, 2), Math);
+    numeric_array_store(args[0], i, box_integer(0));
+  }
+
+  release(args[0]);
+  release(args[1]);
+}
+
+void Test_numarray_reductions(CuTest* tc) {
+  struct LispDatum* array = sample_array(I32Array, LENGTH, 1);
+  const int32_t* values = array->values;
+  int64_t total = 0;
+  int32_t least = values[0];
+  int32_t greatest = values[0];
+
+  for (uint32_t i = 0; i < LENGTH; ++i) {
+    total += values[i];
+    least = values[i] < least ? values[i] : least;
+    greatest = values[i] > greatest ? values[i] : greatest;
+  }
+
+  struct LispDatum* sum = array_sum(&array, 1);
+  struct LispDatum* min = array_min(&array, 1);
+  struct LispDatum* max = array_max(&array, 1);
+  CuAssertIntEquals(tc, total, sum->int_val);
+  CuAssertIntEquals(tc, least, min->int_val);
+  CuAssertIntEquals(tc, greatest, max->int_val);
+
+  release(sum);
+  release(min);
+  release(max);
+  release(array);
+
+  // Each product is 2^62, so the dot product only fits in a big integer.
+  struct LispDatum* minimum = box_integer(INT32_MIN);
+  struct LispDatum* extremes = new_numeric_array(I32Array, LENGTH);
+
+  for (uint32_t i = 0; i < LENGTH; ++i) {
+    numeric_array_store(extremes, i, minimum);
+  }
+
+  struct LispDatum* pair[] = {extremes, extremes};
+  struct LispDatum* dot = array_dot(pair, 2);
+  struct LispDatum* expected = new_bigint_from_string("170632382681813352448");
+  CuAssertIntEquals(tc, BigInt, dot->type);
+  CuAssertTrue(tc, datum_cmp(expected, dot));
+
+  struct LispDatum* empty = new_numeric_array(F64Array, 0);
+  AssertThrows(array_max(&empty, 1), Argument);
+
+  release(minimum);
+  release(dot);
+  release(expected);
+  release(extremes);
+  release(empty);
+}
+
+void Test_numarray_complex_reductions(CuTest* tc) {
+  struct LispDatum* pair[] = {sample_array(C128Array, LENGTH, 1), sample_array(C128Array, LENGTH, 2)};
+  double real = 0;
+  double im = 0;
+
+  for (uint32_t i = 0; i < 2 * LENGTH; i += 2) {
+    const double* x = (const double*) pair[0]->values + i;
+    const double* y = (const double*) pair[1]->values + i;
+    real += x[0] * y[0] - x[1] * y[1];
+    im += x[0] * y[1] + x[1] * y[0];
+  }
+
+  struct LispDatum* dot = array_dot(pair, 2);
+  CuAssertIntEquals(tc, Complex, dot->type);
+  CuAssertDblEquals(tc, real, dot->real, 1e-9);
+  CuAssertDblEquals(tc, im, dot->im, 1e-9);
+
+  // Ordered by real part first.
+  struct LispDatum* max = array_max(pair, 1);
+  struct LispDatum* items = array_to_list(pair, 1);
+
+  for (struct LispDatum* idx = items; idx != NULL; idx = idx->cdr) {
+    CuAssertTrue(tc, numeric_compare(idx->car, max) <= 0);
+  }
+
+  release(dot);
+  release(max);
+  release(items);
+  release(pair[0]);
+  release(pair[1]);
+}
+
+void Test_numarray_lists(CuTest* tc) {
+  struct LispDatum* items[] = {box_integer(1), new_rational(1, 2), new_real(2.5), new_complex(0, 1)};
+  struct LispDatum* list = new_list(items, 4, NULL);
+  struct LispDatum* ints = new_list(items, 1, NULL);
+
+  struct LispDatum* complex = list_to_c128_array(&list, 1);
+  CuAssertIntEquals(tc, C128Array, complex->type);
+  CuAssertIntEquals(tc, 4, complex->count);
+
+  struct LispDatum* back = array_to_list(&complex, 1);
+  CuAssertTrue(tc, datum_cmp(back->cdr->car, items[1]));
+  CuAssertTrue(tc, datum_cmp(back->cdr->cdr->cdr->car, items[3]));
+
+  // Reals can't hold complex numbers, and integer arrays only hold integers.
+  AssertThrows(list_to_f64_array(&list, 1), Type);
+  AssertThrows(i32_array(items, 2), Type);
+
+  struct LispDatum* one = list_to_i32_array(&ints, 1);
+  struct LispDatum* copy = i32_array(items, 1);
+  CuAssertTrue(tc, datum_cmp(one, copy));
+  CuAssertTrue(tc, !datum_cmp(one, complex));
+
+  release(list);
+  release(ints);
+  release(complex);
+  release(back);
+  release(one);
+  release(copy);
+
+  for (int i = 0; i < 4; ++i) {
+    release(items[i]);
+  }
+}
@@ -0,0 +1,102 @@
+#include "CuTest.h"
+#include "../bigint.h"
+#include "../data.h"
+#include "../err.h"
+#include "../numeric.h"
+#include "../stdlisp.h"
+
+#define AssertThrows(expression, err) CuAssertPtrEquals(tc, NULL, (expression)); \
+CuAssertIntEquals(tc, (err), GlobalErrorState); \
+raise(None, NULL);
+
+#define SAMPLES 6
+
+/** One value of each numeric type, plus a big integer that fits in a rational's terms. */
+static void make_samples(struct LispDatum** samples) {
+  samples[0] = box_integer(-3);
+  samples[1] = new_bigint_from_string("100000000000000000000000");
+  samples[2] = new_bigint_from_string("-5000000000");
+  samples[3] = new_rational(7, 4);
+  samples[4] = new_real(2.5);
+  samples[5] = new_complex(1, -2);
+}
+
+void Test_numeric_pairs_commute(CuTest* tc) {
+  struct LispDatum* samples[SAMPLES];
+  make_samples(samples);
+
+  for (int i = 0; i < SAMPLES; ++i) {
+    for (int j = 0; j < SAMPLES; ++j) {
+      struct LispDatum* forward[] = {samples[i], samples[j]};
+      struct LispDatum* backward[] = {samples[j], samples[i]};
+
+      struct LispDatum* a = add(forward, 2);
+      struct LispDatum* b = add(backward, 2);
+      CuAssertTrue(tc, datum_cmp(a, b));
+      release(a);
+      release(b);
+
+      a = multiply(forward, 2);
+      b = multiply(backward, 2);
+      CuAssertTrue(tc, datum_cmp(a, b));
+      release(a);
+      release(b);
+
+      CuAssertIntEquals(tc, numeric_compare(samples[i], samples[j]), -numeric_compare(samples[j], samples[i]));
+    }
+  }
+
+  for (int i = 0; i < SAMPLES; ++i) {
+    release(samples[i]);
+  }
+}
+
+void Test_numeric_mixed_types(CuTest* tc) {
+  struct LispDatum* samples[SAMPLES];
+  make_samples(samples);
+
+  // Big integers that fit in 64 bits stay exact alongside rationals.
+  struct LispDatum* args[] = {samples[2], samples[3]};
+  struct LispDatum* sum = add(args, 2);
+  CuAssertIntEquals(tc, Rational, sum->type);
+  CuAssertTrue(tc, sum->num == -19999999993 && sum->den == 4);
+
+  args[0] = samples[1];
+  struct LispDatum* real = add(args, 2);
+  CuAssertIntEquals(tc, Real, real->type);
+
+  args[1] = samples[5];
+  struct LispDatum* complex = subtract(args, 2);
+  CuAssertIntEquals(tc, Complex, complex->type);
+  CuAssertDblEquals(tc, 2, complex->im, 0);
+
+  release(sum);
+  release(real);
+  release(complex);
+
+  for (int i = 0; i < SAMPLES; ++i) {
+    release(samples[i]);
+  }
+}
+
+void Test_numeric_divide(CuTest* tc) {
+  struct LispDatum* args[] = {new_complex(1, 2), new_complex(3, 4)};
+  struct LispDatum* quotient = divide(args, 2);
+  CuAssertDblEquals(tc, 0.44, quotient->real, 1e-12);
+  CuAssertDblEquals(tc, 0.08, quotient->im, 1e-12);
+  release(args[0]);
+  release(args[1]);
+  release(quotient);
+
+  struct LispDatum* rational_zero = new_rational(0, 5);
+  struct LispDatum* real_zero = new_real(0);
+  struct LispDatum* zeros[] = {box_integer(1), box_integer(2), box_integer(0)};
+  AssertThrows(divide(zeros, 3), ZeroDivision);
+  zeros[2] = rational_zero;
+  AssertThrows(divide(zeros, 3), ZeroDivision);
+  zeros[2] = real_zero;
+  AssertThrows(divide(zeros, 3), ZeroDivision);
+
+  release(rational_zero);
+  release(real_zero);
+}
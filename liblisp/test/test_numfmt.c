@@ -0,0 +1,132 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "../data.h"
+#include "../numfmt.h"
+
+static void assert_real(CuTest* tc, const char* expected, double x) {
+  char out[LISP_REAL_CHARS + 1];
+  out[format_real(x, out)] = '\0';
+  CuAssertStrEquals(tc, expected, out);
+}
+
+/** The number of significant digits in a formatted real, from the first non-zero digit to the last. */
+static int significant_digits(const char* s) {
+  int first = -1;
+  int last = -1;
+
+  for (int i = 0; s[i] != '\0' && s[i] != 'e'; ++i) {
+    if (s[i] >= '1' && s[i] <= '9') {
+      last = i;
+      first = first < 0 ? i : first;
+    }
+  }
+
+  int digits = last - first + 1;
+
+  // Don't count a decimal point that falls between them.
+  for (int i = first; i < last; ++i) {
+    digits -= s[i] == '.';
+  }
+
+  return digits;
+}
+
+void Test_numfmt_integers(CuTest* tc) {
+  char out[LISP_INT_CHARS + 1];
+
+  out[format_int64(0, out)] = '\0';
+  CuAssertStrEquals(tc, "0", out);
+  out[format_int64(-7, out)] = '\0';
+  CuAssertStrEquals(tc, "-7", out);
+  out[format_int64(INT64_MIN, out)] = '\0';
+  CuAssertStrEquals(tc, "-9223372036854775808", out);
+  out[format_uint64(UINT64_MAX, out)] = '\0';
+  CuAssertStrEquals(tc, "18446744073709551615", out);
+
+  format_digits9(1234, out);
+  out[9] = '\0';
+  CuAssertStrEquals(tc, "000001234", out);
+
+  // Every length, either side of each power of 10.
+  for (int64_t power = 1; power <= INT64_MAX / 10; power *= 10) {
+    for (int64_t x = power - 1; x <= power; ++x) {
+      char expected[LISP_INT_CHARS + 1];
+      snprintf(expected, sizeof(expected), "%lld", (long long) -x);
+      out[format_int64(-x, out)] = '\0';
+      CuAssertStrEquals(tc, expected, out);
+    }
+  }
+}
+
+void Test_numfmt_real_notation(CuTest* tc) {
+  assert_real(tc, "0.0", 0.0);
+  assert_real(tc, "-0.0", -0.0);
+  assert_real(tc, "2.0", 2.0);
+  assert_real(tc, "-2.5", -2.5);
+  assert_real(tc, "0.1", 0.1);
+  assert_real(tc, "0.30000000000000004", 0.1 + 0.2);
+  assert_real(tc, "1234.5678", 1234.5678);
+  assert_real(tc, "100000000000000000000.0", 1e20);
+  assert_real(tc, "123456789012345680.0", 123456789012345678.0);
+  assert_real(tc, "1e21", 1e21);
+  assert_real(tc, "0.0000001", 1e-7);
+  assert_real(tc, "1.5e-8", 1.5e-8);
+  assert_real(tc, "5e-324", 5e-324);
+  assert_real(tc, "2.2250738585072014e-308", 2.2250738585072014e-308);
+  assert_real(tc, "1.7976931348623157e308", 1.7976931348623157e308);
+  assert_real(tc, "+inf.0", INFINITY);
+  assert_real(tc, "-inf.0", -INFINITY);
+  assert_real(tc, "+nan.0", NAN);
+}
+
+void Test_numfmt_real_roundtrip(CuTest* tc) {
+  uint64_t state = 88172645463325252u;
+
+  for (int i = 0; i < 100000; ++i) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    double x;
+    memcpy(&x, &state, sizeof(x));
+    if (!isfinite(x)) {
+      continue;
+    }
+
+    char out[LISP_REAL_CHARS + 1];
+    out[format_real(x, out)] = '\0';
+    CuAssertTrue(tc, strtod(out, NULL) == x);
+
+    // Nothing shorter reads back as the same value.
+    int digits = significant_digits(out);
+    if (digits > 1) {
+      char shorter[LISP_REAL_CHARS + 1];
+      snprintf(shorter, sizeof(shorter), "%.*e", digits - 2, x);
+      CuAssertTrue(tc, strtod(shorter, NULL) != x);
+    }
+  }
+}
+
+void Test_numfmt_numbers(CuTest* tc) {
+  char out[LISP_NUMBER_CHARS + 1];
+  struct LispDatum* rational = new_rational(-1, 3);
+  struct LispDatum* complex = new_complex(1, -2.5);
+
+  out[format_number(rational, out)] = '\0';
+  CuAssertStrEquals(tc, "-1/3", out);
+  out[format_number(complex, out)] = '\0';
+  CuAssertStrEquals(tc, "1.0-2.5i", out);
+
+  out[format_complex(0, 0, out)] = '\0';
+  CuAssertStrEquals(tc, "0.0+0.0i", out);
+  out[format_complex(0, -INFINITY, out)] = '\0';
+  CuAssertStrEquals(tc, "0.0-inf.0i", out);
+  out[format_complex(0, NAN, out)] = '\0';
+  CuAssertStrEquals(tc, "0.0+nan.0i", out);
+
+  release(rational);
+  release(complex);
+}
@@ -0,0 +1,208 @@
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "../data.h"
+#include "../lists.h"
+#include "../lstring.h"
+#include "../port.h"
+#include "../stdlisp.h"
+#include "../walk.h"
+
+/** Display a datum into a string port, and check what was written. */
+static void assert_displays(CuTest* tc, const char* expected, struct LispDatum* x) {
+  struct LispPort port;
+  port_open_string(&port);
+  struct LispPort* previous = lisp_set_output_port(&port);
+
+  display(x);
+
+  lisp_set_output_port(previous);
+  struct LispDatum* s = port_take_string(&port);
+  CuAssertStrEquals(tc, expected, string_content(s));
+  release(s);
+  port_close(&port);
+}
+
+void Test_port_display(CuTest* tc) {
+  struct LispDatum* items[] = {box_integer(-4), new_rational(1, 3), LISP_STRING_LITERAL("text"), get_true()};
+  struct LispDatum* list = new_list(items, 4, NULL);
+  struct LispDatum* pair = new_cons(items[0], items[1]);
+
+  assert_displays(tc, "-4", items[0]);
+  assert_displays(tc, "(-4 1/3 text #t )", list);
+  assert_displays(tc, "(-4 . 1/3)", pair);
+  assert_displays(tc, "nil", get_nil());
+
+  release(list);
+  release(pair);
+
+  for (int i = 0; i < 4; ++i) {
+    release(items[i]);
+  }
+}
+
+void Test_port_format(CuTest* tc) {
+  struct LispPort port;
+  port_open_string(&port);
+  struct LispPort* previous = lisp_set_output_port(&port);
+  CuAssertPtrEquals(tc, &port, lisp_output_port());
+
+  struct LispDatum* args[] = {box_integer(1), new_real(2.5), LISP_STRING_LITERAL("three")};
+  release(format(args, 3));
+  release(format(args, 1));
+
+  CuAssertPtrEquals(tc, &port, lisp_set_output_port(previous));
+  CuAssertPtrEquals(tc, previous, lisp_output_port());
+
+  struct LispDatum* s = port_take_string(&port);
+  CuAssertStrEquals(tc, "1 2.5 three \n1 \n", string_content(s));
+  release(s);
+  release(args[1]);
+  release(args[2]);
+
+  // The port is empty again once its contents are taken.
+  s = port_take_string(&port);
+  CuAssertIntEquals(tc, 0, string_length(s));
+  release(s);
+  port_close(&port);
+}
+
+/** Display a datum into a string port, and return what was written. */
+static struct LispDatum* display_to_string(struct LispDatum* x) {
+  struct LispPort port;
+  port_open_string(&port);
+  struct LispPort* previous = lisp_set_output_port(&port);
+
+  display(x);
+
+  lisp_set_output_port(previous);
+  struct LispDatum* s = port_take_string(&port);
+  port_close(&port);
+  return s;
+}
+
+static int ends_with(const struct LispDatum* s, const char* suffix) {
+  size_t length = strlen(suffix);
+  return string_length(s) >= length && memcmp(string_content(s) + string_length(s) - length, suffix, length) == 0;
+}
+
+void Test_port_display_deep(CuTest* tc) {
+  const uint32_t depth = 200000;
+  struct LispDatum* x = box_integer(0);
+
+  for (uint32_t i = 0; i < depth; ++i) {
+    struct LispDatum* next = new_cons(x, NULL);
+    release(x);
+    x = next;
+  }
+
+  // ((...(0 ) ...) )
+  struct LispDatum* s = display_to_string(x);
+  CuAssertIntEquals(tc, 3 * depth + 1, string_length(s));
+  CuAssertIntEquals(tc, '(', string_content(s)[depth - 1]);
+  CuAssertIntEquals(tc, '0', string_content(s)[depth]);
+  CuAssertTrue(tc, ends_with(s, ") )"));
+
+  release(s);
+  release(x);
+}
+
+void Test_port_display_cycles(CuTest* tc) {
+  struct LispDatum* items[] = {box_integer(1), box_integer(2), box_integer(3)};
+  struct LispDatum* x = new_list(items, 3, NULL);
+
+  // (1 2 3 1 2 3 ...
+  struct LispDatum* args[] = {x->cdr->cdr, x};
+  release(set_cdr(args, 2));
+  struct LispDatum* s = display_to_string(x);
+  CuAssertStrEquals(tc, "(1 2 3 . #<cycle>)", string_content(s));
+  release(s);
+
+  // Without cycle detection, the cycle is unrolled until the walk runs out of fuel.
+  set_global_cycle_detection(0);
+  s = display_to_string(x);
+  CuAssertTrue(tc, strncmp(string_content(s), "(1 2 3 1 2 3 ", 13) == 0);
+  CuAssertTrue(tc, ends_with(s, ". #<cycle>)"));
+  release(s);
+  set_global_cycle_detection(1);
+
+  // ((((... 2 3 1 2 3 ...
+  args[0] = x;
+  release(set_car(args, 2));
+  s = display_to_string(x);
+  CuAssertStrEquals(tc, "(#<cycle> 2 3 . #<cycle>)", string_content(s));
+  release(s);
+
+  set_global_cycle_detection(0);
+  s = display_to_string(x);
+  CuAssertTrue(tc, strncmp(string_content(s), "((((", 4) == 0);
+  CuAssertTrue(tc, strstr(string_content(s), "(#<cycle> 2 3 ") != NULL);
+  CuAssertTrue(tc, ends_with(s, ". #<cycle>)"));
+  release(s);
+  set_global_cycle_detection(1);
+
+  // Break the cycles, so that the list can be released.
+  args[0] = x->cdr->cdr;
+  args[1] = get_nil();
+  release(set_cdr(args, 2));
+  args[0] = x;
+  release(set_car(args, 2));
+  release(x);
+}
+
+void Test_port_display_shared(CuTest* tc) {
+  // A value that appears many times over without containing itself is not a cycle, however many times it is written.
+  struct LispDatum* items[] = {box_integer(1), box_integer(2)};
+  struct LispDatum* pair = new_list(items, 2, NULL);
+  struct LispDatum* copies[LISP_WALK_FUEL];
+
+  for (uint32_t i = 0; i < LISP_WALK_FUEL; ++i) {
+    copies[i] = pair;
+  }
+
+  struct LispDatum* x = new_list(copies, LISP_WALK_FUEL, NULL);
+  struct LispDatum* s = display_to_string(x);
+  CuAssertIntEquals(tc, 2 + 7 * LISP_WALK_FUEL, string_length(s));
+  CuAssertTrue(tc, ends_with(s, "(1 2 ) (1 2 ) )"));
+
+  release(s);
+  release(x);
+  release(pair);
+}
+
+void Test_port_file_buffering(CuTest* tc) {
+  FILE* file = tmpfile();
+  struct LispPort port;
+  port_open_file(&port, file);
+
+  // Enough to fill the buffer a few times over, including a single piece larger than the whole buffer.
+  char* large = malloc(LISP_PORT_BUFFER_SIZE + 100);
+  memset(large, 'x', LISP_PORT_BUFFER_SIZE + 99);
+  large[LISP_PORT_BUFFER_SIZE + 99] = '\0';
+  long expected = 0;
+
+  for (int i = 0; i < 20000; ++i) {
+    port_print(&port, "%d,", i);
+    expected += snprintf(NULL, 0, "%d,", i);
+  }
+
+  port_print(&port, "%s", large);
+  port_write(&port, large, 10);
+  port_write_char(&port, '!');
+  expected += LISP_PORT_BUFFER_SIZE + 99 + 10 + 1;
+
+  port_close(&port);
+  CuAssertIntEquals(tc, expected, ftell(file));
+
+  // Everything arrives in order.
+  rewind(file);
+  char head[8] = {0};
+  CuAssertIntEquals(tc, 7, (int) fread(head, 1, 7, file));
+  CuAssertStrEquals(tc, "0,1,2,3", head);
+  fseek(file, -2, SEEK_END);
+  CuAssertIntEquals(tc, 'x', fgetc(file));
+  CuAssertIntEquals(tc, '!', fgetc(file));
+
+  free(large);
+  fclose(file);
+}
@@ -0,0 +1,63 @@
+#include "CuTest.h"
+#include "../data.h"
+#include "../err.h"
+#include "../rational.h"
+#include "../stdlisp.h"
+
+void Test_rational_long_fold(CuTest* tc) {
+  // The harmonic number H_40. Every denominator overflows 32 bits, and unreduced intermediates overflow 64.
+  struct LispDatum* terms[40];
+  for (int32_t k = 1; k <= 40; ++k) {
+    terms[k - 1] = new_rational(1, k);
+  }
+
+  struct LispDatum* sum = add(terms, 40);
+  CuAssertIntEquals(tc, Rational, sum->type);
+  CuAssertTrue(tc, sum->num == 2078178381193813 && sum->den == 485721041551200);
+
+  for (int32_t k = 0; k < 40; ++k) {
+    release(terms[k]);
+  }
+  release(sum);
+}
+
+void Test_rational_intermediate_overflow(CuTest* tc) {
+  // The product of the first two terms does not fit in 32 bits, but the final result does.
+  struct LispDatum* args[] = {new_rational(65536, 3), new_rational(65536, 5), new_rational(1, 65536),
+                              new_rational(1, 65536)};
+  struct LispDatum* product = multiply(args, 4);
+  CuAssertIntEquals(tc, Rational, product->type);
+  CuAssertTrue(tc, product->num == 1 && product->den == 15);
+
+  // Results too large for 64 bit terms even once reduced become reals.
+  struct LispDatum* large[] = {new_rational(INT64_MAX, 7), new_rational(INT64_MAX, 11)};
+  struct LispDatum* overflow = multiply(large, 2);
+  CuAssertIntEquals(tc, Real, overflow->type);
+
+  for (int i = 0; i < 4; ++i) {
+    release(args[i]);
+  }
+  release(large[0]);
+  release(large[1]);
+  release(product);
+  release(overflow);
+}
+
+void Test_rational_exact_compare(CuTest* tc) {
+  // Both of these are nearest to 1.0 as doubles.
+  struct LispDatum* a = new_rational(9007199254740993, 9007199254740992);
+  struct LispDatum* b = new_rational(9007199254740992, 9007199254740991);
+
+  struct LispDatum* args[] = {a, b};
+  CuAssertPtrEquals(tc, get_true(), less_than(args, 2));
+  CuAssertPtrEquals(tc, get_false(), num_equals(args, 2));
+
+  struct LispDatum* half = new_rational(-4, -8);
+  CuAssertTrue(tc, half->num == 1 && half->den == 2);
+  CuAssertIntEquals(tc, 6, (int) binary_gcd(48, 18));
+  CuAssertIntEquals(tc, 7, (int) binary_gcd(0, 7));
+
+  release(a);
+  release(b);
+  release(half);
+}
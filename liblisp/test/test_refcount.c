@@ -0,0 +1,145 @@
+#include "CuTest.h"
+#include "../data.h"
+#include "../lstring.h"
+#include "../stdlisp.h"
+#include "../vector.h"
+
+// Reference counts are left untouched by the tracing collector, so there is nothing to check in that build.
+#ifdef LISP_TRACING_GC
+#define REQUIRE_REFCOUNT(tc) do { (void) (tc); return; } while (0)
+#else
+#define REQUIRE_REFCOUNT(tc) do {} while (0)
+#endif
+
+void Test_new_datum_single_owner(CuTest* tc) {
+  REQUIRE_REFCOUNT(tc);
+
+  struct LispDatum* x = new_real(1.5);
+  CuAssertIntEquals(tc, 1, x->refs);
+
+  CuAssertPtrEquals(tc, x, retain(x));
+  CuAssertIntEquals(tc, 2, x->refs);
+
+  release(x);
+  CuAssertIntEquals(tc, 1, x->refs);
+  release(x);
+}
+
+void Test_statics_are_immortal(CuTest* tc) {
+  REQUIRE_REFCOUNT(tc);
+
+  struct LispDatum* nil = get_nil();
+
+  for (int i = 0; i < 4; ++i) {
+    release(nil);
+    release(get_true());
+    release(box_integer(1));
+  }
+
+  CuAssertIntEquals(tc, Nil, get_nil()->type);
+  CuAssert(tc, "true survives", get_true()->boolean);
+  CuAssertIntEquals(tc, 1, box_integer(1)->int_val);
+}
+
+void Test_list_owns_elements(CuTest* tc) {
+  REQUIRE_REFCOUNT(tc);
+
+  struct LispDatum* args[2];
+  args[0] = new_string("first");
+  args[1] = new_real(2.0);
+
+  struct LispDatum* alist = list(args, 2);
+  CuAssertIntEquals(tc, 2, args[0]->refs);
+  CuAssertIntEquals(tc, 2, args[1]->refs);
+
+  // Releasing the list leaves the caller's references intact.
+  release(alist);
+  CuAssertIntEquals(tc, 1, args[0]->refs);
+  CuAssertIntEquals(tc, 1, args[1]->refs);
+  CuAssertStrEquals(tc, "first", string_content(args[0]));
+
+  release(args[0]);
+  release(args[1]);
+}
+
+void Test_shared_tail_survives(CuTest* tc) {
+  REQUIRE_REFCOUNT(tc);
+
+  struct LispDatum* items[3];
+  for (int i = 0; i < 3; ++i) {
+    items[i] = new_integer(1000 + i);
+  }
+
+  struct LispDatum* alist = list(items, 3);
+  struct LispDatum* tail = cdr(&alist, 1);
+
+  release(alist);
+
+  // The tail is still owned by this test, so it and everything after it must remain valid.
+  CuAssertIntEquals(tc, 1001, tail->car->int_val);
+  CuAssertIntEquals(tc, 1002, tail->cdr->car->int_val);
+
+  release(tail);
+
+  for (int i = 0; i < 3; ++i) {
+    CuAssertIntEquals(tc, 1, items[i]->refs);
+    release(items[i]);
+  }
+}
+
+void Test_release_long_list(CuTest* tc) {
+  REQUIRE_REFCOUNT(tc);
+
+  struct LispDatum* alist = get_nil();
+
+  // Long enough that a recursive release would overflow the stack.
+  for (int i = 0; i < 1000000; ++i) {
+    struct LispDatum* next = new_cons(box_integer(i % 10), alist);
+    release(alist);
+    alist = next;
+  }
+
+  CuAssertIntEquals(tc, 1, alist->refs);
+  release(alist);
+}
+
+void Test_deferred_release(CuTest* tc) {
+  REQUIRE_REFCOUNT(tc);
+
+  struct LispDatum* x = new_real(3.0);
+  retain(x);
+
+  release_deferred(x);
+  CuAssertIntEquals(tc, 2, x->refs);
+
+  flush_releases();
+  CuAssertIntEquals(tc, 1, x->refs);
+
+  // More releases than fit in a single batch.
+  for (int i = 0; i < 1000; ++i) {
+    retain(x);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    release_deferred(x);
+  }
+  flush_releases();
+
+  CuAssertIntEquals(tc, 1, x->refs);
+  release(x);
+}
+
+void Test_release_deep_nesting(CuTest* tc) {
+  REQUIRE_REFCOUNT(tc);
+
+  // Nested through the car, and through vectors, which destroying a list can't simply iterate along.
+  struct LispDatum* x = box_integer(0);
+
+  for (int i = 0; i < 1000000; ++i) {
+    struct LispDatum* next = i % 2 == 0 ? new_cons(x, NULL) : new_vector_from(&x, 1);
+    release(x);
+    x = next;
+  }
+
+  CuAssertIntEquals(tc, 1, x->refs);
+  release(x);
+}
@@ -0,0 +1,130 @@
+#include <math.h>
+#include "CuTest.h"
+#include "../bigint.h"
+#include "../data.h"
+#include "../simd.h"
+#include "../stdlisp.h"
+
+#define RUN 600
+
+static void release_all(struct LispDatum** args, uint32_t nargs) {
+  for (uint32_t i = 0; i < nargs; ++i) {
+    release(args[i]);
+  }
+}
+
+static void assert_digits(CuTest* tc, const char* expected, const struct LispDatum* x) {
+  struct LispStringBuilder digits;
+  string_builder_init(&digits);
+  integer_format(x, &digits);
+  CuAssertStrEquals(tc, expected, string_builder_content(&digits));
+  string_builder_discard(&digits);
+}
+
+void Test_simd_kernels(CuTest* tc) {
+  int32_t ints[37];
+  double reals[37];
+  int64_t sum = 0;
+  double real_sum = 0;
+
+  for (int i = 0; i < 37; ++i) {
+    ints[i] = INT32_MAX - i;
+    reals[i] = 1 + i / 64.0;
+    sum += ints[i];
+    real_sum += reals[i];
+  }
+
+  CuAssertTrue(tc, simd_sum_i32(ints, 37) == sum);
+  CuAssertDblEquals(tc, real_sum, simd_sum_f64(reals, 37), 1e-12);
+  CuAssertIntEquals(tc, 1, simd_ordered_i32(ints, 37, LISP_ORDER_GREATER));
+  CuAssertIntEquals(tc, 0, simd_ordered_i32(ints, 37, LISP_ORDER_LESS));
+  CuAssertIntEquals(tc, 1, simd_ordered_f64(reals, 37, LISP_ORDER_LESS | LISP_ORDER_EQUAL));
+
+  // Each tail length, with and without a violation in the last pair.
+  for (uint32_t n = 2; n < 37; ++n) {
+    reals[n - 1] = 0;
+    CuAssertIntEquals(tc, 0, simd_ordered_f64(reals, n, LISP_ORDER_LESS));
+    reals[n - 1] = 1 + (n - 1) / 64.0;
+    CuAssertIntEquals(tc, 1, simd_ordered_f64(reals, n, LISP_ORDER_LESS));
+  }
+
+  reals[20] = NAN;
+  CuAssertIntEquals(tc, 0, simd_ordered_f64(reals, 37, LISP_ORDER_GREATER | LISP_ORDER_EQUAL));
+}
+
+void Test_simd_integer_fold(CuTest* tc) {
+  struct LispDatum* args[RUN];
+
+  for (int i = 0; i < RUN; ++i) {
+    args[i] = box_integer(INT32_MAX);
+  }
+
+  // The sum no longer fits in an integer, and is promoted.
+  struct LispDatum* sum = add(args, RUN);
+  CuAssertIntEquals(tc, BigInt, sum->type);
+  assert_digits(tc, "1288490188200", sum);
+
+  // Subtraction subtracts the sum of the remaining arguments.
+  struct LispDatum* difference = subtract(args, RUN);
+  assert_digits(tc, "-1284195220906", difference);
+
+  release(sum);
+  release(difference);
+  release_all(args, RUN);
+}
+
+void Test_simd_real_fold(CuTest* tc) {
+  struct LispDatum* args[RUN];
+
+  for (int i = 0; i < RUN; ++i) {
+    args[i] = new_real(1 + i / 1024.0);
+  }
+
+  struct LispDatum* sum = add(args, RUN);
+  CuAssertIntEquals(tc, Real, sum->type);
+  CuAssertDblEquals(tc, RUN + RUN * (RUN - 1) / 2048.0, sum->float_val, 1e-9);
+
+  struct LispDatum* product = multiply(args, 20);
+  double expected = 1;
+
+  for (int i = 0; i < 20; ++i) {
+    expected *= 1 + i / 1024.0;
+  }
+
+  CuAssertDblEquals(tc, expected, product->float_val, 1e-12);
+
+  release(sum);
+  release(product);
+  release_all(args, RUN);
+}
+
+void Test_simd_chained_compare(CuTest* tc) {
+  struct LispDatum* args[RUN];
+
+  for (int i = 0; i < RUN; ++i) {
+    args[i] = box_integer(i);
+  }
+
+  CuAssertPtrEquals(tc, get_true(), less_than(args, RUN));
+  CuAssertPtrEquals(tc, get_false(), greater_than_eql(args, RUN));
+
+  // A violation straddling two blocks of gathered arguments.
+  release(args[256]);
+  args[256] = box_integer(0);
+  CuAssertPtrEquals(tc, get_false(), less_than(args, RUN));
+  release(args[256]);
+  args[256] = box_integer(255);
+  CuAssertPtrEquals(tc, get_false(), less_than(args, RUN));
+  CuAssertPtrEquals(tc, get_true(), less_than_eql(args, RUN));
+  release_all(args, RUN);
+
+  for (int i = 0; i < 20; ++i) {
+    args[i] = new_real(2.5);
+  }
+
+  CuAssertPtrEquals(tc, get_true(), num_equals(args, 20));
+  release(args[19]);
+  args[19] = new_real(NAN);
+  CuAssertPtrEquals(tc, get_false(), num_equals(args, 20));
+  release_all(args, 20);
+}
@@ -0,0 +1,101 @@
+#include <pthread.h>
+
+#include "CuTest.h"
+#include "../data.h"
+#include "../err.h"
+#include "../state.h"
+#include "../stdlisp.h"
+
+void Test_state_error_isolation(CuTest* tc) {
+  struct LispState* state = lisp_state_new();
+  struct LispState* previous = lisp_state_bind(state);
+
+  raise(Type, "Raised in a separate state");
+  CuAssertIntEquals(tc, Type, GlobalErrorState);
+
+  lisp_state_bind(previous);
+  CuAssertIntEquals(tc, None, GlobalErrorState);
+
+  lisp_state_destroy(state);
+}
+
+void Test_state_bind_restores_default(CuTest* tc) {
+  struct LispState* original = lisp_state_current();
+  struct LispState* state = lisp_state_new();
+
+  lisp_state_bind(state);
+  CuAssertPtrEquals(tc, state, lisp_state_current());
+
+  // Destroying the bound state falls back to the default one.
+  lisp_state_destroy(state);
+  CuAssertPtrEquals(tc, original, lisp_state_current());
+}
+
+void Test_state_statics_are_shared(CuTest* tc) {
+  struct LispState* state = lisp_state_new();
+  struct LispState* previous = lisp_state_bind(state);
+
+  struct LispDatum* nil = get_nil();
+  struct LispDatum* small = box_integer(3);
+
+  lisp_state_bind(previous);
+  lisp_state_destroy(state);
+
+  CuAssertPtrEquals(tc, get_nil(), nil);
+  CuAssertPtrEquals(tc, box_integer(3), small);
+  CuAssertIntEquals(tc, 3, small->int_val);
+}
+
+struct Workload {
+  int length;
+  int result;
+};
+
+static void* run_workload(void* arg) {
+  struct Workload* workload = arg;
+  struct LispState* state = lisp_state_new();
+  lisp_state_bind(state);
+
+  struct LispDatum* items[4];
+  for (int i = 0; i < 4; ++i) {
+    items[i] = new_integer(1000 * (i + 1));
+  }
+
+  struct LispDatum* alist = list(items, 4);
+
+  // Repeatedly build and tear down lists so that both threads exercise their allocators at the same time.
+  for (int i = 0; i < workload->length; ++i) {
+    struct LispDatum* args[2] = {alist, alist};
+    struct LispDatum* joined = append(args, 2);
+    struct LispDatum* len = length(&joined, 1);
+
+    workload->result += len->int_val;
+
+    release(len);
+    release(joined);
+  }
+
+  release(alist);
+  for (int i = 0; i < 4; ++i) {
+    release(items[i]);
+  }
+
+  lisp_state_destroy(state);
+  return NULL;
+}
+
+void Test_state_concurrent_workloads(CuTest* tc) {
+  struct Workload workloads[2] = {{.length = 10000}, {.length = 20000}};
+  pthread_t threads[2];
+
+  for (int i = 0; i < 2; ++i) {
+    pthread_create(&threads[i], NULL, run_workload, &workloads[i]);
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  CuAssertIntEquals(tc, 80000, workloads[0].result);
+  CuAssertIntEquals(tc, 160000, workloads[1].result);
+}
@@ -0,0 +1,128 @@
+#include <string.h>
+#include <unistd.h>
+#include "CuTest.h"
+#include "../bigint.h"
+#include "../data.h"
+#include "../err.h"
+#include "../stats.h"
+#include "../stdlisp.h"
+
+// These tests only apply when the runtime is built with LISP_STATS.
+
+#ifdef LISP_STATS
+static struct LispStats totals() {
+  struct LispStats stats;
+  lisp_stats_collect(&stats);
+  return stats;
+}
+
+static uint64_t get(_Atomic uint64_t* counter) {
+  return atomic_load(counter);
+}
+#endif
+
+void TestStats_CountsAllocationsByType(CuTest* tc) {
+#ifdef LISP_STATS
+  struct LispStats before = totals();
+  struct LispDatum* x = new_real(1.5);
+  struct LispDatum* y = new_complex(1, 2);
+  struct LispDatum* z = new_real(2.5);
+  struct LispStats after = totals();
+
+  CuAssertTrue(tc, get(&after.allocations[Real]) - get(&before.allocations[Real]) == 2);
+  CuAssertTrue(tc, get(&after.allocations[Complex]) - get(&before.allocations[Complex]) == 1);
+  CuAssertTrue(tc, get(&after.bytes[Real]) - get(&before.bytes[Real]) == 2 * sizeof(struct LispDatum));
+
+  release(x);
+  release(y);
+  release(z);
+#else
+  (void) tc;
+#endif
+}
+
+void TestStats_CountsNativeCallsOnce(CuTest* tc) {
+#ifdef LISP_STATS
+  struct LispDatum* args[] = {box_integer(1), box_integer(2)};
+  struct LispStats before = totals();
+
+  // Both forms count as the same native, and the variadic form of `car` only counts its direct form.
+  release(add(args, 2));
+  release(add2(args[0], args[1]));
+  struct LispDatum* pair = cons(args, 2);
+  release(car(&pair, 1));
+  struct LispStats after = totals();
+
+  CuAssertTrue(tc, get(&after.calls[LispStats_add]) - get(&before.calls[LispStats_add]) == 2);
+  CuAssertTrue(tc, get(&after.calls[LispStats_cons]) - get(&before.calls[LispStats_cons]) == 1);
+  CuAssertTrue(tc, get(&after.calls[LispStats_car]) - get(&before.calls[LispStats_car]) == 1);
+
+  release(pair);
+#else
+  (void) tc;
+#endif
+}
+
+void TestStats_CountsPromotionSteps(CuTest* tc) {
+#ifdef LISP_STATS
+  struct LispDatum* a = new_bigint_from_string("123456789012345678901234567890");
+  struct LispDatum* b = new_real(1.5);
+  struct LispStats before = totals();
+
+  // Too large for a rational, so the big integer goes straight to a real.
+  release(less_than2(a, b));
+  struct LispStats after = totals();
+
+  CuAssertTrue(tc, get(&after.promotions[BigInt][Real]) - get(&before.promotions[BigInt][Real]) == 1);
+  CuAssertTrue(tc, get(&after.promotions[BigInt][Rational]) == get(&before.promotions[BigInt][Rational]));
+
+  release(a);
+  release(b);
+#else
+  (void) tc;
+#endif
+}
+
+void TestStats_CountsRaisesByCause(CuTest* tc) {
+#ifdef LISP_STATS
+  struct LispStats before = totals();
+  struct LispHandler handler;
+  lisp_push_handler(&handler, LISP_ANY_CAUSE);
+
+  if (setjmp(handler.jump) == 0) {
+    raise(ZeroDivision, "Counted.");
+    lisp_pop_handler(&handler);
+  }
+
+  struct LispStats after = totals();
+  CuAssertTrue(tc, get(&after.raises[ZeroDivision]) - get(&before.raises[ZeroDivision]) == 1);
+  CuAssertTrue(tc, get(&after.raises[Math]) == get(&before.raises[Math]));
+#else
+  (void) tc;
+#endif
+}
+
+void TestStats_ReportIsOneLineOfJson(CuTest* tc) {
+#ifdef LISP_STATS
+  release(add2(box_integer(1), box_integer(2)));
+
+  int fds[2];
+  CuAssertIntEquals(tc, 0, pipe(fds));
+  lisp_stats_report(fds[1]);
+  close(fds[1]);
+
+  char report[8192];
+  ssize_t length = read(fds[0], report, sizeof(report) - 1);
+  close(fds[0]);
+  CuAssertTrue(tc, length > 0);
+  report[length] = '\0';
+
+  CuAssertTrue(tc, strncmp(report, "{\"allocations\":{\"integer\":", 26) == 0);
+  CuAssertPtrNotNull(tc, strstr(report, "\"calls\":{\"+\":"));
+  CuAssertPtrNotNull(tc, strstr(report, ",\"raises\":{\"none\":"));
+  CuAssertTrue(tc, strcmp(report + length - 3, "}}\n") == 0);
+  CuAssertPtrEquals(tc, report + length - 1, strchr(report, '\n'));
+#else
+  (void) tc;
+#endif
+}
@@ -354,6 +354,34 @@ void Test_complex_addition(CuTest* tc) {
   CuAssert(tc, "-3+0i + 3+i = i", datum_cmp(add(args, 2), new_complex(0, 1)));
 }
 
+void Test_direct_arithmetic(CuTest* tc) {
+  struct LispDatum* args[2];
+  args[0] = new_integer(INT32_MAX);
+  args[1] = new_integer(2);
+
+  // Direct entry points promote exactly as the variadic forms do.
+  struct LispDatum* sum = add2(args[0], args[1]);
+  CuAssertIntEquals(tc, BigInt, sum->type);
+  CuAssert(tc, "MAX + 2 agrees", datum_cmp(sum, add(args, 2)));
+
+  struct LispDatum* product = multiply2(args[0], args[1]);
+  CuAssertIntEquals(tc, BigInt, product->type);
+  CuAssert(tc, "MAX * 2 agrees", datum_cmp(product, multiply(args, 2)));
+
+  CuAssert(tc, "MAX - 2 agrees", datum_cmp(subtract2(args[0], args[1]), subtract(args, 2)));
+  CuAssert(tc, "MAX / 2 agrees", datum_cmp(divide2(args[0], args[1]), divide(args, 2)));
+  CuAssert(tc, "MAX > 2", greater_than2(args[0], args[1]) == get_true());
+  CuAssert(tc, "2 <= 5/2", less_than_eql2(args[1], new_rational(5, 2)) == get_true());
+
+  args[0] = new_integer(INT32_MIN);
+  args[1] = new_integer(-1);
+  CuAssert(tc, "MIN / -1 agrees", datum_cmp(divide2(args[0], args[1]), divide(args, 2)));
+
+  args[1] = new_integer(0);
+  AssertThrows(divide2(args[0], args[1]), ZeroDivision)
+  AssertThrows(add2(args[0], new_string("1")), Math)
+}
+
 void Test_int_subtraction(CuTest* tc) {
   struct LispDatum* args[2];
   args[0] = new_integer(16);
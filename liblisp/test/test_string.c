@@ -0,0 +1,101 @@
+#include <string.h>
+
+#include "CuTest.h"
+#include "../data.h"
+#include "../lstring.h"
+#include "../stdlisp.h"
+
+void Test_short_strings_are_inline(CuTest* tc) {
+  struct LispDatum* s = new_string("fourteen chars");
+
+  CuAssert(tc, "Stored inline", string_is_short(s));
+  CuAssertIntEquals(tc, 14, string_length(s));
+  CuAssertStrEquals(tc, "fourteen chars", string_content(s));
+  CuAssertPtrEquals(tc, s->string.small.chars, (void*) string_content(s));
+
+  release(s);
+}
+
+void Test_long_strings(CuTest* tc) {
+  struct LispDatum* s = new_string_from_copy("fifteen chars!!ignored", 15);
+
+  CuAssert(tc, "Stored out of line", !string_is_short(s));
+  CuAssertIntEquals(tc, 15, string_length(s));
+  CuAssertStrEquals(tc, "fifteen chars!!", string_content(s));
+
+  release(s);
+}
+
+void Test_long_literals_are_not_copied(CuTest* tc) {
+  static const char literal[] = "a literal long enough to be stored out of line";
+  struct LispDatum* s = LISP_STRING_LITERAL(literal);
+
+  CuAssertPtrEquals(tc, (void*) literal, (void*) string_content(s));
+  CuAssertIntEquals(tc, sizeof(literal) - 1, string_length(s));
+
+  release(s);
+}
+
+void Test_string_hash(CuTest* tc) {
+  struct LispDatum* a = new_string("a string that is long enough");
+  struct LispDatum* b = new_string("a string that is long enough");
+  struct LispDatum* c = new_string("short");
+
+  CuAssert(tc, "Equal strings hash equally", string_hash(a) == string_hash(b));
+  CuAssert(tc, "Hash is cached", a->string.large.buffer->hash == string_hash(a));
+  CuAssert(tc, "Different strings hash differently", string_hash(a) != string_hash(c));
+
+  release(a);
+  release(b);
+  release(c);
+}
+
+void Test_string_builder(CuTest* tc) {
+  struct LispStringBuilder builder;
+  string_builder_init(&builder);
+  CuAssertStrEquals(tc, "", string_builder_content(&builder));
+
+  // Enough to force the builder to grow several times.
+  for (int i = 0; i < 100; ++i) {
+    string_builder_format(&builder, "%d,", i % 10);
+  }
+  string_builder_append_char(&builder, '!');
+
+  CuAssertIntEquals(tc, 201, string_builder_length(&builder));
+
+  struct LispDatum* s = string_builder_finish(&builder);
+  CuAssertIntEquals(tc, 0, string_builder_length(&builder));
+  CuAssertIntEquals(tc, 201, string_length(s));
+  CuAssert(tc, "Content is preserved", strncmp("0,1,2,3,", string_content(s), 8) == 0);
+  CuAssertIntEquals(tc, '!', string_content(s)[200]);
+
+  string_builder_append(&builder, "short", 5);
+  struct LispDatum* t = string_builder_finish(&builder);
+  CuAssert(tc, "Short results are stored inline", string_is_short(t));
+  CuAssertStrEquals(tc, "short", string_content(t));
+
+  release(s);
+  release(t);
+}
+
+void Test_string_append(CuTest* tc) {
+  struct LispDatum* args[3];
+  args[0] = new_string("Hello");
+  args[1] = new_string(", ");
+  args[2] = new_string("world, in a string too long to be inline");
+
+  struct LispDatum* result = string_append(args, 3);
+  CuAssertStrEquals(tc, "Hello, world, in a string too long to be inline", string_content(result));
+  release(result);
+
+  result = string_append(NULL, 0);
+  CuAssertIntEquals(tc, 0, string_length(result));
+  release(result);
+
+  struct LispDatum* bad[2] = {args[0], box_integer(1)};
+  CuAssertPtrEquals(tc, NULL, string_append(bad, 2));
+
+  for (int i = 0; i < 3; ++i) {
+    release(args[i]);
+  }
+}
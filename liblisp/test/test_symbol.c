@@ -0,0 +1,82 @@
+#include <pthread.h>
+#include <stdio.h>
+
+#include "CuTest.h"
+#include "../data.h"
+#include "../stdlisp.h"
+
+void Test_symbols_are_interned(CuTest* tc) {
+  struct LispDatum* a = new_symbol("alpha");
+  struct LispDatum* b = new_symbol_from_copy("alphabet", 5);
+
+  CuAssertPtrEquals(tc, a, b);
+  CuAssertIntEquals(tc, Symbol, a->type);
+  CuAssertStrEquals(tc, "alpha", a->label);
+  CuAssert(tc, "Different labels are distinct", new_symbol("beta") != a);
+
+  // Interned datums are never freed.
+  release(a);
+  CuAssertPtrEquals(tc, a, new_symbol("alpha"));
+}
+
+void Test_keywords_are_distinct_from_symbols(CuTest* tc) {
+  struct LispDatum* keyword = new_keyword("alpha", 5);
+
+  CuAssertIntEquals(tc, Keyword, keyword->type);
+  CuAssert(tc, "Keyword is not the symbol", keyword != new_symbol("alpha"));
+  CuAssertPtrEquals(tc, keyword, new_keyword("alpha", 5));
+}
+
+void Test_symbol_equality(CuTest* tc) {
+  CuAssert(tc, "Same symbol", datum_cmp(new_symbol("x"), new_symbol("x")));
+  CuAssert(tc, "Different symbols", !datum_cmp(new_symbol("x"), new_symbol("y")));
+  CuAssert(tc, "Same keyword", datum_cmp(new_keyword("x", 1), new_keyword("x", 1)));
+}
+
+void Test_intern_all(CuTest* tc) {
+  const char* const labels[] = {"first", ":second", "first"};
+  struct LispDatum* out[3];
+
+  intern_all(out, labels, 3);
+
+  CuAssertPtrEquals(tc, new_symbol("first"), out[0]);
+  CuAssertPtrEquals(tc, new_keyword("second", 6), out[1]);
+  CuAssertPtrEquals(tc, out[0], out[2]);
+}
+
+#define INTERN_THREADS 4
+#define INTERN_LABELS 2000
+
+static void* intern_labels(void* arg) {
+  struct LispDatum** out = arg;
+  char label[32];
+
+  for (int i = 0; i < INTERN_LABELS; ++i) {
+    snprintf(label, sizeof(label), "concurrent-%d", i);
+    out[i] = new_symbol(label);
+  }
+
+  return NULL;
+}
+
+void Test_concurrent_interning(CuTest* tc) {
+  static struct LispDatum* results[INTERN_THREADS][INTERN_LABELS];
+  pthread_t threads[INTERN_THREADS];
+
+  for (int i = 0; i < INTERN_THREADS; ++i) {
+    pthread_create(&threads[i], NULL, intern_labels, results[i]);
+  }
+
+  for (int i = 0; i < INTERN_THREADS; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  // Every thread must have ended up with the very same datum for each label.
+  for (int i = 1; i < INTERN_THREADS; ++i) {
+    for (int j = 0; j < INTERN_LABELS; ++j) {
+      CuAssertPtrEquals(tc, results[0][j], results[i][j]);
+    }
+  }
+
+  CuAssertStrEquals(tc, "concurrent-1999", results[0][INTERN_LABELS - 1]->label);
+}
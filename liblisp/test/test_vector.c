@@ -0,0 +1,112 @@
+#include "CuTest.h"
+#include "../data.h"
+#include "../err.h"
+#include "../lists.h"
+#include "../stdlisp.h"
+#include "../vector.h"
+
+#define AssertThrows(expression, err) CuAssertPtrEquals(tc, NULL, (expression)); \
+CuAssertIntEquals(tc, (err), GlobalErrorState); \
+raise(None, NULL);
+
+void Test_vector_push_grows(CuTest* tc) {
+  struct LispDatum* v = vector(NULL, 0);
+  CuAssertIntEquals(tc, 0, v->length);
+
+  for (int32_t i = 0; i < 1000; ++i) {
+    struct LispDatum* args[] = {v, box_integer(i)};
+    release(vector_push(args, 2));
+  }
+
+  CuAssertIntEquals(tc, 1000, v->length);
+  CuAssert(tc, "Capacity grows geometrically", v->capacity < 2000);
+
+  for (int32_t i = 0; i < 1000; ++i) {
+    struct LispDatum* args[] = {v, box_integer(i)};
+    struct LispDatum* x = vector_ref(args, 2);
+    CuAssertIntEquals(tc, i, x->int_val);
+    release(x);
+  }
+
+  release(v);
+}
+
+void Test_vector_set(CuTest* tc) {
+  struct LispDatum* items[] = {box_integer(1), box_integer(2), box_integer(3)};
+  struct LispDatum* v = vector(items, 3);
+  struct LispDatum* s = new_string("item");
+
+  struct LispDatum* args[] = {v, box_integer(1), s};
+  release(vector_set(args, 3));
+  CuAssertPtrEquals(tc, s, v->items[1]);
+#ifndef LISP_TRACING_GC
+  CuAssertIntEquals(tc, 2, s->refs);
+#endif
+
+  args[1] = box_integer(3);
+  AssertThrows(vector_set(args, 3), Argument);
+  args[1] = box_integer(-1);
+  AssertThrows(vector_ref(args, 2), Argument);
+  args[1] = s;
+  AssertThrows(vector_ref(args, 2), Type);
+
+  release(v);
+#ifndef LISP_TRACING_GC
+  CuAssertIntEquals(tc, 1, s->refs);
+#endif
+  release(s);
+}
+
+void Test_vector_slice(CuTest* tc) {
+  struct LispDatum* items[] = {box_integer(1), box_integer(2), box_integer(3), box_integer(4)};
+  struct LispDatum* v = vector(items, 4);
+
+  struct LispDatum* args[] = {v, box_integer(1), box_integer(3)};
+  struct LispDatum* slice = vector_slice(args, 3);
+  CuAssertIntEquals(tc, 2, slice->length);
+  CuAssertIntEquals(tc, 2, slice->items[0]->int_val);
+  CuAssertIntEquals(tc, 3, slice->items[1]->int_val);
+  release(slice);
+
+  slice = vector_slice(args, 2);
+  CuAssertIntEquals(tc, 3, slice->length);
+  release(slice);
+
+  args[1] = box_integer(4);
+  slice = vector_slice(args, 2);
+  CuAssertIntEquals(tc, 0, slice->length);
+  release(slice);
+
+  AssertThrows(vector_slice(args, 3), Argument);
+  args[2] = box_integer(5);
+  AssertThrows(vector_slice(args, 3), Argument);
+
+  release(v);
+}
+
+void Test_vector_list_conversion(CuTest* tc) {
+  struct LispDatum* items[] = {box_integer(1), box_integer(2), box_integer(3)};
+  struct LispDatum* l = list(items, 3);
+
+  struct LispDatum* v = list_to_vector(&l, 1);
+  CuAssertIntEquals(tc, 3, v->length);
+  CuAssertPtrEquals(tc, items[2], v->items[2]);
+
+  struct LispDatum* back = vector_to_list(&v, 1);
+  CuAssertIntEquals(tc, 3, list_length(back));
+  CuAssertPtrEquals(tc, items[0], back->car);
+
+  struct LispDatum* empty = list(NULL, 0);
+  struct LispDatum* empty_vector = list_to_vector(&empty, 1);
+  CuAssertIntEquals(tc, 0, empty_vector->length);
+
+  struct LispDatum* pair = new_cons(items[0], items[1]);
+  AssertThrows(list_to_vector(&pair, 1), Type);
+
+  release(l);
+  release(v);
+  release(back);
+  release(empty);
+  release(empty_vector);
+  release(pair);
+}
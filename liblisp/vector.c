@@ -0,0 +1,59 @@
+#include <string.h>
+#include "alloc.h"
+#include "stats.h"
+#include "vector.h"
+
+#define VECTOR_INITIAL_CAPACITY 8
+
+static struct LispDatum** new_items(uint32_t capacity) {
+  return capacity == 0 ? NULL : lisp_alloc(capacity * sizeof(struct LispDatum*));
+}
+
+struct LispDatum* new_vector(uint32_t capacity) {
+  struct LispDatum* v = alloc_datum();
+  v->type = Vector;
+  v->refs = 1;
+  v->items = new_items(capacity);
+  v->length = 0;
+  v->capacity = capacity;
+  LISP_STATS_ALLOC(Vector, sizeof(struct LispDatum) + capacity * sizeof(struct LispDatum*));
+  return v;
+}
+
+struct LispDatum* new_vector_from(struct LispDatum** items, uint32_t count) {
+  struct LispDatum* v = new_vector(count);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    v->items[i] = retain(items[i]);
+  }
+
+  v->length = count;
+  return v;
+}
+
+void vector_append(struct LispDatum* v, struct LispDatum* item) {
+  if (v->length == v->capacity) {
+    uint32_t capacity = v->capacity == 0 ? VECTOR_INITIAL_CAPACITY : v->capacity * 2;
+    struct LispDatum** items = new_items(capacity);
+
+    if (v->length > 0) {
+      memcpy(items, v->items, v->length * sizeof(struct LispDatum*));
+      lisp_free(v->items, v->capacity * sizeof(struct LispDatum*));
+    }
+
+    v->items = items;
+    v->capacity = capacity;
+  }
+
+  v->items[v->length++] = retain(item);
+}
+
+void destroy_vector(struct LispDatum* v) {
+  for (uint32_t i = 0; i < v->length; ++i) {
+    release(v->items[i]);
+  }
+
+  if (v->capacity > 0) {
+    lisp_free(v->items, v->capacity * sizeof(struct LispDatum*));
+  }
+}
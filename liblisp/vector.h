@@ -0,0 +1,25 @@
+#ifndef LISP_VECTOR_H
+#define LISP_VECTOR_H
+
+#include <stdint.h>
+#include "data.h"
+
+/*
+ * Vectors keep their items in a single contiguous buffer, so indexing is constant time and appending is amortized
+ * constant time. The buffer lives outside of the datum and is owned by it. Vectors are mutable, and the vector holds its
+ * own reference to every item.
+ */
+
+/** Create an empty vector with room for `capacity` items before it needs to grow. */
+struct LispDatum* new_vector(uint32_t capacity);
+
+/** Create a vector of the first `count` items. */
+struct LispDatum* new_vector_from(struct LispDatum** items, uint32_t count);
+
+/** Add an item to the end of a vector, growing its buffer geometrically if it is full. */
+void vector_append(struct LispDatum* v, struct LispDatum* item);
+
+/** Free whatever a vector owns outside of its datum. Called when the vector is destroyed or collected. */
+void destroy_vector(struct LispDatum* v);
+
+#endif //LISP_VECTOR_H
@@ -0,0 +1,109 @@
+#include <stdlib.h>
+#include <string.h>
+#include "walk.h"
+#include "err.h"
+
+void* walk_push(struct WalkStack* stack, const void* item, size_t size) {
+  if (stack->count == stack->capacity) {
+    size_t capacity = stack->capacity == 0 ? 64 : stack->capacity * 2;
+    char* items = realloc(stack->items, size * capacity);
+
+    if (items == NULL) {
+      lisp_out_of_memory();
+      return NULL;
+    }
+
+    stack->items = items;
+    stack->capacity = capacity;
+  }
+
+  void* slot = stack->items + stack->count++ * size;
+  memcpy(slot, item, size);
+  return slot;
+}
+
+void walk_stack_free(struct WalkStack* stack) {
+  free(stack->items);
+  stack->items = NULL;
+  stack->count = 0;
+  stack->capacity = 0;
+}
+
+static size_t pointer_slot(const void* key, size_t capacity) {
+  // Fibonacci hashing, taking the high bits of the product since the low bits of a pointer are mostly alignment.
+  uint64_t h = (uint64_t) (uintptr_t) key * 0x9E3779B97F4A7C15u;
+  return (size_t) (h >> 32) & (capacity - 1);
+}
+
+static void grow(struct PointerMap* map) {
+  size_t capacity = map->capacity == 0 ? 64 : map->capacity * 2;
+  struct PointerMapEntry* entries = calloc(capacity, sizeof(struct PointerMapEntry));
+
+  if (entries == NULL) {
+    lisp_out_of_memory();
+    return;
+  }
+
+  for (size_t i = 0; i < map->capacity; ++i) {
+    if (map->entries[i].key != NULL) {
+      size_t slot = pointer_slot(map->entries[i].key, capacity);
+
+      while (entries[slot].key != NULL) {
+        slot = (slot + 1) & (capacity - 1);
+      }
+
+      entries[slot] = map->entries[i];
+    }
+  }
+
+  free(map->entries);
+  map->entries = entries;
+  map->capacity = capacity;
+}
+
+struct PointerMapEntry* pointer_map_find(struct PointerMap* map, const void* key) {
+  // Kept at most half full, so probes stay short.
+  if (2 * (map->count + 1) > map->capacity) {
+    grow(map);
+  }
+
+  size_t slot = pointer_slot(key, map->capacity);
+
+  while (map->entries[slot].key != NULL) {
+    if (map->entries[slot].key == key) {
+      return &map->entries[slot];
+    }
+
+    slot = (slot + 1) & (map->capacity - 1);
+  }
+
+  ++map->count;
+  map->entries[slot].key = key;
+  map->entries[slot].value = 0;
+  return &map->entries[slot];
+}
+
+uintptr_t pointer_map_get(const struct PointerMap* map, const void* key) {
+  if (map->count == 0) {
+    return 0;
+  }
+
+  size_t slot = pointer_slot(key, map->capacity);
+
+  while (map->entries[slot].key != NULL) {
+    if (map->entries[slot].key == key) {
+      return map->entries[slot].value;
+    }
+
+    slot = (slot + 1) & (map->capacity - 1);
+  }
+
+  return 0;
+}
+
+void pointer_map_free(struct PointerMap* map) {
+  free(map->entries);
+  map->entries = NULL;
+  map->count = 0;
+  map->capacity = 0;
+}
@@ -0,0 +1,65 @@
+#ifndef LISP_WALK_H
+#define LISP_WALK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Support for walking nested data with an explicit stack instead of recursion, so that the depth of a structure is
+ * limited by memory rather than by the C stack.
+ *
+ * Walks that could loop forever on a circular structure record where they have been in a `PointerMap`. The printer does
+ * so from the start unless cycle detection is turned off, so that a cycle is written as soon as it comes around. `equal?`,
+ * and the printer without cycle detection, start out trusting the data instead, and only begin recording once they have
+ * visited `LISP_WALK_FUEL` containers and list cells. Small values never pay for the bookkeeping, while a cycle is still
+ * caught one lap after the fuel runs out.
+ */
+
+/** Containers and list cells a walk visits before it starts watching for cycles. */
+#define LISP_WALK_FUEL 1024
+
+/** A growable stack of fixed size items, which starts out empty and unallocated. */
+struct WalkStack {
+  char* items;
+  size_t count;
+  size_t capacity;
+};
+
+/** Push a copy of an item of `size` bytes, and return a pointer to where it was stored. */
+void* walk_push(struct WalkStack* stack, const void* item, size_t size);
+
+/** The item on top of the stack. Must not be called on an empty stack. */
+static inline void* walk_top(const struct WalkStack* stack, size_t size) {
+  return stack->items + (stack->count - 1) * size;
+}
+
+static inline void walk_pop(struct WalkStack* stack) {
+  --stack->count;
+}
+
+void walk_stack_free(struct WalkStack* stack);
+
+struct PointerMapEntry {
+  const void* key;
+  uintptr_t value;
+};
+
+/** Open addressed hash map from pointers to integers, which starts out empty and unallocated. */
+struct PointerMap {
+  struct PointerMapEntry* entries;
+  size_t count;
+  size_t capacity;
+};
+
+/**
+ * Find the entry for a key, adding one with a value of 0 if there is none yet. The entry is only valid until the next
+ * call, which may move it.
+ */
+struct PointerMapEntry* pointer_map_find(struct PointerMap* map, const void* key);
+
+/** The value of a key, or 0 if it has none. */
+uintptr_t pointer_map_get(const struct PointerMap* map, const void* key);
+
+void pointer_map_free(struct PointerMap* map);
+
+#endif //LISP_WALK_H
@@ -43,6 +43,62 @@ impl From<Token> for ASTNode {
     }
 }
 
+/// Keywords naming the causes of runtime errors, which a `guard` may handle. Each matches a
+/// `Cause` in liblisp/err.h.
+pub const CONDITIONS: [&str; 5] = ["type", "argument", "zero-division", "math", "generic"];
+
+impl ASTNode {
+    /// Read the list of conditions handled by a `guard`. An empty list handles every condition.
+    fn conditions(tree: &ParseTree, line: u32) -> Result<Vec<String>, (u32, String)> {
+        let elems = match tree {
+            ParseTree::Branch(elems, _, _) => elems,
+            _ => return Err((line, String::from("`guard` expects a list of conditions to handle."))),
+        };
+
+        let mut causes = Vec::new();
+
+        for elem in elems {
+            match elem {
+                ParseTree::Leaf(Token {
+                    value: Keyword(k), ..
+                }) if CONDITIONS.contains(&&k[..]) => causes.push(k.clone()),
+                _ => {
+                    return Err((
+                        line,
+                        format!("Conditions must be one of :{}.", CONDITIONS.join(", :")),
+                    ))
+                }
+            }
+        }
+
+        Ok(causes)
+    }
+
+    /// Read the parameter list of a `lambda`, which must be distinct symbols.
+    fn parameters(tree: &ParseTree, line: u32) -> Result<Vec<String>, (u32, String)> {
+        let elems = match tree {
+            ParseTree::Branch(elems, _, _) => elems,
+            _ => return Err((line, String::from("`lambda` expects a list of parameters."))),
+        };
+
+        let mut params: Vec<String> = Vec::new();
+
+        for elem in elems {
+            match elem {
+                ParseTree::Leaf(Token {
+                    value: Symbol(p), ..
+                }) if !params.contains(p) => params.push(p.clone()),
+                ParseTree::Leaf(Token {
+                    value: Symbol(p), ..
+                }) => return Err((line, format!("Parameter `{}` appears more than once.", p))),
+                _ => return Err((line, String::from("Parameters must be symbols."))),
+            }
+        }
+
+        Ok(params)
+    }
+}
+
 impl TryFrom<&ParseTree> for ASTNode {
     type Error = (u32, String);
 
@@ -112,6 +168,67 @@ impl TryFrom<&ParseTree> for ASTNode {
                             _ => Err((*line, String::from("Invalid definition."))),
                         }
                     }
+                    ParseTree::Leaf(Token {
+                        line,
+                        value: Symbol(s),
+                    }) if &s[..] == "guard" || &s[..] == "with-handler" => {
+                        if elems.len() != 4 {
+                            return Err((
+                                *line,
+                                format!(
+                                    "Expected exactly 3 arguments in `{}` special form. Found {}.",
+                                    s,
+                                    elems.len() - 1
+                                ),
+                            ));
+                        }
+
+                        let (causes, binding) = if &s[..] == "guard" {
+                            (Self::conditions(&elems[1], *line)?, None)
+                        } else {
+                            match &elems[1] {
+                                ParseTree::Leaf(Token {
+                                    value: Symbol(name),
+                                    ..
+                                }) => (Vec::new(), Some(name.clone())),
+                                _ => {
+                                    return Err((
+                                        *line,
+                                        String::from("`with-handler` expects a symbol to bind the condition to."),
+                                    ))
+                                }
+                            }
+                        };
+
+                        let body = Self::try_from(&elems[2])?;
+                        let handler = Self::try_from(&elems[3])?;
+
+                        match (body, handler) {
+                            (ASTNode::Value(b), ASTNode::Value(h)) => Ok(ASTNode::Value(Value::Guard(causes, binding, Box::new(b), Box::new(h)))),
+                            _ => Err((*line, format!("Expected values for the body and handler of `{}`.", s)))
+                        }
+                    }
+                    ParseTree::Leaf(Token {
+                        line,
+                        value: Symbol(s),
+                    }) if &s[..] == "lambda" => {
+                        if elems.len() != 3 {
+                            return Err((
+                                *line,
+                                format!(
+                                    "Expected exactly 2 arguments in `lambda` special form. Found {}.",
+                                    elems.len() - 1
+                                ),
+                            ));
+                        }
+
+                        let params = Self::parameters(&elems[1], *line)?;
+
+                        match Self::try_from(&elems[2])? {
+                            ASTNode::Value(body) => Ok(ASTNode::Value(Lambda(params, vec![ASTNode::Value(body)]))),
+                            _ => Err((*line, String::from("Expected a value for the body of `lambda`."))),
+                        }
+                    }
                     ParseTree::Leaf(t) => match &t {
                         Token {
                             value: Symbol(_s),
@@ -148,13 +265,28 @@ impl TryFrom<&ParseTree> for ASTNode {
                             String::from("Symbols are the only literal value that may be invoked."),
                         )),
                     },
+                    // Anything evaluating to a procedure may be called, such as a lambda, or a call
+                    //  that returns one.
                     ParseTree::Branch(_elems, start, _stop) => {
-                        // TODO(matthew-c21): Later, it should be possible to invoke lambda special
-                        //  forms as well as functions that may return functions.
-                        Err((
-                            *start,
-                            String::from("Compound forms cannot be used as function calls."),
-                        ))
+                        let callee = match Self::try_from(&elems[0])? {
+                            ASTNode::Value(v) => v,
+                            _ => return Err((*start, String::from("Only values may be called."))),
+                        };
+
+                        let mut args = Vec::new();
+                        for subtree in &elems[1..] {
+                            match Self::try_from(subtree)? {
+                                ASTNode::Value(v) => args.push(v),
+                                _ => {
+                                    return Err((
+                                        *start,
+                                        String::from("All arguments in call should be values."),
+                                    ))
+                                }
+                            }
+                        }
+
+                        Ok(ASTNode::Value(Call(Box::new(callee), args)))
                     }
                 };
             }
@@ -172,6 +304,14 @@ pub enum Value {
 
     // condition, value if true, value if false
     Condition(Box<Value>, Box<Value>, Box<Value>),
+
+    // conditions handled (all of them if empty), variable bound to the condition, body, value if
+    // the body raises
+    Guard(Vec<String>, Option<String>, Box<Value>, Box<Value>),
+
+    // parameters, body. The body starts out as a single value, and takes the same form as the top
+    // level of a program once conditions are unrolled, ending in the value that is returned.
+    Lambda(Vec<String>, Vec<ASTNode>),
 }
 
 #[derive(Clone, Debug)]
@@ -181,6 +321,7 @@ pub enum Statement {
     Definition(String, Value),
     Declaration(String),
     ExpandedCondition(Value, Vec<ASTNode>, Vec<ASTNode>),
+    ExpandedGuard(Vec<String>, Option<String>, Vec<ASTNode>, Vec<ASTNode>),
 }
 
 pub trait ASTVisitor<T> {
@@ -192,7 +333,7 @@ pub trait ASTVisitor<T> {
 }
 
 #[derive(Copy, Clone)]
-struct Gensym {
+pub(crate) struct Gensym {
     counter: u64,
 }
 
@@ -214,7 +355,7 @@ impl Gensym {
     }
 
     /// Transform a non-C compliant symbol into a C compliant one.
-    fn convert(name: &str) -> String {
+    pub(crate) fn convert(name: &str) -> String {
         let mut output = String::new();
 
         if name.chars().nth(0).unwrap().is_digit(10) {
@@ -342,16 +483,11 @@ impl ASTVisitor<Vec<ASTNode>> for ConditionUnroll {
 
                 iftrue = self.try_visit(&ASTNode::Value(*t.clone()), sym_table)?;
                 iffalse = self.try_visit(&ASTNode::Value(*f.clone()), sym_table)?;
-                let condition;
 
-                match **c {
-                    Condition(_, _, _) => {
-                        let (value, mut prefix) = self.split_condition(c, sym_table);
-                        condition = Box::new(value);
-                        output.append(&mut prefix);
-                    }
-                    _ => condition = c.clone(),
-                }
+                // Whatever the condition contains has to be unrolled ahead of the test.
+                let (condition, mut prefix) = self.split_condition(c, sym_table);
+                let condition = Box::new(condition);
+                output.append(&mut prefix);
 
                 // Update each branch to assign to the output variable.
                 let true_value = iftrue.pop().unwrap();
@@ -369,14 +505,38 @@ impl ASTVisitor<Vec<ASTNode>> for ConditionUnroll {
 
                 Ok(output)
             }
-            // Handle the case of a condition used as a value for a definition.
-            ASTNode::Statement(Definition(name, Condition(c, t, f))) => {
-                let mut prefix = self.try_visit(
-                    &ASTNode::Value(Condition(c.clone(), t.clone(), f.clone())),
-                    sym_table,
-                )?;
+            // Guards expand the same way, with the body run under a handler instead of a test.
+            ASTNode::Value(Guard(causes, binding, body, handler)) => {
+                let output_name = sym_table.generate("guarded_value", Scope::Global);
+                output.push(ASTNode::Statement(Declaration(output_name.clone())));
+
+                let mut guarded = self.try_visit(&ASTNode::Value(*body.clone()), sym_table)?;
+                let mut handling = self.try_visit(&ASTNode::Value(*handler.clone()), sym_table)?;
+
+                let guarded_value = guarded.pop().unwrap();
+                let handled_value = handling.pop().unwrap();
+
+                guarded.push(ASTNode::Statement(Definition(output_name.clone(), guarded_value.as_value().to_owned())));
+                handling.push(ASTNode::Statement(Definition(output_name.clone(), handled_value.as_value().to_owned())));
+
+                output.push(ASTNode::Statement(ExpandedGuard(
+                    causes.clone(),
+                    binding.clone(),
+                    guarded,
+                    handling,
+                )));
+                output.push(ASTNode::Value(Literal(Token::from(Symbol(
+                    output_name.clone(),
+                )))));
+
+                Ok(output)
+            }
+            // Handle the case of a condition or guard within the value of a definition.
+            ASTNode::Statement(Definition(name, value)) => {
+                let mut prefix = self.try_visit(&ASTNode::Value(value.clone()), sym_table)?;
                 let value = prefix.pop().unwrap();
 
+                output.append(&mut prefix);
                 output.push(ASTNode::Statement(Definition(
                     name.clone(),
                     value.as_value().clone(),
@@ -386,6 +546,9 @@ impl ASTVisitor<Vec<ASTNode>> for ConditionUnroll {
             }
             // Handle the case of a condition inside a function call.
             ASTNode::Value(Call(callee, args)) => {
+                let (callee, mut prefix) = self.split_condition(callee, sym_table);
+                output.append(&mut prefix);
+
                 let mut new_args = Vec::new();
 
                 for arg in args {
@@ -401,10 +564,21 @@ impl ASTVisitor<Vec<ASTNode>> for ConditionUnroll {
 
                 let new_args: Vec<Value> = new_args.iter().map(|node| node.as_value().clone()).collect();
 
-                output.push(ASTNode::Value(Call(callee.clone(), new_args)));
+                output.push(ASTNode::Value(Call(Box::new(callee), new_args)));
 
                 return Ok(output)
             }
+            // The body of a lambda is unrolled in place, since it runs separately from whatever
+            //  surrounds it.
+            ASTNode::Value(Lambda(params, body)) => {
+                let mut unrolled = Vec::new();
+
+                for node in body {
+                    unrolled.append(&mut self.try_visit(node, sym_table)?);
+                }
+
+                Ok(vec![ASTNode::Value(Lambda(params.clone(), unrolled))])
+            }
             _ => Ok(vec![ast.clone()]),
         }
     }
@@ -450,7 +624,7 @@ pub enum Scope {
 }
 
 #[cfg(test)]
-mod test_utils {
+pub(crate) mod test_utils {
     use crate::ast::*;
     use crate::lex::start;
     use crate::parse::parse;
@@ -648,6 +822,106 @@ mod ast_tests {
     #[test]
     fn from_malformed_condition() {}
 
+    #[test]
+    fn from_guard() {
+        let ast = force_from("(guard (:type :math) (car 1) nil) (with-handler e (car 1) e) (guard () 1 2)");
+        assert_eq!(3, ast.len());
+
+        if let ASTNode::Value(Guard(causes, binding, body, _)) = &ast[0] {
+            assert_eq!(vec!["type".to_string(), "math".to_string()], *causes);
+            assert!(binding.is_none());
+            assert!(matches!(body.as_ref(), Call(_, _)));
+        } else {
+            panic!()
+        }
+
+        if let ASTNode::Value(Guard(causes, Some(binding), _, _)) = &ast[1] {
+            assert!(causes.is_empty());
+            assert_eq!("e", binding);
+        } else {
+            panic!()
+        }
+
+        assert!(matches!(&ast[2], ASTNode::Value(Guard(causes, None, _, _)) if causes.is_empty()));
+    }
+
+    #[test]
+    fn from_malformed_guard() {
+        assert!(from_line("(guard (:nonsense) 1 2)").is_err());
+        assert!(from_line("(guard :type 1 2)").is_err());
+        assert!(from_line("(guard (:type) 1)").is_err());
+        assert!(from_line("(with-handler 1 2 3)").is_err());
+        assert!(from_line("(with-handler (e) 2 3)").is_err());
+    }
+
+    #[test]
+    fn guard_unroll() {
+        let mut sym_table = SymbolTable::dummy();
+        let unrolled = ConditionUnroll.visit(&from_line("(define x (guard () 1 2))").unwrap(), &mut sym_table);
+
+        assert_eq!(3, unrolled.len());
+        assert!(matches!(&unrolled[0], ASTNode::Statement(Declaration(_))));
+
+        if let ASTNode::Statement(ExpandedGuard(_, _, body, handler)) = &unrolled[1] {
+            assert!(matches!(body.last(), Some(ASTNode::Statement(Definition(_, _)))));
+            assert!(matches!(handler.last(), Some(ASTNode::Statement(Definition(_, _)))));
+        } else {
+            panic!()
+        }
+
+        assert!(matches!(&unrolled[2], ASTNode::Statement(Definition(name, _)) if name == "x"));
+    }
+
+    #[test]
+    fn from_lambda() {
+        let ast = force_from("(lambda (x y) (+ x y)) (lambda () 1) ((lambda (x) x) 2)");
+        assert_eq!(3, ast.len());
+
+        if let ASTNode::Value(Lambda(params, body)) = &ast[0] {
+            assert_eq!(vec!["x".to_string(), "y".to_string()], *params);
+            assert!(matches!(body.as_slice(), [ASTNode::Value(Call(_, _))]));
+        } else {
+            panic!()
+        }
+
+        assert!(matches!(&ast[1], ASTNode::Value(Lambda(params, _)) if params.is_empty()));
+
+        if let ASTNode::Value(Call(callee, args)) = &ast[2] {
+            assert!(matches!(callee.as_ref(), Lambda(_, _)));
+            assert_eq!(1, args.len());
+        } else {
+            panic!()
+        }
+    }
+
+    #[test]
+    fn from_malformed_lambda() {
+        assert!(from_line("(lambda x x)").is_err());
+        assert!(from_line("(lambda (x 1) x)").is_err());
+        assert!(from_line("(lambda (x x) x)").is_err());
+        assert!(from_line("(lambda (x))").is_err());
+        assert!(from_line("(lambda (x) (define y x))").is_err());
+    }
+
+    #[test]
+    fn lambda_unroll() {
+        let mut sym_table = SymbolTable::dummy();
+        let unrolled = ConditionUnroll.visit(
+            &from_line("(define f (lambda (x) (if x (+ 1 (if x 2 3)) 4)))").unwrap(),
+            &mut sym_table,
+        );
+
+        // The condition stays within the body, rather than moving ahead of the definition.
+        assert_eq!(1, unrolled.len());
+
+        if let ASTNode::Statement(Definition(_, Lambda(_, body))) = &unrolled[0] {
+            assert!(matches!(body.first(), Some(ASTNode::Statement(Declaration(_)))));
+            assert!(matches!(body.last(), Some(ASTNode::Value(Literal(_)))));
+        } else {
+            panic!()
+        }
+    }
+
     #[test]
     // TODO(matthew-c21): After adding all the relevant listeners, replace this with something else.
     fn basic_comprehensive() {}
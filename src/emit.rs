@@ -0,0 +1,1662 @@
+use crate::ast::Statement::*;
+use crate::ast::Value::*;
+use crate::ast::{ASTNode, Gensym, Value};
+use crate::lex::{Token, TokenValue::*};
+use std::cell::{Cell, RefCell};
+use std::collections::{BTreeSet, HashMap, HashSet};
+
+/// Must match `LISP_SMALL_INT_MIN` and `LISP_SMALL_INT_MAX` in liblisp/data.h. Integer literals in
+/// this range are shared by the runtime, and never need to be released.
+const SMALL_INT_MIN: i32 = -256;
+const SMALL_INT_MAX: i32 = 767;
+
+/// Variable holding the value a function returns, which is never released by the function.
+const RESULT: &str = "_result";
+
+/// What a native requires of its arguments before the unchecked flavor of the runtime may skip
+/// validating them, and which direct entry points it has, read from the `signatures` section of
+/// natives.json. Types are `any`,
+/// `number`, `integer`, `string`, `keyword`, `boolean`, `list` (either a `pair` or `nil`),
+/// `vector`, `hash-map`, `array` and `procedure`.
+pub struct Signature {
+    /// Types of the required arguments.
+    pub args: Vec<String>,
+
+    /// Types of the arguments that may follow the required ones.
+    pub optional: Vec<String>,
+
+    /// Type of any number of further arguments, if the native takes them.
+    pub rest: Option<String>,
+
+    pub returns: String,
+
+    /// Numbers of arguments for which the native has a direct entry point, named after the C
+    /// function and the arity, e.g. `car1(x)`. These are called instead of the variadic form.
+    pub direct: Vec<usize>,
+}
+
+/// Generates a C program from an AST that has already been through the condition unrolling and
+/// function unfurling passes.
+///
+/// The runtime is reference counted. Every native borrows its arguments and returns a new
+/// reference, so the emitter hoists each intermediate value into a temporary that is released
+/// once the statement using it completes, and releases each variable after the last statement
+/// that refers to it.
+///
+/// When the runtime is instead built around the tracing collector, the reference counting
+/// operations compile to nothing, and the roots and safepoints described below take over.
+///
+/// Alongside the code, the emitter tracks the type of each value as far as it is known at compile
+/// time. If every call to a native is proven to match its signature, the program defines
+/// `LISP_UNCHECKED`, which selects the flavor of the runtime that skips validating arguments.
+///
+/// Guards run their body under a handler (see `LispHandler` in liblisp/err.h), which a raise
+/// unwinds to directly. Temporaries and branch local variables of the interrupted code are never
+/// released in that case, which is the price of keeping the path that doesn't raise free of checks.
+/// The variable a guard assigns its result to is declared `volatile`, as it is read after the jump.
+///
+/// Lambdas are closure converted. A function defined at the top level that is only ever called by
+/// name is lifted into a plain C function, which is passed the variables it uses as extra
+/// arguments, so calling it allocates nothing. Any other lambda becomes a closure (see
+/// liblisp/closure.h), whose code reads the values it captured out of a flat environment. Top
+/// level variables that a lambda uses are neither passed nor captured: they are declared at file
+/// scope instead, so every function reads their current value.
+///
+/// For the tracing collector, safepoints come between top level statements and at the start of
+/// every function, so that a loop written as recursion still lets the collector run. Every
+/// variable and parameter is rooted while it is in scope, as are the temporaries of any statement
+/// that may call a function. Temporaries of statements that only call natives are never live
+/// across a safepoint, so they are left unrooted.
+pub struct CEmitter {
+    /// Maps LISP function names to the C function implementing them.
+    natives: HashMap<String, String>,
+
+    /// Maps LISP symbols to C expressions producing their (constant) value, e.g. `nil`.
+    variables: HashMap<String, String>,
+
+    /// Used to name hoisted temporaries.
+    temporaries: Cell<u64>,
+
+    /// Labels of every symbol literal, in the order they were first encountered. These are all
+    /// interned in a single batch when the program starts, and then referred to by index.
+    symbols: RefCell<Vec<String>>,
+
+    /// Maps LISP function names to what they expect of their arguments.
+    signatures: HashMap<String, Signature>,
+
+    /// Type of each variable, by C name, as far as it is known at compile time.
+    types: RefCell<HashMap<String, String>>,
+
+    /// Whether every call emitted so far was proven to match the signature of its native.
+    proven: Cell<bool>,
+
+    /// Maps the LISP names of lifted functions to the C names of the variables passed to them as
+    /// extra arguments.
+    lifted: RefCell<HashMap<String, Vec<String>>>,
+
+    /// Every name the program binds, by LISP name. Calling anything else is an error.
+    bound: RefCell<HashSet<String>>,
+
+    /// Definitions of the C functions generated for lambdas, each preceding any that refer to it.
+    functions: RefCell<String>,
+
+    /// C names of the natives used as values, which need a wrapper to serve as closure code.
+    wrapped: RefCell<BTreeSet<String>>,
+
+    /// Whether code is being emitted for the body of a function rather than for `main`.
+    in_function: Cell<bool>,
+
+    /// C names of the variables defined at the top level of the program.
+    globals: RefCell<HashSet<String>>,
+
+    /// The globals that some lambda uses. These are declared at file scope, and kept alive until
+    /// the end of the program.
+    shared: RefCell<BTreeSet<String>>,
+
+    /// C names bound by the functions being emitted, which hide any global of the same name.
+    scope: RefCell<HashSet<String>>,
+
+    /// C names of the variables that the body of a guard assigns to and that outlive the guard.
+    /// These are declared `volatile`, since their value has to survive a jump to the handler.
+    volatiles: RefCell<HashSet<String>>,
+}
+
+impl CEmitter {
+    pub fn new(natives: HashMap<String, String>, variables: HashMap<String, String>) -> Self {
+        CEmitter {
+            natives,
+            variables,
+            temporaries: Cell::new(0),
+            symbols: RefCell::new(Vec::new()),
+            signatures: HashMap::new(),
+            types: RefCell::new(HashMap::new()),
+            proven: Cell::new(true),
+            lifted: RefCell::new(HashMap::new()),
+            bound: RefCell::new(HashSet::new()),
+            functions: RefCell::new(String::new()),
+            wrapped: RefCell::new(BTreeSet::new()),
+            in_function: Cell::new(false),
+            globals: RefCell::new(HashSet::new()),
+            shared: RefCell::new(BTreeSet::new()),
+            scope: RefCell::new(HashSet::new()),
+            volatiles: RefCell::new(HashSet::new()),
+        }
+    }
+
+    /// Without signatures, no call is ever proven valid, and programs use the checked runtime.
+    pub fn with_signatures(mut self, signatures: HashMap<String, Signature>) -> Self {
+        self.signatures = signatures;
+        self
+    }
+
+    pub fn emit_program(&self, ast: &Vec<ASTNode>) -> Result<String, (u32, String)> {
+        for node in ast {
+            bound_names(node, true, &mut self.bound.borrow_mut());
+        }
+
+        self.globals.replace(global_names(ast));
+        let prototypes = self.lift_functions(ast)?;
+
+        // Find every global a lambda uses before emitting any of main, since those are stored
+        //  differently.
+        let mut names = HashSet::new();
+        for node in ast {
+            self.node_references(node, &mut names);
+        }
+
+        let mut body = String::new();
+        let mut declared = HashSet::new();
+        let rooted = self.emit_block(ast, &mut declared, 1, &mut body)?;
+
+        let mut program = String::new();
+        if self.proven.get() && !self.signatures.is_empty() {
+            program.push_str("#define LISP_UNCHECKED\n");
+        }
+        program.push_str("#include <math.h>\n#include \"lisp.h\"\n#include \"err.h\"\n\n");
+
+        // Symbols are declared outside of main, since functions refer to them as well.
+        let symbols = self.symbols.borrow();
+        if !symbols.is_empty() {
+            let labels: Vec<String> = symbols.iter().map(|s| format!("{:?}", s)).collect();
+
+            program.push_str(&format!(
+                "static const char* const _symbol_labels[] = {{{}}};\n",
+                labels.join(", ")
+            ));
+            program.push_str(&format!("static struct LispDatum* _symbols[{}];\n\n", symbols.len()));
+        }
+
+        let shared = self.shared.borrow();
+        for name in shared.iter() {
+            program.push_str(&format!("static struct LispDatum* {};\n", name));
+        }
+        if !shared.is_empty() {
+            program.push('\n');
+        }
+
+        program.push_str(&prototypes);
+        for c_name in self.wrapped.borrow().iter() {
+            program.push_str(&format!(
+                "static struct LispDatum* _native_{0}(struct LispDatum* _self, struct LispDatum** _args, uint32_t _nargs) {{\n  (void) _self;\n  return {0}(_args, _nargs);\n}}\n\n",
+                c_name
+            ));
+        }
+        program.push_str(&self.functions.borrow());
+
+        program.push_str("int main() {\n  set_global_error_behavior(LogAndQuit);\n\n");
+        if !symbols.is_empty() {
+            program.push_str(&format!(
+                "  intern_all(_symbols, _symbol_labels, {});\n\n",
+                symbols.len()
+            ));
+        }
+        program.push_str(&body);
+        program.push_str(&format!(
+            "\n  gc_pop_roots({});\n  flush_releases();\n  lisp_flush_output();\n  return 0;\n}}\n",
+            rooted
+        ));
+
+        Ok(program)
+    }
+
+    /// Find the functions defined at the top level that are only ever called by name, with the
+    /// right number of arguments, and emit each of them as a plain C function. Returns their
+    /// prototypes, since they may call each other in any order.
+    fn lift_functions(&self, ast: &[ASTNode]) -> Result<String, (u32, String)> {
+        let mut definitions: HashMap<&String, usize> = HashMap::new();
+        for node in ast {
+            if let ASTNode::Statement(Definition(name, _)) = node {
+                *definitions.entry(name).or_insert(0) += 1;
+            }
+        }
+
+        let mut arities = HashMap::new();
+        for node in ast {
+            if let ASTNode::Statement(Definition(name, Lambda(params, _))) = node {
+                if definitions[name] == 1 {
+                    arities.insert(name.clone(), params.len());
+                }
+            }
+        }
+
+        remove_escaping(ast, &mut arities);
+
+        for name in arities.keys() {
+            self.lifted.borrow_mut().insert(name.clone(), Vec::new());
+        }
+
+        // A function is passed whatever the functions it calls are passed, so keep widening the
+        //  extra arguments until they settle.
+        let mut changed = true;
+        while changed {
+            changed = false;
+
+            for node in ast {
+                if let ASTNode::Statement(Definition(name, Lambda(params, body))) = node {
+                    if !arities.contains_key(name) {
+                        continue;
+                    }
+
+                    let extra: Vec<String> = self.free_variables(params, body).into_iter().collect();
+                    if extra != self.lifted.borrow()[name] {
+                        self.lifted.borrow_mut().insert(name.clone(), extra);
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        let mut prototypes = String::new();
+        for node in ast {
+            if let ASTNode::Statement(Definition(name, Lambda(params, body))) = node {
+                if arities.contains_key(name) {
+                    let extra = self.lifted.borrow()[name].clone();
+                    let function = format!("_lifted_{}", Gensym::convert(name));
+                    prototypes.push_str(&format!("{};\n", self.lift(&function, params, &extra, body)?));
+                }
+            }
+        }
+
+        if !prototypes.is_empty() {
+            prototypes.push('\n');
+        }
+
+        Ok(prototypes)
+    }
+
+    /// Emit a lambda as a plain C function taking its parameters followed by `extra`, and return
+    /// its signature.
+    fn lift(
+        &self,
+        function: &str,
+        params: &[String],
+        extra: &[String],
+        body: &[ASTNode],
+    ) -> Result<String, (u32, String)> {
+        let c_params: Vec<String> = params
+            .iter()
+            .map(|p| Gensym::convert(p))
+            .chain(extra.iter().cloned())
+            .collect();
+
+        let signature = if c_params.is_empty() {
+            format!("static struct LispDatum* {}(void)", function)
+        } else {
+            let declarations: Vec<String> =
+                c_params.iter().map(|p| format!("struct LispDatum* {}", p)).collect();
+            format!("static struct LispDatum* {}({})", function, declarations.join(", "))
+        };
+
+        let mut used = HashSet::new();
+        for node in body {
+            self.node_references(node, &mut used);
+        }
+
+        let mut prelude = String::new();
+        for p in c_params.iter().filter(|p| !used.contains(*p)) {
+            prelude.push_str(&format!("  (void) {};\n", p));
+        }
+
+        let roots: Vec<String> = c_params.iter().filter(|p| used.contains(*p)).cloned().collect();
+        self.emit_function(&signature, prelude, c_params.into_iter().collect(), &roots, body)?;
+        Ok(signature)
+    }
+
+    /// Emit the code of a closure for a lambda, and return an expression creating the closure.
+    /// Inside of a lambda bound to `own_name`, that name refers to the closure itself rather than
+    /// to a captured value.
+    fn closure(
+        &self,
+        params: &[String],
+        body: &[ASTNode],
+        own_name: Option<&str>,
+    ) -> Result<String, (u32, String)> {
+        let n = self.temporaries.get() + 1;
+        self.temporaries.set(n);
+        let function = format!("_lambda{}", n);
+
+        let mut captured = self.free_variables(params, body);
+        let own_name = own_name.map(Gensym::convert);
+        let recursive = own_name.as_ref().map_or(false, |name| captured.remove(name));
+        let captured: Vec<String> = captured.into_iter().collect();
+
+        let mut used = HashSet::new();
+        for node in body {
+            self.node_references(node, &mut used);
+        }
+
+        let mut prelude = String::new();
+        let mut bound = HashSet::new();
+        let mut roots = Vec::new();
+
+        for (i, p) in params.iter().map(|p| Gensym::convert(p)).enumerate() {
+            if used.contains(&p) {
+                prelude.push_str(&format!("  struct LispDatum* {} = _args[{}];\n", p, i));
+                roots.push(p.clone());
+            }
+            bound.insert(p);
+        }
+        for (i, c) in captured.iter().enumerate() {
+            prelude.push_str(&format!("  struct LispDatum* {} = closure_captured(_self, {});\n", c, i));
+            roots.push(c.clone());
+            bound.insert(c.clone());
+        }
+        if let (true, Some(name)) = (recursive, &own_name) {
+            prelude.push_str(&format!("  struct LispDatum* {} = _self;\n", name));
+            roots.push(name.clone());
+            bound.insert(name.clone());
+        }
+
+        if captured.is_empty() && !recursive {
+            prelude.push_str("  (void) _self;\n");
+        }
+        if !params.iter().any(|p| used.contains(&Gensym::convert(p))) {
+            prelude.push_str("  (void) _args;\n");
+        }
+        prelude.push_str("  (void) _nargs;\n");
+
+        let signature = format!(
+            "static struct LispDatum* {}(struct LispDatum* _self, struct LispDatum** _args, uint32_t _nargs)",
+            function
+        );
+        self.emit_function(&signature, prelude, bound, &roots, body)?;
+
+        if captured.is_empty() {
+            return Ok(format!("new_closure({}, {}, NULL, 0)", function, params.len()));
+        }
+
+        Ok(format!(
+            "new_closure({}, {}, (struct LispDatum*[]){{{}}}, {})",
+            function,
+            params.len(),
+            captured.join(", "),
+            captured.len()
+        ))
+    }
+
+    /// Emit a C function whose body evaluates a lambda and returns the result. Whatever is in
+    /// `bound` is borrowed from the caller, so only what the body defines itself is released.
+    /// `roots` are the variables declared by the prelude or signature that the body uses.
+    fn emit_function(
+        &self,
+        signature: &str,
+        prelude: String,
+        mut bound: HashSet<String>,
+        roots: &[String],
+        body: &[ASTNode],
+    ) -> Result<(), (u32, String)> {
+        let mut nodes = body.to_vec();
+        match nodes.pop() {
+            Some(ASTNode::Value(v)) => nodes.push(ASTNode::Statement(Definition(RESULT.to_string(), v))),
+            _ => return Err((0, String::from("Lambdas must end in a value."))),
+        }
+
+        // Nothing is known about the parameters, so types are tracked separately in each function.
+        let types = self.types.replace(HashMap::new());
+        let in_function = self.in_function.replace(true);
+
+        let mut names = HashSet::new();
+        for node in &nodes {
+            bound_names(node, false, &mut names);
+        }
+
+        let mut inner = self.scope.borrow().clone();
+        inner.extend(bound.iter().cloned());
+        inner.extend(names.iter().map(|name| Gensym::convert(name)));
+        let scope = self.scope.replace(inner);
+
+        let mut code = format!("{} {{\n{}", signature, prelude);
+        for name in roots {
+            code.push_str(&format!("  gc_push_root(&{});\n", name));
+        }
+        code.push_str("  gc_safepoint();\n");
+
+        let result = self.emit_block(&nodes, &mut bound, 1, &mut code);
+
+        self.types.replace(types);
+        self.in_function.set(in_function);
+        self.scope.replace(scope);
+
+        let rooted = roots.len() + result?;
+        if rooted > 0 {
+            code.push_str(&format!("  gc_pop_roots({});\n", rooted));
+        }
+        code.push_str(&format!("  return {};\n}}\n\n", RESULT));
+        self.functions.borrow_mut().push_str(&code);
+        Ok(())
+    }
+
+    /// The C names of the variables a lambda uses from where it is defined, in a stable order.
+    /// Globals are read where they are rather than passed along, so they are only recorded as
+    /// shared.
+    fn free_variables(&self, params: &[String], body: &[ASTNode]) -> BTreeSet<String> {
+        let mut names = HashSet::new();
+        let mut local = HashSet::new();
+
+        for node in body {
+            self.node_references(node, &mut names);
+            bound_names(node, false, &mut local);
+        }
+
+        let local: HashSet<String> = local
+            .iter()
+            .chain(params.iter())
+            .map(|name| Gensym::convert(name))
+            .collect();
+
+        let globals = self.globals.borrow();
+        let scope = self.scope.borrow();
+        let mut free = BTreeSet::new();
+
+        for name in names.into_iter().filter(|name| !local.contains(name)) {
+            if globals.contains(&name) && !scope.contains(&name) {
+                self.shared.borrow_mut().insert(name);
+            } else {
+                free.insert(name);
+            }
+        }
+
+        free
+    }
+
+    /// Emit a sequence of nodes sharing a scope. Variables introduced by the block are released
+    /// directly after the last node in the block that refers to them, except for shared globals,
+    /// which are released at the very end. They stay rooted until the end of the block, which
+    /// pops them, except for the outermost block of a function or of main. That is left to the
+    /// caller, and the number of roots left pushed is returned instead.
+    fn emit_block(
+        &self,
+        nodes: &[ASTNode],
+        declared: &mut HashSet<String>,
+        indent: usize,
+        out: &mut String,
+    ) -> Result<usize, (u32, String)> {
+        let pad = "  ".repeat(indent);
+        let top_level = indent == 1 && !self.in_function.get();
+        let mut last_use: HashMap<String, usize> = HashMap::new();
+
+        for (i, node) in nodes.iter().enumerate() {
+            let mut names = HashSet::new();
+            self.node_references(node, &mut names);
+
+            for name in names {
+                last_use.insert(name, i);
+            }
+        }
+
+        // Guards assign their result to a variable declared just ahead of them.
+        for node in nodes {
+            if let ASTNode::Statement(ExpandedGuard(_, _, body, _)) = node {
+                for n in body {
+                    if let ASTNode::Statement(Definition(name, _)) = n {
+                        self.volatiles.borrow_mut().insert(Gensym::convert(name));
+                    }
+                }
+            }
+        }
+
+        let mut owned: Vec<String> = Vec::new();
+        let mut rooted = 0;
+
+        for (i, node) in nodes.iter().enumerate() {
+            let previously_owned = owned.len();
+            self.emit_node(node, declared, &mut owned, indent, out)?;
+
+            // Nothing follows the result of a function, so it never needs to be rooted.
+            for name in owned[previously_owned..].iter().filter(|name| *name != RESULT) {
+                if self.volatiles.borrow().contains(name) {
+                    out.push_str(&format!("{}gc_push_root((struct LispDatum**) &{});\n", pad, name));
+                } else {
+                    out.push_str(&format!("{}gc_push_root(&{});\n", pad, name));
+                }
+                rooted += 1;
+            }
+
+            owned.retain(|name| {
+                if name == RESULT || (top_level && self.shared.borrow().contains(name)) {
+                    true
+                } else if last_use.get(name).map_or(true, |&j| j <= i) {
+                    out.push_str(&format!("{}release({});\n", pad, name));
+
+                    // The variable stays rooted, so make sure it no longer keeps its value alive.
+                    if top_level {
+                        out.push_str(&format!("{}{} = NULL;\n", pad, name));
+                    }
+                    false
+                } else {
+                    true
+                }
+            });
+
+            if top_level {
+                out.push_str(&format!("{}gc_safepoint();\n", pad));
+            }
+        }
+
+        if top_level {
+            for name in &owned {
+                out.push_str(&format!("{}release({});\n", pad, name));
+            }
+        }
+
+        if indent == 1 {
+            return Ok(rooted);
+        } else if rooted > 0 {
+            out.push_str(&format!("{}gc_pop_roots({});\n", pad, rooted));
+        }
+
+        Ok(0)
+    }
+
+    fn emit_node(
+        &self,
+        node: &ASTNode,
+        declared: &mut HashSet<String>,
+        owned: &mut Vec<String>,
+        indent: usize,
+        out: &mut String,
+    ) -> Result<(), (u32, String)> {
+        let pad = "  ".repeat(indent);
+        let mut temps: Vec<(String, String)> = Vec::new();
+        let mut statement = String::new();
+
+        match node {
+            // Lifted functions were already emitted on their own.
+            ASTNode::Statement(Definition(name, Lambda(_, _))) if self.lifted.borrow().contains_key(name) => {}
+            ASTNode::Statement(Definition(name, value)) => {
+                let c_name = Gensym::convert(name);
+                let expr = match value {
+                    Lambda(params, body) => self.closure(params, body, Some(name))?,
+                    _ => self.owned_expression(value, &mut temps)?,
+                };
+                self.assign_type(&c_name, self.static_type(value));
+
+                // Definitions made inside a branch of an expanded condition assign to a variable
+                //  that was declared ahead of the condition.
+                if declared.contains(&c_name) {
+                    statement.push_str(&format!(
+                        "{}{} = reassign({}, {});\n",
+                        pad, c_name, c_name, expr
+                    ));
+                } else if self.is_shared(&c_name) {
+                    statement.push_str(&format!("{}{} = {};\n", pad, c_name, expr));
+                    declared.insert(c_name.clone());
+                    owned.push(c_name);
+                } else {
+                    statement.push_str(&format!(
+                        "{}struct LispDatum* {} = {};\n",
+                        pad, c_name, expr
+                    ));
+                    declared.insert(c_name.clone());
+                    owned.push(c_name);
+                }
+            }
+            ASTNode::Statement(Declaration(name)) => {
+                let c_name = Gensym::convert(name);
+
+                if !declared.contains(&c_name) {
+                    // Shared globals start out NULL at file scope.
+                    if self.volatiles.borrow().contains(&c_name) {
+                        statement.push_str(&format!("{}struct LispDatum* volatile {} = NULL;\n", pad, c_name));
+                    } else if !self.is_shared(&c_name) {
+                        statement.push_str(&format!("{}struct LispDatum* {} = NULL;\n", pad, c_name));
+                    }
+                    declared.insert(c_name.clone());
+                    owned.push(c_name);
+                }
+            }
+            ASTNode::Statement(ExpandedCondition(condition, if_true, if_false)) => {
+                let condition = self.expression(condition, &mut temps)?;
+                statement.push_str(&format!("{}if (truthy({})) {{\n", pad, condition));
+
+                // Each branch is its own C block, so anything newly defined inside of it stays there.
+                self.emit_block(if_true, &mut declared.clone(), indent + 1, &mut statement)?;
+                statement.push_str(&format!("{}}} else {{\n", pad));
+                self.emit_block(if_false, &mut declared.clone(), indent + 1, &mut statement)?;
+                statement.push_str(&format!("{}}}\n", pad));
+            }
+            ASTNode::Statement(ExpandedGuard(causes, binding, body, handler)) => {
+                let n = self.temporaries.get() + 1;
+                self.temporaries.set(n);
+                let h = format!("_handler{}", n);
+
+                let mask = if causes.is_empty() {
+                    String::from("LISP_ANY_CAUSE")
+                } else {
+                    let masks: Vec<String> = causes
+                        .iter()
+                        .map(|c| format!("LISP_CAUSE_MASK({})", self.cause(c)))
+                        .collect();
+                    masks.join(" | ")
+                };
+
+                statement.push_str(&format!("{}struct LispHandler {};\n", pad, h));
+                statement.push_str(&format!("{}lisp_push_handler(&{}, {});\n", pad, h, mask));
+                statement.push_str(&format!("{}if (setjmp({}.jump) == 0) {{\n", pad, h));
+                self.emit_block(body, &mut declared.clone(), indent + 1, &mut statement)?;
+                statement.push_str(&format!("{}  lisp_pop_handler(&{});\n", pad, h));
+                statement.push_str(&format!("{}}} else {{\n", pad));
+
+                let mut handler_declared = declared.clone();
+
+                // Condition keywords are interned, so the binding never needs to be released.
+                if let Some(name) = binding {
+                    let c_name = Gensym::convert(name);
+                    statement.push_str(&format!(
+                        "{}  struct LispDatum* {} = condition_keyword({}.cause);\n",
+                        pad, c_name, h
+                    ));
+                    self.assign_type(&c_name, String::from("keyword"));
+                    handler_declared.insert(c_name);
+                }
+
+                self.emit_block(handler, &mut handler_declared, indent + 1, &mut statement)?;
+                statement.push_str(&format!("{}}}\n", pad));
+            }
+            ASTNode::Value(Literal(t)) if !self.allocates(t) => {
+                statement.push_str(&format!("{}(void) {};\n", pad, self.literal(t)?));
+            }
+            ASTNode::Value(v) => {
+                let expr = self.owned_expression(v, &mut temps)?;
+                statement.push_str(&format!("{}release({});\n", pad, expr));
+            }
+        }
+
+        // A temporary may still be needed after a later one calls a function, which may collect.
+        let rooted = !temps.is_empty() && self.may_collect(node);
+
+        for (name, init) in &temps {
+            out.push_str(&format!("{}struct LispDatum* {} = {};\n", pad, name, init));
+
+            if rooted {
+                out.push_str(&format!("{}gc_push_root(&{});\n", pad, name));
+            }
+        }
+
+        out.push_str(&statement);
+
+        for (name, _) in &temps {
+            out.push_str(&format!("{}release_deferred({});\n", pad, name));
+        }
+
+        if rooted {
+            out.push_str(&format!("{}gc_pop_roots({});\n", pad, temps.len()));
+        }
+
+        Ok(())
+    }
+
+    /// Produce an expression for a value that is only borrowed, such as a function argument. Any
+    /// intermediate that would need to be released afterwards is hoisted into a temporary.
+    fn expression(
+        &self,
+        value: &Value,
+        temps: &mut Vec<(String, String)>,
+    ) -> Result<String, (u32, String)> {
+        match value {
+            Literal(t) if self.allocates(t) => {
+                let init = self.literal(t)?;
+                Ok(self.hoist(init, temps))
+            }
+            Literal(t) => self.literal(t),
+            Call(callee, args) => {
+                let init = self.call(callee, args, temps)?;
+                Ok(self.hoist(init, temps))
+            }
+            Lambda(params, body) => {
+                let init = self.closure(params, body, None)?;
+                Ok(self.hoist(init, temps))
+            }
+            Condition(_, _, _) | Guard(_, _, _, _) => Err((
+                0,
+                String::from("Conditions must be unrolled before generating code."),
+            )),
+        }
+    }
+
+    /// Produce an expression evaluating to a new reference, suitable for storing in a variable.
+    fn owned_expression(
+        &self,
+        value: &Value,
+        temps: &mut Vec<(String, String)>,
+    ) -> Result<String, (u32, String)> {
+        match value {
+            Literal(
+                t @ Token {
+                    value: Symbol(s), ..
+                },
+            ) if !self.natives.contains_key(s) => Ok(format!("retain({})", self.literal(t)?)),
+            Literal(t) => self.literal(t),
+            Call(callee, args) => self.call(callee, args, temps),
+            Lambda(params, body) => self.closure(params, body, None),
+            Condition(_, _, _) | Guard(_, _, _, _) => Err((
+                0,
+                String::from("Conditions must be unrolled before generating code."),
+            )),
+        }
+    }
+
+    fn call(
+        &self,
+        callee: &Value,
+        args: &Vec<Value>,
+        temps: &mut Vec<(String, String)>,
+    ) -> Result<String, (u32, String)> {
+        match callee {
+            Literal(Token {
+                value: Symbol(s), ..
+            }) if self.natives.contains_key(s) => return self.native_call(s, args, temps),
+            Literal(Token {
+                line,
+                value: Symbol(s),
+            }) if !self.bound.borrow().contains(s) => {
+                return Err((*line, format!("Unknown function `{}`.", s)))
+            }
+            Literal(Token {
+                value: Symbol(s), ..
+            }) if self.lifted.borrow().contains_key(s) => {
+                let mut c_args = Vec::new();
+                for arg in args {
+                    c_args.push(self.expression(arg, temps)?);
+                }
+                c_args.extend(self.lifted.borrow()[s].iter().cloned());
+
+                return Ok(format!("_lifted_{}({})", Gensym::convert(s), c_args.join(", ")));
+            }
+            // A lambda applied on the spot is lifted as well.
+            Lambda(params, body) if params.len() == args.len() => {
+                let n = self.temporaries.get() + 1;
+                self.temporaries.set(n);
+                let function = format!("_lifted{}", n);
+                let extra: Vec<String> = self.free_variables(params, body).into_iter().collect();
+                self.lift(&function, params, &extra, body)?;
+
+                let mut c_args = Vec::new();
+                for arg in args {
+                    c_args.push(self.expression(arg, temps)?);
+                }
+                c_args.extend(extra);
+
+                return Ok(format!("{}({})", function, c_args.join(", ")));
+            }
+            _ => {}
+        }
+
+        // Closures made from lambdas check their own arguments, so the call is only in question if
+        //  the callee may not be a procedure at all. Wrapped natives never get that far, since
+        //  using one as a value already rules out the unchecked runtime.
+        if self.static_type(callee) != "procedure" {
+            self.proven.set(false);
+        }
+
+        let f = self.expression(callee, temps)?;
+
+        if args.is_empty() {
+            return Ok(format!("call_closure({}, NULL, 0)", f));
+        }
+
+        let mut c_args = Vec::new();
+        for arg in args {
+            c_args.push(self.expression(arg, temps)?);
+        }
+
+        Ok(format!(
+            "call_closure({}, (struct LispDatum*[]){{{}}}, {})",
+            f,
+            c_args.join(", "),
+            c_args.len()
+        ))
+    }
+
+    fn native_call(
+        &self,
+        name: &str,
+        args: &Vec<Value>,
+        temps: &mut Vec<(String, String)>,
+    ) -> Result<String, (u32, String)> {
+        let c_name = &self.natives[name];
+
+        // Whatever `apply` calls is passed arguments that can't be checked here.
+        if name == "apply" || !self.proves(name, args) {
+            self.proven.set(false);
+        }
+
+        if args.is_empty() {
+            return Ok(format!("{}(NULL, 0)", c_name));
+        }
+
+        let mut c_args = Vec::new();
+        for arg in args {
+            c_args.push(self.expression(arg, temps)?);
+        }
+
+        let direct = self.signatures.get(name).map_or(false, |s| s.direct.contains(&args.len()));
+        if direct {
+            return Ok(format!("{}{}({})", c_name, c_args.len(), c_args.join(", ")));
+        }
+
+        Ok(format!(
+            "{}((struct LispDatum*[]){{{}}}, {})",
+            c_name,
+            c_args.join(", "),
+            c_args.len()
+        ))
+    }
+
+    /// Whether running a node may reach a safepoint, by calling anything other than a native. The
+    /// only native that calls back into generated code is `apply`.
+    fn may_collect(&self, node: &ASTNode) -> bool {
+        match node {
+            ASTNode::Statement(Definition(_, value)) => self.value_may_collect(value),
+            ASTNode::Statement(Declaration(_)) => false,
+            ASTNode::Statement(ExpandedCondition(condition, if_true, if_false)) => {
+                self.value_may_collect(condition)
+                    || if_true.iter().chain(if_false.iter()).any(|n| self.may_collect(n))
+            }
+            ASTNode::Statement(ExpandedGuard(_, _, body, handler)) => {
+                body.iter().chain(handler.iter()).any(|n| self.may_collect(n))
+            }
+            ASTNode::Value(v) => self.value_may_collect(v),
+        }
+    }
+
+    fn value_may_collect(&self, value: &Value) -> bool {
+        match value {
+            Literal(_) | Lambda(_, _) => false,
+            Call(callee, args) => {
+                let native = match callee.as_ref() {
+                    Literal(Token {
+                        value: Symbol(s), ..
+                    }) => self.natives.contains_key(s) && s != "apply",
+                    _ => false,
+                };
+
+                !native || args.iter().any(|arg| self.value_may_collect(arg))
+            }
+            Condition(c, t, f) => {
+                self.value_may_collect(c) || self.value_may_collect(t) || self.value_may_collect(f)
+            }
+            Guard(_, _, body, handler) => {
+                self.value_may_collect(body) || self.value_may_collect(handler)
+            }
+        }
+    }
+
+    /// Whether a variable of main is declared at file scope, rather than as a local.
+    fn is_shared(&self, c_name: &str) -> bool {
+        !self.in_function.get() && self.shared.borrow().contains(c_name)
+    }
+
+    fn hoist(&self, init: String, temps: &mut Vec<(String, String)>) -> String {
+        let n = self.temporaries.get() + 1;
+        self.temporaries.set(n);
+
+        let name = format!("_tmp{}", n);
+        temps.push((name.clone(), init));
+        name
+    }
+
+    /// Refer to an interned symbol, registering it to be interned on startup if it is new.
+    fn symbol(&self, label: String) -> String {
+        let mut symbols = self.symbols.borrow_mut();
+
+        let index = match symbols.iter().position(|s| *s == label) {
+            Some(i) => i,
+            None => {
+                symbols.push(label);
+                symbols.len() - 1
+            }
+        };
+
+        format!("_symbols[{}]", index)
+    }
+
+    /// Whether the arguments of a call are known to be what the native expects.
+    fn proves(&self, name: &str, args: &Vec<Value>) -> bool {
+        let signature = match self.signatures.get(name) {
+            Some(s) => s,
+            None => return false,
+        };
+
+        let max = signature.args.len() + signature.optional.len();
+        if args.len() < signature.args.len() || (signature.rest.is_none() && args.len() > max) {
+            return false;
+        }
+
+        args.iter().enumerate().all(|(i, arg)| {
+            let expected = signature
+                .args
+                .iter()
+                .chain(signature.optional.iter())
+                .nth(i)
+                .or(signature.rest.as_ref())
+                .unwrap();
+
+            satisfies(&self.static_type(arg), expected)
+        })
+    }
+
+    /// The type of a value as far as it is known at compile time.
+    fn static_type(&self, value: &Value) -> String {
+        let t = match value {
+            Literal(t) => t,
+            Call(callee, _) => {
+                return match callee.as_ref() {
+                    Literal(Token {
+                        value: Symbol(s), ..
+                    }) => self.signatures.get(s).map_or("any", |sig| &sig.returns[..]),
+                    _ => "any",
+                }
+                .to_string()
+            }
+            Lambda(_, _) => return String::from("procedure"),
+            _ => return String::from("any"),
+        };
+
+        String::from(match t.value() {
+            Int(_) => "integer",
+            BigInt(_) | Float(_) | Rational(_, _) | Complex(_, _) => "number",
+            Str(_) => "string",
+            Keyword(_) => "keyword",
+            True | False => "boolean",
+            Symbol(s) if s == "nil" => "nil",
+            Symbol(s) if self.natives.contains_key(&s) => "procedure",
+            Symbol(s) if !self.variables.contains_key(&s) => {
+                return self
+                    .types
+                    .borrow()
+                    .get(&Gensym::convert(&s))
+                    .cloned()
+                    .unwrap_or(String::from("any"))
+            }
+            _ => "any",
+        })
+    }
+
+    /// Record the type of a value assigned to a variable. A variable assigned values of different
+    /// types, such as the output of a condition, is only known to be `any`.
+    fn assign_type(&self, c_name: &str, t: String) {
+        let mut types = self.types.borrow_mut();
+
+        let joined = match types.get(c_name) {
+            Some(previous) if *previous != t => String::from("any"),
+            _ => t,
+        };
+
+        types.insert(c_name.to_string(), joined);
+    }
+
+    /// Whether a literal produces a new heap value that has to be released. Natives used as values
+    /// are wrapped in a new closure.
+    fn allocates(&self, t: &Token) -> bool {
+        match t.value() {
+            Int(i) => i < SMALL_INT_MIN || i > SMALL_INT_MAX,
+            BigInt(_) | Float(_) | Rational(_, _) | Complex(_, _) | Str(_) => true,
+            Symbol(s) => self.natives.contains_key(&s),
+            _ => false,
+        }
+    }
+
+    /// Collect the C names of every variable referred to by a node, including variables that it
+    /// assigns to.
+    fn node_references(&self, node: &ASTNode, names: &mut HashSet<String>) {
+        match node {
+            ASTNode::Statement(Definition(name, value)) => {
+                names.insert(Gensym::convert(name));
+                self.value_references(value, names);
+            }
+            ASTNode::Statement(Declaration(name)) => {
+                names.insert(Gensym::convert(name));
+            }
+            ASTNode::Statement(ExpandedCondition(condition, if_true, if_false)) => {
+                self.value_references(condition, names);
+
+                for n in if_true.iter().chain(if_false.iter()) {
+                    self.node_references(n, names);
+                }
+            }
+            ASTNode::Statement(ExpandedGuard(_, _, body, handler)) => {
+                for n in body.iter().chain(handler.iter()) {
+                    self.node_references(n, names);
+                }
+            }
+            ASTNode::Value(v) => self.value_references(v, names),
+        }
+    }
+
+    /// Calls to lifted functions refer to the variables passed to them, and lambdas refer to the
+    /// variables they capture.
+    fn value_references(&self, value: &Value, names: &mut HashSet<String>) {
+        match value {
+            Literal(Token {
+                value: Symbol(s), ..
+            }) => {
+                if !self.variables.contains_key(s)
+                    && !self.natives.contains_key(s)
+                    && !self.lifted.borrow().contains_key(s)
+                {
+                    names.insert(Gensym::convert(s));
+                }
+            }
+            Literal(_) => {}
+            Call(callee, args) => {
+                match callee.as_ref() {
+                    Literal(Token {
+                        value: Symbol(s), ..
+                    }) if self.lifted.borrow().contains_key(s) => {
+                        names.extend(self.lifted.borrow()[s].iter().cloned());
+                    }
+                    callee => self.value_references(callee, names),
+                }
+
+                for arg in args {
+                    self.value_references(arg, names);
+                }
+            }
+            Lambda(params, body) => names.extend(self.free_variables(params, body)),
+            Condition(c, t, f) => {
+                self.value_references(c, names);
+                self.value_references(t, names);
+                self.value_references(f, names);
+            }
+            Guard(_, _, body, handler) => {
+                self.value_references(body, names);
+                self.value_references(handler, names);
+            }
+        }
+    }
+
+    /// The `Cause` in liblisp/err.h matching a condition keyword.
+    fn cause(&self, condition: &str) -> &'static str {
+        match condition {
+            "type" => "Type",
+            "argument" => "Argument",
+            "zero-division" => "ZeroDivision",
+            "math" => "Math",
+            _ => "Generic",
+        }
+    }
+
+    /// Literals are passed to natives directly as expressions. Small integers resolve to shared,
+    /// preallocated values, so they cost nothing at runtime.
+    fn literal(&self, t: &Token) -> Result<String, (u32, String)> {
+        match t.value() {
+            Int(i) => Ok(format!("box_integer({})", i)),
+            BigInt(s) => Ok(format!("new_bigint_from_string(\"{}\")", s)),
+            Float(f) => Ok(format!("new_real({})", c_double(f))),
+            Rational(a, b) => Ok(format!("new_rational({}, {})", a, b)),
+            Complex(r, i) => Ok(format!("new_complex({}, {})", c_double(r), c_double(i))),
+            Str(s) => Ok(format!("LISP_STRING_LITERAL(\"{}\")", s)),
+            True => Ok(String::from("get_true()")),
+            False => Ok(String::from("get_false()")),
+            Symbol(s) => {
+                if let Some(expr) = self.variables.get(&s) {
+                    Ok(expr.clone())
+                } else if let Some(c_name) = self.natives.get(&s) {
+                    // The wrapper passes along whatever it is called with, which can't be proven.
+                    self.proven.set(false);
+                    self.wrapped.borrow_mut().insert(c_name.clone());
+                    Ok(format!("new_closure(_native_{}, LISP_VARIADIC, NULL, 0)", c_name))
+                } else {
+                    Ok(Gensym::convert(&s))
+                }
+            }
+            Keyword(k) => Ok(self.symbol(format!(":{}", k))),
+            Open | VectorOpen | Close | MapOpen | MapClose => {
+                Err((t.line(), String::from("Unexpected parenthesis.")))
+            }
+        }
+    }
+}
+
+/// Collect the LISP names a node binds: the variables it defines and handler bindings, as well as
+/// the parameters of lambdas if `nested`. Variables defined within lambdas are only included if
+/// `nested`, since they are local to the lambda.
+fn bound_names(node: &ASTNode, nested: bool, names: &mut HashSet<String>) {
+    match node {
+        ASTNode::Statement(Definition(name, value)) => {
+            names.insert(name.clone());
+            value_bound_names(value, nested, names);
+        }
+        ASTNode::Statement(Declaration(name)) => {
+            names.insert(name.clone());
+        }
+        ASTNode::Statement(ExpandedCondition(condition, if_true, if_false)) => {
+            value_bound_names(condition, nested, names);
+
+            for n in if_true.iter().chain(if_false.iter()) {
+                bound_names(n, nested, names);
+            }
+        }
+        ASTNode::Statement(ExpandedGuard(_, binding, body, handler)) => {
+            names.extend(binding.iter().cloned());
+
+            for n in body.iter().chain(handler.iter()) {
+                bound_names(n, nested, names);
+            }
+        }
+        ASTNode::Value(v) => value_bound_names(v, nested, names),
+    }
+}
+
+fn value_bound_names(value: &Value, nested: bool, names: &mut HashSet<String>) {
+    match value {
+        Literal(_) => {}
+        Call(callee, args) => {
+            value_bound_names(callee, nested, names);
+
+            for arg in args {
+                value_bound_names(arg, nested, names);
+            }
+        }
+        Condition(c, t, f) => {
+            value_bound_names(c, nested, names);
+            value_bound_names(t, nested, names);
+            value_bound_names(f, nested, names);
+        }
+        Guard(_, binding, body, handler) => {
+            names.extend(binding.iter().cloned());
+            value_bound_names(body, nested, names);
+            value_bound_names(handler, nested, names);
+        }
+        Lambda(params, body) if nested => {
+            names.extend(params.iter().cloned());
+
+            for n in body {
+                bound_names(n, nested, names);
+            }
+        }
+        Lambda(_, _) => {}
+    }
+}
+
+/// The C names of the variables defined at the top level. A handler binding hides a variable of
+/// the same name within its handler, so those are left out.
+fn global_names(ast: &[ASTNode]) -> HashSet<String> {
+    let mut names = HashSet::new();
+    let mut bindings = HashSet::new();
+
+    for node in ast {
+        match node {
+            ASTNode::Statement(Definition(name, _)) | ASTNode::Statement(Declaration(name)) => {
+                names.insert(Gensym::convert(name));
+            }
+            _ => {}
+        }
+        handler_bindings(node, &mut bindings);
+    }
+
+    names.retain(|name| !bindings.contains(name));
+    names
+}
+
+/// Collect the C names bound by handlers outside of any lambda.
+fn handler_bindings(node: &ASTNode, names: &mut HashSet<String>) {
+    match node {
+        ASTNode::Statement(ExpandedCondition(_, if_true, if_false)) => {
+            for n in if_true.iter().chain(if_false.iter()) {
+                handler_bindings(n, names);
+            }
+        }
+        ASTNode::Statement(ExpandedGuard(_, binding, body, handler)) => {
+            names.extend(binding.iter().map(|name| Gensym::convert(name)));
+
+            for n in body.iter().chain(handler.iter()) {
+                handler_bindings(n, names);
+            }
+        }
+        _ => {}
+    }
+}
+
+/// Remove every function from `arities` that is used other than by calling it by name with the
+/// expected number of arguments, or whose name is bound again anywhere.
+fn remove_escaping(nodes: &[ASTNode], arities: &mut HashMap<String, usize>) {
+    for node in nodes {
+        match node {
+            ASTNode::Statement(Definition(_, value)) => value_escapes(value, arities),
+            ASTNode::Statement(Declaration(_)) => {}
+            ASTNode::Statement(ExpandedCondition(condition, if_true, if_false)) => {
+                value_escapes(condition, arities);
+                remove_escaping(if_true, arities);
+                remove_escaping(if_false, arities);
+            }
+            ASTNode::Statement(ExpandedGuard(_, binding, body, handler)) => {
+                if let Some(name) = binding {
+                    arities.remove(name);
+                }
+                remove_escaping(body, arities);
+                remove_escaping(handler, arities);
+            }
+            ASTNode::Value(v) => value_escapes(v, arities),
+        }
+    }
+}
+
+fn value_escapes(value: &Value, arities: &mut HashMap<String, usize>) {
+    match value {
+        Literal(Token {
+            value: Symbol(s), ..
+        }) => {
+            arities.remove(s);
+        }
+        Literal(_) => {}
+        Call(callee, args) => {
+            match callee.as_ref() {
+                Literal(Token {
+                    value: Symbol(s), ..
+                }) if arities.get(s) == Some(&args.len()) => {}
+                callee => value_escapes(callee, arities),
+            }
+
+            for arg in args {
+                value_escapes(arg, arities);
+            }
+        }
+        Condition(c, t, f) => {
+            value_escapes(c, arities);
+            value_escapes(t, arities);
+            value_escapes(f, arities);
+        }
+        Guard(_, binding, body, handler) => {
+            if let Some(name) = binding {
+                arities.remove(name);
+            }
+            value_escapes(body, arities);
+            value_escapes(handler, arities);
+        }
+        Lambda(params, body) => {
+            for p in params {
+                arities.remove(p);
+            }
+            remove_escaping(body, arities);
+        }
+    }
+}
+
+/// A C expression for a double. Literals too large to represent are read as infinities, which C
+/// has no literal syntax for.
+fn c_double(f: f64) -> String {
+    if f.is_nan() {
+        String::from("NAN")
+    } else if f.is_infinite() {
+        String::from(if f > 0.0 { "HUGE_VAL" } else { "-HUGE_VAL" })
+    } else {
+        format!("{:?}", f)
+    }
+}
+
+/// Whether a value of type `actual` is always acceptable where `expected` is required.
+fn satisfies(actual: &str, expected: &str) -> bool {
+    actual == expected
+        || expected == "any"
+        || (expected == "list" && (actual == "pair" || actual == "nil"))
+        || (expected == "number" && actual == "integer")
+}
+
+#[cfg(test)]
+mod test {
+    use crate::ast::test_utils::force_from;
+    use crate::ast::{ASTVisitor, ConditionUnroll, SymbolTable};
+    use crate::emit::{CEmitter, Signature};
+    use std::collections::HashMap;
+
+    fn emitter() -> CEmitter {
+        let mut natives = HashMap::new();
+        natives.insert("+".to_string(), "add".to_string());
+        natives.insert("format".to_string(), "format".to_string());
+
+        let mut variables = HashMap::new();
+        variables.insert("nil".to_string(), "get_nil()".to_string());
+
+        CEmitter::new(natives, variables)
+    }
+
+    #[test]
+    fn integer_literals_are_immediate() {
+        let program = emitter().emit_program(&force_from("(+ 1 -2)")).unwrap();
+
+        assert!(program
+            .contains("release(add((struct LispDatum*[]){box_integer(1), box_integer(-2)}, 2));"));
+    }
+
+    #[test]
+    fn non_finite_reals() {
+        let program = emitter().emit_program(&force_from("(format 1e400 -1e400 2.5)")).unwrap();
+
+        assert!(program.starts_with("#include <math.h>\n"));
+        assert!(program.contains("new_real(HUGE_VAL)"));
+        assert!(program.contains("new_real(-HUGE_VAL)"));
+        assert!(program.contains("new_real(2.5)"));
+        assert_eq!(super::c_double(f64::NAN), "NAN");
+    }
+
+    #[test]
+    fn definitions_and_variables() {
+        let program = emitter()
+            .emit_program(&force_from("(define my-val nil) (format my-val)"))
+            .unwrap();
+
+        assert!(program.contains("struct LispDatum* my_minus_val = retain(get_nil());"));
+        assert!(program.contains("release(format((struct LispDatum*[]){my_minus_val}, 1));"));
+    }
+
+    #[test]
+    fn temporaries_are_released() {
+        let program = emitter()
+            .emit_program(&force_from("(format (+ 1 2.5) \"text\")"))
+            .unwrap();
+
+        assert!(program.contains("struct LispDatum* _tmp1 = new_real(2.5);"));
+        assert!(program.contains(
+            "struct LispDatum* _tmp2 = add((struct LispDatum*[]){box_integer(1), _tmp1}, 2);"
+        ));
+        assert!(program.contains("struct LispDatum* _tmp3 = LISP_STRING_LITERAL(\"text\");"));
+        assert!(program.contains("release(format((struct LispDatum*[]){_tmp2, _tmp3}, 2));"));
+
+        for i in 1..4 {
+            assert!(program.contains(&format!("release_deferred(_tmp{});", i)));
+        }
+    }
+
+    #[test]
+    fn variables_released_after_last_use() {
+        let program = emitter()
+            .emit_program(&force_from(
+                "(define a 1) (define b 2) (format a) (format b)",
+            ))
+            .unwrap();
+
+        let release_a = program.find("release(a);").unwrap();
+        let release_b = program.find("release(b);").unwrap();
+        let format_a = program.find("format((struct LispDatum*[]){a}, 1)").unwrap();
+        let format_b = program.find("format((struct LispDatum*[]){b}, 1)").unwrap();
+
+        assert!(format_a < release_a && release_a < format_b && format_b < release_b);
+    }
+
+    #[test]
+    fn variables_are_rooted() {
+        let program = emitter()
+            .emit_program(&force_from("(define a 1) (format a) (format 2)"))
+            .unwrap();
+
+        let define_a = program
+            .find("struct LispDatum* a = box_integer(1);")
+            .unwrap();
+        let root_a = program.find("gc_push_root(&a);").unwrap();
+        let clear_a = program.find("a = NULL;").unwrap();
+        let format_2 = program
+            .find("format((struct LispDatum*[]){box_integer(2)}, 1)")
+            .unwrap();
+
+        assert!(define_a < root_a && root_a < clear_a && clear_a < format_2);
+        assert_eq!(program.matches("gc_safepoint();").count(), 3);
+        assert!(program.contains("gc_pop_roots(1);"));
+    }
+
+    #[test]
+    fn functions_reach_safepoints() {
+        let program = emitter()
+            .emit_program(&force_from("(define f (lambda (x) (format x (f (+ x 1))))) (format (f 1))"))
+            .unwrap();
+
+        // Every call passes through a safepoint, with the parameters rooted.
+        assert!(program.contains(
+            "static struct LispDatum* _lifted_f(struct LispDatum* x) {\n  gc_push_root(&x);\n  gc_safepoint();\n"
+        ));
+
+        // Temporaries of a statement that calls a function are rooted until the statement ends.
+        let root = program.find("gc_push_root(&_tmp1);").unwrap();
+        let call = program.find("_lifted_f(_tmp1);").unwrap();
+        let pop = program.find("gc_pop_roots(2);").unwrap();
+        assert!(root < call && call < pop);
+        assert!(program.contains("  gc_pop_roots(1);\n  return _result;"));
+
+        // Statements that only call natives can't collect, so their temporaries aren't rooted.
+        let program = emitter().emit_program(&force_from("(format (+ 1 2.5))")).unwrap();
+        assert!(!program.contains("gc_push_root(&_tmp"));
+    }
+
+    #[test]
+    fn keywords_are_interned_once() {
+        let program = emitter()
+            .emit_program(&force_from("(format :a :b :a)"))
+            .unwrap();
+
+        assert!(program.contains("static const char* const _symbol_labels[] = {\":a\", \":b\"};"));
+        assert!(program.contains("intern_all(_symbols, _symbol_labels, 2);"));
+        assert!(program
+            .contains("format((struct LispDatum*[]){_symbols[0], _symbols[1], _symbols[0]}, 3)"));
+    }
+
+    #[test]
+    fn guards_install_handlers() {
+        let mut sym_table = SymbolTable::dummy();
+        let ast: Vec<_> = force_from("(format (guard (:zero-division :math) (+ 1 2) 0))")
+            .iter()
+            .flat_map(|node| ConditionUnroll.visit(node, &mut sym_table))
+            .collect();
+        let program = emitter().emit_program(&ast).unwrap();
+
+        let push = program
+            .find("lisp_push_handler(&_handler1, LISP_CAUSE_MASK(ZeroDivision) | LISP_CAUSE_MASK(Math));")
+            .unwrap();
+        let body = program.find("reassign(gensym1_guarded_value, add(").unwrap();
+        let pop = program.find("lisp_pop_handler(&_handler1);").unwrap();
+        let handler = program
+            .find("gensym1_guarded_value = reassign(gensym1_guarded_value, box_integer(0));")
+            .unwrap();
+
+        // The result is assigned after the `setjmp`, and read after a jump to the handler.
+        assert!(program.contains("struct LispDatum* volatile gensym1_guarded_value = NULL;"));
+        assert!(program.contains("gc_push_root((struct LispDatum**) &gensym1_guarded_value);"));
+        assert!(program.contains("if (setjmp(_handler1.jump) == 0) {"));
+        assert!(push < body && body < pop && pop < handler);
+        assert!(program.contains("format((struct LispDatum*[]){gensym1_guarded_value}, 1)"));
+    }
+
+    #[test]
+    fn with_handler_binds_condition() {
+        let mut sym_table = SymbolTable::dummy();
+        let ast: Vec<_> = force_from("(define x (with-handler e (+ 1 2) e)) (format x)")
+            .iter()
+            .flat_map(|node| ConditionUnroll.visit(node, &mut sym_table))
+            .collect();
+        let program = emitter().emit_program(&ast).unwrap();
+
+        assert!(program.contains("lisp_push_handler(&_handler1, LISP_ANY_CAUSE);"));
+        assert!(program.contains("struct LispDatum* e = condition_keyword(_handler1.cause);"));
+        assert!(program.contains("gensym1_guarded_value = reassign(gensym1_guarded_value, retain(e));"));
+        assert!(program.contains("struct LispDatum* x = retain(gensym1_guarded_value);"));
+        assert!(!program.contains("release(e);"));
+    }
+
+    fn checked_emitter() -> CEmitter {
+        let mut natives = HashMap::new();
+        natives.insert("car".to_string(), "car".to_string());
+        natives.insert("cons".to_string(), "cons".to_string());
+        natives.insert("apply".to_string(), "apply".to_string());
+
+        let mut signatures = HashMap::new();
+        let signature = |args: &[&str], returns: &str| Signature {
+            args: args.iter().map(|t| t.to_string()).collect(),
+            optional: Vec::new(),
+            rest: None,
+            returns: returns.to_string(),
+            direct: vec![args.len()],
+        };
+        signatures.insert("car".to_string(), signature(&["pair"], "any"));
+        signatures.insert("cons".to_string(), signature(&["any", "any"], "pair"));
+        signatures.insert("apply".to_string(), signature(&["procedure", "pair"], "any"));
+
+        CEmitter::new(natives, HashMap::new()).with_signatures(signatures)
+    }
+
+    #[test]
+    fn proven_programs_are_unchecked() {
+        let program = checked_emitter()
+            .emit_program(&force_from("(define p (cons 1 2)) (car p) (car (cons p 3))"))
+            .unwrap();
+
+        assert!(program.starts_with("#define LISP_UNCHECKED\n"));
+    }
+
+    #[test]
+    fn unproven_programs_are_checked() {
+        for source in &["(car 1)", "(car (car (cons 1 2)))", "(cons 1)", "(define p 1) (define p (cons 1 2)) (car p)"] {
+            let program = checked_emitter().emit_program(&force_from(source)).unwrap();
+
+            assert!(!program.contains("LISP_UNCHECKED"), "{}", source);
+        }
+
+        // Natives called through a closure or `apply` aren't checked against their signatures.
+        for source in &["(define f car) (f 5)", "(apply car (cons 5 nil))", "(apply (lambda (x) x) (cons 5 nil))"] {
+            let program = checked_emitter().emit_program(&force_from(source)).unwrap();
+
+            assert!(!program.contains("LISP_UNCHECKED"), "{}", source);
+        }
+
+        // Natives without signatures are never proven.
+        let program = emitter().emit_program(&force_from("(+ 1 2)")).unwrap();
+        assert!(!program.contains("LISP_UNCHECKED"));
+    }
+
+    #[test]
+    fn fixed_arity_calls_are_direct() {
+        let program = checked_emitter()
+            .emit_program(&force_from("(car (cons 1 2)) (cons 1)"))
+            .unwrap();
+
+        assert!(program.contains("_tmp1 = cons2(box_integer(1), box_integer(2));"));
+        assert!(program.contains("release(car1(_tmp1));"));
+
+        // Other arities, and natives without signatures, go through the variadic form.
+        assert!(program.contains("cons((struct LispDatum*[]){"));
+        let program = emitter().emit_program(&force_from("(+ 1 2)")).unwrap();
+        assert!(program.contains("add((struct LispDatum*[]){"));
+    }
+
+    #[test]
+    fn functions_called_by_name_are_lifted() {
+        let program = emitter()
+            .emit_program(&force_from(
+                "(define k 2) (define f (lambda (x) (+ x k))) (define g (lambda () (f 1))) (format (g))",
+            ))
+            .unwrap();
+
+        // Variables used from the top level are read at file scope rather than passed along.
+        assert!(program.contains("static struct LispDatum* k;"));
+        assert!(program.contains("static struct LispDatum* _lifted_f(struct LispDatum* x);"));
+        assert!(program.contains("static struct LispDatum* _lifted_g(void) {"));
+        assert!(program.contains("struct LispDatum* _result = _lifted_f(box_integer(1));"));
+        assert!(program.contains("  k = box_integer(2);"));
+        assert!(!program.contains("new_closure"));
+
+        let release_k = program.find("release(k);").unwrap();
+        assert!(program.find("_lifted_g()").unwrap() < release_k);
+    }
+
+    #[test]
+    fn applied_lambdas_are_lifted() {
+        let program = emitter()
+            .emit_program(&force_from("(format ((lambda (a b) a) 1 2))"))
+            .unwrap();
+
+        assert!(program.contains("(struct LispDatum* a, struct LispDatum* b) {\n  (void) b;\n"));
+        assert!(program.contains("(box_integer(1), box_integer(2))"));
+        assert!(!program.contains("new_closure"));
+    }
+
+    #[test]
+    fn escaping_lambdas_are_closures() {
+        let program = emitter()
+            .emit_program(&force_from(
+                "(define make (lambda (k) (lambda (x) (+ x k)))) (define f (make 1)) (format (f 2))",
+            ))
+            .unwrap();
+
+        assert!(program.contains("struct LispDatum* x = _args[0];"));
+        assert!(program.contains("struct LispDatum* k = closure_captured(_self, 0);"));
+        assert!(program.contains("new_closure(_lambda1, 1, (struct LispDatum*[]){k}, 1)"));
+        assert!(program.contains("call_closure(f, (struct LispDatum*[]){box_integer(2)}, 1)"));
+    }
+
+    #[test]
+    fn closures_read_current_globals() {
+        let program = emitter()
+            .emit_program(&force_from(
+                "(define x 1) (define get-x (lambda () x)) (define get-y (lambda () x)) (define g get-y) \
+                 (define x 2) (format (get-x) (get-y) (g))",
+            ))
+            .unwrap();
+
+        // Both the lifted function and the closure see the redefinition.
+        assert!(program.contains("static struct LispDatum* x;"));
+        assert!(program.contains("static struct LispDatum* _lifted_get_minus_x(void)"));
+        assert!(program.contains("get_minus_y = new_closure(_lambda1, 0, NULL, 0);"));
+        assert!(program.contains("x = reassign(x, box_integer(2));"));
+        assert!(!program.contains("closure_captured"));
+
+        // Globals are only released once nothing could call a function reading them.
+        let release_x = program.find("release(x);").unwrap();
+        assert!(program.find("call_closure(g, NULL, 0)").unwrap() < release_x);
+        assert!(release_x < program.rfind("gc_pop_roots(").unwrap());
+    }
+
+    #[test]
+    fn closures_refer_to_themselves() {
+        let program = emitter()
+            .emit_program(&force_from("(define f (lambda () (f))) (define g f) (format (g))"))
+            .unwrap();
+
+        assert!(program.contains("static struct LispDatum* f;"));
+        assert!(program.contains("  f = new_closure(_lambda1, 0, NULL, 0);"));
+        assert!(program.contains("  struct LispDatum* _result = call_closure(f, NULL, 0);"));
+        assert!(program.contains("call_closure(g, NULL, 0)"));
+
+        // Closures that capture nothing don't read themselves.
+        let program = emitter()
+            .emit_program(&force_from("(define f (lambda (x) x)) (define g f)"))
+            .unwrap();
+        assert!(program.contains("(void) _self;"));
+    }
+
+    #[test]
+    fn natives_as_values() {
+        let program = emitter()
+            .emit_program(&force_from("(define f +) (format (f 1 2))"))
+            .unwrap();
+
+        assert!(program.contains("static struct LispDatum* _native_add("));
+        assert!(program.contains("return add(_args, _nargs);"));
+        assert!(program.contains("struct LispDatum* f = new_closure(_native_add, LISP_VARIADIC, NULL, 0);"));
+    }
+
+    #[test]
+    fn unknown_function() {
+        let result = emitter().emit_program(&force_from("(frobnicate 1)"));
+
+        assert!(result.is_err());
+    }
+}
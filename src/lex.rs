@@ -37,6 +37,8 @@ impl Token {
 #[derive(Debug, Clone, PartialEq)]
 pub enum TokenValue {
     Int(i32),
+    /// An integer literal too large for an `Int`, kept as its base 10 digits (with any `-` sign).
+    BigInt(String),
     Float(f64),
     Complex(f64, f64),
     Rational(i32, i32),
@@ -45,7 +47,12 @@ pub enum TokenValue {
     Keyword(String),
     Symbol(String),
     Open,
+    /// The `#(` that opens a vector literal. It is closed by an ordinary `Close`.
+    VectorOpen,
     Close,
+    /// The braces around a hash map literal.
+    MapOpen,
+    MapClose,
     True,
     False,
 }
@@ -110,6 +117,8 @@ pub fn start(input: &str) -> Result<Vec<Token>, LexError> {
                 }),
                 Ok((s, v)) => Ok((s, v)),
             }
+        } else if s.starts_with("#(") {
+            Ok((&s[2..], TokenValue::VectorOpen))
         } else {
             // There's something left in the stream, so we first try to consume everything up to the
             // next token terminal.
@@ -123,6 +132,8 @@ pub fn start(input: &str) -> Result<Vec<Token>, LexError> {
                 match s.chars().nth(0).unwrap() {
                     '(' => Ok((&s[1..], TokenValue::Open)),
                     ')' => Ok((&s[1..], TokenValue::Close)),
+                    '{' => Ok((&s[1..], TokenValue::MapOpen)),
+                    '}' => Ok((&s[1..], TokenValue::MapClose)),
                     _ => panic!("This should theoretically be unreachable."),
                 }
             } else {
@@ -168,7 +179,7 @@ pub fn start(input: &str) -> Result<Vec<Token>, LexError> {
 
 // Auxiliary functions
 fn is_token_terminal(ch: char) -> bool {
-    ch.is_whitespace() || ch == '(' || ch == ')'
+    ch.is_whitespace() || ch == '(' || ch == ')' || ch == '{' || ch == '}'
 }
 
 fn is_symbolic_start(ch: char) -> bool {
@@ -292,9 +303,15 @@ fn escape(input: &str) -> IResult<&str, &str> {
 // Main Parsers
 
 fn int(input: &str) -> IResult<&str, TokenValue> {
-    let r: (&str, i32) = signed(&digits, false)(input)?;
+    let r = recognize(pair(signopt, digit1))(input)?;
 
-    Ok((r.0, TokenValue::Int(r.1)))
+    match r.1.parse::<i32>() {
+        Ok(i) => Ok((r.0, TokenValue::Int(i))),
+        Err(_) => Ok((
+            r.0,
+            TokenValue::BigInt(String::from(r.1.trim_start_matches('+'))),
+        )),
+    }
 }
 
 fn float(input: &str) -> IResult<&str, TokenValue> {
@@ -377,6 +394,15 @@ mod tests {
         assert_eq!(int("123"), Ok(("", Int(123))));
         assert_eq!(int("+123 asdf"), Ok((" asdf", Int(123))));
         assert_eq!(int("-123 "), Ok((" ", Int(-123))));
+        assert_eq!(
+            int("2147483648"),
+            Ok(("", BigInt(String::from("2147483648"))))
+        );
+        assert_eq!(
+            int("+123456789012345678901234567890"),
+            Ok(("", BigInt(String::from("123456789012345678901234567890"))))
+        );
+        assert_eq!(int("-2147483648"), Ok(("", Int(-2147483648))));
     }
 
     #[test]
@@ -576,6 +602,67 @@ mod tests {
         assert_eq!(boolean("#ft"), Ok(("t", False)));
     }
 
+    #[test]
+    fn vector_literals() {
+        assert_eq!(
+            start("#(1 #t) #f"),
+            Ok(vec!(
+                Token {
+                    line: 1,
+                    value: VectorOpen,
+                },
+                Token {
+                    line: 1,
+                    value: Int(1),
+                },
+                Token {
+                    line: 1,
+                    value: True,
+                },
+                Token {
+                    line: 1,
+                    value: Close,
+                },
+                Token {
+                    line: 1,
+                    value: False,
+                }
+            ))
+        );
+        assert_eq!(
+            start("# ("),
+            Err(LexError {
+                line: 1,
+                msg: "Unable to match `#` to a token value.".to_string(),
+            })
+        );
+    }
+
+    #[test]
+    fn map_literals() {
+        assert_eq!(
+            start("{:a 1}"),
+            Ok(vec!(
+                Token {
+                    line: 1,
+                    value: MapOpen,
+                },
+                Token {
+                    line: 1,
+                    value: Keyword("a".to_string()),
+                },
+                Token {
+                    line: 1,
+                    value: Int(1),
+                },
+                Token {
+                    line: 1,
+                    value: MapClose,
+                }
+            ))
+        );
+    }
+
     #[test]
     fn strings() {
         // assert_eq!(string("hello, world"), Ok(("", Str("hello, world".to_string()))));
@@ -2,9 +2,12 @@
 extern crate nom;
 
 use crate::ast::*;
+use crate::emit::{CEmitter, Signature};
+use std::collections::HashMap;
 use std::{env, fs};
 
 mod ast;
+mod emit;
 mod lex;
 mod parse;
 // mod ast;
@@ -20,8 +23,52 @@ fn main() {
     }
 }
 
+/// Read a string to string mapping out of the natives.json manifest.
+fn native_table(section: &str) -> HashMap<String, String> {
+    let manifest = json::parse(include_str!("../natives.json")).expect("Malformed natives.json");
+    let mut table = HashMap::new();
+
+    for (name, c_name) in manifest[section].entries() {
+        table.insert(name.to_string(), c_name.as_str().unwrap().to_string());
+    }
+
+    table
+}
+
+/// Read the signatures of natives out of the natives.json manifest.
+fn native_signatures() -> HashMap<String, Signature> {
+    let manifest = json::parse(include_str!("../natives.json")).expect("Malformed natives.json");
+    let mut signatures = HashMap::new();
+
+    for (name, signature) in manifest["signatures"].entries() {
+        let types = |key: &str| -> Vec<String> {
+            signature[key]
+                .members()
+                .map(|t| t.as_str().unwrap().to_string())
+                .collect()
+        };
+
+        signatures.insert(
+            name.to_string(),
+            Signature {
+                args: types("args"),
+                optional: types("optional"),
+                rest: signature["rest"].as_str().map(String::from),
+                returns: signature["returns"].as_str().unwrap_or("any").to_string(),
+                direct: signature["direct"]
+                    .members()
+                    .map(|n| n.as_usize().unwrap())
+                    .collect(),
+            },
+        );
+    }
+
+    signatures
+}
+
+// The generated C program is written to stdout, so all diagnostic output goes to stderr.
 fn run(program: &str) -> Result<(), (u32, String)> {
-    println!("########## Initial Program ##########\n{}", program);
+    eprintln!("########## Initial Program ##########\n{}", program);
 
     // let tokens = lex::start("(format (* 1 2 3))  (format 17i) (format 1.28) (format (+ 6 7 (* 2 7)))").unwrap();
     let tokens = lex::start(program).unwrap();
@@ -35,14 +82,14 @@ fn run(program: &str) -> Result<(), (u32, String)> {
         output.push('\n');
     }
 
-    println!("\n########## Parse Tree ##########\n{}", output);
+    eprintln!("\n########## Parse Tree ##########\n{}", output);
 
     let cnde = ConditionUnroll;
     let fne = FunctionUnfurl;
     let mut sym_table = SymbolTable::dummy();
     let ast = ast::construct_ast(&parse_tree)?;
 
-    println!("\n########## Initial AST ##########\n{:#?}", ast);
+    eprintln!("\n########## Initial AST ##########\n{:#?}", ast);
 
     let mut preliminary_pass = Vec::new();
 
@@ -50,7 +97,7 @@ fn run(program: &str) -> Result<(), (u32, String)> {
         preliminary_pass.append(&mut cnde.try_visit(&line, &mut sym_table)?);
     }
 
-    println!("\n########## AST After Conditional Unroll ##########\n{:#?}", preliminary_pass);
+    eprintln!("\n########## AST After Conditional Unroll ##########\n{:#?}", preliminary_pass);
 
     let mut output = Vec::new();
 
@@ -58,7 +105,11 @@ fn run(program: &str) -> Result<(), (u32, String)> {
         output.append(&mut fne.try_visit(&line, &mut sym_table)?);
     }
 
-    println!("\n########## Final AST ##########\n{:#?}", output);
+    eprintln!("\n########## Final AST ##########\n{:#?}", output);
+
+    let emitter = CEmitter::new(native_table("functions"), native_table("variables"))
+        .with_signatures(native_signatures());
+    println!("{}", emitter.emit_program(&output)?);
 
     Ok(())
 }
@@ -71,18 +71,32 @@ fn statement(tokens: &[Token]) -> Result<(ParseTree, &[Token]), (u32, String)> {
 
     match tokens[0].value() {
         TokenValue::Open => list(rest, tokens[0].line()),
+        TokenValue::VectorOpen => vector(rest, tokens[0].line()),
+        TokenValue::MapOpen => map(rest, tokens[0].line()),
         TokenValue::Close => Err((tokens[0].line(), "Unexpected end of list.".to_string())),
+        TokenValue::MapClose => Err((tokens[0].line(), "Unexpected end of hash map.".to_string())),
         _ => Ok((ParseTree::Leaf(tokens[0].clone()), rest)),
     }
 }
 
 fn list(tokens: &[Token], start_line: u32) -> Result<(ParseTree, &[Token]), (u32, String)> {
+    let (vals, stop_line, rest) = sequence(tokens, TokenValue::Close)?;
+
+    Ok((ParseTree::Branch(vals, start_line, stop_line), rest))
+}
+
+/// Read statements up to the given closing token. Returns them along with the line of the closing
+/// token and whatever follows it.
+fn sequence(
+    tokens: &[Token],
+    close: TokenValue,
+) -> Result<(Vec<ParseTree>, u32, &[Token]), (u32, String)> {
     let mut vals: Vec<ParseTree> = Vec::new();
     let mut t = &tokens[..];
 
     while !t.is_empty() {
-        if t[0].value() == TokenValue::Close {
-            return Ok((ParseTree::Branch(vals, start_line, t[0].line()), &t[1..]));
+        if t[0].value() == close {
+            return Ok((vals, t[0].line(), &t[1..]));
         }
 
         let r = statement(t)?;
@@ -93,6 +107,45 @@ fn list(tokens: &[Token], start_line: u32) -> Result<(ParseTree, &[Token]), (u32
     Err((0, "Unexpected EOF at end of list.".to_string()))
 }
 
+/// Literals are read as calls to the native that builds them, so their contents are evaluated
+/// like any other arguments.
+fn constructor_call(name: &str, mut vals: Vec<ParseTree>, start: u32, stop: u32) -> ParseTree {
+    let constructor = Token {
+        line: start,
+        value: TokenValue::Symbol(name.to_string()),
+    };
+    vals.insert(0, ParseTree::Leaf(constructor));
+
+    ParseTree::Branch(vals, start, stop)
+}
+
+/// A vector literal `#(a b c)` is read as `(vector a b c)`.
+fn vector(tokens: &[Token], start_line: u32) -> Result<(ParseTree, &[Token]), (u32, String)> {
+    let (vals, stop_line, rest) = sequence(tokens, TokenValue::Close)?;
+
+    Ok((
+        constructor_call("vector", vals, start_line, stop_line),
+        rest,
+    ))
+}
+
+/// A hash map literal `{k1 v1 k2 v2}` is read as `(hash-map k1 v1 k2 v2)`.
+fn map(tokens: &[Token], start_line: u32) -> Result<(ParseTree, &[Token]), (u32, String)> {
+    let (vals, stop_line, rest) = sequence(tokens, TokenValue::MapClose)?;
+
+    if vals.len() % 2 != 0 {
+        return Err((
+            start_line,
+            "Hash map literals need a value for every key.".to_string(),
+        ));
+    }
+
+    Ok((
+        constructor_call("hash-map", vals, start_line, stop_line),
+        rest,
+    ))
+}
+
 #[cfg(test)]
 mod test {
     use crate::lex::{start, Token, TokenValue::*};
@@ -171,6 +224,67 @@ mod test {
         }
     }
 
+    #[test]
+    fn vector_literal() {
+        let tokens = vec![
+            Token::from(VectorOpen),
+            Token::from(Int(1)),
+            Token::from(Int(2)),
+            Token::from(Close),
+        ];
+
+        let x = parse(&tokens).unwrap();
+
+        assert_eq!(x.len(), 1);
+        assert_eq!(
+            x[0],
+            Branch(
+                vec!(
+                    Leaf(Token::from(Symbol("vector".to_string()))),
+                    Leaf(Token::from(Int(1))),
+                    Leaf(Token::from(Int(2)))
+                ),
+                0,
+                0
+            )
+        );
+    }
+
+    #[test]
+    fn map_literal() {
+        let tokens = vec![
+            Token::from(MapOpen),
+            Token::from(Keyword("a".to_string())),
+            Token::from(Int(1)),
+            Token::from(MapClose),
+        ];
+
+        let x = parse(&tokens).unwrap();
+
+        assert_eq!(
+            x[0],
+            Branch(
+                vec!(
+                    Leaf(Token::from(Symbol("hash-map".to_string()))),
+                    Leaf(Token::from(Keyword("a".to_string()))),
+                    Leaf(Token::from(Int(1)))
+                ),
+                0,
+                0
+            )
+        );
+
+        let unpaired = vec![
+            Token::from(MapOpen),
+            Token::from(Int(1)),
+            Token::from(MapClose),
+        ];
+        assert!(parse(&unpaired).is_err());
+
+        let mismatched = vec![Token::from(MapOpen), Token::from(Close)];
+        assert!(parse(&mismatched).is_err());
+    }
+
     #[test]
     fn small_comprehensive() {
         let tokens = start("a 12 d1- (* 1i 2. (+ x 3)) ()").unwrap();